@@ -0,0 +1,610 @@
+/** \file alpha_expansion.hxx
+    \brief  Implementation of inferno::inference::AlphaExpansion,
+    alpha-expansion and alpha-beta-swap
+    for second order models.
+
+    Each move is a binary fusion move which is solved with
+    the bundled inferno::inference::MaxFlow, therefore
+    this solver does not need any externals.
+*/
+#ifndef INFERNO_INFERENCE_ALPHA_EXPANSION_HXX
+#define INFERNO_INFERENCE_ALPHA_EXPANSION_HXX
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <thread>
+#include <memory>
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "inferno/inferno.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
+#include "inferno/utilities/profiler.hxx"
+#include "inferno/model/discrete_model_base.hxx"
+#include "inferno/inference/discrete_inference_base.hxx"
+#include "inferno/inference/utilities/maxflow.hxx"
+
+namespace inferno{
+namespace inference{
+
+/// \cond
+namespace detail_alpha_expansion{
+
+    // dense view on the (second order) structure
+    // of a model which is shared between all move solvers
+    template<class MODEL>
+    class ModelStructure{
+    public:
+        typedef typename MODEL::VariableDescriptor VariableDescriptor;
+        typedef typename MODEL::FactorDescriptor   FactorDescriptor;
+        typedef typename MODEL::UnaryDescriptor    UnaryDescriptor;
+
+        struct Edge{
+            Vi u_;
+            Vi v_;
+            FactorDescriptor factor_;
+        };
+
+        ModelStructure(const MODEL & model)
+        :   model_(model),
+            denseVarIds_(model),
+            variables_(model.nVariables()),
+            nLabels_(model.nVariables()),
+            unaries_(),
+            unaryFactors_(),
+            edges_(),
+            maxNLabels_(0){
+
+            for(const auto var : model.variableDescriptors()){
+                const auto dvi = denseVarIds_.toDenseId(var);
+                variables_[dvi] = var;
+                nLabels_[dvi] = model.nLabels(var);
+                maxNLabels_ = std::max(maxNLabels_, nLabels_[dvi]);
+            }
+            for(const auto uDesc : model.unaryDescriptors()){
+                const auto unary = model.unary(uDesc);
+                unaries_.push_back(std::make_pair(denseVarIds_.toDenseId(unary->variable()), uDesc));
+            }
+            for(const auto fDesc : model.factorDescriptors()){
+                const auto factor = model.factor(fDesc);
+                const auto arity = factor->arity();
+                if(arity == 1){
+                    unaryFactors_.push_back(std::make_pair(denseVarIds_.toDenseId(factor->variable(0)), fDesc));
+                }
+                else if(arity == 2){
+                    const Vi u = denseVarIds_.toDenseId(factor->variable(0));
+                    const Vi v = denseVarIds_.toDenseId(factor->variable(1));
+                    INFERNO_CHECK_OP(u,!=,v, "second order factors must connect two different variables");
+                    edges_.push_back(Edge{u, v, fDesc});
+                }
+                else{
+                    throw RuntimeError("AlphaExpansion is only implemented for models with maxArity<=2");
+                }
+            }
+        }
+
+        ValueType energy(const std::vector<DiscreteLabel> & conf)const{
+            ValueType e = model_.constTerm();
+            for(const auto & u : unaries_)
+                e += model_.unary(u.second)->eval(conf[u.first]);
+            for(const auto & u : unaryFactors_){
+                const LabelType l = conf[u.first];
+                e += model_.factor(u.second)->eval(&l);
+            }
+            for(const auto & edge : edges_)
+                e += model_.factor(edge.factor_)->eval(conf[edge.u_], conf[edge.v_]);
+            return e;
+        }
+
+        const MODEL & model_;
+        models::DenseVariableIds<MODEL> denseVarIds_;
+        std::vector<VariableDescriptor> variables_;
+        std::vector<DiscreteLabel> nLabels_;
+        std::vector<std::pair<Vi, UnaryDescriptor> > unaries_;
+        std::vector<std::pair<Vi, FactorDescriptor> > unaryFactors_;
+        std::vector<Edge> edges_;
+        DiscreteLabel maxNLabels_;
+    };
+
+
+    // solves binary moves where each variable
+    // chooses between l0_ and l1_, l0_ is always the
+    // current labeling.
+    // The max-flow graph is allocated once and
+    // reused (including the search trees) for all moves.
+    template<class MODEL>
+    class MoveSolver{
+    public:
+        typedef ModelStructure<MODEL> Structure;
+        typedef MaxFlow<ValueType> Graph;
+
+        MoveSolver(const Structure & structure, const bool reuseTrees)
+        :   structure_(&structure),
+            graph_(structure.variables_.size(), structure.edges_.size()),
+            reuseTrees_(reuseTrees),
+            built_(false),
+            l0_(structure.variables_.size()),
+            l1_(structure.variables_.size()),
+            net_(structure.variables_.size()),
+            edgeCap_(structure.edges_.size()),
+            deficit_(structure.edges_.size()),
+            delta_(0){
+        }
+
+        // energy of the last result minus the energy of the labeling
+        // the move started from, computed from the cut
+        ValueType delta()const{
+            return delta_;
+        }
+
+        bool expansion(
+            const DiscreteLabel alpha,
+            const std::vector<DiscreteLabel> & conf,
+            std::vector<DiscreteLabel> & result
+        ){
+            const auto & nLabels = structure_->nLabels_;
+            for(size_t i=0; i<conf.size(); ++i){
+                l0_[i] = conf[i];
+                l1_[i] = alpha < nLabels[i] ? alpha : conf[i];
+            }
+            return solve(conf, result);
+        }
+
+        bool swap(
+            const DiscreteLabel alpha,
+            const DiscreteLabel beta,
+            const std::vector<DiscreteLabel> & conf,
+            std::vector<DiscreteLabel> & result
+        ){
+            const auto & nLabels = structure_->nLabels_;
+            for(size_t i=0; i<conf.size(); ++i){
+                const auto l = conf[i];
+                if((l == alpha || l == beta) && alpha < nLabels[i] && beta < nLabels[i]){
+                    l0_[i] = l;
+                    l1_[i] = l == alpha ? beta : alpha;
+                }
+                else{
+                    l0_[i] = l;
+                    l1_[i] = l;
+                }
+            }
+            return solve(conf, result);
+        }
+
+        bool fusion(
+            const std::vector<DiscreteLabel> & conf,
+            const std::vector<DiscreteLabel> & proposal,
+            std::vector<DiscreteLabel> & result
+        ){
+            for(size_t i=0; i<conf.size(); ++i){
+                l0_[i] = conf[i];
+                l1_[i] = proposal[i];
+            }
+            return solve(conf, result);
+        }
+
+    private:
+
+        void computeTerms(){
+            const auto & s = *structure_;
+            std::fill(net_.begin(), net_.end(), ValueType(0));
+
+            // first order terms:
+            // label 0 is paid with the sink capacity,
+            // label 1 with the source capacity
+            for(const auto & u : s.unaries_){
+                const Vi i = u.first;
+                if(l0_[i] != l1_[i]){
+                    const auto unary = s.model_.unary(u.second);
+                    net_[i] += unary->eval(l1_[i]) - unary->eval(l0_[i]);
+                }
+            }
+            for(const auto & u : s.unaryFactors_){
+                const Vi i = u.first;
+                if(l0_[i] != l1_[i]){
+                    const auto factor = s.model_.factor(u.second);
+                    const LabelType l0 = l0_[i];
+                    const LabelType l1 = l1_[i];
+                    net_[i] += factor->eval(&l1) - factor->eval(&l0);
+                }
+            }
+
+            // second order terms
+            for(size_t e=0; e<s.edges_.size(); ++e){
+                const auto & edge = s.edges_[e];
+                const Vi u = edge.u_;
+                const Vi v = edge.v_;
+                deficit_[e] = 0;
+                if(l0_[u] == l1_[u] && l0_[v] == l1_[v]){
+                    edgeCap_[e] = std::make_pair(0.0, 0.0);
+                    continue;
+                }
+                const auto factor = s.model_.factor(edge.factor_);
+                const ValueType a = factor->eval(l0_[u], l0_[v]);
+                ValueType       b = factor->eval(l0_[u], l1_[v]);
+                const ValueType c = factor->eval(l1_[u], l0_[v]);
+                const ValueType d = factor->eval(l1_[u], l1_[v]);
+
+                // make the term submodular by overestimating
+                // b, the energy of (l0,l0) stays exact
+                const ValueType deficit = (a + d) - (b + c);
+                if(deficit > 0){
+                    b += deficit;
+                    deficit_[e] = deficit;
+                }
+
+                net_[u] += d - a;
+                const ValueType bb = b - a;
+                const ValueType cc = c - d;
+                if(bb < 0){
+                    net_[u] -= bb;
+                    net_[v] += bb;
+                    edgeCap_[e] = std::make_pair(0.0, std::max(bb + cc, 0.0));
+                }
+                else if(cc < 0){
+                    net_[u] += cc;
+                    net_[v] -= cc;
+                    edgeCap_[e] = std::make_pair(std::max(bb + cc, 0.0), 0.0);
+                }
+                else{
+                    edgeCap_[e] = std::make_pair(bb, cc);
+                }
+            }
+        }
+
+        bool solve(
+            const std::vector<DiscreteLabel> & conf,
+            std::vector<DiscreteLabel> & result
+        ){
+            computeTerms();
+            const auto nNodes = l0_.size();
+            if(!built_){
+                graph_.addNodes(nNodes);
+                for(size_t i=0; i<nNodes; ++i)
+                    graph_.setTWeights(i, std::max(net_[i], 0.0), std::max(-net_[i], 0.0));
+                const auto & edges = structure_->edges_;
+                for(size_t e=0; e<edges.size(); ++e)
+                    graph_.addEdge(edges[e].u_, edges[e].v_, edgeCap_[e].first, edgeCap_[e].second);
+                graph_.resetFlow();
+                graph_.maxflow(false);
+                built_ = true;
+            }
+            else{
+                for(size_t i=0; i<nNodes; ++i)
+                    graph_.setTWeights(i, std::max(net_[i], 0.0), std::max(-net_[i], 0.0));
+                for(size_t e=0; e<edgeCap_.size(); ++e)
+                    graph_.setEdgeCapacities(e, edgeCap_[e].first, edgeCap_[e].second);
+                if(!reuseTrees_)
+                    graph_.resetFlow();
+                graph_.maxflow(reuseTrees_);
+            }
+            bool changes = false;
+            for(size_t i=0; i<nNodes; ++i){
+                result[i] = graph_.segment(i) == Graph::Sink ? l1_[i] : l0_[i];
+                changes = changes || result[i] != conf[i];
+            }
+            if(changes)
+                computeDelta();
+            else
+                delta_ = 0;
+            return changes;
+        }
+
+        // value of the cut relative to the all l0_ labeling.
+        // The flow of a reused graph is only known up to the
+        // constants of the reparametrizations, the cut is evaluated
+        // from the capacities instead (no factor is evaluated).
+        // Truncated terms are only overestimated for (l0, l1),
+        // which is corrected here, hence delta_ is exact.
+        void computeDelta(){
+            const auto & edges = structure_->edges_;
+            ValueType delta = 0;
+            for(size_t i=0; i<net_.size(); ++i)
+                if(graph_.segment(i) == Graph::Sink)
+                    delta += net_[i];
+            for(size_t e=0; e<edges.size(); ++e){
+                const bool xu = graph_.segment(edges[e].u_) == Graph::Sink;
+                const bool xv = graph_.segment(edges[e].v_) == Graph::Sink;
+                if(!xu && xv)
+                    delta += edgeCap_[e].first - deficit_[e];
+                else if(xu && !xv)
+                    delta += edgeCap_[e].second;
+            }
+            delta_ = delta;
+        }
+
+        const Structure * structure_;
+        Graph graph_;
+        bool reuseTrees_;
+        bool built_;
+        std::vector<DiscreteLabel> l0_;
+        std::vector<DiscreteLabel> l1_;
+        std::vector<ValueType> net_;
+        std::vector<std::pair<ValueType, ValueType> > edgeCap_;
+        std::vector<ValueType> deficit_;
+        ValueType delta_;
+    };
+
+} // end namespace inferno::inference::detail_alpha_expansion
+/// \endcond
+
+
+    /** \brief alpha-expansion and alpha-beta-swap
+        for models with maxArity <= 2.
+
+        Each move is solved as binary fusion move
+        with the bundled MaxFlow (no externals needed).
+        Non submodular moves (non-metric expansion terms,
+        non-semi-metric swap terms) are truncated,
+        only moves which decrease the energy are accepted.
+
+        With Options::nThreads_ != 1 the label schedule
+        is processed in batches: all moves of a batch
+        are solved in parallel from the same labeling
+        and afterwards fused sequentially into the current labeling.
+    */
+    template<class MODEL>
+    class AlphaExpansion  : public DiscreteInferenceBase<MODEL> {
+    public:
+        typedef MODEL Model;
+        typedef AlphaExpansion<MODEL> Self;
+        typedef DiscreteInferenceBase<MODEL> BaseInf;
+        typedef typename BaseInf::Visitor Visitor;
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+        typedef detail_alpha_expansion::ModelStructure<Model> Structure;
+        typedef detail_alpha_expansion::MoveSolver<Model> MoveSolverType;
+
+        struct Options{
+            enum MoveType{
+                Expansion,
+                Swap
+            };
+            enum LabelOrder{
+                DefaultOrder,
+                RandomOrder
+            };
+
+            Options(
+                const MoveType moveType = Expansion,
+                const uint64_t maxIterations = 1000,
+                const LabelOrder labelOrder = DefaultOrder,
+                const bool reuseTrees = true,
+                const uint64_t nThreads = 1,
+                const uint64_t seed = 0
+            )
+            :   moveType_(moveType),
+                maxIterations_(maxIterations),
+                labelOrder_(labelOrder),
+                reuseTrees_(reuseTrees),
+                nThreads_(nThreads),
+                seed_(seed)
+            {
+            }
+            MoveType moveType_;
+            uint64_t maxIterations_;
+            LabelOrder labelOrder_;
+            bool reuseTrees_;
+            uint64_t nThreads_;
+            uint64_t seed_;
+        };
+
+        AlphaExpansion(const Model & model, const Options & options = Options())
+        :   BaseInf(),
+            model_(model),
+            options_(options),
+            structure_(model),
+            conf_(structure_.variables_.size(), 0),
+            energy_(0.0),
+            moveSolvers_(),
+            pool_(),
+            stopInference_(false){
+            INFERNO_PROFILE_SCOPE("AlphaExpansion::setup");
+
+            const auto nThreads = options_.nThreads_ == 0 ?
+                std::thread::hardware_concurrency() : options_.nThreads_;
+            moveSolvers_.reserve(nThreads);
+            for(size_t t=0; t<nThreads; ++t)
+                moveSolvers_.emplace_back(structure_, options_.reuseTrees_);
+            if(nThreads > 1)
+                pool_.reset(new utilities::ThreadPool(nThreads));
+            energy_ = structure_.energy(conf_);
+        }
+
+        // MUST HAVE INTERACE
+        virtual std::string name() const {
+            return options_.moveType_ == Options::Expansion ?
+                "AlphaExpansion" : "AlphaBetaSwap";
+        }
+        // inference
+        virtual void infer( Visitor  * visitor  = NULL) {
+            INFERNO_PROFILE_SCOPE("AlphaExpansion::infer");
+            stopInference_ = false;
+            if(visitor!=NULL)
+                visitor->begin(this);
+
+            std::mt19937 gen(options_.seed_);
+
+            // the label schedule
+            std::vector<std::pair<DiscreteLabel, DiscreteLabel> > moves;
+            const auto nl = structure_.maxNLabels_;
+            if(options_.moveType_ == Options::Expansion){
+                for(DiscreteLabel alpha=0; alpha<nl; ++alpha)
+                    moves.push_back(std::make_pair(alpha, alpha));
+            }
+            else{
+                for(DiscreteLabel alpha=0; alpha<nl; ++alpha)
+                for(DiscreteLabel beta=alpha+1; beta<nl; ++beta)
+                    moves.push_back(std::make_pair(alpha, beta));
+            }
+
+            for(uint64_t iter=0; iter<options_.maxIterations_ && !stopInference_; ++iter){
+                INFERNO_PROFILE_SCOPE("AlphaExpansion::sweep");
+                if(options_.labelOrder_ == Options::RandomOrder)
+                    std::shuffle(moves.begin(), moves.end(), gen);
+                const bool changes = pool_ ?
+                    parallelSweep(moves, visitor) :
+                    sequentialSweep(moves, visitor);
+                if(!changes)
+                    break;
+            }
+            // drop the rounding errors of the accumulated deltas
+            energy_ = structure_.energy(conf_);
+
+            if(visitor!=NULL)
+                visitor->end(this);
+        }
+        // get result
+        virtual void conf(Conf & confMap ) {
+            for(size_t i=0; i<conf_.size(); ++i)
+                confMap[structure_.variables_[i]] = conf_[i];
+        }
+        virtual DiscreteLabel label(const Vi vi ) {
+            return conf_[structure_.denseVarIds_.toDenseId(vi)];
+        }
+        // get model
+        virtual const Model & model() const{
+            return model_;
+        }
+        // stop inference (via visitor)
+        virtual void stopInference(){
+            stopInference_ = true;
+        }
+
+        // OPTIONAL INTERFACE
+        // warm start related
+        virtual void setConf(const Conf & conf){
+            for(size_t i=0; i<conf_.size(); ++i)
+                conf_[i] = conf[structure_.variables_[i]];
+            energy_ = structure_.energy(conf_);
+        }
+        // get results optional interface
+        virtual ValueType upperBound(){
+            return energy_;
+        }
+        virtual ValueType energy(){
+            return energy_;
+        }
+
+    private:
+
+        bool solveMove(
+            MoveSolverType & moveSolver,
+            const std::pair<DiscreteLabel, DiscreteLabel> & move,
+            const std::vector<DiscreteLabel> & conf,
+            std::vector<DiscreteLabel> & result
+        ){
+            INFERNO_PROFILE_SCOPE("AlphaExpansion::move");
+            if(options_.moveType_ == Options::Expansion)
+                return moveSolver.expansion(move.first, conf, result);
+            else
+                return moveSolver.swap(move.first, move.second, conf, result);
+        }
+
+        bool fuse(
+            MoveSolverType & moveSolver,
+            const std::vector<DiscreteLabel> & proposal,
+            std::vector<DiscreteLabel> & result
+        ){
+            INFERNO_PROFILE_SCOPE("AlphaExpansion::fusion");
+            return moveSolver.fusion(conf_, proposal, result);
+        }
+
+        // accept result if it decreases the energy,
+        // delta is the energy of result minus energy_ (see MoveSolver::delta)
+        bool accept(std::vector<DiscreteLabel> & result, const ValueType delta){
+            if(delta < 0){
+                conf_.swap(result);
+                energy_ += delta;
+                return true;
+            }
+            return false;
+        }
+
+        bool sequentialSweep(
+            const std::vector<std::pair<DiscreteLabel, DiscreteLabel> > & moves,
+            Visitor * visitor
+        ){
+            auto & moveSolver = moveSolvers_.front();
+            std::vector<DiscreteLabel> result(conf_.size());
+            bool changes = false;
+            for(const auto & move : moves){
+                if(stopInference_)
+                    break;
+                if(solveMove(moveSolver, move, conf_, result) && accept(result, moveSolver.delta())){
+                    changes = true;
+                    if(visitor!=NULL)
+                        visitor->visit(this);
+                }
+            }
+            return changes;
+        }
+
+        bool parallelSweep(
+            const std::vector<std::pair<DiscreteLabel, DiscreteLabel> > & moves,
+            Visitor * visitor
+        ){
+            const size_t batchSize = moveSolvers_.size();
+            std::vector<std::vector<DiscreteLabel> > proposals(batchSize,
+                std::vector<DiscreteLabel>(conf_.size()));
+            std::vector<unsigned char> hasProposal(batchSize);
+            std::vector<ValueType> deltas(batchSize);
+            std::vector<DiscreteLabel> result(conf_.size());
+            bool changes = false;
+
+            for(size_t batchBegin=0; batchBegin<moves.size(); batchBegin+=batchSize){
+                if(stopInference_)
+                    break;
+                const size_t batchEnd = std::min(batchBegin + batchSize, moves.size());
+                const size_t nMoves = batchEnd - batchBegin;
+
+                // solve all moves of the batch from the current labeling
+                utilities::parallel_foreach(*pool_, nMoves,
+                    boost::counting_iterator<size_t>(0),
+                    boost::counting_iterator<size_t>(nMoves),
+                    [&](const int tid, const size_t m){
+                        auto & moveSolver = moveSolvers_[tid];
+                        hasProposal[m] = solveMove(moveSolver, moves[batchBegin + m], conf_, proposals[m]);
+                        deltas[m] = moveSolver.delta();
+                    }
+                );
+
+                // fuse the proposals into the current labeling
+                bool confChanged = false;
+                auto & moveSolver = moveSolvers_.front();
+                for(size_t m=0; m<nMoves; ++m){
+                    if(!hasProposal[m])
+                        continue;
+                    bool improved = false;
+                    if(!confChanged){
+                        // proposal has been computed from the current labeling
+                        improved = accept(proposals[m], deltas[m]);
+                    }
+                    else if(fuse(moveSolver, proposals[m], result)){
+                        improved = accept(result, moveSolver.delta());
+                    }
+                    if(improved){
+                        confChanged = true;
+                        changes = true;
+                        if(visitor!=NULL)
+                            visitor->visit(this);
+                    }
+                }
+            }
+            return changes;
+        }
+
+        const Model & model_;
+        Options options_;
+        Structure structure_;
+        std::vector<DiscreteLabel> conf_;
+        ValueType energy_;
+        std::vector<MoveSolverType> moveSolvers_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+        bool stopInference_;
+    };
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+#endif /* INFERNO_INFERENCE_ALPHA_EXPANSION_HXX */
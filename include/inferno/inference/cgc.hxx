@@ -1,28 +1,314 @@
-/** \file qpbo.hxx 
-    \brief  Implementation of inferno::inference::Cgc  
-
-    \warning To include this header one needs qpbo
-    from  inferno_externals
-    (in CMake ''WITH_QPBO'')
+/** \file cgc.hxx
+    \brief  Implementation of inferno::inference::Cgc
+
+    Cut, Glue & Cut for second order multicut models.
+    The binary cut problems are solved with a QPBO
+    construction on top of the bundled
+    inferno::inference::MaxFlow, therefore
+    this solver does not need any externals.
 */
-#ifndef INFERNO_INFERENCE_QPBO_HXX
-#define INFERNO_INFERENCE_QPBO_HXX
+#ifndef INFERNO_INFERENCE_CGC_HXX
+#define INFERNO_INFERENCE_CGC_HXX
+
+#include <map>
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <memory>
+#include <algorithm>
 
-#include <unordered_map>
+#include <boost/iterator/counting_iterator.hpp>
 
+#include "inferno/inferno.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
+#include "inferno/utilities/profiler.hxx"
 #include "inferno/model/discrete_model_base.hxx"
 #include "inferno/inference/discrete_inference_base.hxx"
-
-#ifdef WITH_QPBO
-#include <inferno_externals/qpbo/QPBO.h>
-#else 
-#error "To include inferno/infernece/cgc.hxx, WITH_QPBO needs to be" 
-#endif 
+#include "inferno/inference/utilities/maxflow.hxx"
 
 namespace inferno{
 namespace inference{
 
-    
+/// \cond
+namespace detail_cgc{
+
+    // dense view on the edges of a multicut model
+    template<class MODEL>
+    class ModelStructure{
+    public:
+        typedef typename MODEL::VariableDescriptor VariableDescriptor;
+
+        struct Edge{
+            Vi u_;
+            Vi v_;
+            ValueType beta_;
+        };
+        struct Adjacency{
+            Vi other_;
+            uint64_t edge_;
+        };
+
+        ModelStructure(const MODEL & model)
+        :   denseVarIds_(model),
+            variables_(model.nVariables()),
+            edges_(),
+            adjBegin_(model.nVariables() + 1, 0),
+            adjacency_(),
+            constTerm_(model.constTerm()){
+
+            INFERNO_CHECK(model.isSecondOrderMulticutModel(),
+                "Cgc is only implemented for second order multicut models");
+
+            for(const auto var : model.variableDescriptors())
+                variables_[denseVarIds_.toDenseId(var)] = var;
+
+            for(const auto factor : model.factors()){
+                ValueType beta;
+                factor->isPotts(beta);
+                const Vi u = denseVarIds_.toDenseId(factor->variable(0));
+                const Vi v = denseVarIds_.toDenseId(factor->variable(1));
+                INFERNO_CHECK_OP(u,!=,v, "second order factors must connect two different variables");
+                edges_.push_back(Edge{std::min(u,v), std::max(u,v), beta});
+            }
+
+            // compressed adjacency
+            for(const auto & edge : edges_){
+                ++adjBegin_[edge.u_ + 1];
+                ++adjBegin_[edge.v_ + 1];
+            }
+            for(size_t i=0; i<variables_.size(); ++i)
+                adjBegin_[i+1] += adjBegin_[i];
+            adjacency_.resize(adjBegin_.back());
+            std::vector<uint64_t> pos(adjBegin_.begin(), adjBegin_.end()-1);
+            for(uint64_t e=0; e<edges_.size(); ++e){
+                const auto & edge = edges_[e];
+                adjacency_[pos[edge.u_]++] = Adjacency{edge.v_, e};
+                adjacency_[pos[edge.v_]++] = Adjacency{edge.u_, e};
+            }
+        }
+
+        Vi nVariables()const{
+            return variables_.size();
+        }
+        const Adjacency * adjacencyBegin(const Vi u)const{
+            return adjacency_.data() + adjBegin_[u];
+        }
+        const Adjacency * adjacencyEnd(const Vi u)const{
+            return adjacency_.data() + adjBegin_[u+1];
+        }
+
+        models::DenseVariableIds<MODEL> denseVarIds_;
+        std::vector<VariableDescriptor> variables_;
+        std::vector<Edge> edges_;
+        std::vector<uint64_t> adjBegin_;
+        std::vector<Adjacency> adjacency_;
+        ValueType constTerm_;
+    };
+
+
+    // solves binary cut problems on a region of the
+    // model with QPBO.
+    // Variable u is represented by the nodes 2u and 2u+1
+    // (the negated variable) of a max-flow graph which contains
+    // all edges of the model. Only the edges of the current
+    // region have non-zero capacities. Between two calls
+    // only the capacities of edges which enter / leave the
+    // region are changed and the residual graph
+    // (and the search trees) of the last call are reused.
+    template<class MODEL>
+    class CutSolver{
+    public:
+        typedef ModelStructure<MODEL> Structure;
+        typedef MaxFlow<ValueType> Graph;
+
+        CutSolver(const Structure & structure, const bool reuseTrees)
+        :   structure_(&structure),
+            graph_(2*structure.nVariables(), 2*structure.edges_.size()),
+            reuseTrees_(reuseTrees),
+            nodes_(),
+            edges_(),
+            current_(structure.nVariables(), 0),
+            activeEdges_(),
+            isActive_(structure.edges_.size(), 0),
+            isWanted_(structure.edges_.size(), 0),
+            stack_(),
+            inStack_(structure.nVariables(), 0),
+            anchor_(-1){
+
+            graph_.addNodes(2*structure.nVariables());
+            for(const auto & edge : structure.edges_){
+                const auto u = 2*edge.u_;
+                const auto v = 2*edge.v_;
+                // attractive edges connect u-v and their negations,
+                // repulsive edges connect u with the negation of v
+                if(edge.beta_ >= 0){
+                    graph_.addEdge(u, v, 0, 0);
+                    graph_.addEdge(u+1, v+1, 0, 0);
+                }
+                else{
+                    graph_.addEdge(u, v+1, 0, 0);
+                    graph_.addEdge(v, u+1, 0, 0);
+                }
+            }
+        }
+
+        /// start a new region
+        void clear(){
+            nodes_.clear();
+            edges_.clear();
+        }
+        /// add a node and its current binary label,
+        /// the first node is fixed to its current label
+        /// which must be 0
+        void addNode(const Vi u, const DiscreteLabel current){
+            nodes_.push_back(u);
+            current_[u] = current;
+        }
+        /// add an edge which is inside of the region
+        void addEdge(const uint64_t e){
+            edges_.push_back(e);
+        }
+
+        /// solve the cut problem of the region.
+        /// Labels which are not persistent keep their current
+        /// value.
+        /// \returns the energy decrease w.r.t. the current labels
+        ValueType solve(std::vector<DiscreteLabel> & result){
+            INFERNO_ASSERT(!nodes_.empty());
+            INFERNO_ASSERT_OP(current_[nodes_.front()],==,0);
+            const auto & edges = structure_->edges_;
+
+            // update the capacities which have been changed
+            // since the last region
+            for(const auto e : edges_)
+                isWanted_[e] = 1;
+            for(const auto e : activeEdges_){
+                if(!isWanted_[e]){
+                    graph_.setEdgeCapacities(2*e, 0, 0);
+                    graph_.setEdgeCapacities(2*e+1, 0, 0);
+                    isActive_[e] = 0;
+                }
+            }
+            ValueType absSum = 1;
+            for(const auto e : edges_){
+                const ValueType c = std::abs(edges[e].beta_);
+                isWanted_[e] = 0;
+                absSum += c;
+                if(!isActive_[e]){
+                    graph_.setEdgeCapacities(2*e, c/2, c/2);
+                    graph_.setEdgeCapacities(2*e+1, c/2, c/2);
+                    isActive_[e] = 1;
+                }
+            }
+            activeEdges_.assign(edges_.begin(), edges_.end());
+
+            // fix the anchor to label 0
+            const Vi anchor = nodes_.front();
+            if(anchor_ >= 0 && anchor_ != anchor){
+                graph_.setTWeights(2*anchor_, 0, 0);
+                graph_.setTWeights(2*anchor_+1, 0, 0);
+            }
+            graph_.setTWeights(2*anchor, absSum, 0);
+            graph_.setTWeights(2*anchor+1, 0, absSum);
+            anchor_ = anchor;
+
+            if(!reuseTrees_)
+                graph_.resetFlow();
+            graph_.maxflow(reuseTrees_);
+
+            // persistent labels
+            for(const auto u : nodes_){
+                const auto s0 = graph_.segment(2*u);
+                const auto s1 = graph_.segment(2*u+1);
+                if(s0 == Graph::Source && s1 == Graph::Sink)
+                    result[u] = 0;
+                else if(s0 == Graph::Sink && s1 == Graph::Source)
+                    result[u] = 1;
+                else
+                    result[u] = current_[u];
+            }
+            this->improve(result);
+
+            ValueType currentEnergy = 0;
+            ValueType resultEnergy = 0;
+            for(const auto e : edges_){
+                const auto & edge = edges[e];
+                if(current_[edge.u_] != current_[edge.v_])
+                    currentEnergy += edge.beta_;
+                if(result[edge.u_] != result[edge.v_])
+                    resultEnergy += edge.beta_;
+            }
+            return currentEnergy - resultEnergy;
+        }
+
+    private:
+
+        // QPBO leaves frustrated parts unlabeled,
+        // improve the result with single variable flips
+        void improve(std::vector<DiscreteLabel> & result){
+            const auto & edges = structure_->edges_;
+            for(const auto u : nodes_){
+                stack_.push_back(u);
+                inStack_[u] = 1;
+            }
+            while(!stack_.empty()){
+                const Vi u = stack_.back();
+                stack_.pop_back();
+                inStack_[u] = 0;
+                ValueType delta = 0;
+                for(auto a = structure_->adjacencyBegin(u); a != structure_->adjacencyEnd(u); ++a){
+                    if(isActive_[a->edge_]){
+                        const ValueType beta = edges[a->edge_].beta_;
+                        delta += result[u] == result[a->other_] ? beta : -beta;
+                    }
+                }
+                if(delta < 0){
+                    result[u] = 1 - result[u];
+                    for(auto a = structure_->adjacencyBegin(u); a != structure_->adjacencyEnd(u); ++a){
+                        if(isActive_[a->edge_] && !inStack_[a->other_]){
+                            stack_.push_back(a->other_);
+                            inStack_[a->other_] = 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        const Structure * structure_;
+        Graph graph_;
+        bool reuseTrees_;
+        std::vector<Vi> nodes_;
+        std::vector<uint64_t> edges_;
+        std::vector<DiscreteLabel> current_;
+        std::vector<uint64_t> activeEdges_;
+        std::vector<unsigned char> isActive_;
+        std::vector<unsigned char> isWanted_;
+        std::vector<Vi> stack_;
+        std::vector<unsigned char> inStack_;
+        int64_t anchor_;
+    };
+
+} // end namespace inferno::inference::detail_cgc
+/// \endcond
+
+
+    /** \brief Cut, Glue & Cut for second order multicut models
+
+        The labeling is kept as a set of connected clusters.
+        In the cut phase each cluster is recursively split
+        by binary cuts, in the glue and cut phase each pair of
+        adjacent clusters is merged and re-cut.
+        All binary problems are solved with QPBO, non persistent
+        variables keep their current label and the result
+        is improved with single variable flips.
+        A move is only accepted if it decreases the energy.
+
+        Moves on disjoint clusters are independent, therefore
+        they are solved in batches (in parallel
+        for Options::nThreads_ != 1). A move is only repeated if
+        one of its clusters has been changed since it has
+        been solved the last time.
+    */
     template<class MODEL>
     class Cgc  : public DiscreteInferenceBase<MODEL> {
     public:
@@ -31,82 +317,64 @@ namespace inference{
         typedef DiscreteInferenceBase<MODEL> BaseInf;
         typedef typename BaseInf::Visitor Visitor;
         typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+        typedef detail_cgc::ModelStructure<Model> Structure;
+        typedef detail_cgc::CutSolver<Model> CutSolverType;
 
-        typedef typename MODEL:: template VariableMap<DiscreteLabel>    ArgPrimal;
-        typedef typename MODEL:: template FactorMap<DiscreteLabel>      ArgDual;
-        typedef typename MODEL:: template FactorMap<ValueType>          Betas;
-
-        std::vector<VariableDescriptor> VarVec;
-
-        typedef inferno::models::DenseVariableIds<Model> DenseVarIds;
-        typedef kolmogorov::qpbo::QPBO<ValueType> CgcSolver;
-
-        typedef  std::pair<VariableDescriptor, VariableDescriptor> VarPair;
         typedef  std::pair<DiscreteLabel, DiscreteLabel> LabelPair;
 
         struct Options{
             Options(
-                const uint64_t maxIterations = 1
-            ) 
-            :   maxIterations_(maxIterations)
+                const uint64_t maxIterations = 1000,
+                const bool reuseTrees = true,
+                const uint64_t nThreads = 1
+            )
+            :   maxIterations_(maxIterations),
+                reuseTrees_(reuseTrees),
+                nThreads_(nThreads)
             {
             }
             uint64_t maxIterations_;
+            bool reuseTrees_;
+            uint64_t nThreads_;
         };
 
-
-
         Cgc(const Model & model, const Options & options = Options() )
         :   BaseInf(),
             model_(model),
-            bestConf_(model,0),
-            denseVarIds_(model),
             options_(options),
+            structure_(model),
+            labels_(structure_.nVariables(), 0),
+            members_(structure_.nVariables()),
+            freeLabels_(),
+            versions_(structure_.nVariables(), 0),
+            cutTried_(structure_.nVariables(), -1),
+            glueTried_(),
+            cutSolvers_(),
+            pool_(),
+            moves_(),
+            moveLabels_(structure_.nVariables(), 0),
+            inRegion_(structure_.nVariables(), 0),
+            regionNodes_(),
+            touchedLabels_(),
             stopInference_(false),
-            bound_(-1.0*infVal()),
-            value_(infVal()){
-
-
-            // check for valid models
-            {
-                INFERNO_CHECK_OP(model.maxArity(),<=,2,
-                    "Cgc is only allowed for models with maxArity<=2");
-
-                LabelType nLabels;
-                const bool simpleLabelSpace  =  model_.hasSimpleLabelSpace(nLabels);
-                INFERNO_CHECK(simpleLabelSpace && nLabels == 2, "Cgc is only implemented for models "
-                                                                "where all variables  have a binary label space");
-            } 
-            
-            const Vi nVar = model_.nVariables();
-
-            // construct qpbo
-            qpbo_ = new CgcSolver(nVar, model_.nPairwiseFactors());
-            qpbo_->AddNode(nVar);
-
-
-            for(const auto unary : model_.unaries()){
-                const int qpboVi0 = denseVarIds_.toDenseId(unary->variable());
-                qpbo_->AddUnaryTerm(qpboVi0, unary->eval(0l), unary->eval(1l));
-            }
-            for(const auto factor : model_.factors()){
-                const auto arity = factor->arity();
-                if(arity == 2){
-                    const int qpboVi0 = denseVarIds_.toDenseId(factor->variable(0));
-                    const int qpboVi1 = denseVarIds_.toDenseId(factor->variable(1));
-                    INFERNO_CHECK_OP(qpboVi0,!=,qpboVi1,"");
-                    qpbo_->AddPairwiseTerm(qpboVi0, qpboVi1,factor->eval(0,0), factor->eval(0,1),
-                        factor->eval(1,0), factor->eval(1,1));
-                }
-                else{
-                    throw RuntimeError("INTERNAL ERROR: model_.maxArity() must have a bug");
-                }
-            }
-            qpbo_->MergeParallelEdges();
-        }
-
-        ~Cgc(){
-            delete qpbo_;
+            bound_(structure_.constTerm_),
+            value_(0){
+            INFERNO_PROFILE_SCOPE("Cgc::setup");
+
+            const auto nThreads = options_.nThreads_ == 0 ?
+                std::thread::hardware_concurrency() : options_.nThreads_;
+            cutSolvers_.reserve(nThreads);
+            for(size_t t=0; t<nThreads; ++t)
+                cutSolvers_.emplace_back(structure_, options_.reuseTrees_);
+            if(nThreads > 1)
+                pool_.reset(new utilities::ThreadPool(nThreads));
+
+            for(const auto & edge : structure_.edges_)
+                bound_ += std::min(edge.beta_, ValueType(0));
+
+            // start with the connected components of the model
+            std::vector<DiscreteLabel> conf(structure_.nVariables(), 0);
+            this->setClusters(conf);
         }
 
         // MUST HAVE INTERACE
@@ -115,47 +383,45 @@ namespace inference{
         }
         // inference
         virtual void infer( Visitor  * visitor  = NULL) {
-
-            this->initPhase();
-
-            auto preCut = this->energy();;
-            auto postCut = preCut;
-            auto preGlue = preCut;
-            auto postGlue = preCut;
-
-            for(const auto iter : range(options_.maxIterations_)){
-        
-                if(i==0){
-                    this->cutPhase();
-                    this->glueAndCutPhase();
-                }
+            INFERNO_PROFILE_SCOPE("Cgc::infer");
+            stopInference_ = false;
+            if(visitor!=NULL)
+                visitor->begin(this);
+
+            this->cutPhase(visitor);
+            for(uint64_t iter=0; iter<options_.maxIterations_ && !stopInference_; ++iter){
+                if(!this->glueAndCutRound(visitor))
+                    break;
             }
 
+            if(visitor!=NULL)
+                visitor->end(this);
         }
         // get result
         virtual void conf(Conf & confMap ) {
-            
+            for(size_t i=0; i<labels_.size(); ++i)
+                confMap[structure_.variables_[i]] = labels_[i];
         }
         virtual DiscreteLabel label(const Vi vi ) {
-
+            return labels_[structure_.denseVarIds_.toDenseId(vi)];
         }
-
-
-
         // get model
         virtual const Model & model() const{
             return model_;
         }
-
-        virtual void setConf(const Conf & conf){
-            for(const auto var : model_.variableDescriptors())
-                bestConf_[var] = conf[var];
-        }
-
         // stop inference (via visitor)
         virtual void stopInference(){
             stopInference_ = true;
         }
+
+        // OPTIONAL INTERFACE
+        // warm start related
+        virtual void setConf(const Conf & conf){
+            std::vector<DiscreteLabel> denseConf(labels_.size());
+            for(size_t i=0; i<labels_.size(); ++i)
+                denseConf[i] = conf[structure_.variables_[i]];
+            this->setClusters(denseConf);
+        }
         // get results optional interface
         virtual ValueType lowerBound(){
             return bound_;
@@ -169,149 +435,274 @@ namespace inference{
 
     private:
 
-        VarPair uvInternalSorted(const uint64_t internalEdge)const{
-
-        }
-        LabelPair sortedLabelPair(const VarPair varPair)const{
-
-        }
-        ValueType betaInternal(const uint64_t internalEdge)const{
-
-        }
-
-
-        bool isCut(const VarPair & varPair)const{
-            
-        }
-        bool isCut(const uint64_t internalEdge )const{
-            
-        }
-        uint64_t nInternalEdges()const{
-        }
+        // a cut move if a_ == b_, otherwise a glue and cut move
+        struct Move{
+            DiscreteLabel a_;
+            DiscreteLabel b_;
+            ValueType gain_;
+        };
 
-        void startFromHc(Visitor * visitor ){
-        }
-        void initPhase(Visitor  * visitor ){
-        }
-        void cutPhase(Visitor * visitor ){
+        // rebuild all clusters from a labeling,
+        // each cluster is a connected component of
+        // equally labeled variables
+        void setClusters(const std::vector<DiscreteLabel> & conf){
+            const Vi nVar = structure_.nVariables();
+            glueTried_.clear();
+            freeLabels_.clear();
+            for(Vi i=0; i<nVar; ++i){
+                members_[i].clear();
+                freeLabels_.push_back(nVar - i - 1);
+                ++versions_[i];
+            }
+            regionNodes_.resize(nVar);
+            for(Vi i=0; i<nVar; ++i)
+                regionNodes_[i] = i;
+            this->relabelRegion(std::vector<DiscreteLabel>(), conf);
+
+            value_ = structure_.constTerm_;
+            for(const auto & edge : structure_.edges_)
+                if(labels_[edge.u_] != labels_[edge.v_])
+                    value_ += edge.beta_;
         }
 
-
-        void fillMap(std::map<LabelPair, ValAndFac> & map){
-            map.clear();
-            for(const auto ei : range(nInternalEdges())){
-                const auto uv =  uvInternalSorted(ei);
-                const auto luv = labelPair(uv);
-                if(luv.first !=  luv.second){
-                    const auto beta = betaInternal(ei);
-                    auto iter = ccMap.find(luv);
-                    if(iter == ccMap.end()){
-                        ccMap.insert(std::make_pair(luv, ValAndFac(beta,ei)));
-                    }
-                    else{
-                        iter->second.first +=beta;
-                    }
+        // relabel the variables in regionNodes_ with the
+        // connected components w.r.t. the labeling x,
+        // oldLabels (the labels of the region) are reused.
+        void relabelRegion(
+            const std::vector<DiscreteLabel> & oldLabels,
+            const std::vector<DiscreteLabel> & x
+        ){
+            touchedLabels_.assign(oldLabels.begin(), oldLabels.end());
+            for(const auto u : regionNodes_)
+                inRegion_[u] = 1;
+
+            size_t nUsedOld = 0;
+            std::vector<Vi> stack;
+            for(const auto root : regionNodes_){
+                if(inRegion_[root] != 1)
+                    continue;
+                DiscreteLabel l;
+                if(nUsedOld < oldLabels.size()){
+                    l = oldLabels[nUsedOld++];
                 }
-            } 
-        }
-
-        bool glueAndCutPhase(Visitor * visitor ){
-
-            typedef std::pair<ValueType, uint64_t> ValAndFac;
-            std::map<LabelPair, ValAndFac> ccMap;
-
-            bool anyImprovment = false
-            bool improvmentInRound = true;
-
-            while(improvmentInRound){
-                
-                improvmentInRound = false;
-                this->fillMap(ccMap);
-
-                // do we have any cc's
-                if(ccMap.size() >= 2){  
-                    for(const auto iter : ccMap){
-                        const auto ei = iter->second->second;
-                        if(isCut(ei)){
-                            const bool improvment = doSingleGlueAndCut(ei);
-                            if(improvment){
-                                anyImprovment = true;
-                                improvmentInRound= true;
-                            }
+                else{
+                    l = freeLabels_.back();
+                    freeLabels_.pop_back();
+                    touchedLabels_.push_back(l);
+                }
+                auto & members = members_[l];
+                inRegion_[root] = 2;
+                stack.push_back(root);
+                while(!stack.empty()){
+                    const Vi u = stack.back();
+                    stack.pop_back();
+                    labels_[u] = l;
+                    members.push_back(u);
+                    for(auto a = structure_.adjacencyBegin(u); a != structure_.adjacencyEnd(u); ++a){
+                        const Vi v = a->other_;
+                        if(inRegion_[v] == 1 && x[v] == x[u]){
+                            inRegion_[v] = 2;
+                            stack.push_back(v);
                         }
                     }
-                }   
+                }
             }
-            return anyImprovment;
+            for(size_t i=nUsedOld; i<oldLabels.size(); ++i)
+                freeLabels_.push_back(oldLabels[i]);
+            for(const auto l : touchedLabels_)
+                ++versions_[l];
+            for(const auto u : regionNodes_)
+                inRegion_[u] = 0;
         }
 
-
-        void doSingleGlueAndCut(const uint64_t eInternal){
-
-            // initialize this move
-            this->preMove();
-
-            // setup the submodel
-            this->setupModel2();
-
-            // solve submodel
-            this->solveSubmodel();
-
-            // finish this move
-            this->postMove()
-        }
-
-        void getGlueVarInCC(const uint64_t eInternal, VarVec & varVec){
-
+        // solve the binary problem of a move
+        // (only reads the current clusters)
+        void solveMove(CutSolverType & cutSolver, Move & move){
+            INFERNO_PROFILE_SCOPE("Cgc::move");
+            cutSolver.clear();
+            for(const auto u : members_[move.a_])
+                cutSolver.addNode(u, 0);
+            if(move.b_ != move.a_)
+                for(const auto u : members_[move.b_])
+                    cutSolver.addNode(u, 1);
+
+            auto addEdges = [&](const DiscreteLabel l){
+                for(const auto u : members_[l]){
+                    for(auto a = structure_.adjacencyBegin(u); a != structure_.adjacencyEnd(u); ++a){
+                        const auto lv = labels_[a->other_];
+                        if(u < a->other_ && (lv == move.a_ || lv == move.b_))
+                            cutSolver.addEdge(a->edge_);
+                    }
+                }
+            };
+            addEdges(move.a_);
+            if(move.b_ != move.a_)
+                addEdges(move.b_);
+            move.gain_ = cutSolver.solve(moveLabels_);
         }
 
-
-        void setupModel1(const uint64_t eInternal){
-
-        }
-        void setupModel2(const uint64_t eInternal){
-            
+        // solve all moves in moves_, the clusters
+        // of the moves must be disjoint
+        void solveMoves(){
+            if(pool_){
+                utilities::parallel_foreach(*pool_, moves_.size(),
+                    boost::counting_iterator<size_t>(0),
+                    boost::counting_iterator<size_t>(moves_.size()),
+                    [&](const int tid, const size_t m){
+                        solveMove(cutSolvers_[tid], moves_[m]);
+                    }
+                );
+            }
+            else{
+                for(auto & move : moves_)
+                    solveMove(cutSolvers_.front(), move);
+            }
         }
-        void solveSubmodel(){
-
-            // qpbo
-
-            // planar max cut
-
-            // hc
-
-            // sw
-
-            // optimal(?)
 
+        // apply a solved move, the labels of
+        // all changed clusters are in touchedLabels_
+        bool applyMove(const Move & move){
+            if(!(move.gain_ > 0)){
+                return false;
+            }
+            regionNodes_.assign(members_[move.a_].begin(), members_[move.a_].end());
+            members_[move.a_].clear();
+            std::vector<DiscreteLabel> oldLabels(1, move.a_);
+            if(move.b_ != move.a_){
+                regionNodes_.insert(regionNodes_.end(), members_[move.b_].begin(), members_[move.b_].end());
+                members_[move.b_].clear();
+                oldLabels.push_back(move.b_);
+            }
+            this->relabelRegion(oldLabels, moveLabels_);
+            value_ -= move.gain_;
+            return true;
         }
 
-
-
-        void preMove(){
-            varVec_.resize(0);
+        void cutPhase(Visitor * visitor){
+            INFERNO_PROFILE_SCOPE("Cgc::cutPhase");
+            std::vector<DiscreteLabel> toCut;
+            for(DiscreteLabel l=0; l<DiscreteLabel(members_.size()); ++l)
+                if(members_[l].size() > 1 && cutTried_[l] != versions_[l])
+                    toCut.push_back(l);
+
+            while(!toCut.empty() && !stopInference_){
+                moves_.clear();
+                for(const auto l : toCut){
+                    moves_.push_back(Move{l, l, 0});
+                    cutTried_[l] = versions_[l];
+                }
+                this->solveMoves();
+
+                toCut.clear();
+                bool improvement = false;
+                for(const auto & move : moves_){
+                    if(this->applyMove(move)){
+                        improvement = true;
+                        for(const auto l : touchedLabels_)
+                            if(members_[l].size() > 1)
+                                toCut.push_back(l);
+                    }
+                }
+                if(improvement && visitor!=NULL)
+                    visitor->visit(this);
+            }
         }
 
-        void postMove(){
+        bool glueAndCutRound(Visitor * visitor){
+            INFERNO_PROFILE_SCOPE("Cgc::glueAndCutRound");
 
+            // adjacent clusters which changed since they have been glued the last time
+            std::vector<LabelPair> pairs;
+            for(const auto & edge : structure_.edges_){
+                const auto lu = labels_[edge.u_];
+                const auto lv = labels_[edge.v_];
+                if(lu != lv)
+                    pairs.push_back(LabelPair(std::min(lu, lv), std::max(lu, lv)));
+            }
+            std::sort(pairs.begin(), pairs.end());
+            pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+            auto isDirty = [&](const LabelPair & lp){
+                if(members_[lp.first].empty() || members_[lp.second].empty())
+                    return false;
+                const auto iter = glueTried_.find(lp);
+                return iter == glueTried_.end() ||
+                    iter->second.first != versions_[lp.first] ||
+                    iter->second.second != versions_[lp.second];
+            };
+
+            bool anyImprovement = false;
+            std::vector<unsigned char> inBatch(members_.size(), 0);
+            std::vector<LabelPair> rest;
+            while(!pairs.empty() && !stopInference_){
+
+                // greedy batch of moves on disjoint clusters
+                moves_.clear();
+                rest.clear();
+                for(const auto & lp : pairs){
+                    if(!isDirty(lp))
+                        continue;
+                    if(!inBatch[lp.first] && !inBatch[lp.second]){
+                        inBatch[lp.first] = 1;
+                        inBatch[lp.second] = 1;
+                        moves_.push_back(Move{lp.first, lp.second, 0});
+                        glueTried_[lp] = std::make_pair(versions_[lp.first], versions_[lp.second]);
+                    }
+                    else{
+                        rest.push_back(lp);
+                    }
+                }
+                pairs.swap(rest);
+                if(moves_.empty())
+                    break;
+                this->solveMoves();
+
+                bool improvement = false;
+                for(const auto & move : moves_){
+                    inBatch[move.a_] = 0;
+                    inBatch[move.b_] = 0;
+                    if(this->applyMove(move))
+                        improvement = true;
+                }
+                if(improvement){
+                    anyImprovement = true;
+                    if(visitor!=NULL)
+                        visitor->visit(this);
+                }
+            }
+            return anyImprovement;
         }
 
-
         const Model & model_;
-        
-        ArgPrimal     bestConf_;
+        Options options_;
+        Structure structure_;
+
+        // clusters
+        std::vector<DiscreteLabel> labels_;
+        std::vector<std::vector<Vi> > members_;
+        std::vector<DiscreteLabel> freeLabels_;
+        std::vector<int64_t> versions_;
+        std::vector<int64_t> cutTried_;
+        std::map<LabelPair, std::pair<int64_t, int64_t> > glueTried_;
+
+        // moves
+        std::vector<CutSolverType> cutSolvers_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+        std::vector<Move> moves_;
+        std::vector<DiscreteLabel> moveLabels_;
+
+        // buffers
+        std::vector<unsigned char> inRegion_;
+        std::vector<Vi> regionNodes_;
+        std::vector<DiscreteLabel> touchedLabels_;
 
-        DenseVarIds   denseVarIds_;
-        Options       options_;
         bool          stopInference_;
         ValueType     bound_;
         ValueType     value_;
-
-        VarVec varVec_;
     };
 
 
 } // end namespace inference
 } // end namespace inferno
 
-#endif /* INFERNO_INFERENCE_QPBO_HXX */
+#endif /* INFERNO_INFERENCE_CGC_HXX */
@@ -0,0 +1,318 @@
+/** \file component_decomposition.hxx
+    \brief  Implementation of inferno::inference::ComponentDecomposition,
+    a meta solver which solves each connected component
+    of a model independently.
+*/
+#ifndef INFERNO_INFERENCE_COMPONENT_DECOMPOSITION_HXX
+#define INFERNO_INFERENCE_COMPONENT_DECOMPOSITION_HXX
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "inferno/inferno.hxx"
+#include "inferno/inference/discrete_inference_base.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/model/factors_of_variables.hxx"
+#include "inferno/model/view_submodel.hxx"
+#include "inferno/utilities/ufd.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
+
+namespace inferno{
+namespace inference{
+
+
+    /** \brief Meta solver which decomposes a model
+        into its connected components.
+
+        Two variables are connected if they share a factor
+        which is not provably constant (a Potts factor with
+        \f$\beta = 0\f$ is constant).
+        Components with a single variable are solved
+        exactly by enumerating its labels, all other
+        components are solved with a solver created
+        by Options::factory_ on a models::ViewSubmodel
+        of the model.
+        The components are independent and are processed
+        in parallel (Options::nThreads_ != 1),
+        largest components first.
+        Each thread reuses a single models::ViewSubmodel.
+        The labeling given by setConf is the starting point
+        of the sub-solvers.
+
+        The visitor is called after each solved component
+        (serialized, from the worker threads), stopInference
+        takes effect before the next component is started.
+    */
+    template<class MODEL>
+    class ComponentDecomposition  : public DiscreteInferenceBase<MODEL> {
+
+    public:
+        typedef MODEL Model;
+        typedef ComponentDecomposition<MODEL> Self;
+        typedef DiscreteInferenceBase<MODEL> BaseInf;
+        typedef typename BaseInf::Visitor Visitor;
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+
+        typedef models::FactorsOfVariables<Model> FactorsOfVariables;
+        typedef models::ViewSubmodel<Model, FactorsOfVariables> SubModel;
+        typedef BaseDiscreteInferenceFactory<SubModel> SubInferenceFactory;
+        typedef typename SubModel:: template VariableMap<DiscreteLabel> SubConf;
+    private:
+        typedef models::DenseVariableIds<Model> DenseVarIds;
+        typedef typename Model::VariableDescriptor VariableDescriptor;
+        typedef typename Model::UnaryDescriptor UnaryDescriptor;
+    public:
+
+        struct Options{
+            Options(
+                std::shared_ptr<SubInferenceFactory> factory = std::shared_ptr<SubInferenceFactory>(),
+                const uint64_t nThreads = 1
+            )
+            :   factory_(factory),
+                nThreads_(nThreads)
+            {
+            }
+            std::shared_ptr<SubInferenceFactory> factory_;
+            uint64_t nThreads_;
+        };
+
+        ComponentDecomposition(const Model & model, const Options & options = Options())
+        :   BaseInf(),
+            model_(model),
+            options_(options),
+            denseVarIds_(model),
+            factorsOfVariables_(model),
+            conf_(model, 0),
+            unariesOfVariables_(model.nVariables()),
+            components_(),
+            subModels_(),
+            pool_(),
+            mutex_(),
+            value_(infVal()),
+            stopInference_(false){
+
+            INFERNO_CHECK(bool(options_.factory_), "ComponentDecomposition needs a factory for the sub-solvers");
+            this->buildComponents();
+
+            const auto nThreads = options_.nThreads_ == 0 ?
+                std::thread::hardware_concurrency() : options_.nThreads_;
+            for(size_t t=0; t<nThreads; ++t)
+                subModels_.emplace_back(new SubModel(model_, factorsOfVariables_));
+            if(nThreads > 1)
+                pool_.reset(new utilities::ThreadPool(nThreads));
+        }
+
+        // MUST HAVE INTERACE
+        virtual std::string name() const {
+            return "ComponentDecomposition";
+        }
+        // inference
+        virtual void infer( Visitor  * visitor  = NULL) {
+            stopInference_ = false;
+            value_ = model_.eval(conf_);
+            if(visitor!=NULL)
+                visitor->begin(this);
+
+            // dynamic scheduling: the components are sorted
+            // largest first and each worker pulls the next one
+            std::atomic<size_t> next(0);
+            auto worker = [&](const int tid, const size_t){
+                std::vector<DiscreteLabel> labels;
+                size_t c;
+                while(!stopInference_ && (c = next++) < components_.size()){
+                    const auto & component = components_[c];
+                    const auto delta = this->solveComponent(*subModels_[tid], component, labels);
+
+                    // write back the labels of the component and report,
+                    // the energy is updated with the change of this component
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    for(size_t i=0; i<component.size(); ++i)
+                        conf_[component[i]] = labels[i];
+                    value_ += delta;
+                    if(visitor!=NULL)
+                        visitor->visit(this);
+                }
+            };
+            if(pool_){
+                utilities::parallel_foreach(*pool_, subModels_.size(),
+                    boost::counting_iterator<size_t>(0),
+                    boost::counting_iterator<size_t>(subModels_.size()), worker);
+            }
+            else{
+                worker(0, 0);
+            }
+            // avoid accumulated rounding errors
+            value_ = model_.eval(conf_);
+
+            if(visitor!=NULL)
+                visitor->end(this);
+        }
+        // get result
+        virtual void conf(Conf & confMap ) {
+            for(const auto varDesc : model_.variableDescriptors())
+                confMap[varDesc] = conf_[varDesc];
+        }
+        virtual DiscreteLabel label(const Vi vi ) {
+            return conf_[vi];
+        }
+        // get model
+        virtual const Model & model() const{
+            return model_;
+        }
+        // stop inference (via visitor)
+        virtual void stopInference(){
+            stopInference_ = true;
+        }
+
+        // OPTIONAL INTERFACE
+        virtual void setConf(const Conf & confMap){
+            for(const auto varDesc : model_.variableDescriptors())
+                conf_[varDesc] = confMap[varDesc];
+            value_ = model_.eval(conf_);
+        }
+        // get results optional interface
+        virtual ValueType upperBound(){
+            return value_;
+        }
+        virtual ValueType energy(){
+            return value_;
+        }
+
+        /// \brief number of connected components
+        uint64_t nComponents()const{
+            return components_.size();
+        }
+
+    private:
+
+        // union find over all non constant factors
+        // with arity >= 2, components are stored
+        // with sorted variables, largest first
+        void buildComponents(){
+            const Vi nVar = model_.nVariables();
+            utilities::Ufd<Vi> ufd(nVar);
+            ValueType beta;
+            for(const auto factor : model_.factors()){
+                const auto arity = factor->arity();
+                if(arity < 2 || (factor->isPotts(beta) && beta == 0.0))
+                    continue;
+                const Vi u = denseVarIds_.toDenseId(factor->variable(0));
+                for(size_t a=1; a<arity; ++a)
+                    ufd.merge(u, denseVarIds_.toDenseId(factor->variable(a)));
+            }
+
+            for(const auto unaryDesc : model_.unaryDescriptors()){
+                const auto var = model_.unary(unaryDesc)->variable();
+                unariesOfVariables_[denseVarIds_.toDenseId(var)].push_back(unaryDesc);
+            }
+
+            std::vector<Vi> componentId(nVar, nVar);
+            for(const auto var : model_.variableDescriptors()){
+                const Vi root = ufd.find(denseVarIds_.toDenseId(var));
+                if(componentId[root] == nVar){
+                    componentId[root] = components_.size();
+                    components_.push_back(std::vector<VariableDescriptor>());
+                }
+                components_[componentId[root]].push_back(var);
+            }
+            std::stable_sort(components_.begin(), components_.end(),
+                [](const std::vector<VariableDescriptor> & a, const std::vector<VariableDescriptor> & b){
+                    return a.size() > b.size();
+                }
+            );
+        }
+
+        // solve a component, the labels of the component
+        // are written to labels (in the order of the component).
+        // Only the calling worker writes the labels of this component,
+        // therefore conf_ can be read without the lock.
+        // The current labels are kept unless the
+        // sub-solver found a strictly better labeling.
+        // \returns the change of the energy
+        ValueType solveComponent(SubModel & subModel, const std::vector<VariableDescriptor> & component,
+                                 std::vector<DiscreteLabel> & labels){
+            labels.resize(component.size());
+            if(component.size() == 1)
+                return this->solveSingleVariable(component.front(), labels.front());
+
+            subModel.setSubmodelVariables(component.begin(), component.end());
+            // the remaining model does not change
+            // the optimum of this component
+            subModel.setConstTerm(0.0);
+
+            // warm start from the current labeling
+            SubConf subConf(subModel);
+            for(size_t i=0; i<component.size(); ++i)
+                subConf[i] = conf_[subModel.viToBaseVi(i)];
+            const ValueType startValue = subModel.eval(subConf);
+
+            for(size_t i=0; i<component.size(); ++i)
+                labels[i] = subConf[i];
+
+            auto solver = options_.factory_->create(subModel);
+            solver->setConf(subConf);
+            solver->infer();
+            solver->conf(subConf);
+            const ValueType delta = subModel.eval(subConf) - startValue;
+            if(delta >= 0.0)
+                return 0.0;
+            for(size_t i=0; i<component.size(); ++i)
+                labels[i] = subConf[i];
+            return delta;
+        }
+
+        // all factors connecting var to other
+        // variables are constant, ties keep the current label
+        ValueType solveSingleVariable(const VariableDescriptor var, DiscreteLabel & bestLabel){
+            const DiscreteLabel nLabels = model_.nLabels(var);
+            const DiscreteLabel current = conf_[var];
+            bestLabel = 0;
+            ValueType bestValue = infVal();
+            ValueType currentValue = 0.0;
+            for(DiscreteLabel l=0; l<nLabels; ++l){
+                ValueType value = 0.0;
+                for(const auto fi : factorsOfVariables_[var]){
+                    const auto factor = model_.factor(fi);
+                    if(factor->arity() == 1)
+                        value += factor->eval(&l);
+                }
+                for(const auto unaryDesc : unariesOfVariables_[denseVarIds_.toDenseId(var)])
+                    value += model_.unary(unaryDesc)->eval(l);
+                if(value < bestValue){
+                    bestValue = value;
+                    bestLabel = l;
+                }
+                if(l == current)
+                    currentValue = value;
+            }
+            if(bestValue >= currentValue){
+                bestLabel = current;
+                return 0.0;
+            }
+            return bestValue - currentValue;
+        }
+
+        const Model & model_;
+        Options options_;
+        DenseVarIds denseVarIds_;
+        FactorsOfVariables factorsOfVariables_;
+        Conf conf_;
+        std::vector<std::vector<UnaryDescriptor> > unariesOfVariables_;
+        std::vector<std::vector<VariableDescriptor> > components_;
+        std::vector<std::unique_ptr<SubModel> > subModels_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+        std::mutex mutex_;
+        ValueType value_;
+        std::atomic<bool> stopInference_;
+    };
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+#endif /* INFERNO_INFERENCE_COMPONENT_DECOMPOSITION_HXX */
@@ -75,7 +75,6 @@ namespace inference{
             hoe_.AddVars(model_.nVariables());
 
             std::vector<ValueType> coeffs(1 << maxArity);
-            std::vector<DiscreteLabel> cliqueLabels(maxArity);
 
 
             for (const auto factor : model_.factors()){
@@ -88,26 +87,15 @@ namespace inference{
                 const ArityType arity = factor->arity();
 
                 const unsigned int numAssignments = 1 << arity;
-                for (unsigned int subset = 1; subset < numAssignments; ++subset){
-                    coeffs[subset] = 0;
-                }
-                // For each boolean assignment, get the clique energy at the
-                // corresponding labeling
-                for (unsigned int assignment = 0;  assignment < numAssignments; ++assignment){
-                    for (unsigned int i = 0; i < arity; ++i){
-                        cliqueLabels[i] = (assignment & (1 << i)) ? 1 : 0;
-                    }
-                    const ValueType energy = factor->eval(cliqueLabels);
+                // energies of all boolean assignments with a single call,
+                // bit i of an assignment is the label of the i-th variable
+                factor->bufferValueTable(coeffs.data());
+                // inplace moebius transform, afterwards coeffs[subset] is the
+                // sum of (-1)^|subset \ assignment| * energy over all assignments within subset
+                for (unsigned int b = 0; b < arity; ++b){
                     for (unsigned int subset = 1; subset < numAssignments; ++subset){
-                        if (assignment & ~subset){
-                            continue;
-                        }
-                        else{
-                            int parity = 0;
-                            for (unsigned int b = 0; b < arity; ++b){
-                                parity ^=  (((assignment ^ subset) & (1 << b)) != 0);
-                            }
-                            coeffs[subset] += parity ? -energy : energy;
+                        if (subset & (1 << b)){
+                            coeffs[subset] -= coeffs[subset ^ (1 << b)];
                         }
                     }
                 }
@@ -1,25 +1,96 @@
-/** \file discrete_inference_base.hxx 
-    \brief  Functionality which is shared between all inference algorithms
-    is implemented in this header.
+/** \file hmmwc.hxx
+    \brief  Implementation of inferno::inference::Hmmwc,
+    a hierarchical top-down solver for modified multiway cut models.
 
-    \warning Not yet finished
+    The binary problems are solved with a QPBO
+    construction on top of the bundled
+    inferno::inference::MaxFlow.
 */
 #ifndef INFERNO_INFERENCE_HMMWC_HXX
 #define INFERNO_INFERENCE_HMMWC_HXX
 
+#include <vector>
+#include <cmath>
+#include <thread>
+#include <memory>
+#include <algorithm>
+
+#include <boost/iterator/counting_iterator.hpp>
 
 #include "inferno/inferno.hxx"
 #include "inferno/inference/discrete_inference_base.hxx"
-#include "inferno/utilities/ufd.hxx"
+#include "inferno/inference/utilities/maxflow.hxx"
 #include "inferno/model/algorithms/connected_components.hxx"
-    
 #include "inferno/utilities/parallel/pool.hxx"
 
 namespace inferno{
+namespace inference{
 
+/// \cond
+namespace detail_hmmwc{
 
-namespace inference{
+    // a connected set of (dense) variables which
+    // still has to be split into the semantic
+    // classes [classBegin_, classEnd_)
+    struct Task{
+        std::vector<Vi> nodes_;
+        DiscreteLabel classBegin_;
+        DiscreteLabel classEnd_;
+    };
 
+    struct Adjacency{
+        Vi other_;
+        ValueType beta_;
+    };
+
+    // per thread buffers of the binary split subroutine
+    struct Workspace{
+        Workspace(const Vi nVar)
+        :   graph_(),
+            mark_(nVar, 0),
+            localId_(nVar, 0),
+            stamp_(0),
+            cost0_(),
+            cost1_(),
+            current_(),
+            result_(),
+            stack_(),
+            inStack_(){
+        }
+        MaxFlow<ValueType> graph_;
+        std::vector<uint64_t> mark_;
+        std::vector<Vi> localId_;
+        uint64_t stamp_;
+        std::vector<ValueType> cost0_;
+        std::vector<ValueType> cost1_;
+        std::vector<DiscreteLabel> current_;
+        std::vector<DiscreteLabel> result_;
+        std::vector<Vi> stack_;
+        std::vector<unsigned char> inStack_;
+    };
+
+} // end namespace inferno::inference::detail_hmmwc
+/// \endcond
+
+
+    /** \brief Hierarchical solver for modified multiway cut models
+
+        Each connected component of the model is split top-down:
+        First the set of semantic classes is recursively halved
+        with binary cuts, afterwards each connected component of
+        a semantic class which allows cuts within is recursively
+        split into instances by binary cuts.
+        The binary problems are solved with QPBO, non persistent
+        variables keep their unary-optimal label and the result
+        is improved with single variable flips.
+
+        All components are independent and are processed in
+        parallel (Options::nThreads_ != 1).
+        The visitor is called after each level of the hierarchy.
+
+        \warning the unaries must have the same value for all
+        labels of a semantic class
+    */
     template<class MODEL>
     class Hmmwc  : public DiscreteInferenceBase<MODEL> {
 
@@ -32,104 +103,111 @@ namespace inference{
     private:
         typedef models::ConnectedComponents<Model> ConnectedComp;
         typedef typename ConnectedComp::Options CCOpt;
+        typedef models::DenseVariableIds<Model> DenseVarIds;
+        typedef detail_hmmwc::Task Task;
+        typedef detail_hmmwc::Workspace Workspace;
     public:
-        
-        struct Options{
 
+        struct Options{
+            Options(
+                const uint64_t nThreads = 1
+            )
+            :   nThreads_(nThreads)
+            {
+            }
+            uint64_t nThreads_;
         };
 
-
-
         Hmmwc(const Model & model, const Options & options = Options())
         :   BaseInf(),
             model_(model),
-            connectedComp_(model,CCOpt{true}),
+            options_(options),
+            denseVarIds_(model),
             conf_(model, 0),
-            semanticConf_(model,0),
-            partitionConf_(model,0),
+            rootTasks_(),
             allowCuts_(),
+            startLabel_(),
+            unaryCost_(),
+            adjBegin_(),
+            adjacency_(),
+            workspaces_(),
+            pool_(),
             lowerBound_(infVal()*-1.0),
+            value_(infVal()),
             stopInference_(false){
 
             INFERNO_CHECK_OP(model_.maxArity(),==, 2, "Hmmwc is only implemented for models with maxArity == 2");
 
-            std::cout<<"Hmmwc constructor \n";
             model_.guessAllowCutsWithin(allowCuts_);
+            INFERNO_CHECK(!allowCuts_.empty(), "Hmmwc is only implemented for modified multiway cut models");
             startLabel_.resize(allowCuts_.size());
-
             DiscreteLabel s=0;
-            std::cout<<" #"<<allowCuts_.size()<<" semantic classes\n";
-            for(auto i=0; i<allowCuts_.size(); ++i){
+            for(size_t i=0; i<allowCuts_.size(); ++i){
                 startLabel_[i] = s;
                 s+= allowCuts_[i] ? model_.nVariables() : 1;
-                std::cout<<" sc "<<i<<" cuts within? "<<allowCuts_[i]<<" (label range "<<startLabel_[i]<<" - "<<s<<")"<<"\n";
-            }
-        }
-
-        void computeTrivialLowerBoundUpperBound(){
-            lowerBound_ = 0.0;
-
-            for(const auto fac : model_.factors()){
-                const auto arity = fac->arity();
-                if(arity == 1){
-                    auto minVal = infVal();
-                    DiscreteLabel argMin = 0;
-                    for(const auto label : startLabel_){
-                        const auto val = fac->eval(label);
-                        if(val<minVal){
-                            minVal = val;
-                            argMin = label;
-                        }
-                    }
-                    std::cout<<argMin<<" ["<<minVal<<"]\n";
-                    const auto vi = fac->variable(0);
-                    conf_[vi] = argMin;
-                    semanticConf_[vi] = argMin;
-                    partitionConf_[vi] = argMin;
-                }
-                else{
-                    ValueType beta;
-                    if(!fac->isPotts(beta)){
-                        throw RuntimeError("second order factors isPotts must be true");
-                    }
-                    if(beta<0.0)
-                        lowerBound_ +=beta;
-                }
             }
-        }
 
-        void topDownSplitting(){
-            std::cout<<"to-down-splitting\n";
-            const Vi nCC = connectedComp_.run(partitionConf_) + 1;
-
-            std::cout<<"vars "<<model_.nVariables()<<" nCC "<<nCC<<"\n\n";
-
-            for(const auto anchor : connectedComp_.anchors()){
-                std::cout<<" anchors "<<anchor<<"\n";
-            }
+            this->buildStructure();
+            this->buildRootTasks();
 
+            const auto nThreads = options_.nThreads_ == 0 ?
+                std::thread::hardware_concurrency() : options_.nThreads_;
+            for(size_t t=0; t<nThreads; ++t)
+                workspaces_.emplace_back(model_.nVariables());
+            if(nThreads > 1)
+                pool_.reset(new utilities::ThreadPool(nThreads));
         }
 
-
         // MUST HAVE INTERACE
         virtual std::string name() const {
             return "Hmmwc";
         }
         // inference
         virtual void infer( Visitor  * visitor  = NULL) {
-
+            stopInference_ = false;
             if(visitor!=NULL)
                 visitor->begin(this);
 
-            
-            this->computeTrivialLowerBoundUpperBound();
-            this->topDownSplitting();
-
-
-            if(visitor!=NULL)
-                visitor->visit(this);    
+            // each connected component of the model is a root task
+            std::vector<Task> tasks(rootTasks_);
+
+            std::vector<Task> leaves;
+            std::vector<std::vector<Task> > children;
+            std::vector<unsigned char> isLeaf;
+            while(!tasks.empty() && !stopInference_){
+
+                // all tasks are independent
+                children.resize(tasks.size());
+                isLeaf.resize(tasks.size());
+                auto f = [&](const int tid, const size_t t){
+                    children[t].clear();
+                    isLeaf[t] = this->splitTask(workspaces_[tid], tasks[t], children[t]);
+                };
+                if(pool_){
+                    utilities::parallel_foreach(*pool_, tasks.size(),
+                        boost::counting_iterator<size_t>(0),
+                        boost::counting_iterator<size_t>(tasks.size()), f);
+                }
+                else{
+                    for(size_t t=0; t<tasks.size(); ++t)
+                        f(0, t);
+                }
 
+                std::vector<Task> nextTasks;
+                for(size_t t=0; t<tasks.size(); ++t){
+                    if(isLeaf[t])
+                        leaves.push_back(std::move(tasks[t]));
+                    for(auto & child : children[t])
+                        nextTasks.push_back(std::move(child));
+                }
+                tasks.swap(nextTasks);
 
+                if(visitor!=NULL){
+                    this->writeConf(leaves, tasks);
+                    visitor->visit(this);
+                }
+            }
+            this->writeConf(leaves, tasks);
 
             if(visitor!=NULL)
                 visitor->end(this);
@@ -152,38 +230,311 @@ namespace inference{
         }
 
         // OPTIONAL INTERFACE
-        // warm start related (do nothing default)
-        //virtual void setConf(const Conf & conf){
-        //    
-        //}
-
         // get results optional interface
-        //virtual ValueType upperBound(){
-        //    
-        //}
-        //virtual ValueType energy(){
-        //    
-        //}
+        virtual ValueType upperBound(){
+            return value_;
+        }
+        virtual ValueType energy(){
+            return value_;
+        }
         virtual ValueType lowerBound(){
             return lowerBound_;
         }
 
     private:
 
+        ValueType unaryCost(const Vi u, const DiscreteLabel c)const{
+            return unaryCost_[u*allowCuts_.size() + c];
+        }
+
+        // the connected components of the model (independent of conf_,
+        // which holds the result of the previous run)
+        void buildRootTasks(){
+            ConnectedComp connectedComp(model_, CCOpt{true});
+            Conf components(model_, 0);
+            const Vi nCC = connectedComp.run(components) + 1;
+            rootTasks_.resize(nCC);
+            for(auto & task : rootTasks_){
+                task.classBegin_ = 0;
+                task.classEnd_ = allowCuts_.size();
+            }
+            for(const auto var : model_.variableDescriptors())
+                rootTasks_[components[var]].nodes_.push_back(denseVarIds_.toDenseId(var));
+        }
+
+        // dense unaries (per semantic class), adjacency and a trivial bound
+        void buildStructure(){
+            const Vi nVar = model_.nVariables();
+            const DiscreteLabel nClasses = allowCuts_.size();
+            unaryCost_.assign(nVar*nClasses, 0);
+            adjBegin_.assign(nVar + 1, 0);
+            lowerBound_ = model_.constTerm();
+
+            for(const auto unary : model_.unaries()){
+                const Vi u = denseVarIds_.toDenseId(unary->variable());
+                for(DiscreteLabel c=0; c<nClasses; ++c)
+                    unaryCost_[u*nClasses + c] += unary->eval(startLabel_[c]);
+            }
+            std::vector<std::pair<Vi, detail_hmmwc::Adjacency> > edges;
+            for(const auto fac : model_.factors()){
+                const auto arity = fac->arity();
+                if(arity == 1){
+                    const Vi u = denseVarIds_.toDenseId(fac->variable(0));
+                    for(DiscreteLabel c=0; c<nClasses; ++c){
+                        const LabelType l = startLabel_[c];
+                        unaryCost_[u*nClasses + c] += fac->eval(&l);
+                    }
+                }
+                else{
+                    ValueType beta;
+                    if(!fac->isPotts(beta)){
+                        throw RuntimeError("second order factors isPotts must be true");
+                    }
+                    if(beta<0.0)
+                        lowerBound_ +=beta;
+                    const Vi u = denseVarIds_.toDenseId(fac->variable(0));
+                    const Vi v = denseVarIds_.toDenseId(fac->variable(1));
+                    edges.push_back(std::make_pair(u, detail_hmmwc::Adjacency{v, beta}));
+                    edges.push_back(std::make_pair(v, detail_hmmwc::Adjacency{u, beta}));
+                    ++adjBegin_[u+1];
+                    ++adjBegin_[v+1];
+                }
+            }
+            for(Vi u=0; u<nVar; ++u){
+                adjBegin_[u+1] += adjBegin_[u];
+                lowerBound_ += *std::min_element(unaryCost_.begin() + u*nClasses,
+                                                 unaryCost_.begin() + (u+1)*nClasses);
+            }
+            adjacency_.resize(edges.size());
+            std::vector<uint64_t> pos(adjBegin_.begin(), adjBegin_.end()-1);
+            for(const auto & e : edges)
+                adjacency_[pos[e.first]++] = e.second;
+        }
+
+        // split a task with a binary cut.
+        // \returns true if the task cannot be split any further
+        bool splitTask(Workspace & ws, const Task & task, std::vector<Task> & children){
+            const auto & nodes = task.nodes_;
+            const Vi n = nodes.size();
+            const auto b = task.classBegin_;
+            const auto e = task.classEnd_;
+            const bool splitClasses = e - b > 1;
+            if(!splitClasses && (!allowCuts_[b] || n == 1))
+                return true;
+
+            ++ws.stamp_;
+            ws.cost0_.resize(n);
+            ws.cost1_.resize(n);
+            ws.current_.resize(n);
+            ws.result_.resize(n);
+            const auto mid = (b + e)/2;
+            for(Vi i=0; i<n; ++i){
+                const Vi u = nodes[i];
+                ws.mark_[u] = ws.stamp_;
+                ws.localId_[u] = i;
+                if(splitClasses){
+                    ValueType c0 = infVal(), c1 = infVal();
+                    for(auto c=b; c<mid; ++c)
+                        c0 = std::min(c0, unaryCost(u, c));
+                    for(auto c=mid; c<e; ++c)
+                        c1 = std::min(c1, unaryCost(u, c));
+                    ws.cost0_[i] = c0;
+                    ws.cost1_[i] = c1;
+                    ws.current_[i] = c1 < c0 ? 1 : 0;
+                }
+                else{
+                    ws.cost0_[i] = 0;
+                    ws.cost1_[i] = 0;
+                    ws.current_[i] = 0;
+                }
+            }
+
+            // splitting a single class is symmetric,
+            // therefore the first variable is fixed
+            const ValueType gain = this->solveBinary(ws, nodes, !splitClasses);
+            if(!splitClasses && !(gain > 0))
+                return true;
+
+            // the connected components of both sides are the new tasks
+            for(Vi root=0; root<n; ++root){
+                if(ws.mark_[nodes[root]] != ws.stamp_)
+                    continue;
+                const auto side = ws.result_[root];
+                Task child;
+                child.classBegin_ = splitClasses ? (side == 0 ? b : mid) : b;
+                child.classEnd_ = splitClasses ? (side == 0 ? mid : e) : e;
+                ws.mark_[nodes[root]] = 0;
+                ws.stack_.push_back(nodes[root]);
+                while(!ws.stack_.empty()){
+                    const Vi u = ws.stack_.back();
+                    ws.stack_.pop_back();
+                    child.nodes_.push_back(u);
+                    for(auto a=adjBegin_[u]; a<adjBegin_[u+1]; ++a){
+                        const Vi v = adjacency_[a].other_;
+                        if(ws.mark_[v] == ws.stamp_ && ws.result_[ws.localId_[v]] == side){
+                            ws.mark_[v] = 0;
+                            ws.stack_.push_back(v);
+                        }
+                    }
+                }
+                children.push_back(std::move(child));
+            }
+            return false;
+        }
+
+        // solve the binary problem of the marked nodes,
+        // the result is stored in ws.result_
+        // \returns the energy decrease w.r.t. ws.current_
+        ValueType solveBinary(Workspace & ws, const std::vector<Vi> & nodes, const bool fixFirst){
+            const Vi n = nodes.size();
+            auto & graph = ws.graph_;
+            graph.clear();
+            graph.addNodes(2*n);
+
+            ValueType absSum = 1;
+            for(Vi i=0; i<n; ++i){
+                const ValueType c0 = ws.cost0_[i];
+                const ValueType c1 = ws.cost1_[i];
+                absSum += std::abs(c0 - c1);
+                graph.addTWeights(2*i, c1/2, c0/2);
+                graph.addTWeights(2*i+1, c0/2, c1/2);
+                const Vi u = nodes[i];
+                for(auto a=adjBegin_[u]; a<adjBegin_[u+1]; ++a){
+                    const Vi v = adjacency_[a].other_;
+                    if(ws.mark_[v] != ws.stamp_ || v < u)
+                        continue;
+                    const Vi j = ws.localId_[v];
+                    const ValueType beta = adjacency_[a].beta_;
+                    const ValueType c = std::abs(beta)/2;
+                    absSum += std::abs(beta);
+                    if(beta >= 0){
+                        graph.addEdge(2*i, 2*j, c, c);
+                        graph.addEdge(2*i+1, 2*j+1, c, c);
+                    }
+                    else{
+                        graph.addEdge(2*i, 2*j+1, c, c);
+                        graph.addEdge(2*j, 2*i+1, c, c);
+                    }
+                }
+            }
+            if(fixFirst){
+                graph.addTWeights(0, absSum, 0);
+                graph.addTWeights(1, 0, absSum);
+            }
+            graph.maxflow();
+
+            // persistent labels
+            for(Vi i=0; i<n; ++i){
+                const auto s0 = graph.segment(2*i);
+                const auto s1 = graph.segment(2*i+1);
+                if(s0 == MaxFlow<ValueType>::Source && s1 == MaxFlow<ValueType>::Sink)
+                    ws.result_[i] = 0;
+                else if(s0 == MaxFlow<ValueType>::Sink && s1 == MaxFlow<ValueType>::Source)
+                    ws.result_[i] = 1;
+                else
+                    ws.result_[i] = ws.current_[i];
+            }
+
+            // improve with single variable flips
+            auto flipDelta = [&](const Vi i){
+                const Vi u = nodes[i];
+                const auto xi = ws.result_[i];
+                ValueType delta = xi == 0 ? ws.cost1_[i] - ws.cost0_[i] : ws.cost0_[i] - ws.cost1_[i];
+                for(auto a=adjBegin_[u]; a<adjBegin_[u+1]; ++a){
+                    const Vi v = adjacency_[a].other_;
+                    if(ws.mark_[v] == ws.stamp_){
+                        const ValueType beta = adjacency_[a].beta_;
+                        delta += ws.result_[ws.localId_[v]] == xi ? beta : -beta;
+                    }
+                }
+                return delta;
+            };
+            ws.inStack_.assign(n, 1);
+            for(Vi i=0; i<n; ++i)
+                ws.stack_.push_back(i);
+            while(!ws.stack_.empty()){
+                const Vi i = ws.stack_.back();
+                ws.stack_.pop_back();
+                ws.inStack_[i] = 0;
+                if(flipDelta(i) < 0){
+                    ws.result_[i] = 1 - ws.result_[i];
+                    const Vi u = nodes[i];
+                    for(auto a=adjBegin_[u]; a<adjBegin_[u+1]; ++a){
+                        const Vi v = adjacency_[a].other_;
+                        if(ws.mark_[v] == ws.stamp_ && !ws.inStack_[ws.localId_[v]]){
+                            ws.inStack_[ws.localId_[v]] = 1;
+                            ws.stack_.push_back(ws.localId_[v]);
+                        }
+                    }
+                }
+            }
+
+            // compare with the starting point
+            ValueType currentEnergy = 0;
+            ValueType resultEnergy = 0;
+            for(Vi i=0; i<n; ++i){
+                currentEnergy += ws.current_[i] == 0 ? ws.cost0_[i] : ws.cost1_[i];
+                resultEnergy += ws.result_[i] == 0 ? ws.cost0_[i] : ws.cost1_[i];
+                const Vi u = nodes[i];
+                for(auto a=adjBegin_[u]; a<adjBegin_[u+1]; ++a){
+                    const Vi v = adjacency_[a].other_;
+                    if(ws.mark_[v] == ws.stamp_ && u < v){
+                        const Vi j = ws.localId_[v];
+                        const ValueType beta = adjacency_[a].beta_;
+                        if(ws.current_[i] != ws.current_[j])
+                            currentEnergy += beta;
+                        if(ws.result_[i] != ws.result_[j])
+                            resultEnergy += beta;
+                    }
+                }
+            }
+            if(!(resultEnergy < currentEnergy)){
+                ws.result_ = ws.current_;
+                return 0;
+            }
+            return currentEnergy - resultEnergy;
+        }
+
+        // leaves and unfinished tasks get the first
+        // semantic class of their range
+        void writeConf(const std::vector<Task> & leaves, const std::vector<Task> & tasks){
+            std::vector<DiscreteLabel> nInstances(allowCuts_.size(), 0);
+            auto write = [&](const Task & task){
+                const auto c = task.classBegin_;
+                DiscreteLabel l = startLabel_[c];
+                if(allowCuts_[c])
+                    l += nInstances[c]++;
+                for(const auto u : task.nodes_)
+                    conf_[denseVarIds_.toDescriptor(u)] = l;
+            };
+            for(const auto & task : leaves)
+                write(task);
+            for(const auto & task : tasks)
+                write(task);
+            value_ = model_.eval(conf_);
+        }
 
         const Model & model_;
-        ConnectedComp connectedComp_;
+        Options options_;
+        DenseVarIds denseVarIds_;
         Conf conf_;
-        Conf semanticConf_;
-        Conf partitionConf_;
+        std::vector<Task> rootTasks_;
 
         std::vector<bool> allowCuts_;
         std::vector<DiscreteLabel> startLabel_;
+        std::vector<ValueType> unaryCost_;
+        std::vector<uint64_t> adjBegin_;
+        std::vector<detail_hmmwc::Adjacency> adjacency_;
+
+        std::vector<Workspace> workspaces_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+
         ValueType lowerBound_;
+        ValueType value_;
         bool stopInference_;
     };
-  
-    
+
+
 
 } // end namespace inferno::inference
 } // end namespace inferno
@@ -3,6 +3,7 @@
 
 #include "inferno/inferno.hxx"
 #include "inferno/utilities/delegate.hxx"
+#include "inferno/utilities/profiler.hxx"
 #include "inferno/inference/discrete_inference_base.hxx"
 #include "inferno/inference/utilities/movemaker.hxx"
 #include "inferno/model/factors_of_variables.hxx"
@@ -46,6 +47,7 @@ namespace inference{
         }
         // inference
         virtual void infer( Visitor  * visitor  = NULL) {
+            INFERNO_PROFILE_SCOPE("Icm::infer");
 
             const auto factorOfVariables  = movemaker_.factorsOfVariabes();
 
@@ -57,6 +59,7 @@ namespace inference{
 
             bool changes = true;
             while(changes){
+                INFERNO_PROFILE_SCOPE("Icm::sweep");
                 changes = false;
                 for(const auto varDesc : model_.variableDescriptors()){
                     if(stopInference_){
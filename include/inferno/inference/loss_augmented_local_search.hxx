@@ -0,0 +1,314 @@
+/** \file loss_augmented_local_search.hxx
+    \brief  Implementation of inferno::inference::LossAugmentedLocalSearch
+*/
+#ifndef INFERNO_INFERENCE_LOSS_AUGMENTED_LOCAL_SEARCH_HXX
+#define INFERNO_INFERENCE_LOSS_AUGMENTED_LOCAL_SEARCH_HXX
+
+// std
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+
+// inferno
+#include "inferno/inferno.hxx"
+#include "inferno/inference/discrete_inference_base.hxx"
+#include "inferno/model/factors_of_variables.hxx"
+#include "inferno/learning/loss_functions/loss_function_base.hxx"
+
+namespace inferno{
+namespace inference{
+
+
+    /** \brief Approximate loss augmented inference for
+        non decomposable loss functions.
+
+        Greedy local search on a
+        models::NonDecomposableLossAugmentedModel which minimizes
+        \f[
+            E(x) - \Delta(x_{gt}, x)
+        \f]
+        by moving single variables.
+        The energy change of a move is computed from the factors
+        of the variable, the loss change from the incremental loss
+        of the loss function (see
+        learning::loss_functions::NonDecomposableLossFunctionBase::incrementalLoss),
+        which is O(1) for the variation of information and the rand index.
+
+        For variables with at most Options::maxEnumeratedLabels_ labels
+        all labels are tried, otherwise (e.g. multicut models) the labels
+        of the neighbours and a single unused label (a new cluster).
+
+        The search starts from the labeling given by setConf,
+        or from the ground truth. Since the factors are read
+        lazily, the solver can be reused after the weights
+        of the lossless model have changed.
+    */
+    template<class MODEL>
+    class LossAugmentedLocalSearch  : public DiscreteInferenceBase<MODEL> {
+    public:
+        typedef MODEL Model;
+        typedef LossAugmentedLocalSearch<MODEL> Self;
+        typedef DiscreteInferenceBase<MODEL> BaseInf;
+        typedef typename BaseInf::Visitor Visitor;
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+
+        typedef typename Model::LosslessModel LosslessModel;
+        typedef typename LosslessModel::VariableDescriptor LosslessVariableDescriptor;
+        typedef typename LosslessModel::UnaryDescriptor LosslessUnaryDescriptor;
+        typedef typename LosslessModel:: template VariableMap<DiscreteLabel> LosslessConf;
+        typedef learning::loss_functions::IncrementalLossBase<LosslessModel> IncrementalLoss;
+
+        static void defaultOptions(InferenceOptions & ){
+
+        }
+
+        struct Options{
+            Options(
+                const uint64_t maxSweeps = 100,
+                const DiscreteLabel maxEnumeratedLabels = 16,
+                const double eps = 1.0e-10
+            )
+            :   maxSweeps_(maxSweeps),
+                maxEnumeratedLabels_(maxEnumeratedLabels),
+                eps_(eps){
+            }
+            uint64_t maxSweeps_;
+            DiscreteLabel maxEnumeratedLabels_;
+            double eps_;
+        };
+
+        LossAugmentedLocalSearch(const Model & model, const Options & options = Options())
+        :   BaseInf(),
+            model_(model),
+            losslessModel_(model.baseModel()),
+            options_(options),
+            factorsOfVariables_(losslessModel_),
+            variablesNeighbours_(losslessModel_),
+            unariesOfVariables_(losslessModel_),
+            incrementalLoss_(model.lossFunction().incrementalLoss(
+                losslessModel_, model.groundTruth())),
+            conf_(losslessModel_),
+            startConf_(losslessModel_),
+            hasStartConf_(false),
+            labelCounts_(),
+            freeLabels_(),
+            nextFreeLabel_(0),
+            candidates_(),
+            factorConf_(losslessModel_.maxArity()),
+            energy_(0),
+            loss_(0),
+            stopInference_(false){
+            for(const auto unary : losslessModel_.unaryDescriptors())
+                unariesOfVariables_[losslessModel_.unary(unary)->variable()].push_back(unary);
+        }
+
+        // MUST HAVE INTERACE
+        virtual std::string name() const {
+            return "LossAugmentedLocalSearch";
+        }
+        // inference
+        virtual void infer( Visitor  * visitor  = NULL) {
+            stopInference_ = false;
+            const auto & start = hasStartConf_ ? startConf_ : model_.groundTruth();
+            for(const auto var : losslessModel_.variableDescriptors())
+                conf_[var] = start[var];
+            this->resetLabels();
+            incrementalLoss_->reset(conf_);
+            loss_ = incrementalLoss_->loss();
+            energy_ = losslessModel_.eval(conf_);
+
+            if(visitor!=NULL)
+                visitor->begin(this);
+
+            for(uint64_t sweep=0; sweep<options_.maxSweeps_ && !stopInference_; ++sweep){
+                bool changes = false;
+                for(const auto var : losslessModel_.variableDescriptors()){
+                    if(stopInference_)
+                        break;
+                    if(this->moveOptimally(var))
+                        changes = true;
+                }
+                if(visitor!=NULL)
+                    visitor->visit(this);
+                if(!changes)
+                    break;
+            }
+
+            if(visitor!=NULL)
+                visitor->end(this);
+        }
+        // get result
+        virtual void conf(Conf & confMap ) {
+            for(const auto var : losslessModel_.variableDescriptors())
+                confMap[var] = conf_[var];
+        }
+        virtual DiscreteLabel label(const Vi vi ) {
+            return conf_[losslessModel_.variableDescriptor(vi)];
+        }
+        // get model
+        virtual const Model & model() const{
+            return model_;
+        }
+        // stop inference (via visitor)
+        virtual void stopInference(){
+            stopInference_ = true;
+        }
+
+        // OPTIONAL INTERFACE
+        // warm start related
+        virtual void setConf(const Conf & conf){
+            for(const auto var : losslessModel_.variableDescriptors())
+                startConf_[var] = conf[var];
+            hasStartConf_ = true;
+        }
+
+        // get results optional interface
+        virtual ValueType upperBound(){
+            return energy_ - loss_;
+        }
+        virtual ValueType energy(){
+            return energy_ - loss_;
+        }
+
+        // the factors are not cached
+        virtual void energyChange() {
+        }
+
+    private:
+
+        // move var to the label with the lowest
+        // loss augmented energy, returns true if var has been moved
+        bool moveOptimally(const LosslessVariableDescriptor var){
+            const auto currentLabel = conf_[var];
+            this->candidateLabels(var);
+
+            auto bestLabel = currentLabel;
+            ValueType bestDelta = -1.0*options_.eps_;
+            ValueType bestEnergyDelta = 0;
+            LossType bestLoss = loss_;
+            for(const auto label : candidates_){
+                if(label == currentLabel)
+                    continue;
+                const auto energyDelta = this->energyDelta(var, label);
+                const auto loss = incrementalLoss_->lossAfterMove(var, label);
+                const auto delta = energyDelta - (loss - loss_);
+                if(delta < bestDelta){
+                    bestDelta = delta;
+                    bestLabel = label;
+                    bestEnergyDelta = energyDelta;
+                    bestLoss = loss;
+                }
+            }
+            if(bestLabel == currentLabel)
+                return false;
+
+            incrementalLoss_->move(var, bestLabel);
+            this->decrementLabel(currentLabel);
+            ++labelCounts_[bestLabel];
+            conf_[var] = bestLabel;
+            energy_ += bestEnergyDelta;
+            loss_ = bestLoss;
+            return true;
+        }
+
+        void candidateLabels(const LosslessVariableDescriptor var){
+            candidates_.clear();
+            const auto nLabels = losslessModel_.nLabels(var);
+            if(nLabels <= options_.maxEnumeratedLabels_){
+                for(DiscreteLabel l=0; l<nLabels; ++l)
+                    candidates_.push_back(l);
+                return;
+            }
+            for(const auto otherVar : variablesNeighbours_[var])
+                candidates_.push_back(conf_[otherVar]);
+            std::sort(candidates_.begin(), candidates_.end());
+            candidates_.erase(std::unique(candidates_.begin(), candidates_.end()), candidates_.end());
+
+            DiscreteLabel freeLabel;
+            if(this->freeLabel(nLabels, freeLabel))
+                candidates_.push_back(freeLabel);
+        }
+
+        ValueType energyDelta(const LosslessVariableDescriptor var, const DiscreteLabel label){
+            const auto currentLabel = conf_[var];
+            ValueType delta = 0;
+            for(const auto fac : factorsOfVariables_[var]){
+                const auto factor = losslessModel_.factor(fac);
+                const auto arity = factor->arity();
+                for(size_t d=0; d<arity; ++d)
+                    factorConf_[d] = conf_[factor->variable(d)];
+                delta -= factor->eval(factorConf_.data());
+                for(size_t d=0; d<arity; ++d)
+                    if(factor->variable(d) == var)
+                        factorConf_[d] = label;
+                delta += factor->eval(factorConf_.data());
+            }
+            for(const auto unaryDesc : unariesOfVariables_[var]){
+                const auto unary = losslessModel_.unary(unaryDesc);
+                delta += unary->eval(label) - unary->eval(currentLabel);
+            }
+            return delta;
+        }
+
+        // bookkeeping of the used labels to find unused labels
+        void resetLabels(){
+            labelCounts_.clear();
+            freeLabels_.clear();
+            nextFreeLabel_ = 0;
+            for(const auto var : losslessModel_.variableDescriptors())
+                ++labelCounts_[conf_[var]];
+        }
+        void decrementLabel(const DiscreteLabel label){
+            const auto iter = labelCounts_.find(label);
+            if(--iter->second == 0){
+                labelCounts_.erase(iter);
+                freeLabels_.push_back(label);
+            }
+        }
+        bool isUsed(const DiscreteLabel label)const{
+            return labelCounts_.find(label) != labelCounts_.end();
+        }
+        bool freeLabel(const DiscreteLabel nLabels, DiscreteLabel & label){
+            while(!freeLabels_.empty() && this->isUsed(freeLabels_.back()))
+                freeLabels_.pop_back();
+            if(!freeLabels_.empty() && freeLabels_.back() < nLabels){
+                label = freeLabels_.back();
+                return true;
+            }
+            while(nextFreeLabel_ < nLabels && this->isUsed(nextFreeLabel_))
+                ++nextFreeLabel_;
+            if(nextFreeLabel_ < nLabels){
+                label = nextFreeLabel_;
+                return true;
+            }
+            return false;
+        }
+
+        const Model & model_;
+        const LosslessModel & losslessModel_;
+        Options options_;
+        models::FactorsOfVariables<LosslessModel> factorsOfVariables_;
+        models::VariablesNeighbours<LosslessModel> variablesNeighbours_;
+        typename LosslessModel:: template VariableMap<std::vector<LosslessUnaryDescriptor> > unariesOfVariables_;
+        std::unique_ptr<IncrementalLoss> incrementalLoss_;
+        LosslessConf conf_;
+        LosslessConf startConf_;
+        bool hasStartConf_;
+        std::unordered_map<DiscreteLabel, uint64_t> labelCounts_;
+        std::vector<DiscreteLabel> freeLabels_;
+        DiscreteLabel nextFreeLabel_;
+        std::vector<DiscreteLabel> candidates_;
+        std::vector<DiscreteLabel> factorConf_;
+        ValueType energy_;
+        LossType loss_;
+        bool stopInference_;
+    };
+
+
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+
+#endif /* INFERNO_INFERENCE_LOSS_AUGMENTED_LOCAL_SEARCH_HXX */
@@ -12,6 +12,7 @@
 #include "inferno/inferno.hxx"
 #include "inferno/utilities/delegate.hxx"
 #include "inferno/utilities/parallel/pool.hxx"
+#include "inferno/utilities/profiler.hxx"
 #include "inferno/inference/discrete_inference_base.hxx"
 #include "inferno/inference/utilities/movemaker.hxx"
 #include "inferno/model/factors_of_variables.hxx"
@@ -217,6 +218,7 @@ namespace inference{
         }
         // inference
         virtual void infer( Visitor  * visitor  = NULL) {
+            INFERNO_PROFILE_SCOPE("MessagePassing::infer");
 
             if(visitor!=NULL)
                 visitor->begin(this);
@@ -253,6 +255,7 @@ namespace inference{
         // send varToFac parallel for
         // random access iterator
         void sendAllVarToFac(){
+            INFERNO_PROFILE_SCOPE("MessagePassing::varToFacSweep");
             std::vector<ValueType> sum(nThreads_, 0.0);
             utilities::parallel_foreach(pool_, model_.nVariables(), 
                 model_.variableDescriptorsBegin(), model_.variableDescriptorsEnd(),
@@ -270,6 +273,7 @@ namespace inference{
         // send facToVar parallel for
         // NON random access iterator
         void sendAllFacToVar(){
+            INFERNO_PROFILE_SCOPE("MessagePassing::facToVarSweep");
             utilities::parallel_foreach(pool_, model_.nFactors(),
                 model_.factorDescriptorsBegin(),model_.factorDescriptorsEnd(),
                 [this] (int id, FactorDescriptor fDesc) {
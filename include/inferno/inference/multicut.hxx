@@ -26,7 +26,9 @@
 
 #include "inferno/inferno.hxx"
 #include "inferno/utilities/timer.hxx"
+#include "inferno/utilities/profiler.hxx"
 #include "inferno/utilities/small_vector.hxx"
+#include "inferno/utilities/queues.hxx"
 #include "inferno/inference/discrete_inference_base.hxx"
 
 #include <ilcplex/ilocplex.h>
@@ -1385,6 +1387,7 @@ template<class MODEL>
 void
 Multicut<MODEL>::initCplex()
 {
+   INFERNO_PROFILE_SCOPE("Multicut::setup");
 
    cplex_.setParam(IloCplex::Threads, options_.numThreads_);
    cplex_.setParam(IloCplex::CutUp, options_.cutUp_);
@@ -1440,6 +1443,7 @@ Multicut<MODEL>::infer(VisitorType& mcv)
       }
    }
 
+   INFERNO_PROFILE_SCOPE("Multicut::infer");
    Timer timer,timer2;
    timer.tic();     
    //mcv.begin(*this);    
@@ -1460,44 +1464,47 @@ Multicut<MODEL>::infer(VisitorType& mcv)
          cplex_.setParam(IloCplex::Threads, options_.numThreads_); 
          cplex_.setParam(IloCplex::TiLim, options_.timeOut_-timer.elapsedTime());
          timer2.tic();
-         if(!cplex_.solve()) {
-            if(cplex_.getStatus() != IloAlgorithm::Unbounded){ 
-               std::cout << "failed to optimize. " <<cplex_.getStatus()<< std::endl; 
-               //Serious problem -> exit
-               //mcv(*this);  
-            }  
-            else{ 
-               //undbounded ray - most likely numerical problems
+         {
+            INFERNO_PROFILE_SCOPE("Multicut::lpSolve");
+            if(!cplex_.solve()) {
+               if(cplex_.getStatus() != IloAlgorithm::Unbounded){ 
+                  std::cout << "failed to optimize. " <<cplex_.getStatus()<< std::endl; 
+                  //Serious problem -> exit
+                  //mcv(*this);  
+               }  
+               else{ 
+                  //undbounded ray - most likely numerical problems
+               }
+            }
+            if(cplex_.getStatus()!= IloAlgorithm::Unbounded){
+               if(!integerMode_)
+                  bound_ = cplex_.getObjValue()+constant_;
+               else{
+                  bound_ = cplex_.getBestObjValue()+constant_;
+                  if(!cplex_.solveFixed()) {
+                     std::cout << "failed to fixed optimize." << std::endl; 
+                     //mcv(*this);
+                  }
+               } 
             }
-         }
-         if(cplex_.getStatus()!= IloAlgorithm::Unbounded){
-            if(!integerMode_)
-               bound_ = cplex_.getObjValue()+constant_;
             else{
-               bound_ = cplex_.getBestObjValue()+constant_;
-               if(!cplex_.solveFixed()) {
-                  std::cout << "failed to fixed optimize." << std::endl; 
-                  //mcv(*this);
-               }
-            } 
-         }
-         else{
-            //bound is not set - todo
-         }
-         try{ cplex_.getValues(sol_, x_);}
-         catch(IloAlgorithm::NotExtractedException e)  {
-            //std::cout << "UPS: solution not extractable due to unbounded dual ... solving this"<<std::endl;
-            // The following code is very ugly -> todo:  using rays instead
-            sol_.clear();
-            for(Vi v=0; v<numberOfTerminalEdges_+numberOfInternalEdges_+numberOfInterTerminalEdges_ + numberOfHigherOrderValues_; ++v){ 
-               try{ 
-                  sol_.add(cplex_.getValue(x_[v]));
-               } catch(IloAlgorithm::NotExtractedException e)  {
-                  sol_.add(0);          
-               }
-            } 
-         }
+               //bound is not set - todo
+            }
+            try{ cplex_.getValues(sol_, x_);}
+            catch(IloAlgorithm::NotExtractedException e)  {
+               //std::cout << "UPS: solution not extractable due to unbounded dual ... solving this"<<std::endl;
+               // The following code is very ugly -> todo:  using rays instead
+               sol_.clear();
+               for(Vi v=0; v<numberOfTerminalEdges_+numberOfInternalEdges_+numberOfInterTerminalEdges_ + numberOfHigherOrderValues_; ++v){ 
+                  try{ 
+                     sol_.add(cplex_.getValue(x_[v]));
+                  } catch(IloAlgorithm::NotExtractedException e)  {
+                     sol_.add(0);          
+                  }
+               } 
+            }
         
+         }
          timer2.toc();
          T[Protocol_ID_Solve] += timer2.elapsedTime();
 
@@ -1521,6 +1528,7 @@ Multicut<MODEL>::infer(VisitorType& mcv)
          for(std::vector<size_t>::iterator it=workFlow_[workingState].begin() ; it != workFlow_[workingState].end(); it++ ){
             size_t n = 0;
             size_t protocol_ID = Protocol_ID_Unknown;
+            INFERNO_PROFILE_SCOPE("Multicut::separation");
             timer2.tic();
             if(*it == Action_ID_TTC){
                if(options_.verbose_) std::cout << "* Add  terminal triangle constraints: " << std::flush;
@@ -2011,26 +2019,16 @@ inline double Multicut<MODEL>::shortestPath(
 
    std::vector<Vi>  prev(numberOfNodes,nonePrev);
    std::vector<double>     dist(numberOfNodes,inf);
-   MYSET                   openNodes;
+   // edge weights are cut at zero, therefore distances are monotone
+   RadixHeap<double>       openNodes(numberOfNodes);
    
-   openNodes.insert(startNode);
+   openNodes.push(startNode, 0.0);
    dist[startNode]=0.0;
 
    while(!openNodes.empty()){ 
-      Vi node;
       //Find smallest open node
-      {
-         typename MYSET::iterator it, itMin;
-         double v = std::numeric_limits<double>::infinity();
-         for(it = openNodes.begin(); it!= openNodes.end(); ++it){
-            if( dist[*it]<v ){
-               v = dist[*it];
-               itMin = it;
-            }
-         }
-         node = *itMin;
-         openNodes.erase(itMin);
-      }
+      const Vi node = openNodes.top();
+      openNodes.pop();
       // Check if target is reached
       if(node == endNode)
          break;
@@ -2061,7 +2059,7 @@ inline double Multicut<MODEL>::shortestPath(
                if(updateNode){
                   prev[node2] = node;
                   dist[node2] = weight2;
-                  openNodes.insert(node2);
+                  openNodes.push(node2, weight2);
                } 
             }
          }
@@ -0,0 +1,591 @@
+/** \file persistency.hxx
+    \brief  Partial optimality preprocessing:
+    inferno::inference::Persistency computes labels which
+    can be excluded from some global optimal solution and
+    inferno::inference::PersistencyReduction runs any solver
+    on the reduced model.
+*/
+#ifndef INFERNO_INFERENCE_PERSISTENCY_HXX
+#define INFERNO_INFERENCE_PERSISTENCY_HXX
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "inferno/inferno.hxx"
+#include "inferno/inference/discrete_inference_base.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/inference/utilities/maxflow.hxx"
+#include "inferno/model/factors_of_variables.hxx"
+#include "inferno/model/view_submodel.hxx"
+#include "inferno/utilities/small_vector.hxx"
+#include "inferno/utilities/flat_hash.hxx"
+#include "inferno/value_tables/min_marginals.hxx"
+
+namespace inferno{
+namespace inference{
+
+
+    /** \brief Partial optimality of a discrete model
+
+        Labels are excluded in a way that at least one
+        global optimal solution stays feasible:
+
+        - QPBO persistencies for binary models with maxArity <= 2,
+          computed with the bundled inferno::inference::MaxFlow
+          (all labels but the persistent one are excluded)
+
+        - Dominance (dead end elimination): label \f$b\f$ of variable
+          \f$u\f$ is excluded if there is a non-excluded label \f$a\f$
+          such that switching from \f$b\f$ to \f$a\f$ can never increase
+          the energy, no matter which non-excluded labels the
+          neighbours take:
+          \f[
+              \theta_u(b) - \theta_u(a) \geq \sum_{f \ni u} \max_{x_{f \setminus u}}
+              \left[ \theta_f(a, x_{f \setminus u}) - \theta_f(b, x_{f \setminus u}) \right]
+          \f]
+          The maximum enumerates the non-excluded labels of
+          the neighbours, therefore the cost grows with
+          the size of the factors.
+          Before enumerating, the maximum is bounded by
+          \f$ \max \theta_f - \min_{x_{f \setminus u}} \theta_f(b, x_{f \setminus u}) \f$
+          from the (cached) min-marginals of the factors.
+
+        A variable is partial optimal if all but one
+        label are excluded.
+    */
+    template<class MODEL>
+    class Persistency{
+    public:
+        typedef MODEL Model;
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+        typedef models::FactorsOfVariables<Model> FactorsOfVariables;
+    private:
+        typedef models::DenseVariableIds<Model> DenseVarIds;
+        typedef MaxFlow<ValueType> Graph;
+    public:
+
+        struct Options{
+            Options(
+                const bool useQpbo = true,
+                const bool useDominance = true
+            )
+            :   useQpbo_(useQpbo),
+                useDominance_(useDominance)
+            {
+            }
+            bool useQpbo_;
+            bool useDominance_;
+        };
+
+        Persistency(
+            const Model & model,
+            const FactorsOfVariables & factorsOfVariables,
+            const Options & options = Options()
+        )
+        :   model_(model),
+            factorsOfVariables_(factorsOfVariables),
+            options_(options),
+            denseVarIds_(model),
+            labelOffset_(model.nVariables()+1, 0),
+            allowed_(),
+            nAllowed_(model.nVariables(), 0),
+            unaryCost_(){
+
+            Vi u = 0;
+            for(const auto var : model_.variableDescriptors()){
+                labelOffset_[u+1] = labelOffset_[u] + model_.nLabels(var);
+                ++u;
+            }
+        }
+
+        /// \brief compute the excluded labels
+        void run(){
+            const Vi nVar = model_.nVariables();
+            // the weights of the model might have changed since the last run
+            minMarginals_.clear();
+            allowed_.assign(labelOffset_.back(), 1);
+            for(Vi u=0; u<nVar; ++u)
+                nAllowed_[u] = labelOffset_[u+1] - labelOffset_[u];
+            this->buildUnaryCost();
+
+            if(options_.useQpbo_ && this->isBinaryPairwise())
+                this->qpbo();
+            if(options_.useDominance_)
+                this->dominance();
+        }
+
+        /// \brief is all but one label excluded
+        bool isPartialOptimal(const Vi var)const{
+            return nAllowed_[denseVarIds_.toDenseId(var)] == 1;
+        }
+
+        /// \brief is the label excluded
+        bool isExcluded(const Vi var, const DiscreteLabel label)const{
+            return !allowed_[labelOffset_[denseVarIds_.toDenseId(var)] + label];
+        }
+
+        /// \brief the (only) label of a partial optimal variable
+        DiscreteLabel optimalLabel(const Vi var)const{
+            INFERNO_ASSERT(this->isPartialOptimal(var));
+            const Vi u = denseVarIds_.toDenseId(var);
+            DiscreteLabel l = 0;
+            while(!allowed_[labelOffset_[u] + l])
+                ++l;
+            return l;
+        }
+
+        /// \brief number of partial optimal variables
+        uint64_t nPartialOptimal()const{
+            return std::count(nAllowed_.begin(), nAllowed_.end(), 1);
+        }
+
+        /// \brief number of excluded labels (over all variables)
+        uint64_t nExcludedLabels()const{
+            return std::count(allowed_.begin(), allowed_.end(), 0);
+        }
+
+    private:
+
+        DiscreteLabel nLabels(const Vi u)const{
+            return labelOffset_[u+1] - labelOffset_[u];
+        }
+
+        bool isAllowed(const Vi u, const DiscreteLabel l)const{
+            return allowed_[labelOffset_[u] + l];
+        }
+
+        void exclude(const Vi u, const DiscreteLabel l){
+            INFERNO_ASSERT(this->isAllowed(u, l));
+            INFERNO_ASSERT_OP(nAllowed_[u],>,1);
+            allowed_[labelOffset_[u] + l] = 0;
+            --nAllowed_[u];
+        }
+
+        void fix(const Vi u, const DiscreteLabel label){
+            for(DiscreteLabel l=0; l<this->nLabels(u); ++l)
+                if(l != label && this->isAllowed(u, l))
+                    this->exclude(u, l);
+        }
+
+        // unaries and factors of arity 1
+        void buildUnaryCost(){
+            unaryCost_.assign(labelOffset_.back(), 0);
+            for(const auto factor : model_.factors()){
+                if(factor->arity() == 1){
+                    const Vi u = denseVarIds_.toDenseId(factor->variable(0));
+                    for(DiscreteLabel l=0; l<this->nLabels(u); ++l)
+                        unaryCost_[labelOffset_[u] + l] += factor->eval(&l);
+                }
+            }
+            for(const auto unary : model_.unaries()){
+                const Vi u = denseVarIds_.toDenseId(unary->variable());
+                for(DiscreteLabel l=0; l<this->nLabels(u); ++l)
+                    unaryCost_[labelOffset_[u] + l] += unary->eval(l);
+            }
+        }
+
+        bool isBinaryPairwise()const{
+            if(model_.maxArity() > 2)
+                return false;
+            const Vi nVar = model_.nVariables();
+            for(Vi u=0; u<nVar; ++u)
+                if(this->nLabels(u) != 2)
+                    return false;
+            return true;
+        }
+
+        // QPBO on the doubled graph, node 2u is x_u
+        // and node 2u+1 is its negation.
+        // A binary pairwise factor is rewritten as
+        // A + (C-A) x_u + (B-A) x_v + c x_u x_v with c = A+D-B-C
+        // and x_u x_v = (x_u + x_v - [x_u != x_v]) / 2
+        void qpbo(){
+            const Vi nVar = model_.nVariables();
+            std::vector<ValueType> cost1(nVar);
+            for(Vi u=0; u<nVar; ++u)
+                cost1[u] = unaryCost_[labelOffset_[u]+1] - unaryCost_[labelOffset_[u]];
+
+            Graph graph(2*nVar, 2*model_.nFactors());
+            graph.addNodes(2*nVar);
+            DiscreteLabel conf[2];
+            for(const auto factor : model_.factors()){
+                if(factor->arity() != 2)
+                    continue;
+                const Vi u = denseVarIds_.toDenseId(factor->variable(0));
+                const Vi v = denseVarIds_.toDenseId(factor->variable(1));
+                conf[0] = 0; conf[1] = 0;
+                const ValueType A = factor->eval(conf);
+                conf[0] = 0; conf[1] = 1;
+                const ValueType B = factor->eval(conf);
+                conf[0] = 1; conf[1] = 0;
+                const ValueType C = factor->eval(conf);
+                conf[0] = 1; conf[1] = 1;
+                const ValueType D = factor->eval(conf);
+                const ValueType c = A + D - B - C;
+                cost1[u] += C - A + c/2.0;
+                cost1[v] += B - A + c/2.0;
+                const ValueType beta = -c/2.0;
+                if(beta > 0){
+                    graph.addEdge(2*u, 2*v, beta/2.0, beta/2.0);
+                    graph.addEdge(2*u+1, 2*v+1, beta/2.0, beta/2.0);
+                }
+                else if(beta < 0){
+                    graph.addEdge(2*u, 2*v+1, -beta/2.0, -beta/2.0);
+                    graph.addEdge(2*v, 2*u+1, -beta/2.0, -beta/2.0);
+                }
+            }
+            // nodes in the source segment pay the sink capacity
+            for(Vi u=0; u<nVar; ++u){
+                if(cost1[u] > 0){
+                    graph.addTWeights(2*u, cost1[u]/2.0, 0);
+                    graph.addTWeights(2*u+1, 0, cost1[u]/2.0);
+                }
+                else if(cost1[u] < 0){
+                    graph.addTWeights(2*u, 0, -cost1[u]/2.0);
+                    graph.addTWeights(2*u+1, -cost1[u]/2.0, 0);
+                }
+            }
+            graph.maxflow();
+
+            // the source segment is the set of nodes reachable
+            // from the source, the induced labeling is persistent
+            for(Vi u=0; u<nVar; ++u){
+                const auto s0 = graph.segment(2*u);
+                const auto s1 = graph.segment(2*u+1);
+                if(s0 == Graph::Source && s1 == Graph::Sink)
+                    this->fix(u, 0);
+                else if(s0 == Graph::Sink && s1 == Graph::Source)
+                    this->fix(u, 1);
+            }
+        }
+
+        // dead end elimination, a variable is revisited
+        // whenever a label of a neighbour has been excluded
+        void dominance(){
+            const Vi nVar = model_.nVariables();
+            std::vector<Vi> stack;
+            std::vector<unsigned char> inStack(nVar, 1);
+            for(Vi u=0; u<nVar; ++u)
+                stack.push_back(nVar - 1 - u);
+
+            std::vector<ValueType> maxDiff;
+            SmallVector<Vi> vars;
+            SmallVector<DiscreteLabel> confA, confB;
+            while(!stack.empty()){
+                const Vi u = stack.back();
+                stack.pop_back();
+                inStack[u] = 0;
+                if(nAllowed_[u] <= 1)
+                    continue;
+
+                const auto var = denseVarIds_.toDescriptor(u);
+                const DiscreteLabel nl = this->nLabels(u);
+                bool changed = false;
+                for(DiscreteLabel b=0; b<nl && nAllowed_[u] > 1; ++b){
+                    if(!this->isAllowed(u, b))
+                        continue;
+                    const ValueType bPenalty = this->maxPenalty(u, var, b);
+                    for(DiscreteLabel a=0; a<nl; ++a){
+                        if(a == b || !this->isAllowed(u, a))
+                            continue;
+                        ValueType gain = unaryCost_[labelOffset_[u] + b] - unaryCost_[labelOffset_[u] + a];
+                        // cheap sufficient test with cached min-marginals before
+                        // the enumeration of the allowed labels of the neighbours
+                        if(gain - bPenalty >= 0){
+                            this->exclude(u, b);
+                            changed = true;
+                            break;
+                        }
+                        for(const auto fi : factorsOfVariables_[var]){
+                            if(gain < 0)
+                                break;
+                            const auto factor = model_.factor(fi);
+                            if(factor->arity() < 2)
+                                continue;
+                            gain -= this->maxFactorDiff(factor, u, a, b, vars, confA, confB);
+                        }
+                        if(gain >= 0){
+                            this->exclude(u, b);
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+                if(changed){
+                    for(const auto fi : factorsOfVariables_[var]){
+                        const auto factor = model_.factor(fi);
+                        for(size_t d=0; d<factor->arity(); ++d){
+                            const Vi w = denseVarIds_.toDenseId(factor->variable(d));
+                            if(w != u && !inStack[w] && nAllowed_[w] > 1){
+                                stack.push_back(w);
+                                inStack[w] = 1;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // upper bound of the sum of maxFactorDiff(factor, u, a, b) over all factors of u,
+        // for any a: factor(a, rest) - factor(b, rest) <= max(factor) - minMarginal_u(b)
+        template<class VAR>
+        ValueType maxPenalty(const Vi u, const VAR var, const DiscreteLabel b){
+            ValueType penalty = 0;
+            for(const auto fi : factorsOfVariables_[var]){
+                const auto factor = model_.factor(fi);
+                const size_t arity = factor->arity();
+                if(arity < 2)
+                    continue;
+                // computed once per factor, the default factor implementation
+                // buffers the whole value table on each call, models with
+                // a cache per value table only share their object here
+                auto & minMarginals = minMarginals_[fi];
+                if(!minMarginals)
+                    minMarginals = factor->minMarginals();
+                size_t pos = 0;
+                while(denseVarIds_.toDenseId(factor->variable(pos)) != u)
+                    ++pos;
+                penalty += minMarginals->maxValue() - minMarginals->minMarginal(pos, b);
+            }
+            return penalty;
+        }
+
+        // max over the allowed labels of all other variables
+        // of factor(a, rest) - factor(b, rest)
+        template<class FACTOR>
+        ValueType maxFactorDiff(
+            const FACTOR & factor,
+            const Vi u,
+            const DiscreteLabel a,
+            const DiscreteLabel b,
+            SmallVector<Vi> & vars,
+            SmallVector<DiscreteLabel> & confA,
+            SmallVector<DiscreteLabel> & confB
+        )const{
+            const size_t arity = factor->arity();
+            vars.resize(arity);
+            confA.resize(arity);
+            confB.resize(arity);
+            size_t pos = arity;
+            for(size_t d=0; d<arity; ++d){
+                vars[d] = denseVarIds_.toDenseId(factor->variable(d));
+                if(vars[d] == u){
+                    pos = d;
+                    confA[d] = a;
+                    confB[d] = b;
+                }
+                else{
+                    confA[d] = this->firstAllowed(vars[d], 0);
+                    confB[d] = confA[d];
+                }
+            }
+            INFERNO_ASSERT_OP(pos,<,arity);
+
+            ValueType best = -1.0*infVal();
+            while(true){
+                best = std::max(best, factor->eval(confA.data()) - factor->eval(confB.data()));
+                // odometer over the allowed labels of the other variables
+                size_t d = 0;
+                for(; d<arity; ++d){
+                    if(d == pos)
+                        continue;
+                    const DiscreteLabel next = this->firstAllowed(vars[d], confA[d]+1);
+                    if(next < this->nLabels(vars[d])){
+                        confA[d] = next;
+                        confB[d] = next;
+                        break;
+                    }
+                    confA[d] = this->firstAllowed(vars[d], 0);
+                    confB[d] = confA[d];
+                }
+                if(d == arity)
+                    break;
+            }
+            return best;
+        }
+
+        DiscreteLabel firstAllowed(const Vi u, DiscreteLabel l)const{
+            const DiscreteLabel nl = this->nLabels(u);
+            while(l < nl && !this->isAllowed(u, l))
+                ++l;
+            return l;
+        }
+
+        const Model & model_;
+        const FactorsOfVariables & factorsOfVariables_;
+        Options options_;
+        DenseVarIds denseVarIds_;
+        std::vector<uint64_t> labelOffset_;
+        std::vector<unsigned char> allowed_;
+        std::vector<DiscreteLabel> nAllowed_;
+        std::vector<ValueType> unaryCost_;
+        FlatHashMap<typename Model::FactorDescriptor, std::shared_ptr<const value_tables::MinMarginals> > minMarginals_;
+    };
+
+
+    /** \brief Meta solver which removes the partial optimal
+        variables (see inferno::inference::Persistency) and runs
+        a solver created by Options::factory_ on
+        a models::ViewSubmodel of the remaining variables.
+
+        The partial optimal variables are fixed in the
+        submodel, factors connecting them to the remaining
+        variables become factors of lower order.
+        Labels which are excluded but not fixed
+        are reported via excludedLabels only,
+        the sub-solver does not know about them.
+    */
+    template<class MODEL>
+    class PersistencyReduction  : public DiscreteInferenceBase<MODEL> {
+
+    public:
+        typedef MODEL Model;
+        typedef PersistencyReduction<MODEL> Self;
+        typedef DiscreteInferenceBase<MODEL> BaseInf;
+        typedef typename BaseInf::Visitor Visitor;
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+
+        typedef models::FactorsOfVariables<Model> FactorsOfVariables;
+        typedef models::ViewSubmodel<Model, FactorsOfVariables> SubModel;
+        typedef BaseDiscreteInferenceFactory<SubModel> SubInferenceFactory;
+        typedef typename SubModel:: template VariableMap<DiscreteLabel> SubConf;
+        typedef Persistency<Model> PersistencyType;
+
+        struct Options{
+            Options(
+                std::shared_ptr<SubInferenceFactory> factory = std::shared_ptr<SubInferenceFactory>(),
+                const typename PersistencyType::Options & persistencyOptions = typename PersistencyType::Options()
+            )
+            :   factory_(factory),
+                persistencyOptions_(persistencyOptions)
+            {
+            }
+            std::shared_ptr<SubInferenceFactory> factory_;
+            typename PersistencyType::Options persistencyOptions_;
+        };
+
+        PersistencyReduction(const Model & model, const Options & options = Options())
+        :   BaseInf(),
+            model_(model),
+            options_(options),
+            factorsOfVariables_(model),
+            persistency_(model, factorsOfVariables_, options.persistencyOptions_),
+            subModel_(model, factorsOfVariables_),
+            conf_(model, 0),
+            value_(infVal()),
+            lowerBound_(-1.0*infVal()),
+            stopInference_(false){
+            INFERNO_CHECK(bool(options_.factory_), "PersistencyReduction needs a factory for the sub-solver");
+        }
+
+        // MUST HAVE INTERACE
+        virtual std::string name() const {
+            return "PersistencyReduction";
+        }
+        // inference
+        virtual void infer( Visitor  * visitor  = NULL) {
+            stopInference_ = false;
+            value_ = infVal();
+            lowerBound_ = -1.0*infVal();
+            if(visitor!=NULL)
+                visitor->begin(this);
+
+            persistency_.run();
+
+            // fix the partial optimal variables
+            std::vector<Vi> freeVars;
+            for(const auto var : model_.variableDescriptors()){
+                if(persistency_.isPartialOptimal(var)){
+                    conf_[var] = persistency_.optimalLabel(var);
+                    subModel_.setBaseModelLabel(var, conf_[var]);
+                }
+                else
+                    freeVars.push_back(var);
+            }
+            value_ = model_.eval(conf_);
+            if(visitor!=NULL)
+                visitor->visit(this);
+
+            if(!freeVars.empty() && !stopInference_){
+                subModel_.setSubmodelVariables(freeVars.begin(), freeVars.end());
+                auto solver = options_.factory_->create(subModel_);
+                solver->infer();
+                SubConf subConf(subModel_);
+                solver->conf(subConf);
+                for(size_t i=0; i<freeVars.size(); ++i)
+                    conf_[subModel_.viToBaseVi(i)] = subConf[i];
+                value_ = model_.eval(conf_);
+                if(visitor!=NULL)
+                    visitor->visit(this);
+            }
+            else if(freeVars.empty()){
+                // all variables are partial optimal
+                lowerBound_ = value_;
+            }
+
+            if(visitor!=NULL)
+                visitor->end(this);
+        }
+        // get result
+        virtual void conf(Conf & confMap ) {
+            for(const auto varDesc : model_.variableDescriptors())
+                confMap[varDesc] = conf_[varDesc];
+        }
+        virtual DiscreteLabel label(const Vi vi ) {
+            return conf_[vi];
+        }
+        // get model
+        virtual const Model & model() const{
+            return model_;
+        }
+        // stop inference (via visitor)
+        virtual void stopInference(){
+            stopInference_ = true;
+        }
+
+        // OPTIONAL INTERFACE
+        // get results optional interface
+        virtual ValueType upperBound(){
+            return value_;
+        }
+        virtual ValueType energy(){
+            return value_;
+        }
+        virtual ValueType lowerBound(){
+            return lowerBound_;
+        }
+        virtual bool isPartialOptimal(const Vi vi){
+            return persistency_.isPartialOptimal(vi);
+        }
+        virtual void excludedLabels(
+            const Vi vi,
+            VectorSet<DiscreteLabel> & excludedLabes
+        ){
+            excludedLabes.clear();
+            for(DiscreteLabel l=0; l<model_.nLabels(vi); ++l)
+                if(persistency_.isExcluded(vi, l))
+                    excludedLabes.insert(l);
+        }
+
+        /// \brief the partial optimality of the last call of infer
+        const PersistencyType & persistency()const{
+            return persistency_;
+        }
+
+    private:
+        const Model & model_;
+        Options options_;
+        FactorsOfVariables factorsOfVariables_;
+        PersistencyType persistency_;
+        SubModel subModel_;
+        Conf conf_;
+        ValueType value_;
+        ValueType lowerBound_;
+        bool stopInference_;
+    };
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+#endif /* INFERNO_INFERENCE_PERSISTENCY_HXX */
@@ -0,0 +1,316 @@
+/** \file portfolio.hxx
+    \brief  Implementation of inferno::inference::Portfolio,
+    a meta solver which runs several solvers concurrently
+    and shares the best labeling between them.
+*/
+#ifndef INFERNO_INFERENCE_PORTFOLIO_HXX
+#define INFERNO_INFERENCE_PORTFOLIO_HXX
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#include "inferno/inferno.hxx"
+#include "inferno/inference/discrete_inference_base.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/utilities/profiler.hxx"
+
+namespace inferno{
+namespace inference{
+
+
+    /** \brief Anytime meta solver which runs a portfolio
+        of solvers concurrently on the same model.
+
+        Each solver created by Options::factories_ runs in its
+        own thread. Whenever a solver visits, the best labeling
+        (the incumbent) and the best lower bound of all solvers
+        are updated and the incumbent energy is passed to
+        the solver via DiscreteInferenceBase::setUpperBound.
+
+        Solvers do not support a change of their labeling while
+        they are running, therefore DiscreteInferenceBase::setConf
+        is only called between runs: with Options::restartFromIncumbent_
+        a solver which has finished is restarted from the incumbent
+        if another solver has found a better labeling in the meantime.
+
+        All solvers are stopped (at their next visit) when
+        the gap between the incumbent and the best lower bound is closed
+        (Options::absoluteGap_, Options::relativeGap_),
+        when the time limit (wall-clock seconds) has passed
+        or when Portfolio::stopInference is called.
+        The visitor of the portfolio is called from the
+        thread which called Portfolio::infer whenever
+        the incumbent has improved.
+    */
+    template<class MODEL>
+    class Portfolio  : public DiscreteInferenceBase<MODEL> {
+
+    public:
+        typedef MODEL Model;
+        typedef Portfolio<MODEL> Self;
+        typedef DiscreteInferenceBase<MODEL> BaseInf;
+        typedef typename BaseInf::Visitor Visitor;
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+        typedef BaseDiscreteInferenceFactory<Model> InferenceFactory;
+    private:
+        typedef std::chrono::steady_clock Clock;
+        typedef typename Visitor::VisitCallBack VisitCallBack;
+    public:
+
+        struct Options{
+            Options(
+                const std::vector<std::shared_ptr<InferenceFactory> > & factories = std::vector<std::shared_ptr<InferenceFactory> >(),
+                const double timeLimit = std::numeric_limits<double>::infinity(),
+                const ValueType absoluteGap = 0.0,
+                const ValueType relativeGap = 0.0,
+                const bool restartFromIncumbent = true
+            )
+            :   factories_(factories),
+                timeLimit_(timeLimit),
+                absoluteGap_(absoluteGap),
+                relativeGap_(relativeGap),
+                restartFromIncumbent_(restartFromIncumbent)
+            {
+            }
+            std::vector<std::shared_ptr<InferenceFactory> > factories_;
+            double timeLimit_;
+            ValueType absoluteGap_;
+            ValueType relativeGap_;
+            bool restartFromIncumbent_;
+        };
+
+        Portfolio(const Model & model, const Options & options = Options())
+        :   BaseInf(),
+            model_(model),
+            options_(options),
+            mutex_(),
+            changed_(),
+            conf_(model, 0),
+            value_(model.eval(conf_)),
+            bound_(-1.0*std::numeric_limits<ValueType>::infinity()),
+            version_(0),
+            best_(-1),
+            stopInference_(false){
+            INFERNO_CHECK(!options_.factories_.empty(), "Portfolio needs at least one solver factory");
+            for(const auto & factory : options_.factories_)
+                INFERNO_CHECK(bool(factory), "Portfolio: factory must not be empty");
+        }
+
+        // MUST HAVE INTERACE
+        virtual std::string name() const {
+            return "Portfolio";
+        }
+        // inference
+        virtual void infer( Visitor  * visitor  = NULL) {
+            INFERNO_PROFILE_SCOPE("Portfolio::infer");
+            stopInference_ = false;
+            best_ = -1;
+            if(visitor!=NULL)
+                visitor->begin(this);
+
+            const auto start = Clock::now();
+            const bool hasDeadline = std::isfinite(options_.timeLimit_);
+            const auto deadline = start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(hasDeadline ? options_.timeLimit_ : 0.0));
+            deadline_ = hasDeadline ? deadline : Clock::time_point::max();
+
+            const size_t nSolvers = options_.factories_.size();
+            std::atomic<size_t> running(nSolvers);
+            std::vector<std::thread> threads;
+            threads.reserve(nSolvers);
+            for(size_t s=0; s<nSolvers; ++s){
+                threads.emplace_back([this, s, &running](){
+                    this->runSolver(s);
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        --running;
+                    }
+                    changed_.notify_all();
+                });
+            }
+
+            // report improvements and enforce the deadline
+            // from the calling thread
+            uint64_t reported = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                for(;;){
+                    if(running == 0)
+                        break;
+                    // once stopped there is no deadline left to wait for,
+                    // wait until the solvers reach their next visit
+                    if(hasDeadline && !stopInference_)
+                        changed_.wait_until(lock, deadline);
+                    else
+                        changed_.wait(lock);
+                    if(hasDeadline && Clock::now() >= deadline)
+                        stopInference_ = true;
+                    if(visitor!=NULL && version_ != reported){
+                        reported = version_;
+                        lock.unlock();
+                        visitor->visit(this);
+                        lock.lock();
+                    }
+                }
+            }
+            for(auto & t : threads)
+                t.join();
+
+            if(visitor!=NULL){
+                if(version_ != reported)
+                    visitor->visit(this);
+                visitor->end(this);
+            }
+        }
+        // get result
+        virtual void conf(Conf & confMap ) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(const auto varDesc : model_.variableDescriptors())
+                confMap[varDesc] = conf_[varDesc];
+        }
+        virtual DiscreteLabel label(const Vi vi ) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return conf_[vi];
+        }
+        // get model
+        virtual const Model & model() const{
+            return model_;
+        }
+        // stop inference (via visitor)
+        virtual void stopInference(){
+            stopInference_ = true;
+            changed_.notify_all();
+        }
+
+        // OPTIONAL INTERFACE
+        // warm start related
+        virtual void setConf(const Conf & conf){
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(const auto varDesc : model_.variableDescriptors())
+                conf_[varDesc] = conf[varDesc];
+            value_ = model_.eval(conf_);
+            ++version_;
+        }
+        // get results optional interface
+        virtual ValueType lowerBound(){
+            std::lock_guard<std::mutex> lock(mutex_);
+            return bound_;
+        }
+        virtual ValueType upperBound(){
+            std::lock_guard<std::mutex> lock(mutex_);
+            return value_;
+        }
+        virtual ValueType energy(){
+            std::lock_guard<std::mutex> lock(mutex_);
+            return value_;
+        }
+
+        /// \brief index of the solver which found the incumbent (-1 if none did)
+        int64_t bestSolver(){
+            std::lock_guard<std::mutex> lock(mutex_);
+            return best_;
+        }
+
+    private:
+
+        // per solver state for the visitor callbacks
+        struct SolverRun{
+            Self * self_;
+            size_t index_;
+            uint64_t version_;
+            void visit(BaseInf * inf){
+                self_->update(*this, inf);
+            }
+        };
+
+        void runSolver(const size_t s){
+            auto solver = options_.factories_[s]->create(model_);
+
+            SolverRun run{this, s, 0};
+            Visitor visitor;
+            visitor.visitCallBack = VisitCallBack:: template from_method<SolverRun, &SolverRun::visit>(&run);
+
+            Conf conf(model_);
+            for(;;){
+                ValueType incumbent;
+                {
+                    // start from the incumbent
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if(stopInference_ || this->gapClosed())
+                        break;
+                    run.version_ = version_;
+                    for(const auto varDesc : model_.variableDescriptors())
+                        conf[varDesc] = conf_[varDesc];
+                    incumbent = value_;
+                }
+                solver->setConf(conf);
+                solver->setUpperBound(incumbent);
+                solver->infer(&visitor);
+                this->update(run, solver.get());
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                // restart only if another solver improved the incumbent
+                if(!options_.restartFromIncumbent_ || version_ == run.version_)
+                    break;
+            }
+        }
+
+        // update the incumbent and the bound with the state of a solver
+        void update(SolverRun & run, BaseInf * inf){
+            const ValueType e = inf->energy();
+            const ValueType lb = inf->lowerBound();
+            bool stop = false;
+            ValueType incumbent;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(e < value_){
+                    inf->conf(conf_);
+                    value_ = e;
+                    best_ = int64_t(run.index_);
+                    ++version_;
+                    run.version_ = version_;
+                }
+                bound_ = std::max(bound_, lb);
+                if(this->gapClosed() || Clock::now() >= deadline_)
+                    stopInference_ = true;
+                stop = stopInference_;
+                incumbent = value_;
+            }
+            changed_.notify_all();
+            inf->setUpperBound(incumbent);
+            if(stop)
+                inf->stopInference();
+        }
+
+        bool gapClosed()const{
+            const ValueType gap = value_ - bound_;
+            return gap <= options_.absoluteGap_ ||
+                   gap <= options_.relativeGap_ * std::abs(value_);
+        }
+
+        const Model & model_;
+        Options options_;
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        Conf conf_;
+        ValueType value_;
+        ValueType bound_;
+        uint64_t version_;
+        int64_t best_;
+        std::atomic<bool> stopInference_;
+        Clock::time_point deadline_;
+    };
+
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+#endif /* INFERNO_INFERENCE_PORTFOLIO_HXX */
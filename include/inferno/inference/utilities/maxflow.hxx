@@ -0,0 +1,632 @@
+/** \file maxflow.hxx
+    \brief  Implementation of inferno::inference::MaxFlow,
+    a Boykov-Kolmogorov style augmenting path max-flow / min-cut
+    solver which is bundled with inferno and therefore
+    does not need any externals.
+
+    The graph can be reused:
+        - MaxFlow::resetFlow restores the capacities
+          without any reallocation
+        - MaxFlow::setTWeights and MaxFlow::setEdgeCapacities
+          change capacities of an already solved graph
+          while keeping the current flow feasible
+          (reparametrization as in Kohli & Torr "dynamic graph cuts").
+          A subsequent MaxFlow::maxflow(true) reuses the
+          search trees of the previous run.
+*/
+#ifndef INFERNO_INFERENCE_UTILITIES_MAXFLOW_HXX
+#define INFERNO_INFERENCE_UTILITIES_MAXFLOW_HXX
+
+#include <vector>
+#include <deque>
+#include <limits>
+#include <algorithm>
+
+#include "inferno/inferno.hxx"
+
+namespace inferno{
+namespace inference{
+
+    /** \brief Boykov-Kolmogorov max-flow
+
+        Nodes which end up in the source segment
+        (label 0) pay the sink capacity, nodes
+        in the sink segment (label 1) pay the source capacity.
+        An edge capacity of \f$ i \rightarrow j \f$
+        is paid if \f$ i \f$ is in the source
+        and \f$ j \f$ is in the sink segment.
+    */
+    template<class CAP = ValueType>
+    class MaxFlow{
+    public:
+        typedef CAP CapType;
+        typedef int64_t NodeIndex;
+        typedef int64_t ArcIndex;
+
+        enum Segment{
+            Source = 0,
+            Sink = 1
+        };
+
+        MaxFlow(const uint64_t nNodesHint = 0, const uint64_t nEdgesHint = 0)
+        :   nodes_(),
+            arcs_(),
+            markedNodes_(),
+            activeQueue_(),
+            orphans_(),
+            flow_(0),
+            time_(0),
+            currentNode_(NoNode),
+            solvedOnce_(false){
+            nodes_.reserve(nNodesHint);
+            arcs_.reserve(2*nEdgesHint);
+        }
+
+        /// \brief remove all nodes and edges but keep the allocated memory
+        void clear(){
+            nodes_.clear();
+            arcs_.clear();
+            markedNodes_.clear();
+            activeQueue_.clear();
+            orphans_.clear();
+            flow_ = 0;
+            time_ = 0;
+            currentNode_ = NoNode;
+            solvedOnce_ = false;
+        }
+
+        void reserve(const uint64_t nNodes, const uint64_t nEdges){
+            nodes_.reserve(nNodes);
+            arcs_.reserve(2*nEdges);
+        }
+
+        /// \brief add n nodes and return the index of the first new node
+        NodeIndex addNodes(const uint64_t n = 1){
+            const NodeIndex first = nodes_.size();
+            nodes_.resize(nodes_.size() + n);
+            return first;
+        }
+
+        /** \brief add an edge pair \f$ i \rightarrow j \f$ and  \f$ j \rightarrow i \f$
+            \returns the index of the edge which is needed for  MaxFlow::setEdgeCapacities
+        */
+        ArcIndex addEdge(
+            const NodeIndex i,
+            const NodeIndex j,
+            const CapType cap,
+            const CapType revCap
+        ){
+            INFERNO_ASSERT_OP(i,!=,j);
+            INFERNO_ASSERT_OP(i,<,NodeIndex(nodes_.size()));
+            INFERNO_ASSERT_OP(j,<,NodeIndex(nodes_.size()));
+            INFERNO_ASSERT(cap >= 0 && revCap >= 0);
+            const ArcIndex a = arcs_.size();
+            arcs_.resize(a + 2);
+            Arc & arc = arcs_[a];
+            Arc & sister = arcs_[a+1];
+            arc.head_ = j;
+            arc.next_ = nodes_[i].first_;
+            arc.cap_ = cap;
+            arc.rCap_ = cap;
+            nodes_[i].first_ = a;
+            sister.head_ = i;
+            sister.next_ = nodes_[j].first_;
+            sister.cap_ = revCap;
+            sister.rCap_ = revCap;
+            nodes_[j].first_ = a + 1;
+            return a/2;
+        }
+
+        /** \brief add source and sink capacities to a node
+            (can be called multiple times, capacities can be negative)
+        */
+        void addTWeights(const NodeIndex i, const CapType capSource, const CapType capSink){
+            Node & node = nodes_[i];
+            const CapType d = capSource - capSink;
+            flow_ += capSink - negPart(node.trCap_ + d) + negPart(node.trCap_);
+            node.termCap_ += d;
+            node.trCap_ += d;
+        }
+
+        /** \brief set the source and sink capacities of a node.
+
+            Can be called after MaxFlow::maxflow, the current
+            flow stays feasible.
+            Only the difference capSource - capSink is relevant,
+            common terms are constants of the cut.
+        */
+        void setTWeights(const NodeIndex i, const CapType capSource, const CapType capSink){
+            Node & node = nodes_[i];
+            const CapType d = (capSource - capSink) - node.termCap_;
+            if(d != 0){
+                node.termCap_ += d;
+                shiftTrCap(i, d);
+            }
+        }
+
+        /** \brief set the capacities of an edge pair created
+            with MaxFlow::addEdge.
+
+            Can be called after MaxFlow::maxflow, the current
+            flow stays feasible.
+        */
+        void setEdgeCapacities(const ArcIndex edge, const CapType cap, const CapType revCap){
+            INFERNO_ASSERT(cap >= 0 && revCap >= 0);
+            Arc & arc = arcs_[2*edge];
+            Arc & sister = arcs_[2*edge+1];
+            if(arc.cap_ == cap && sister.cap_ == revCap)
+                return;
+
+            // flow from tail to head
+            const CapType f = arc.cap_ - arc.rCap_;
+            arc.cap_ = cap;
+            sister.cap_ = revCap;
+            arc.rCap_ = cap - f;
+            sister.rCap_ = revCap + f;
+
+            const NodeIndex i = sister.head_;
+            const NodeIndex j = arc.head_;
+
+            // flow not feasible anymore:
+            // move the excess / deficit to the terminals
+            if(arc.rCap_ < 0){
+                const CapType excess = -arc.rCap_;
+                arc.rCap_ = 0;
+                sister.rCap_ = cap + revCap;
+                shiftTrCap(i, excess);
+                shiftTrCap(j, -excess);
+            }
+            else if(sister.rCap_ < 0){
+                const CapType excess = -sister.rCap_;
+                sister.rCap_ = 0;
+                arc.rCap_ = cap + revCap;
+                shiftTrCap(i, -excess);
+                shiftTrCap(j, excess);
+            }
+            markNode(i);
+            markNode(j);
+        }
+
+        /// \brief restore all residual capacities (and drop the search trees)
+        void resetFlow(){
+            for(auto & arc : arcs_)
+                arc.rCap_ = arc.cap_;
+            flow_ = 0;
+            for(auto & node : nodes_){
+                node.trCap_ = node.termCap_;
+                node.isMarked_ = false;
+            }
+            markedNodes_.clear();
+            solvedOnce_ = false;
+        }
+
+        /** \brief compute the max-flow / min-cut
+
+            \param reuseTrees reuse the search trees of the
+            last call. Only nodes whose capacities
+            have been changed since the last call are revisited.
+
+            \returns the flow (which equals the
+            min-cut value up to a constant if capacities
+            have been changed since MaxFlow::resetFlow)
+        */
+        CapType maxflow(const bool reuseTrees = false){
+            if(reuseTrees && solvedOnce_)
+                initReuseTrees();
+            else
+                init();
+            solvedOnce_ = true;
+
+            for(;;){
+                NodeIndex i = currentNode_;
+                if(i != NoNode){
+                    nodes_[i].isActive_ = false;
+                    if(nodes_[i].parent_ == NoParent)
+                        i = NoNode;
+                }
+                if(i == NoNode){
+                    i = nextActive();
+                    if(i == NoNode)
+                        break;
+                }
+
+                ArcIndex middle = grow(i);
+                ++time_;
+
+                if(middle != NoArc){
+                    // i stays the current node
+                    nodes_[i].isActive_ = true;
+                    currentNode_ = i;
+                    augment(middle);
+                    adopt();
+                }
+                else{
+                    currentNode_ = NoNode;
+                }
+            }
+            return flow_;
+        }
+
+        /** \brief segment of a node after MaxFlow::maxflow
+
+            The source segment is the source search tree
+            (all nodes reachable from the source in the
+            residual graph), everything else is in the sink segment.
+        */
+        Segment segment(const NodeIndex i)const{
+            const Node & node = nodes_[i];
+            if(node.parent_ != NoParent && !node.isSink_)
+                return Source;
+            return Sink;
+        }
+
+        uint64_t nNodes()const{
+            return nodes_.size();
+        }
+        uint64_t nEdges()const{
+            return arcs_.size()/2;
+        }
+        CapType flow()const{
+            return flow_;
+        }
+
+    private:
+
+        static const NodeIndex NoNode = -1;
+        static const ArcIndex  NoArc = -1;
+        static const ArcIndex  NoParent = -1;
+        static const ArcIndex  Terminal = -2;
+        static const ArcIndex  Orphan = -3;
+
+        struct Node{
+            Node()
+            :   first_(NoArc),
+                parent_(NoParent),
+                ts_(0),
+                dist_(0),
+                trCap_(0),
+                termCap_(0),
+                isSink_(false),
+                isActive_(false),
+                isMarked_(false){
+            }
+            ArcIndex  first_;
+            ArcIndex  parent_;
+            uint64_t  ts_;
+            uint64_t  dist_;
+            CapType   trCap_;
+            CapType   termCap_;
+            bool      isSink_;
+            bool      isActive_;
+            bool      isMarked_;
+        };
+
+        struct Arc{
+            NodeIndex head_;
+            ArcIndex  next_;
+            CapType   cap_;
+            CapType   rCap_;
+        };
+
+        static CapType negPart(const CapType v){
+            return v < 0 ? -v : CapType(0);
+        }
+        static ArcIndex sister(const ArcIndex a){
+            return a ^ ArcIndex(1);
+        }
+
+        // change the residual terminal capacity
+        // while keeping the flow conservation
+        void shiftTrCap(const NodeIndex i, const CapType d){
+            Node & node = nodes_[i];
+            flow_ += negPart(node.trCap_) - negPart(node.trCap_ + d);
+            node.trCap_ += d;
+            markNode(i);
+        }
+
+        void markNode(const NodeIndex i){
+            Node & node = nodes_[i];
+            if(!node.isMarked_){
+                node.isMarked_ = true;
+                markedNodes_.push_back(i);
+            }
+        }
+
+        void setActive(const NodeIndex i){
+            Node & node = nodes_[i];
+            if(!node.isActive_){
+                node.isActive_ = true;
+                activeQueue_.push_back(i);
+            }
+        }
+
+        NodeIndex nextActive(){
+            while(!activeQueue_.empty()){
+                const NodeIndex i = activeQueue_.front();
+                activeQueue_.pop_front();
+                nodes_[i].isActive_ = false;
+                if(nodes_[i].parent_ != NoParent)
+                    return i;
+            }
+            return NoNode;
+        }
+
+        void setOrphanFront(const NodeIndex i){
+            nodes_[i].parent_ = Orphan;
+            orphans_.push_front(i);
+        }
+        void setOrphanRear(const NodeIndex i){
+            nodes_[i].parent_ = Orphan;
+            orphans_.push_back(i);
+        }
+
+        void init(){
+            activeQueue_.clear();
+            orphans_.clear();
+            markedNodes_.clear();
+            time_ = 0;
+            currentNode_ = NoNode;
+            for(NodeIndex i=0; i<NodeIndex(nodes_.size()); ++i){
+                Node & node = nodes_[i];
+                node.isActive_ = false;
+                node.isMarked_ = false;
+                node.ts_ = time_;
+                if(node.trCap_ != 0){
+                    node.isSink_ = node.trCap_ < 0;
+                    node.parent_ = Terminal;
+                    node.dist_ = 1;
+                    setActive(i);
+                }
+                else{
+                    node.parent_ = NoParent;
+                }
+            }
+        }
+
+        void initReuseTrees(){
+            activeQueue_.clear();
+            orphans_.clear();
+            currentNode_ = NoNode;
+            ++time_;
+            for(const auto i : markedNodes_){
+                Node & node = nodes_[i];
+                node.isMarked_ = false;
+                node.isActive_ = false;
+                setActive(i);
+                if(node.trCap_ == 0){
+                    if(node.parent_ != NoParent && node.parent_ != Orphan)
+                        setOrphanRear(i);
+                    continue;
+                }
+                const bool toSink = node.trCap_ < 0;
+                if(node.parent_ == NoParent || node.parent_ == Orphan || node.isSink_ != toSink){
+                    node.isSink_ = toSink;
+                    for(ArcIndex a=node.first_; a!=NoArc; a=arcs_[a].next_){
+                        const NodeIndex j = arcs_[a].head_;
+                        Node & nodeJ = nodes_[j];
+                        if(nodeJ.isMarked_)
+                            continue;
+                        if(nodeJ.parent_ == sister(a))
+                            setOrphanRear(j);
+                        if(nodeJ.parent_ != NoParent && nodeJ.parent_ != Orphan && nodeJ.isSink_ != toSink){
+                            const CapType r = toSink ? arcs_[sister(a)].rCap_ : arcs_[a].rCap_;
+                            if(r > 0)
+                                setActive(j);
+                        }
+                    }
+                }
+                node.parent_ = Terminal;
+                node.ts_ = time_;
+                node.dist_ = 1;
+            }
+            markedNodes_.clear();
+            adopt();
+        }
+
+        // grow the tree of node i, returns the arc
+        // connecting both trees (from source tree to sink tree)
+        ArcIndex grow(const NodeIndex i){
+            Node & node = nodes_[i];
+            if(!node.isSink_){
+                for(ArcIndex a=node.first_; a!=NoArc; a=arcs_[a].next_){
+                    if(arcs_[a].rCap_ > 0){
+                        const NodeIndex j = arcs_[a].head_;
+                        Node & nodeJ = nodes_[j];
+                        if(nodeJ.parent_ == NoParent){
+                            nodeJ.isSink_ = false;
+                            nodeJ.parent_ = sister(a);
+                            nodeJ.ts_ = node.ts_;
+                            nodeJ.dist_ = node.dist_ + 1;
+                            setActive(j);
+                        }
+                        else if(nodeJ.isSink_){
+                            return a;
+                        }
+                        else if(nodeJ.ts_ <= node.ts_ && nodeJ.dist_ > node.dist_){
+                            nodeJ.parent_ = sister(a);
+                            nodeJ.ts_ = node.ts_;
+                            nodeJ.dist_ = node.dist_ + 1;
+                        }
+                    }
+                }
+            }
+            else{
+                for(ArcIndex a=node.first_; a!=NoArc; a=arcs_[a].next_){
+                    if(arcs_[sister(a)].rCap_ > 0){
+                        const NodeIndex j = arcs_[a].head_;
+                        Node & nodeJ = nodes_[j];
+                        if(nodeJ.parent_ == NoParent){
+                            nodeJ.isSink_ = true;
+                            nodeJ.parent_ = sister(a);
+                            nodeJ.ts_ = node.ts_;
+                            nodeJ.dist_ = node.dist_ + 1;
+                            setActive(j);
+                        }
+                        else if(!nodeJ.isSink_){
+                            return sister(a);
+                        }
+                        else if(nodeJ.ts_ <= node.ts_ && nodeJ.dist_ > node.dist_){
+                            nodeJ.parent_ = sister(a);
+                            nodeJ.ts_ = node.ts_;
+                            nodeJ.dist_ = node.dist_ + 1;
+                        }
+                    }
+                }
+            }
+            return NoArc;
+        }
+
+        void augment(const ArcIndex middle){
+            // find bottleneck
+            CapType bottleneck = arcs_[middle].rCap_;
+            NodeIndex i = arcs_[sister(middle)].head_;
+            for(ArcIndex a=nodes_[i].parent_; a!=Terminal; a=nodes_[i].parent_){
+                bottleneck = std::min(bottleneck, arcs_[sister(a)].rCap_);
+                i = arcs_[a].head_;
+            }
+            bottleneck = std::min(bottleneck, nodes_[i].trCap_);
+            i = arcs_[middle].head_;
+            for(ArcIndex a=nodes_[i].parent_; a!=Terminal; a=nodes_[i].parent_){
+                bottleneck = std::min(bottleneck, arcs_[a].rCap_);
+                i = arcs_[a].head_;
+            }
+            bottleneck = std::min(bottleneck, -nodes_[i].trCap_);
+
+            // augment
+            arcs_[sister(middle)].rCap_ += bottleneck;
+            arcs_[middle].rCap_ -= bottleneck;
+
+            i = arcs_[sister(middle)].head_;
+            for(ArcIndex a=nodes_[i].parent_; a!=Terminal; a=nodes_[i].parent_){
+                arcs_[a].rCap_ += bottleneck;
+                arcs_[sister(a)].rCap_ -= bottleneck;
+                const NodeIndex next = arcs_[a].head_;
+                if(arcs_[sister(a)].rCap_ <= 0){
+                    arcs_[sister(a)].rCap_ = 0;
+                    setOrphanFront(i);
+                }
+                i = next;
+            }
+            nodes_[i].trCap_ -= bottleneck;
+            if(nodes_[i].trCap_ <= 0){
+                nodes_[i].trCap_ = 0;
+                setOrphanFront(i);
+            }
+
+            i = arcs_[middle].head_;
+            for(ArcIndex a=nodes_[i].parent_; a!=Terminal; a=nodes_[i].parent_){
+                arcs_[sister(a)].rCap_ += bottleneck;
+                arcs_[a].rCap_ -= bottleneck;
+                const NodeIndex next = arcs_[a].head_;
+                if(arcs_[a].rCap_ <= 0){
+                    arcs_[a].rCap_ = 0;
+                    setOrphanFront(i);
+                }
+                i = next;
+            }
+            nodes_[i].trCap_ += bottleneck;
+            if(nodes_[i].trCap_ >= 0){
+                nodes_[i].trCap_ = 0;
+                setOrphanFront(i);
+            }
+            flow_ += bottleneck;
+        }
+
+        void adopt(){
+            while(!orphans_.empty()){
+                const NodeIndex i = orphans_.front();
+                orphans_.pop_front();
+                if(nodes_[i].parent_ == Orphan)
+                    processOrphan(i, nodes_[i].isSink_);
+            }
+        }
+
+        void processOrphan(const NodeIndex i, const bool isSink){
+            const uint64_t infDist = std::numeric_limits<uint64_t>::max();
+            Node & node = nodes_[i];
+            ArcIndex bestArc = NoArc;
+            uint64_t bestDist = infDist;
+
+            // try to find a new valid parent
+            for(ArcIndex a0=node.first_; a0!=NoArc; a0=arcs_[a0].next_){
+                const CapType r = isSink ? arcs_[a0].rCap_ : arcs_[sister(a0)].rCap_;
+                if(r <= 0)
+                    continue;
+                NodeIndex j = arcs_[a0].head_;
+                if(nodes_[j].isSink_ != isSink || nodes_[j].parent_ == NoParent)
+                    continue;
+
+                // check the origin of j
+                uint64_t d = 0;
+                for(;;){
+                    Node & nodeJ = nodes_[j];
+                    if(nodeJ.ts_ == time_){
+                        d += nodeJ.dist_;
+                        break;
+                    }
+                    const ArcIndex a = nodeJ.parent_;
+                    ++d;
+                    if(a == Terminal){
+                        nodeJ.ts_ = time_;
+                        nodeJ.dist_ = 1;
+                        break;
+                    }
+                    if(a == Orphan){
+                        d = infDist;
+                        break;
+                    }
+                    j = arcs_[a].head_;
+                }
+                if(d < infDist){
+                    if(d < bestDist){
+                        bestArc = a0;
+                        bestDist = d;
+                    }
+                    // set marks along the path
+                    for(j=arcs_[a0].head_; nodes_[j].ts_!=time_; j=arcs_[nodes_[j].parent_].head_){
+                        nodes_[j].ts_ = time_;
+                        nodes_[j].dist_ = d--;
+                    }
+                }
+            }
+
+            node.parent_ = bestArc == NoArc ? NoParent : bestArc;
+            if(bestArc != NoArc){
+                node.ts_ = time_;
+                node.dist_ = bestDist + 1;
+            }
+            else{
+                // i becomes free, process neighbours.
+                // Neighbours of both trees which could grow into i
+                // are activated, this keeps both trees maximal
+                // (which is needed for MaxFlow::segment).
+                for(ArcIndex a0=node.first_; a0!=NoArc; a0=arcs_[a0].next_){
+                    const NodeIndex j = arcs_[a0].head_;
+                    Node & nodeJ = nodes_[j];
+                    const ArcIndex a = nodeJ.parent_;
+                    if(a != NoParent){
+                        const CapType r = nodeJ.isSink_ ? arcs_[a0].rCap_ : arcs_[sister(a0)].rCap_;
+                        if(r > 0)
+                            setActive(j);
+                        if(nodeJ.isSink_ == isSink && a != Terminal && a != Orphan && arcs_[a].head_ == i)
+                            setOrphanRear(j);
+                    }
+                }
+            }
+        }
+
+        std::vector<Node>     nodes_;
+        std::vector<Arc>      arcs_;
+        std::vector<NodeIndex> markedNodes_;
+        std::deque<NodeIndex> activeQueue_;
+        std::deque<NodeIndex> orphans_;
+        CapType   flow_;
+        uint64_t  time_;
+        NodeIndex currentNode_;
+        bool      solvedOnce_;
+    };
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+#endif /* INFERNO_INFERENCE_UTILITIES_MAXFLOW_HXX */
@@ -179,7 +179,7 @@ Movemaker<MODEL>::valueAfterMove
 
     for (const auto fi: facToRecomp_) {
 
-        const auto factor = model_[fi];
+        const auto factor = model_.factor(fi);
         factor->getFactorConf(state_, currentFState_.begin());
         factor->getFactorConf(stateBuffer_, destFState_.begin());
         destinationValue -= factor->eval(currentFState_.data());
@@ -307,7 +307,7 @@ Movemaker<MODEL>::evaluateFactors
     ValueType value = ValueType(0.0);
     for(; begin != end; ++begin) {
         const auto fi = *begin;
-        const auto factor = model_[fi];
+        const auto factor = model_.factor(fi);
         const auto arity = factor->arity();
         factor->getFactorConf(state, currentFState_.begin());
         value += factor->eval(currentFState_.data());
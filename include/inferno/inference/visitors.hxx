@@ -9,8 +9,12 @@
 
 #include <iostream>
 #include <iomanip>
+#include <vector>
+#include <limits>
+#include <cmath>
 
 #include "inferno/inferno.hxx"
+#include "inferno/utilities/timer.hxx"
 #include "inferno/inference/discrete_inference_base.hxx"
 
 namespace inferno{
@@ -98,6 +102,195 @@ namespace inference{
     };
 
 
+    /// \brief criterion which stopped a solver (see StoppingVisitor)
+    enum StopReason{
+        NotStopped,
+        TimeLimit,
+        IterationLimit,
+        NoImprovement,
+        GapClosed
+    };
+
+    /** \brief Visitor which stops a solver when a budget is exhausted
+        and records a (time, energy, lower bound) trace.
+
+        The solver is stopped (via DiscreteInferenceBase::stopInference)
+        as soon as one of the following criteria is met:
+            - the wall-clock time since begin exceeds Options::timeLimit_
+            - the solver visited Options::maxIterations_ times (0 means no limit)
+            - within the last Options::improvementWindow_ visits the energy
+              has improved by no more than Options::minRelativeImprovement_
+              relative to the energy at the beginning of the window
+              (0 disables this criterion)
+            - the gap between the energy and the lower bound is at most
+              Options::absoluteGap_ or Options::relativeGap_ times the energy.
+
+        The criteria are checked on every visit, therefore
+        a solver overruns the time limit by (at most) the time
+        between two of its visits.
+        All callbacks are forwarded to an optional second visitor.
+    */
+    template<class MODEL>
+    class StoppingVisitor{
+    public:
+        typedef StoppingVisitor<MODEL> SelfType;
+        typedef DiscreteInferenceBase<MODEL> BaseInf;
+        typedef typename BaseInf::Visitor VisitorType;
+        typedef typename VisitorType::BeginCallBack BeginCallBack;
+        typedef typename VisitorType::VisitCallBack VisitCallBack;
+        typedef typename VisitorType::LoggingCallBack LoggingCallBack;
+        typedef typename VisitorType::EndCallBack EndCallBack;
+
+        typedef inference::StopReason StopReason;
+
+        struct Options{
+            Options(
+                const double timeLimit = std::numeric_limits<double>::infinity(),
+                const uint64_t maxIterations = 0,
+                const uint64_t improvementWindow = 0,
+                const ValueType minRelativeImprovement = 0.0,
+                const ValueType absoluteGap = 0.0,
+                const ValueType relativeGap = 0.0,
+                const bool recordTrace = true
+            )
+            :   timeLimit_(timeLimit),
+                maxIterations_(maxIterations),
+                improvementWindow_(improvementWindow),
+                minRelativeImprovement_(minRelativeImprovement),
+                absoluteGap_(absoluteGap),
+                relativeGap_(relativeGap),
+                recordTrace_(recordTrace)
+            {
+            }
+            double timeLimit_;
+            uint64_t maxIterations_;
+            uint64_t improvementWindow_;
+            ValueType minRelativeImprovement_;
+            ValueType absoluteGap_;
+            ValueType relativeGap_;
+            bool recordTrace_;
+        };
+
+        StoppingVisitor(
+            const Options & options = Options(),
+            VisitorType * next = NULL
+        )
+        :   visitor_(),
+            next_(next),
+            options_(options),
+            start_(0),
+            iteration_(0),
+            stopReason_(NotStopped),
+            window_(),
+            times_(),
+            energies_(),
+            bounds_(){
+            visitor_.beginCallBack = BeginCallBack:: template from_method<SelfType,&SelfType::begin>(this);
+            visitor_.visitCallBack = VisitCallBack:: template from_method<SelfType,&SelfType::visit>(this);
+            visitor_.endCallBack   = EndCallBack::   template from_method<SelfType,&SelfType::end>(this);
+            visitor_.loggingCallBack = LoggingCallBack:: template from_method<SelfType,&SelfType::logging>(this);
+        }
+
+        void begin(BaseInf * inf){
+            start_ = Timer::now();
+            iteration_ = 0;
+            stopReason_ = NotStopped;
+            window_.assign(options_.improvementWindow_, 0.0);
+            times_.clear();
+            energies_.clear();
+            bounds_.clear();
+            if(options_.recordTrace_){
+                times_.reserve(1024);
+                energies_.reserve(1024);
+                bounds_.reserve(1024);
+            }
+            this->record(0.0, inf->energy(), inf->lowerBound());
+            if(next_ != NULL)
+                next_->begin(inf);
+        }
+        void visit(BaseInf * inf){
+            const double t = Timer::now() - start_;
+            const ValueType e = inf->energy();
+            const ValueType lb = inf->lowerBound();
+            this->record(t, e, lb);
+
+            if(next_ != NULL)
+                next_->visit(inf);
+
+            const uint64_t w = options_.improvementWindow_;
+            StopReason reason = NotStopped;
+            if(t >= options_.timeLimit_)
+                reason = TimeLimit;
+            else if(options_.maxIterations_ != 0 && iteration_ + 1 >= options_.maxIterations_)
+                reason = IterationLimit;
+            else if(e - lb <= options_.absoluteGap_ || e - lb <= options_.relativeGap_ * std::abs(e))
+                reason = GapClosed;
+            else if(w != 0 && iteration_ >= w &&
+                    window_[iteration_ % w] - e <= options_.minRelativeImprovement_ * std::abs(window_[iteration_ % w]))
+                reason = NoImprovement;
+            if(w != 0)
+                window_[iteration_ % w] = e;
+            ++iteration_;
+
+            if(reason != NotStopped && stopReason_ == NotStopped){
+                stopReason_ = reason;
+                inf->stopInference();
+            }
+        }
+        void logging(BaseInf * inf, const std::string & name, const ValueType value){
+            if(next_ != NULL)
+                next_->logging(inf, name, value);
+        }
+        void end(BaseInf * inf){
+            this->record(Timer::now() - start_, inf->energy(), inf->lowerBound());
+            if(next_ != NULL)
+                next_->end(inf);
+        }
+
+        VisitorType & visitor(){
+            return visitor_;
+        }
+        /// \brief criterion which stopped the solver
+        StopReason stopReason()const{
+            return stopReason_;
+        }
+        /// \brief number of visits
+        uint64_t iterations()const{
+            return iteration_;
+        }
+        /// \brief seconds since begin of each record (begin, visits, end)
+        const std::vector<double> & times()const{
+            return times_;
+        }
+        const std::vector<ValueType> & energies()const{
+            return energies_;
+        }
+        const std::vector<ValueType> & lowerBounds()const{
+            return bounds_;
+        }
+
+    private:
+        void record(const double t, const ValueType e, const ValueType lb){
+            if(options_.recordTrace_){
+                times_.push_back(t);
+                energies_.push_back(e);
+                bounds_.push_back(lb);
+            }
+        }
+
+        VisitorType visitor_;
+        VisitorType * next_;
+        Options options_;
+        double start_;
+        uint64_t iteration_;
+        StopReason stopReason_;
+        std::vector<ValueType> window_;
+        std::vector<double> times_;
+        std::vector<ValueType> energies_;
+        std::vector<ValueType> bounds_;
+    };
+
+
 } // end namespace inference
 } // end namespace inferno
 
@@ -0,0 +1,518 @@
+/** \file bundle_method.hxx
+    \brief  Implementation of inferno::learning::learners::BundleMethod,
+    a bundle method (BMRM) / 1-slack cutting plane structured SVM learner,
+    and its dual solver inferno::learning::learners::CuttingPlaneDualSolver.
+*/
+#ifndef INFERNO_LEARNING_LEARNERS_BUNDLE_METHOD_HXX
+#define INFERNO_LEARNING_LEARNERS_BUNDLE_METHOD_HXX
+
+// std
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+// boost
+#include <boost/iterator/counting_iterator.hpp>
+
+// inferno
+#include "inferno/inferno.hxx"
+#include "inferno/learning/weights.hxx"
+#include "inferno/learning/learners/learners.hxx"
+#include "inferno/learning/learners/loss_augmented_argmin.hxx"
+#include "inferno/learning/learners/learning_visitor.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
+#include "inferno/utilities/timer.hxx"
+
+namespace inferno{
+namespace learning{
+namespace learners{
+
+
+    /** \brief Dual solver for the cutting plane problem of BundleMethod
+
+        Solves
+        \f[
+            \min_{l \leq w \leq u} \frac{1}{2} \|w\|^2 +
+            c \max_j \left( \langle a_j, w \rangle + b_j \right)
+        \f]
+        via its dual over the simplex:
+        \f[
+            \max_{\alpha \in \Delta} \min_{l \leq w \leq u}
+            \frac{1}{2} \|w\|^2 + c \sum_j \alpha_j \left( \langle a_j, w \rangle + b_j \right).
+        \f]
+        The inner minimum is \f$ w(\alpha) = \mathrm{clip}(-c \sum_j \alpha_j a_j, l, u) \f$.
+        The dual is solved by pairwise (SMO like) coordinate ascent,
+        mass is moved from the active plane with the smallest gradient to the plane with the
+        largest gradient until both differ by less than eps.
+        Without bounds the line search is solved in closed form,
+        otherwise by a safeguarded Newton method on the piecewise linear derivative.
+
+        The multipliers are kept between calls of CuttingPlaneDualSolver::solve,
+        therefore adding a plane and solving again is cheap.
+    */
+    class CuttingPlaneDualSolver{
+    public:
+        CuttingPlaneDualSolver(const size_t nWeights = 0)
+        :   lowerBounds_(nWeights, -1.0*std::numeric_limits<WeightType>::infinity()),
+            upperBounds_(nWeights,  std::numeric_limits<WeightType>::infinity()),
+            planes_(),
+            offsets_(),
+            alpha_(),
+            inactive_(),
+            aggregated_(nWeights, 0.0),
+            weights_(nWeights),
+            gradient_(){
+        }
+
+        void setBound(const size_t weightIndex, const WeightType lowerBound, const WeightType upperBound){
+            INFERNO_CHECK_OP(lowerBound, <=, upperBound, "");
+            lowerBounds_[weightIndex] = lowerBound;
+            upperBounds_[weightIndex] = upperBound;
+        }
+
+        /// \brief add the plane \f$ \langle a, w \rangle + b \f$
+        void addPlane(const WeightVector & a, const ValueType b){
+            INFERNO_CHECK_OP(size_t(a.size()), ==, aggregated_.size(), "");
+            planes_.push_back(a);
+            offsets_.push_back(b);
+            inactive_.push_back(0);
+            if(alpha_.empty()){
+                alpha_.push_back(1.0);
+                for(size_t wi=0; wi<aggregated_.size(); ++wi)
+                    aggregated_[wi] = a[wi];
+            }
+            else{
+                alpha_.push_back(0.0);
+            }
+        }
+
+        /** \brief solve the dual
+
+            \param c scaling of the planes
+            \param eps tolerance of the KKT conditions
+            \param maxIterations maximum number of pairwise updates
+
+            \returns the dual value, a lower bound
+            of the cutting plane problem
+        */
+        ValueType solve(const ValueType c, const ValueType eps = 1.0e-8, const uint64_t maxIterations = 100000){
+            INFERNO_CHECK(!planes_.empty(), "no planes to solve for");
+            const auto nPlanes = planes_.size();
+            gradient_.resize(nPlanes);
+            this->computeWeights(c, aggregated_, weights_);
+
+            for(uint64_t iter=0; iter<maxIterations; ++iter){
+
+                for(size_t p=0; p<nPlanes; ++p)
+                    gradient_[p] = c*(this->dot(planes_[p], weights_) + offsets_[p]);
+
+                // most violating pair
+                size_t up = 0;
+                size_t down = nPlanes;
+                for(size_t p=0; p<nPlanes; ++p){
+                    if(gradient_[p] > gradient_[up])
+                        up = p;
+                    if(alpha_[p] > 0.0 && (down == nPlanes || gradient_[p] < gradient_[down]))
+                        down = p;
+                }
+                if(gradient_[up] - gradient_[down] <= eps)
+                    break;
+
+                const auto t = this->lineSearch(c, up, down);
+                if(t <= 0.0)
+                    break;
+                const auto & planeUp = planes_[up];
+                const auto & planeDown = planes_[down];
+                for(size_t wi=0; wi<aggregated_.size(); ++wi)
+                    aggregated_[wi] += t*(planeUp[wi] - planeDown[wi]);
+                alpha_[up] += t;
+                alpha_[down] = t >= alpha_[down] ? 0.0 : alpha_[down] - t;
+                this->computeWeights(c, aggregated_, weights_);
+            }
+
+            for(size_t p=0; p<nPlanes; ++p)
+                inactive_[p] = alpha_[p] > 0.0 ? 0 : inactive_[p] + 1;
+            return this->dualValue(c);
+        }
+
+        /// \brief remove planes which have not been active in the last maxInactive calls of solve
+        void removeInactivePlanes(const uint64_t maxInactive){
+            size_t kept = 0;
+            for(size_t p=0; p<planes_.size(); ++p){
+                if(inactive_[p] <= maxInactive){
+                    if(kept != p){
+                        planes_[kept] = planes_[p];
+                        offsets_[kept] = offsets_[p];
+                        alpha_[kept] = alpha_[p];
+                        inactive_[kept] = inactive_[p];
+                    }
+                    ++kept;
+                }
+            }
+            planes_.resize(kept);
+            offsets_.resize(kept);
+            alpha_.resize(kept);
+            inactive_.resize(kept);
+        }
+
+        /// \brief minimizer of the cutting plane problem (after solve)
+        const WeightVector & weights()const{
+            return weights_;
+        }
+        size_t nPlanes()const{
+            return planes_.size();
+        }
+        const std::vector<ValueType> & alpha()const{
+            return alpha_;
+        }
+
+    private:
+        static ValueType dot(const WeightVector & a, const WeightVector & b){
+            ValueType s = 0;
+            const size_t nWeights = a.size();
+            for(size_t wi=0; wi<nWeights; ++wi)
+                s += a[wi]*b[wi];
+            return s;
+        }
+
+        void computeWeights(const ValueType c, const std::vector<ValueType> & aggregated, WeightVector & weights)const{
+            for(size_t wi=0; wi<aggregated.size(); ++wi)
+                weights[wi] = std::min(upperBounds_[wi], std::max(lowerBounds_[wi], -1.0*c*aggregated[wi]));
+        }
+
+        ValueType dualValue(const ValueType c)const{
+            ValueType v = 0;
+            for(size_t wi=0; wi<aggregated_.size(); ++wi)
+                v += 0.5*weights_[wi]*weights_[wi] + c*aggregated_[wi]*weights_[wi];
+            for(size_t p=0; p<offsets_.size(); ++p)
+                v += c*alpha_[p]*offsets_[p];
+            return v;
+        }
+
+        // derivative of the dual along e_up - e_down at step t
+        // and its slope (the derivative is piecewise linear and non increasing)
+        ValueType dualDerivative(const ValueType c, const size_t up, const size_t down,
+                                 const ValueType t, ValueType & slope)const{
+            const auto & planeUp = planes_[up];
+            const auto & planeDown = planes_[down];
+            ValueType derivative = c*(offsets_[up] - offsets_[down]);
+            slope = 0;
+            for(size_t wi=0; wi<aggregated_.size(); ++wi){
+                const auto d = planeUp[wi] - planeDown[wi];
+                if(d == 0.0)
+                    continue;
+                const auto unclipped = -1.0*c*(aggregated_[wi] + t*d);
+                if(unclipped <= lowerBounds_[wi])
+                    derivative += c*d*lowerBounds_[wi];
+                else if(unclipped >= upperBounds_[wi])
+                    derivative += c*d*upperBounds_[wi];
+                else{
+                    derivative += c*d*unclipped;
+                    slope -= c*c*d*d;
+                }
+            }
+            return derivative;
+        }
+
+        // optimal step in [0, alpha_[down]]
+        ValueType lineSearch(const ValueType c, const size_t up, const size_t down)const{
+            ValueType lower = 0;
+            ValueType upper = alpha_[down];
+            ValueType slope;
+            if(this->dualDerivative(c, up, down, upper, slope) >= 0.0)
+                return upper;
+            ValueType t = 0;
+            for(size_t i=0; i<100; ++i){
+                const auto derivative = this->dualDerivative(c, up, down, t, slope);
+                if(derivative > 0.0)
+                    lower = t;
+                else
+                    upper = t;
+                if(derivative == 0.0 || upper - lower <= std::numeric_limits<ValueType>::epsilon()*alpha_[down])
+                    break;
+                auto newT = slope < 0.0 ? t - derivative/slope : upper;
+                if(!(newT > lower && newT < upper))
+                    newT = 0.5*(lower + upper);
+                t = newT;
+            }
+            return t;
+        }
+
+        std::vector<WeightType> lowerBounds_;
+        std::vector<WeightType> upperBounds_;
+        std::vector<WeightVector> planes_;
+        std::vector<ValueType> offsets_;
+        std::vector<ValueType> alpha_;
+        std::vector<uint64_t> inactive_;
+        std::vector<ValueType> aggregated_;
+        WeightVector weights_;
+        std::vector<ValueType> gradient_;
+    };
+
+
+
+    /** \brief Bundle method (BMRM) / 1-slack cutting plane structured SVM learner
+
+        Minimizes
+        \f[
+            J(w) = \frac{1}{2} \|w\|^2 + \frac{c}{N} \sum_{n=1}^N
+            \max_y \left( \Delta(y_n, y) + E(y_n; w) - E(y; w) \right)
+        \f]
+        (the objective of SubGradient) with \f$ c \f$ from the regularizer of the dataset.
+        Each iteration calls the separation oracle, the loss augmented
+        inference of all training instances, once and adds
+        the resulting cutting plane of the empirical risk to the bundle.
+        The weights of the next iteration minimize the regularizer plus the
+        piecewise linear lower bound of the risk given by the bundle
+        (see CuttingPlaneDualSolver).
+        Learning stops when the gap between the best objective so far and the
+        lower bound is smaller than Options::eps_ times the objective.
+
+        - Options::nThreads_ != 1 : the loss augmented inference of all
+          training instances runs in parallel
+        - Options::warmStart_ : the loss augmented inference of each
+          training instance is started from its argmin
+          of the last iteration (off by default, with a local
+          search solver this can change the learned weights)
+        - Options::maxInactive_ : planes which have not been active in the
+          dual for more iterations are removed from the bundle
+
+        The bounds of the weight constraints are respected exactly,
+        general linear weight constraints are ignored (as in SubGradient).
+        The learned weights are the weights with the lowest objective.
+        If the loss augmented inference is approximate, the plane is a lower bound
+        of the risk only approximately and the gap can be negative.
+
+        Progress and timings of each iteration are reported
+        to a LearningVisitorBase (see LearningRecorder),
+        without a visitor a VerboseLearningVisitor is used.
+    */
+    template<class DATASET>
+    class BundleMethod{
+    public:
+        typedef DATASET                                                             Dataset;
+        typedef typename Dataset::Model                                             Model;
+        typedef typename Dataset::GroundTruth                                       GroundTruth;
+        typedef typename Dataset::LossFunction                                      LossFunction;
+        typedef typename Model:: template VariableMap<DiscreteLabel>                ConfMap;
+        typedef inference::BaseDiscreteInferenceFactory<Model>                      InferenceFactoryBase;
+        typedef typename LossFunction::LossAugmentedModel                           LossAugmentedModel;
+        typedef inference::BaseDiscreteInferenceFactory<LossAugmentedModel>         LossAugmentedInferenceFactoryBase;
+        typedef typename LossAugmentedModel:: template VariableMap<DiscreteLabel>   LossAugmentedConfMap;
+        struct Options{
+            Options(
+                const uint64_t maxIterations = 1000,
+                const double   eps = 1.0e-3,
+                const int      nThreads = 1,
+                const bool     warmStart = false,
+                const uint64_t maxInactive = 50,
+                const double   qpEps = 1.0e-8,
+                const uint64_t qpMaxIterations = 100000,
+                const int      showLossEvery = 0
+            )
+            :   maxIterations_(maxIterations),
+                eps_(eps),
+                nThreads_(nThreads),
+                warmStart_(warmStart),
+                maxInactive_(maxInactive),
+                qpEps_(qpEps),
+                qpMaxIterations_(qpMaxIterations),
+                showLossEvery_(showLossEvery)
+            {
+            }
+            uint64_t maxIterations_;
+            double   eps_;
+            int      nThreads_;
+            bool     warmStart_;
+            uint64_t maxInactive_;
+            double   qpEps_;
+            uint64_t qpMaxIterations_;
+            uint64_t showLossEvery_;
+        };
+
+        BundleMethod(Dataset & dset, const Options & options = Options())
+        :   dataset_(dset),
+            options_(options),
+            lossAugmentedArgmin_(dset){
+        }
+
+        Dataset & dataset(){
+            return dataset_;
+        }
+
+        void learn(
+            LossAugmentedInferenceFactoryBase * lossAugmentedInferenceFactory,
+            WeightVector & weightVector,
+            InferenceFactoryBase * inferenceFactory = nullptr,
+            LearningVisitorBase * visitor = nullptr
+        ){
+            VerboseLearningVisitor verboseVisitor;
+            if(visitor == nullptr)
+                visitor = &verboseVisitor;
+
+            auto & dset = dataset();
+            const uint64_t nInstances = dset.size();
+            const uint64_t nWeights = weightVector.size();
+            const auto c = dset.regularizer().c();
+            const uint64_t nThreads = options_.nThreads_ <= 0 ?
+                std::thread::hardware_concurrency() : options_.nThreads_;
+
+            lossAugmentedArgmin_.reset(lossAugmentedInferenceFactory, options_.warmStart_);
+
+            std::unique_ptr<utilities::ThreadPool> pool;
+            if(nThreads > 1)
+                pool.reset(new utilities::ThreadPool(nThreads));
+
+            // the bundle
+            CuttingPlaneDualSolver dualSolver(nWeights);
+            for(const auto kv : dset.weightConstraints().weightBounds())
+                dualSolver.setBound(kv.first, kv.second.first, kv.second.second);
+
+            // per thread accumulators
+            std::vector<WeightVector> threadFeatureDiff(nThreads, WeightVector(nWeights));
+            std::vector<WeightVector> threadInstanceDiff(nThreads, WeightVector(nWeights));
+            std::vector<ValueType> hinges(nInstances, 0.0);
+            std::vector<double> instanceTimes(nInstances, 0.0);
+
+            WeightVector plane(nWeights);
+            WeightVector bestWeights = weightVector;
+            ValueType bestObjective = std::numeric_limits<ValueType>::infinity();
+
+            dset.updateWeights(weightVector);
+            visitor->begin(weightVector);
+
+            for(size_t iter=0; iter<options_.maxIterations_; ++iter){
+
+                LearningIterationRecord record(iter);
+                Timer iterationWatch, watch;
+                iterationWatch.tic();
+                watch.tic();
+
+                // separation oracle
+                for(auto & featureDiff : threadFeatureDiff)
+                    std::fill(featureDiff.begin(), featureDiff.end(), 0.0);
+                auto oracle = [&](const int tid, const size_t i){
+                    Timer instanceWatch;
+                    instanceWatch.tic();
+                    auto & instanceDiff = threadInstanceDiff[tid];
+                    std::fill(instanceDiff.begin(), instanceDiff.end(), 0.0);
+                    hinges[i] = lossAugmentedArgmin_.argmin(i, weightVector, instanceDiff);
+                    // the ground truth itself is the most violating labeling
+                    if(hinges[i] > 0.0)
+                        threadFeatureDiff[tid] += instanceDiff;
+                    else
+                        hinges[i] = 0.0;
+                    instanceWatch.toc();
+                    instanceTimes[i] = instanceWatch.elapsedTime();
+                };
+                if(pool){
+                    utilities::parallel_foreach(*pool, nInstances,
+                        boost::counting_iterator<size_t>(0),
+                        boost::counting_iterator<size_t>(nInstances), oracle);
+                }
+                else{
+                    for(size_t i=0; i<nInstances; ++i)
+                        oracle(0, i);
+                }
+                watch.toc();
+                record.inferenceTime = watch.elapsedTime();
+
+                // new plane and objective
+                watch.tic();
+                plane = threadFeatureDiff.front();
+                for(size_t t=1; t<nThreads; ++t)
+                    plane += threadFeatureDiff[t];
+                plane *= 1.0/nInstances;
+
+                ValueType risk = 0;
+                for(const auto hinge : hinges)
+                    risk += hinge;
+                risk /= nInstances;
+
+                ValueType offset = risk;
+                ValueType squaredNorm = 0;
+                ValueType gradientSquaredNorm = 0;
+                for(size_t wi=0; wi<nWeights; ++wi){
+                    offset -= plane[wi]*weightVector[wi];
+                    squaredNorm += weightVector[wi]*weightVector[wi];
+                    const auto g = weightVector[wi] + c*plane[wi];
+                    gradientSquaredNorm += g*g;
+                }
+                const auto objective = 0.5*squaredNorm + c*risk;
+                if(objective < bestObjective){
+                    bestObjective = objective;
+                    bestWeights = weightVector;
+                }
+
+                // solve the cutting plane problem
+                dualSolver.addPlane(plane, offset);
+                const auto lowerBound = dualSolver.solve(c, options_.qpEps_, options_.qpMaxIterations_);
+                dualSolver.removeInactivePlanes(options_.maxInactive_);
+
+                double eps = 0;
+                const auto & newWeights = dualSolver.weights();
+                for(size_t wi=0; wi<nWeights; ++wi){
+                    const auto d = newWeights[wi] - weightVector[wi];
+                    eps += d*d;
+                    weightVector[wi] = newWeights[wi];
+                }
+                watch.toc();
+                record.weightUpdateTime = watch.elapsedTime();
+
+                watch.tic();
+                dset.updateWeights(weightVector);
+                watch.toc();
+                record.datasetTime = watch.elapsedTime();
+
+                record.gradientNorm = std::sqrt(gradientSquaredNorm);
+                record.weightChange = eps;
+                record.objective = bestObjective;
+                record.lowerBound = lowerBound;
+                for(uint64_t i=0; i<nInstances; ++i){
+                    if(instanceTimes[i] > record.slowestInstanceTime){
+                        record.slowestInstanceTime = instanceTimes[i];
+                        record.slowestInstance = i;
+                    }
+                }
+                const auto showLossN = options_.showLossEvery_;
+                if(inferenceFactory != nullptr && showLossN != 0 && (iter + 1) % showLossN == 0){
+                    watch.tic();
+                    record.regularizer = dset.evalRegularizer(weightVector);
+                    record.loss = dset.totalLoss(inferenceFactory);
+                    watch.toc();
+                    record.lossEvaluationTime = watch.elapsedTime();
+                }
+                iterationWatch.toc();
+                record.totalTime = iterationWatch.elapsedTime();
+
+                if(!visitor->visit(record, weightVector))
+                    break;
+
+                const auto gap = bestObjective - lowerBound;
+                if(gap <= options_.eps_ * std::abs(bestObjective))
+                    break;
+            }
+
+            weightVector = bestWeights;
+            dset.updateWeights(weightVector);
+            visitor->end(weightVector);
+        }
+
+    private:
+
+        Dataset & dataset_;
+        Options options_;
+        LossAugmentedArgmin<Dataset> lossAugmentedArgmin_;
+    };
+
+} // end namespace inferno::learning::learners
+} // end namespace inferno::learning
+} // end namespace inferno
+
+
+#endif /* INFERNO_LEARNING_LEARNERS_BUNDLE_METHOD_HXX */
@@ -5,6 +5,8 @@
 
 
 #include "inferno/learning/learners/learners.hxx"
+#include "inferno/learning/learners/perturbation_evaluator.hxx"
+#include "inferno/learning/weights/perturbation_matrix.hxx"
 #include "inferno/utilities/index_vector.hxx"
 #include "inferno/utilities/line_search/line_search.hxx"
 #include "inferno/inference/base_discrete_inference_factory.hxx"
@@ -30,6 +32,7 @@ namespace learners{
         typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
         typedef std::vector<ConfMap> ConfMapVector;
         typedef inference::BaseDiscreteInferenceFactory<Model> InferenceFactoryBase;
+        typedef PerturbationEvaluator<Model> PerturbationEvaluatorType;
 
         struct Options{
             Options(
@@ -39,7 +42,9 @@ namespace learners{
                 const double   sigma = 1.0,
                 const int      verbose =2,
                 const int      seed = 0,
-                const double   beta = 0.5
+                const double   beta = 0.5,
+                const uint64_t nThreads = 1,
+                const bool     warmStart = false
             )
             :   nPertubations_(nPertubations),
                 nElites_(nElites),
@@ -47,7 +52,9 @@ namespace learners{
                 sigma_(sigma),
                 verbose_(verbose),
                 seed_(seed),
-                beta_(beta)
+                beta_(beta),
+                nThreads_(nThreads),
+                warmStart_(warmStart)
             {
             }
 
@@ -60,6 +67,8 @@ namespace learners{
             int seed_;
             double n_;
             double beta_;
+            uint64_t nThreads_;
+            bool warmStart_;
         };
 
         Igo(Dataset & dset, const Options & options = Options())
@@ -82,20 +91,16 @@ namespace learners{
             auto & dset = dataset();
 
 
-            // multiple weight-vectors stacked as matrix
-            WeightMatrix            weightMatrix(weightVector,options_.nPertubations_);   
+            // random weight-vectors stacked as matrix
+            weights::PerturbationMatrix weightMatrix(options_.nPertubations_,
+                                                     weightVector.size(),
+                                                     options_.seed_);
+            weightMatrix.setBounds(dset.weightConstraints());
             std::vector<LossType>   losses(options_.nPertubations_);
+            std::vector<double>     eliteCoefficients(options_.nPertubations_);
             utilities::IndexVector< > randIndices(options_.nPertubations_);
-
-            // random gen
-            boost::mt19937 rng(options_.seed_); // I don't seed it on purpouse (it's not relevant)
-            boost::normal_distribution<> nd(0.0, options_.sigma_);
-            boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > normalDist(rng, nd);
-
-            for(int ii=0; ii<10; ++ii){
-                std::cout<<normalDist()<<"  ";
-            }
-            std::cout<<" \n";
+            PerturbationEvaluatorType perturbationEvaluator(options_.nThreads_, options_.warmStart_);
+            uint64_t step = 0;
 
             // indices
             utilities::IndexVector< > indices(dset.size());
@@ -110,35 +115,26 @@ namespace learners{
 
                     dset.unlock(trainingInstanceIndex);
 
-                    auto & model = dset.model(trainingInstanceIndex);
-                    const auto & gt = dset.groundTruth(trainingInstanceIndex);
-                    auto & lossFunction = dset.lossFunction(trainingInstanceIndex);
+                    auto & model = *dset.model(trainingInstanceIndex);
+                    const auto & gt = *dset.groundTruth(trainingInstanceIndex);
+                    const auto lossFunction = dset.lossFunction(trainingInstanceIndex);
 
                     // get random weight vector
-                    weightMatrix.gaussianWeights(weightVector, vars_, rng);
+                    weightMatrix.gaussianWeights(weightVector, vars_, step);
+                    ++step;
                     
-                    auto  cc = 0;
-                    for(auto & rWeightVector : weightMatrix){
-
-                        model.updateWeights(rWeightVector);
-
-                        auto inference = inferenceFactory->create(model);
-                        ConfMap conf(model);
-                        inference->infer();
-                        inference->conf(conf); 
-                        const auto l = lossFunction.eval(model, gt, conf);
-                        //std::cout<<"l "<<l<<"\n";
-                        losses[cc] = l;
-                        ++cc;
-                    }
+                    // argmin and loss for all random weight vectors
+                    perturbationEvaluator.evaluate(model, *lossFunction, gt, inferenceFactory,
+                                                   weightMatrix, losses, trainingInstanceIndex);
                     randIndices.reset();
                     vigra::indexSort(losses.begin(), losses.end(), randIndices.begin(), std::less<ValueType>());
 
                     std::fill(eliteMean.begin(), eliteMean.end(), 0.0);
+                    std::fill(eliteCoefficients.begin(), eliteCoefficients.end(), 0.0);
                     for(size_t e=0; e<options_.nElites_; ++e){
-                        eliteMean += weightMatrix[randIndices[e]]; 
+                        eliteCoefficients[randIndices[e]] = 1.0/options_.nElites_;
                     }
-                    eliteMean /= options_.nElites_;
+                    weightMatrix.weightedSum(eliteCoefficients, eliteMean);
                     // lock
                     dset.lock(trainingInstanceIndex);
                 }
@@ -12,6 +12,7 @@ namespace learning{
     - loss augmented:
         - Struct-max-margin
         - Sub-gradient
+        - Bundle method (BMRM)
     - loss evaluating:
         - stochastic gradient
 */
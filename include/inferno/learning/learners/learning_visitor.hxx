@@ -1,3 +1,345 @@
+/** \file learning_visitor.hxx
+    \brief  Visitors to monitor learners:
+    inferno::learning::learners::LearningVisitorBase,
+    inferno::learning::learners::VerboseLearningVisitor and
+    inferno::learning::learners::LearningRecorder
+    (per iteration timings, losses, asynchronous validation
+    loss, CSV / JSON output).
+*/
+#ifndef INFERNO_LEARNING_LEARNERS_LEARNING_VISITOR_HXX
+#define INFERNO_LEARNING_LEARNERS_LEARNING_VISITOR_HXX
 
+// std
+#include <vector>
+#include <string>
+#include <chrono>
+#include <future>
+#include <limits>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <fstream>
 
+// inferno
+#include "inferno/inferno.hxx"
+#include "inferno/learning/weights.hxx"
 
+namespace inferno{
+namespace learning{
+namespace learners{
+
+
+    /** \brief Statistics of a single iteration of a learner.
+
+        All times are wall-clock seconds.
+        Values which have not been computed in an
+        iteration are NaN (see LearningIterationRecord::hasValue).
+    */
+    struct LearningIterationRecord{
+        LearningIterationRecord(const uint64_t iter = 0)
+        :   iteration(iter),
+            totalTime(0),
+            inferenceTime(0),
+            lossEvaluationTime(0),
+            weightUpdateTime(0),
+            datasetTime(0),
+            slowestInstance(0),
+            slowestInstanceTime(0),
+            gradientNorm(nan()),
+            weightChange(nan()),
+            regularizer(nan()),
+            loss(nan()),
+            validationLoss(nan()),
+            objective(nan()),
+            lowerBound(nan()){
+        }
+
+        static double nan(){
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        static bool hasValue(const double value){
+            return !std::isnan(value);
+        }
+
+        uint64_t iteration;
+        /// \brief time of the whole iteration
+        double totalTime;
+        /// \brief time in (loss augmented) inference
+        double inferenceTime;
+        /// \brief time spent to evaluate the training loss
+        double lossEvaluationTime;
+        /// \brief time of the gradient steps
+        double weightUpdateTime;
+        /// \brief time spent to update the weights of the models in the dataset
+        double datasetTime;
+        /// \brief training instance with the slowest inference
+        uint64_t slowestInstance;
+        /// \brief inference time of the slowest training instance
+        double slowestInstanceTime;
+        /// \brief norm of the (last) gradient
+        double gradientNorm;
+        /// \brief squared change of the weights
+        double weightChange;
+        /// \brief value of the regularizer
+        double regularizer;
+        /** \brief total loss on the training set
+
+            Evaluated by the learner on its own thread,
+            the models of the training set are shared with the learner.
+        */
+        double loss;
+        /// \brief average loss on the validation set
+        double validationLoss;
+        /// \brief (best) value of the learning objective
+        double objective;
+        /// \brief lower bound of the learning objective
+        double lowerBound;
+    };
+
+
+    /** \brief Base class of visitors for learners
+
+        Learners call LearningVisitorBase::begin before
+        the first iteration, LearningVisitorBase::visit after each
+        iteration and LearningVisitorBase::end after the last one.
+        All calls are made from the thread which called learn.
+    */
+    class LearningVisitorBase{
+    public:
+        virtual ~LearningVisitorBase(){
+        }
+        virtual void begin(const WeightVector & ){
+        }
+        /// \brief return false to stop learning
+        virtual bool visit(const LearningIterationRecord & , const WeightVector & ){
+            return true;
+        }
+        virtual void end(const WeightVector & ){
+        }
+    };
+
+
+    /// \brief print the regularizer, the losses and the objective whenever they have been evaluated
+    class VerboseLearningVisitor : public LearningVisitorBase{
+    public:
+        VerboseLearningVisitor(std::ostream & out = std::cout)
+        :   out_(out){
+        }
+        virtual bool visit(const LearningIterationRecord & r, const WeightVector & ) override {
+            const bool hasReg = LearningIterationRecord::hasValue(r.regularizer);
+            const bool hasLoss = LearningIterationRecord::hasValue(r.loss);
+            const bool hasValLoss = LearningIterationRecord::hasValue(r.validationLoss);
+            const bool hasObjective = LearningIterationRecord::hasValue(r.objective);
+            if(hasReg || hasLoss || hasValLoss || hasObjective){
+                out_<<"i = "<<r.iteration<<"  ( "<<r.totalTime<<" s )\n";
+                if(hasReg)
+                    out_<<"    regularizer = "<<r.regularizer<<"\n";
+                if(hasLoss)
+                    out_<<"    loss = "<<r.loss<<"\n";
+                if(hasValLoss)
+                    out_<<"    validation loss = "<<r.validationLoss<<"\n";
+                if(hasObjective){
+                    out_<<"    objective = "<<r.objective;
+                    if(LearningIterationRecord::hasValue(r.lowerBound))
+                        out_<<"  lower bound = "<<r.lowerBound;
+                    out_<<"\n";
+                }
+                out_<<"\n";
+            }
+            return true;
+        }
+    private:
+        std::ostream & out_;
+    };
+
+
+    /** \brief record the statistics of all iterations
+
+        If a validation dataset is given, the average validation loss is
+        evaluated every validationEvery iterations on a snapshot of the weights.
+        With asyncValidation the evaluation runs on a separate thread, so the
+        learner is not slowed down.
+        If the last evaluation has not finished yet, the snapshot
+        is skipped. Asynchronous results are attached to the record
+        of the iteration of the snapshot.
+        The validation dataset must not share models with the training dataset.
+        The training loss is always evaluated synchronously by the learner
+        (see LearningIterationRecord::loss).
+    */
+    class LearningRecorder : public LearningVisitorBase{
+    public:
+        LearningRecorder(
+            const bool verbose = false,
+            const uint64_t validationEvery = 1,
+            const bool asyncValidation = true
+        )
+        :   verbose_(verbose),
+            validationEvery_(validationEvery),
+            asyncValidation_(asyncValidation),
+            records_(),
+            validationLoss_(),
+            pending_(),
+            pendingRecord_(0),
+            verboseVisitor_(){
+        }
+
+        virtual ~LearningRecorder(){
+            this->collect(true);
+        }
+
+        /** \brief set the dataset for the validation loss
+
+            \param dataset validation dataset, the weights of its
+                models are changed by the validation
+            \param inferenceFactory inference to compute the argmin
+        */
+        template<class DATASET>
+        void setValidationDataset(
+            DATASET & dataset,
+            typename DATASET::InferenceFactoryBase * inferenceFactory
+        ){
+            validationLoss_ = [&dataset, inferenceFactory](const WeightVector & weights){
+                dataset.updateWeights(weights);
+                return double(dataset.averageLoss(inferenceFactory));
+            };
+        }
+
+        virtual void begin(const WeightVector & ) override {
+            this->collect(true);
+            records_.clear();
+        }
+
+        virtual bool visit(const LearningIterationRecord & record, const WeightVector & weights) override {
+            records_.push_back(record);
+            this->collect(false);
+
+            if(validationLoss_ && validationEvery_ > 0 &&
+               (record.iteration + 1) % validationEvery_ == 0){
+                if(!asyncValidation_){
+                    records_.back().validationLoss = validationLoss_(weights);
+                }
+                else if(!pending_.valid()){
+                    // the snapshot is copied into the task
+                    auto f = validationLoss_;
+                    pending_ = std::async(std::launch::async, [f, weights](){
+                        return f(weights);
+                    });
+                    pendingRecord_ = records_.size() - 1;
+                }
+            }
+            if(verbose_)
+                verboseVisitor_.visit(records_.back(), weights);
+            return true;
+        }
+
+        virtual void end(const WeightVector & ) override {
+            this->collect(true);
+        }
+
+        const std::vector<LearningIterationRecord> & records()const{
+            return records_;
+        }
+
+        /// \brief write all records as CSV (one line per iteration)
+        void writeCsv(std::ostream & out)const{
+            out<<"iteration,totalTime,inferenceTime,lossEvaluationTime,weightUpdateTime,"
+               <<"datasetTime,slowestInstance,slowestInstanceTime,gradientNorm,"
+               <<"weightChange,regularizer,loss,validationLoss,objective,lowerBound\n";
+            for(const auto & r : records_){
+                out<<r.iteration<<","<<r.totalTime<<","<<r.inferenceTime<<","
+                   <<r.lossEvaluationTime<<","<<r.weightUpdateTime<<","<<r.datasetTime<<","
+                   <<r.slowestInstance<<","<<r.slowestInstanceTime<<",";
+                writeValue(out, r.gradientNorm, "");
+                out<<",";
+                writeValue(out, r.weightChange, "");
+                out<<",";
+                writeValue(out, r.regularizer, "");
+                out<<",";
+                writeValue(out, r.loss, "");
+                out<<",";
+                writeValue(out, r.validationLoss, "");
+                out<<",";
+                writeValue(out, r.objective, "");
+                out<<",";
+                writeValue(out, r.lowerBound, "");
+                out<<"\n";
+            }
+        }
+
+        /// \brief write all records as JSON array of objects
+        void writeJson(std::ostream & out)const{
+            out<<"[\n";
+            for(size_t i=0; i<records_.size(); ++i){
+                const auto & r = records_[i];
+                out<<"  {\"iteration\": "<<r.iteration
+                   <<", \"totalTime\": "<<r.totalTime
+                   <<", \"inferenceTime\": "<<r.inferenceTime
+                   <<", \"lossEvaluationTime\": "<<r.lossEvaluationTime
+                   <<", \"weightUpdateTime\": "<<r.weightUpdateTime
+                   <<", \"datasetTime\": "<<r.datasetTime
+                   <<", \"slowestInstance\": "<<r.slowestInstance
+                   <<", \"slowestInstanceTime\": "<<r.slowestInstanceTime
+                   <<", \"gradientNorm\": ";
+                writeValue(out, r.gradientNorm, "null");
+                out<<", \"weightChange\": ";
+                writeValue(out, r.weightChange, "null");
+                out<<", \"regularizer\": ";
+                writeValue(out, r.regularizer, "null");
+                out<<", \"loss\": ";
+                writeValue(out, r.loss, "null");
+                out<<", \"validationLoss\": ";
+                writeValue(out, r.validationLoss, "null");
+                out<<", \"objective\": ";
+                writeValue(out, r.objective, "null");
+                out<<", \"lowerBound\": ";
+                writeValue(out, r.lowerBound, "null");
+                out<<"}"<<(i+1 < records_.size() ? ",\n" : "\n");
+            }
+            out<<"]\n";
+        }
+
+        void writeCsv(const std::string & filename)const{
+            std::ofstream out(filename.c_str());
+            INFERNO_CHECK(out.good(), "cannot open "+filename);
+            this->writeCsv(out);
+        }
+        void writeJson(const std::string & filename)const{
+            std::ofstream out(filename.c_str());
+            INFERNO_CHECK(out.good(), "cannot open "+filename);
+            this->writeJson(out);
+        }
+
+    private:
+        static void writeValue(std::ostream & out, const double value, const char * missing){
+            if(LearningIterationRecord::hasValue(value))
+                out<<value;
+            else
+                out<<missing;
+        }
+
+        // attach a finished asynchronous validation loss
+        void collect(const bool wait){
+            if(!pending_.valid())
+                return;
+            if(!wait && pending_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                return;
+            const auto loss = pending_.get();
+            if(pendingRecord_ < records_.size())
+                records_[pendingRecord_].validationLoss = loss;
+        }
+
+        bool verbose_;
+        uint64_t validationEvery_;
+        bool asyncValidation_;
+        std::vector<LearningIterationRecord> records_;
+        std::function<double(const WeightVector &)> validationLoss_;
+        std::future<double> pending_;
+        size_t pendingRecord_;
+        VerboseLearningVisitor verboseVisitor_;
+    };
+
+} // end namespace inferno::learning::learners
+} // end namespace inferno::learning
+} // end namespace inferno
+
+#endif /* INFERNO_LEARNING_LEARNERS_LEARNING_VISITOR_HXX */
@@ -0,0 +1,171 @@
+/** \file loss_augmented_argmin.hxx
+    \brief  Implementation of inferno::learning::learners::LossAugmentedArgmin,
+    the loss augmented inference of a single training instance
+    which is shared by the loss augmented learners.
+*/
+#ifndef INFERNO_LEARNING_LEARNERS_LOSS_AUGMENTED_ARGMIN_HXX
+#define INFERNO_LEARNING_LEARNERS_LOSS_AUGMENTED_ARGMIN_HXX
+
+#include <vector>
+#include <memory>
+
+#include "inferno/inferno.hxx"
+#include "inferno/learning/weights.hxx"
+#include "inferno/learning/learners/warm_start_inference.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+
+namespace inferno{
+namespace learning{
+namespace learners{
+
+
+    /** \brief Loss augmented inference of the training instances of a dataset.
+
+        The loss augmented model and the labelings of each training
+        instance are allocated in the first call for this instance,
+        later calls only update the loss augmented terms
+        (see DecomposableLossFunctionBase::updateLossAugmentedModel).
+        With warm start the solver of each training instance is
+        started from its last argmin (see WarmStartInference).
+
+        Different training instances can be processed concurrently.
+        Used by SubGradient and BundleMethod.
+    */
+    template<class DATASET>
+    class LossAugmentedArgmin{
+    public:
+        typedef DATASET                                                             Dataset;
+        typedef typename Dataset::Model                                             Model;
+        typedef typename Dataset::LossFunction                                      LossFunction;
+        typedef typename Model:: template VariableMap<DiscreteLabel>                ConfMap;
+        typedef typename LossFunction::LossAugmentedModel                           LossAugmentedModel;
+        typedef inference::BaseDiscreteInferenceFactory<LossAugmentedModel>         LossAugmentedInferenceFactoryBase;
+        typedef typename LossAugmentedModel:: template VariableMap<DiscreteLabel>   LossAugmentedConfMap;
+
+        LossAugmentedArgmin(Dataset & dset)
+        :   dataset_(dset),
+            lossAugmentedInferenceFactory_(nullptr),
+            warmStart_(false),
+            warmStartInference_(),
+            lossAugmentedModels_(),
+            lossAugmentedConfs_(),
+            modelConfs_(){
+        }
+
+        /** \brief forget all models, labelings and solvers
+
+            \param lossAugmentedInferenceFactory inference for the loss augmented models
+            \param warmStart start each solver from the last argmin
+                of its training instance
+        */
+        void reset(
+            LossAugmentedInferenceFactoryBase * lossAugmentedInferenceFactory,
+            const bool warmStart
+        ){
+            const auto nInstances = dataset_.size();
+            lossAugmentedInferenceFactory_ = lossAugmentedInferenceFactory;
+            warmStart_ = warmStart;
+            warmStartInference_.resize(nInstances);
+            warmStartInference_.clear();
+            lossAugmentedModels_.clear();
+            lossAugmentedModels_.resize(nInstances);
+            lossAugmentedConfs_.clear();
+            lossAugmentedConfs_.resize(nInstances);
+            modelConfs_.clear();
+            modelConfs_.resize(nInstances);
+        }
+
+        /** \brief loss augmented argmin of a single training instance
+
+            \param trainingInstanceIndex index of the training instance
+            \param weightVector current weights
+            \param[in,out] featureDiff the joint feature difference of
+                the ground truth and the argmin is added
+            \param updateModelWeights set weightVector to the model
+                before the inference (the weights of the dataset
+                are not up to date, e.g. Hogwild snapshots)
+
+            \returns the hinge loss  \f$\Delta(y_n, y) + E(y_n) - E(y)\f$
+        */
+        ValueType argmin(
+            const uint64_t trainingInstanceIndex,
+            const WeightVector & weightVector,
+            WeightVector & featureDiff,
+            const bool updateModelWeights = false
+        ){
+            auto & dset = dataset_;
+
+            // unlock model
+            dset.unlock(trainingInstanceIndex);
+
+            auto & model = *dset.model(trainingInstanceIndex);
+            const auto & gt = *dset.groundTruth(trainingInstanceIndex);
+            auto  lossFunction = dset.lossFunction(trainingInstanceIndex);
+
+            if(updateModelWeights)
+                model.updateWeights(weightVector);
+
+            // get the loss augmented model,
+            // it is only made in the first iteration
+            auto & lossAugmentedModelPtr = lossAugmentedModels_[trainingInstanceIndex];
+            if(!lossAugmentedModelPtr){
+                lossAugmentedModelPtr.reset(new LossAugmentedModel());
+                lossFunction->makeLossAugmentedModel(model, gt, *lossAugmentedModelPtr);
+                lossAugmentedConfs_[trainingInstanceIndex] = LossAugmentedConfMap(*lossAugmentedModelPtr);
+                modelConfs_[trainingInstanceIndex] = ConfMap(model);
+            }
+            else{
+                lossFunction->updateLossAugmentedModel(model, gt, *lossAugmentedModelPtr);
+            }
+            const auto & lossAugmentedModel = *lossAugmentedModelPtr;
+            auto & lossAugmentedConf = lossAugmentedConfs_[trainingInstanceIndex];
+            auto & modelConf = modelConfs_[trainingInstanceIndex];
+
+            // compute argmin
+            if(warmStart_){
+                warmStartInference_.argmin(trainingInstanceIndex, lossAugmentedModel,
+                                           lossAugmentedInferenceFactory_, weightVector,
+                                           lossAugmentedConf, true);
+            }
+            else{
+                auto lossAugmentedInference = lossAugmentedInferenceFactory_->create(lossAugmentedModel);
+                lossAugmentedInference->infer();
+                lossAugmentedInference->conf(lossAugmentedConf);
+            }
+
+            // map conf
+            auto lVarIter = lossAugmentedModel.variableDescriptorsBegin();
+            for(const auto var : model.variableDescriptors()){
+                modelConf[var] = lossAugmentedConf[*lVarIter];
+                ++lVarIter;
+            }
+
+            const auto hinge = lossFunction->eval(model, gt, modelConf) +
+                model.eval(gt) - model.eval(modelConf);
+
+            // accumulate
+            INFERNO_CHECK_OP(featureDiff.size(), ==, weightVector.size(),"");
+            model.accumulateJointFeaturesDifference(featureDiff, gt, modelConf);
+
+            // lock
+            dset.lock(trainingInstanceIndex);
+            return hinge;
+        }
+
+    private:
+        Dataset & dataset_;
+        LossAugmentedInferenceFactoryBase * lossAugmentedInferenceFactory_;
+        bool warmStart_;
+        WarmStartInference<LossAugmentedModel> warmStartInference_;
+
+        // per training instance
+        std::vector<std::unique_ptr<LossAugmentedModel> > lossAugmentedModels_;
+        std::vector<LossAugmentedConfMap> lossAugmentedConfs_;
+        std::vector<ConfMap> modelConfs_;
+    };
+
+} // end namespace inferno::learning::learners
+} // end namespace inferno::learning
+} // end namespace inferno
+
+#endif /* INFERNO_LEARNING_LEARNERS_LOSS_AUGMENTED_ARGMIN_HXX */
@@ -0,0 +1,243 @@
+/** \file perturbation_evaluator.hxx
+    \brief  Implementation of inferno::learning::learners::PerturbationEvaluator,
+    the (parallel) loss evaluation of perturbed weight vectors
+    used by the loss evaluating learners.
+*/
+#ifndef INFERNO_LEARNING_LEARNERS_PERTURBATION_EVALUATOR_HXX
+#define INFERNO_LEARNING_LEARNERS_PERTURBATION_EVALUATOR_HXX
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include <boost/iterator/counting_iterator.hpp>
+
+#include "inferno/inferno.hxx"
+#include "inferno/learning/weights.hxx"
+#include "inferno/learning/weights/perturbation_matrix.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/learning/learners/warm_start_inference.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
+
+namespace inferno{
+namespace learning{
+namespace learners{
+
+/// \cond
+namespace detail_perturbation_evaluator{
+
+    // models with an internal thread pool
+    // (e.g. models::ParametrizedMulticutModel)
+    template<class MODEL>
+    auto setSingleThreaded(MODEL & model, int) -> decltype(model.setNumberOfThreads(1), void()){
+        model.setNumberOfThreads(1);
+    }
+    template<class MODEL>
+    void setSingleThreaded(MODEL &, long){
+    }
+
+} // end namespace inferno::learning::learners::detail_perturbation_evaluator
+/// \endcond
+
+
+    /** \brief Evaluate the loss of all weight vectors
+        of a WeightMatrix (or the rows of a weights::PerturbationMatrix)
+        on a single training instance.
+
+        For each weight vector the model weights are updated,
+        the argmin is computed with a solver from the
+        inference factory and the loss is evaluated.
+
+        If the model is copy constructible and nThreads != 1
+        each thread works on its own replica of the model,
+        therefore the perturbations are evaluated in parallel
+        and the model passed to evaluate is not changed.
+        There is a single set of replicas, it is copied from
+        the model whenever the training instance (or the model
+        passed to evaluate) changes and reused by consecutive
+        calls for the same training instance, which only update
+        the weights. Therefore the memory does not grow with the
+        number of training instances. Since the parallelism is
+        over the perturbations, the replicas are restricted
+        to a single thread (if the model has a setNumberOfThreads).
+        Otherwise the perturbations are evaluated sequentially
+        on the model itself, which keeps the weights of
+        the last perturbation.
+        In the parallel case the inference factory and the
+        loss function are used concurrently.
+
+        losses[p] always belongs to weightMatrix[p],
+        therefore any reduction over the losses is
+        independent of the number of threads.
+
+        With warmStart the argmin of each training instance
+        is warm started with a WarmStartInference cache
+        which stores a single labeling per training instance.
+        In the sequential case a single solver per training
+        instance is kept alive and started from the argmin
+        of the previous perturbation.
+        In the parallel case all perturbations are started
+        from the argmin of the first perturbation
+        in the last call for the same training instance,
+        therefore the result is independent of the
+        number of threads (as long as nThreads > 1).
+    */
+    template<class MODEL>
+    class PerturbationEvaluator{
+    public:
+        typedef MODEL Model;
+        typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
+        typedef inference::BaseDiscreteInferenceFactory<Model> InferenceFactoryBase;
+        typedef std::is_copy_constructible<Model> CanReplicate;
+
+        PerturbationEvaluator(const uint64_t nThreads = 1, const bool warmStart = false)
+        :   nThreads_(nThreads == 0 ? std::thread::hardware_concurrency() : nThreads),
+            warmStart_(warmStart),
+            replicas_(),
+            replicaSource_(NULL),
+            replicaInstance_(0),
+            pool_(),
+            warmStartInference_(),
+            rowBuffers_(){
+            if(!CanReplicate::value)
+                nThreads_ = 1;
+            if(nThreads_ > 1)
+                pool_.reset(new utilities::ThreadPool(nThreads_));
+        }
+
+        template<class LOSS_FUNCTION, class GROUND_TRUTH>
+        void evaluate(
+            const Model & model,
+            const LOSS_FUNCTION & lossFunction,
+            const GROUND_TRUTH & groundTruth,
+            InferenceFactoryBase * inferenceFactory,
+            const WeightMatrix & weightMatrix,
+            std::vector<LossType> & losses,
+            const uint64_t trainingInstanceIndex = 0
+        ){
+            auto getWeights = [&](const int tid, const size_t p) -> const WeightVector & {
+                return weightMatrix[p];
+            };
+            this->evaluateImpl(model, lossFunction, groundTruth, inferenceFactory,
+                               weightMatrix.size(), getWeights, losses, trainingInstanceIndex);
+        }
+
+        /// \brief evaluate the rows of a contiguous weights::PerturbationMatrix
+        template<class LOSS_FUNCTION, class GROUND_TRUTH>
+        void evaluate(
+            const Model & model,
+            const LOSS_FUNCTION & lossFunction,
+            const GROUND_TRUTH & groundTruth,
+            InferenceFactoryBase * inferenceFactory,
+            const weights::PerturbationMatrix & perturbationMatrix,
+            std::vector<LossType> & losses,
+            const uint64_t trainingInstanceIndex = 0
+        ){
+            rowBuffers_.resize(nThreads_);
+            auto getWeights = [&](const int tid, const size_t p) -> const WeightVector & {
+                auto & buffer = rowBuffers_[tid];
+                perturbationMatrix.getWeights(p, buffer);
+                return buffer;
+            };
+            this->evaluateImpl(model, lossFunction, groundTruth, inferenceFactory,
+                               perturbationMatrix.nPerturbations(), getWeights, losses, trainingInstanceIndex);
+        }
+
+        uint64_t nThreads()const{
+            return nThreads_;
+        }
+
+    private:
+
+        template<class LOSS_FUNCTION, class GROUND_TRUTH, class GET_WEIGHTS>
+        void evaluateImpl(
+            const Model & model,
+            const LOSS_FUNCTION & lossFunction,
+            const GROUND_TRUTH & groundTruth,
+            InferenceFactoryBase * inferenceFactory,
+            const size_t nPerturbations,
+            GET_WEIGHTS & getWeights,
+            std::vector<LossType> & losses,
+            const uint64_t trainingInstanceIndex
+        ){
+            losses.resize(nPerturbations);
+            const auto replicas = this->replicas(model, trainingInstanceIndex, CanReplicate());
+            if(warmStart_ && warmStartInference_.size() <= trainingInstanceIndex)
+                warmStartInference_.resize(trainingInstanceIndex + 1);
+            // argmin of the first perturbation, the start
+            // labeling of the next call in the parallel case
+            ConfMap firstArgmin;
+
+            auto f = [&](const int tid, const size_t p){
+                const Model & m = replicas == NULL ? model : *(*replicas)[tid];
+                const WeightVector & weights = getWeights(tid, p);
+                m.updateWeights(weights);
+                ConfMap conf(m);
+                if(warmStart_){
+                    if(pool_){
+                        warmStartInference_.argminFrom(trainingInstanceIndex, m, inferenceFactory, conf);
+                        if(p == 0)
+                            firstArgmin = conf;
+                    }
+                    else
+                        warmStartInference_.argmin(trainingInstanceIndex, m, inferenceFactory,
+                                                   weights, conf, true);
+                }
+                else{
+                    auto inference = inferenceFactory->create(m);
+                    inference->infer();
+                    inference->conf(conf);
+                }
+                losses[p] = lossFunction.eval(m, groundTruth, conf);
+            };
+            if(pool_){
+                utilities::parallel_foreach(*pool_, nPerturbations,
+                    boost::counting_iterator<size_t>(0),
+                    boost::counting_iterator<size_t>(nPerturbations), f);
+                if(warmStart_ && nPerturbations > 0)
+                    warmStartInference_.setConf(trainingInstanceIndex, firstArgmin);
+            }
+            else{
+                for(size_t p=0; p<nPerturbations; ++p)
+                    f(0, p);
+            }
+        }
+
+        typedef std::vector<std::unique_ptr<Model> > Replicas;
+
+        // one replica per thread, refreshed if the
+        // training instance changes
+        const Replicas * replicas(const Model & model, const uint64_t trainingInstanceIndex, std::true_type){
+            if(nThreads_ == 1)
+                return NULL;
+            if(replicas_.empty() || replicaSource_ != &model || replicaInstance_ != trainingInstanceIndex){
+                replicas_.resize(nThreads_);
+                for(auto & replica : replicas_){
+                    replica.reset(new Model(model));
+                    detail_perturbation_evaluator::setSingleThreaded(*replica, 0);
+                }
+                replicaSource_ = &model;
+                replicaInstance_ = trainingInstanceIndex;
+            }
+            return &replicas_;
+        }
+        const Replicas * replicas(const Model & model, const uint64_t trainingInstanceIndex, std::false_type){
+            return NULL;
+        }
+
+        uint64_t nThreads_;
+        bool warmStart_;
+        Replicas replicas_;
+        const Model * replicaSource_;
+        uint64_t replicaInstance_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+        WarmStartInference<Model> warmStartInference_;
+        std::vector<WeightVector> rowBuffers_;
+    };
+
+} // end namespace inferno::learning::learners
+} // end namespace inferno::learning
+} // end namespace inferno
+
+#endif /* INFERNO_LEARNING_LEARNERS_PERTURBATION_EVALUATOR_HXX */
@@ -5,6 +5,8 @@
 
 
 #include "inferno/learning/learners/learners.hxx"
+#include "inferno/learning/learners/perturbation_evaluator.hxx"
+#include "inferno/learning/weights/perturbation_matrix.hxx"
 #include "inferno/utilities/index_vector.hxx"
 #include "inferno/utilities/line_search/line_search.hxx"
 #include "inferno/inference/base_discrete_inference_factory.hxx"
@@ -30,6 +32,7 @@ namespace learners{
         typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
         typedef std::vector<ConfMap> ConfMapVector;
         typedef inference::BaseDiscreteInferenceFactory<Model> InferenceFactoryBase;
+        typedef PerturbationEvaluator<Model> PerturbationEvaluatorType;
 
         struct Options{
             Options(
@@ -38,14 +41,18 @@ namespace learners{
                 const double   sigma = 1.0,
                 const int      verbose =2,
                 const int      seed = 0,
-                const double   n = 1.0
+                const double   n = 1.0,
+                const uint64_t nThreads = 1,
+                const bool     warmStart = false
             )
             :   nPertubations_(nPertubations),
                 maxIterations_(maxIterations),
                 sigma_(sigma),
                 verbose_(verbose),
                 seed_(seed),
-                n_(n)
+                n_(n),
+                nThreads_(nThreads),
+                warmStart_(warmStart)
             {
             }
 
@@ -55,6 +62,8 @@ namespace learners{
             int      verbose_;
             int seed_;
             double n_;
+            uint64_t nThreads_;
+            bool warmStart_;
         };
 
         StochasticGradient(Dataset & dset, const Options & options = Options())
@@ -76,15 +85,14 @@ namespace learners{
                 bestLoss_  = dataset_.averageLoss(inferenceFactory);
                 WeightVector bestWeight = weightVector;
 
-                // multiple weight-vectors stacked as matrix
-                WeightMatrix            noiseMatrix(weightVector,options_.nPertubations_);
-                WeightMatrix            weightMatrix(weightVector,options_.nPertubations_);   
+                // perturbed weight-vectors and their noise stacked as matrices
+                weights::PerturbationMatrix perturbationMatrix(options_.nPertubations_,
+                                                               weightVector.size(),
+                                                               options_.seed_);
+                perturbationMatrix.setBounds(dset.weightConstraints());
                 std::vector<LossType>   losses(options_.nPertubations_);
-
-                // random gen
-                boost::mt19937 rng(options_.seed_); // I don't seed it on purpouse (it's not relevant)
-                boost::normal_distribution<> nd(0.0, options_.sigma_);
-                boost::variate_generator<boost::mt19937&, boost::normal_distribution<> > normalDist(rng, nd);
+                PerturbationEvaluatorType perturbationEvaluator(options_.nThreads_, options_.warmStart_);
+                uint64_t step = 0;
 
 
 
@@ -92,8 +100,6 @@ namespace learners{
                 utilities::IndexVector< > indices(dset.size());
 
 
-                const auto & weightConstraints =  dset.weightConstraints();
-
                 for(size_t i=0; i<options_.maxIterations_; ++i){
                     
                     indices.randomShuffle();
@@ -110,37 +116,17 @@ namespace learners{
                         const auto & gt = *dset.groundTruth(trainingInstanceIndex);
                         const auto  lossFunction = dset.lossFunction(trainingInstanceIndex);
 
-                        // pertubate (and remember noise matrix)
-
-                        weightMatrix.pertubate(weightVector,noiseMatrix,weightConstraints, normalDist);
-
-                        // to remember arg mins
-                        //std::cout<<"conf assign \n";
-                        ConfMapVector confMapVector(options_.nPertubations_);
-                        for(auto & cmap : confMapVector){
-                            cmap.assign(model);
-                        }
+                        // pertubate (and remember noise matrix),
+                        // the noise only depends on the seed and the step
+                        perturbationMatrix.perturb(weightVector, options_.sigma_, step);
+                        ++step;
 
-                        // argmin for perturbed model
-                        auto cc=0;
-                        for(const auto & perturbedWeightVector : weightMatrix){
-                            // set perturbed weights
-                            model.updateWeights(perturbedWeightVector);
-
-                            // get argmin 
-                            auto inference = inferenceFactory->create(model);
-                            inference->infer();
-                            inference->conf(confMapVector[cc]); 
-
-
-                    
-                            const auto l = lossFunction->eval(model, gt, confMapVector[cc]);
-                            losses[cc] = l;
-                            ++cc;
-                        }
+                        // argmin and loss for all perturbed models
+                        perturbationEvaluator.evaluate(model, *lossFunction, gt, inferenceFactory,
+                                                       perturbationMatrix, losses, trainingInstanceIndex);
 
                         WeightVector gradient(weightVector.size(),0);
-                        noiseMatrix.weightedSum(losses, gradient);
+                        perturbationMatrix.weightedNoiseSum(losses, gradient);
                         gradient *= dset.regularizer().c()/double(options_.nPertubations_);
 
         
@@ -5,12 +5,22 @@
 
 
 #include "inferno/learning/learners/learners.hxx"
+#include "inferno/learning/learners/loss_augmented_argmin.hxx"
+#include "inferno/learning/learners/learning_visitor.hxx"
 #include "inferno/learning/weights/weight_averaging.hxx"
 #include "inferno/utilities/index_vector.hxx"
 #include "inferno/utilities/line_search/line_search.hxx"
 #include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
+#include "inferno/utilities/timer.hxx"
 
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <cmath>
 
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/random.hpp>
 #include <boost/random/normal_distribution.hpp>
 
@@ -62,6 +72,44 @@ namespace learners{
     #endif
 
 
+    /** \brief Sub-gradient learner with loss augmented inference
+
+        The loss augmented inference of all training instances
+        within a mini-batch runs in parallel (Options::nThreads_ != 1),
+        each thread accumulates the joint feature differences
+        in its own buffer, the buffers are reduced before
+        the gradient step.
+
+        - Options::batchSize_ == 0 : full batch (one step per iteration)
+        - Options::batchSize_ >  0 : the training instances are shuffled
+          and a step is taken after each mini-batch, the step size
+          decays per iteration (epoch) as in the full batch mode and
+          the weight change of all mini-batches is summed for Options::eps_
+        - Options::hogwild_ : each thread takes a step after each training
+          instance and writes the shared weights without any locking
+          (Hogwild!), the momentum is not used in this mode.
+          The shared weights are relaxed atomics, steps of different
+          threads may overwrite each other. Each thread runs the
+          inference with its own snapshot of the shared weights,
+          the models never see the shared weights.
+        - Options::warmStart_ : the loss augmented inference of each
+          training instance is started from its argmin
+          of the last iteration (off by default, with a local
+          search solver this can change the learned weights)
+
+        The loss augmented model of each training instance
+        and the labelings are allocated once per call of
+        learn, later iterations only update the loss augmented
+        terms (see DecomposableLossFunctionBase::updateLossAugmentedModel).
+
+        Progress and timings of each iteration are reported
+        to a LearningVisitorBase (see LearningRecorder),
+        without a visitor a VerboseLearningVisitor is used.
+
+        Non decomposable losses (e.g. VariationOfInformation2) can be used
+        with approximate loss augmented inference,
+        see inference::LossAugmentedLocalSearch.
+    */
     template<class DATASET>
     class SubGradient{
     public:
@@ -81,10 +129,13 @@ namespace learners{
                 const double   eps = 1.0e-10,
                 const double   m = 0.5,
                 const int      verbose = 2,
-                const int      nThreads = 0,
+                const int      nThreads = 1,
                 const int      averagingOrder = -1,
                 const int      showLossEvery = 0,
-                const int      showRegularizerEvery = 0
+                const int      showRegularizerEvery = 0,
+                const uint64_t batchSize = 0,
+                const bool     hogwild = false,
+                const bool     warmStart = false
             )
             :   maxIterations_(maxIterations),
                 n_(n),
@@ -94,7 +145,10 @@ namespace learners{
                 nThreads_(nThreads),
                 averagingOrder_(averagingOrder),
                 showLossEvery_(showLossEvery),
-                showRegularizerEvery_(showRegularizerEvery)
+                showRegularizerEvery_(showRegularizerEvery),
+                batchSize_(batchSize),
+                hogwild_(hogwild),
+                warmStart_(warmStart)
             {
             }
             uint64_t maxIterations_;
@@ -106,12 +160,16 @@ namespace learners{
             int      averagingOrder_;
             uint64_t showLossEvery_;
             uint64_t showRegularizerEvery_;
+            uint64_t batchSize_;
+            bool     hogwild_;
+            bool     warmStart_;
         };
 
         SubGradient(Dataset & dset, const Options & options = Options())
         :   dataset_(dset),
             options_(options),
-            currentN_(options.n_){
+            currentN_(options.n_),
+            lossAugmentedArgmin_(dset){
         }
 
         Dataset & dataset(){
@@ -121,159 +179,238 @@ namespace learners{
         void learn(
             LossAugmentedInferenceFactoryBase * lossAugmentedInferenceFactory, 
             WeightVector & weightVector,
-            InferenceFactoryBase * inferenceFactory = nullptr
+            InferenceFactoryBase * inferenceFactory = nullptr,
+            LearningVisitorBase * visitor = nullptr
         ){
+            VerboseLearningVisitor verboseVisitor;
+            if(visitor == nullptr)
+                visitor = &verboseVisitor;
 
+            lossAugmentedArgmin_.reset(lossAugmentedInferenceFactory, options_.warmStart_);
             weights::WeightAveraging weightAveraging(weightVector, options_.averagingOrder_);
 
             auto & dset = dataset();
+            const uint64_t nInstances = dset.size();
+            const uint64_t batchSize = options_.batchSize_ == 0 ? 
+                nInstances : std::min(options_.batchSize_, nInstances);
+            const uint64_t nThreads = options_.nThreads_ <= 0 ? 
+                std::thread::hardware_concurrency() : options_.nThreads_;
+            const size_t nWeights = weightVector.size();
+
+            std::unique_ptr<utilities::ThreadPool> pool;
+            if(nThreads > 1)
+                pool.reset(new utilities::ThreadPool(nThreads));
+            auto forEachInstance = [&](const uint64_t begin, const uint64_t end, 
+                                       std::function<void(const int, const size_t)> f){
+                if(pool){
+                    utilities::parallel_foreach(*pool, end-begin,
+                        boost::counting_iterator<size_t>(begin),
+                        boost::counting_iterator<size_t>(end), f);
+                }
+                else{
+                    for(auto i=begin; i<end; ++i)
+                        f(0, i);
+                }
+            };
+
+            // per thread accumulators
+            std::vector<WeightVector> threadFeatureDiff(nThreads, WeightVector(weightVector.size()));
+
             WeightVector accFeatureDiff(weightVector.size());
             WeightVector gradient(weightVector.size());
             WeightVector oldGradient(weightVector.size());
             WeightVector oldWeights = weightVector;
+            utilities::IndexVector< > indices(nInstances);
+            uint64_t step = 0;
+
+            // Hogwild: shared weights and a snapshot per thread
+            std::vector<std::atomic<WeightType> > sharedWeights(options_.hogwild_ ? nWeights : 0);
+            std::vector<WeightVector> threadWeights(options_.hogwild_ ? nThreads : 0, weightVector);
+
+            // wall-clock time of the inference of each instance
+            std::vector<double> instanceTimes(nInstances, 0.0);
+            auto timedArgmin = [&](const size_t instance, const WeightVector & weights,
+                                   WeightVector & featureDiff){
+                Timer instanceWatch;
+                instanceWatch.tic();
+                // Hogwild: weights is the snapshot of this thread
+                lossAugmentedArgmin_.argmin(instance, weights, featureDiff, options_.hogwild_);
+                instanceWatch.toc();
+                instanceTimes[instance] = instanceWatch.elapsedTime();
+            };
+
+            visitor->begin(weightVector);
 
             for(size_t iter=0; iter<options_.maxIterations_; ++iter){
 
                 if(kbhit())
                     break;
-                //if(options_.verbose_ == 2){
-                //    std::cout<<"Iteration "<<iter<<"\n";
-                //
-                //    std::cout<<"Weights : ";
-                //    for(size_t wi=0; wi<weightVector.size(); ++wi){
-                //        std::cout<<weightVector[wi]<<" ";
-                //    }
-                //    std::cout<<"\n";
-                //}
-                // reset accumulatedFeatures 
-                std::fill(accFeatureDiff.begin(), accFeatureDiff.end(), 0.0);
-
-
-                // iterate over all training instances
-                LossType totalLoss = 0;
-                for(size_t trainingInstanceIndex=0; trainingInstanceIndex<dataset_.size(); ++trainingInstanceIndex){
-                    
-
-                    // unlock model
-                    dset.unlock(trainingInstanceIndex);
-
-                    auto & model = *dset.model(trainingInstanceIndex);
-                    const auto & gt = *dset.groundTruth(trainingInstanceIndex);
-                    auto  lossFunction = dset.lossFunction(trainingInstanceIndex);
-
-
 
-                        
-                    
-                    // get the loss augmented model
-                    LossAugmentedModel lossAugmentedModel;
-                    lossFunction->makeLossAugmentedModel(model, gt, lossAugmentedModel);
-
-
-                    // compute argmin
-                    auto lossAugmentedInference = lossAugmentedInferenceFactory->create(lossAugmentedModel);
-                    
-
-                    lossAugmentedInference->infer();
-
-                    LossAugmentedConfMap lossAugmentedConf(lossAugmentedModel);
-                    lossAugmentedInference->conf(lossAugmentedConf);
-
-                    // map conf
-                    ConfMap modelConf(model);
-                    auto lVarIter = lossAugmentedModel.variableDescriptorsBegin();
-                    for(const auto var : model.variableDescriptors()){
-                        modelConf[var] = lossAugmentedConf[*lVarIter];
-                        ++lVarIter;
+                LearningIterationRecord record(iter);
+                Timer iterationWatch, watch;
+                iterationWatch.tic();
+
+                double eps = 0;
+                if(options_.hogwild_){
+                    indices.randomShuffle();
+                    const double stepSize = options_.n_/(double(iter+1)*nInstances);
+                    const auto c = dset.regularizer().c();
+                    watch.tic();
+                    for(size_t wi=0; wi<nWeights; ++wi)
+                        sharedWeights[wi].store(weightVector[wi], std::memory_order_relaxed);
+                    forEachInstance(0, nInstances, [&](const int tid, const size_t i){
+                        auto & localWeights = threadWeights[tid];
+                        for(size_t wi=0; wi<nWeights; ++wi)
+                            localWeights[wi] = sharedWeights[wi].load(std::memory_order_relaxed);
+                        auto & featureDiff = threadFeatureDiff[tid];
+                        std::fill(featureDiff.begin(), featureDiff.end(), 0.0);
+                        timedArgmin(indices[i], localWeights, featureDiff);
+                        // unsynchronized update of the shared weights
+                        for(size_t wi=0; wi<nWeights; ++wi){
+                            auto & w = sharedWeights[wi];
+                            const WeightType old = w.load(std::memory_order_relaxed);
+                            w.store(old - stepSize*(old + c*featureDiff[wi]), std::memory_order_relaxed);
+                        }
+                    });
+                    for(size_t wi=0; wi<nWeights; ++wi)
+                        weightVector[wi] = sharedWeights[wi].load(std::memory_order_relaxed);
+                    watch.toc();
+                    record.inferenceTime += watch.elapsedTime();
+
+                    watch.tic();
+                    this->fixBoundedWeights(weightVector);
+                    eps = this->weightChange(weightVector, oldWeights);
+                    weightAveraging(weightVector,weightVector);
+                    watch.toc();
+                    record.weightUpdateTime += watch.elapsedTime();
+
+                    watch.tic();
+                    dset.updateWeights(weightVector);
+                    watch.toc();
+                    record.datasetTime += watch.elapsedTime();
+                }
+                else{
+                    if(batchSize < nInstances)
+                        indices.randomShuffle();
+                    const double stepSize = options_.n_/double(iter+1);
+                    for(uint64_t batchBegin=0; batchBegin<nInstances; batchBegin+=batchSize){
+                        const auto batchEnd = std::min(batchBegin + batchSize, nInstances);
+
+                        // loss augmented inference for the whole batch
+                        watch.tic();
+                        for(auto & featureDiff : threadFeatureDiff)
+                            std::fill(featureDiff.begin(), featureDiff.end(), 0.0);
+                        forEachInstance(batchBegin, batchEnd, [&](const int tid, const size_t i){
+                            timedArgmin(indices[i], weightVector, threadFeatureDiff[tid]);
+                        });
+                        watch.toc();
+                        record.inferenceTime += watch.elapsedTime();
+
+                        // reduce
+                        watch.tic();
+                        accFeatureDiff = threadFeatureDiff.front();
+                        for(size_t t=1; t<nThreads; ++t)
+                            accFeatureDiff += threadFeatureDiff[t];
+
+                        const auto normalizationFactor = dset.regularizer().c() / (batchEnd - batchBegin);
+                        accFeatureDiff *= normalizationFactor;
+                        gradient = weightVector;
+                        gradient += accFeatureDiff;
+                        double gradientSquaredNorm = 0;
+                        for(const auto g : gradient)
+                            gradientSquaredNorm += g*g;
+                        record.gradientNorm = std::sqrt(gradientSquaredNorm);
+
+                        // take gradient step
+                        eps += takeGradientStep(weightVector, oldWeights, gradient, oldGradient, stepSize, step > 0);
+                        ++step;
+
+                        weightAveraging(weightVector,weightVector);
+                        watch.toc();
+                        record.weightUpdateTime += watch.elapsedTime();
+
+                        watch.tic();
+                        dset.updateWeights(weightVector);
+                        watch.toc();
+                        record.datasetTime += watch.elapsedTime();
+                    }
+                }
+                record.weightChange = eps;
+                for(uint64_t i=0; i<nInstances; ++i){
+                    if(instanceTimes[i] > record.slowestInstanceTime){
+                        record.slowestInstanceTime = instanceTimes[i];
+                        record.slowestInstance = i;
                     }
-
-                    const auto modelEval = model.eval(modelConf);
-                    const auto lossModelEval = lossAugmentedModel.eval(lossAugmentedConf);
-                    const auto localLoss = modelEval - lossModelEval;
-
-                    //std::cout<<"model         "<<modelEval<<"\n";
-                    //std::cout<<"lossModelEval "<<lossModelEval<<"\n";
-                    //std::cout<<"loss  "<<localLoss<<"\n";
-                    totalLoss += localLoss;
-
-
-                    // accumulate
-                    INFERNO_CHECK_OP(accFeatureDiff.size(), ==, weightVector.size(),"");
-                    model.accumulateJointFeaturesDifference(accFeatureDiff, gt, modelConf);
-
-                    // lock
-                    dset.lock(trainingInstanceIndex);       
                 }
-                
-                const auto normalizationFactor = dset.regularizer().c() / dset.size();
-                accFeatureDiff *= normalizationFactor;
-                gradient = weightVector;
-                gradient += accFeatureDiff;
-
-                // take gradient step
-                auto eps = takeGradientStep(inferenceFactory, weightVector,oldWeights, gradient, oldGradient, iter);
-                
-
-                weightAveraging(weightVector,weightVector);
-                dset.updateWeights(weightVector);
 
                 const auto showRegN  = options_.showRegularizerEvery_;
                 const auto showLossN = options_.showLossEvery_;
 
                 const bool showLoss = showLossN !=0 && (iter + 1) % showLossN == 0;
                 const bool showReg =  showLoss || (showRegN !=0 && (iter + 1) % showRegN == 0);
-                
-
-
-                if(showReg || showLoss){
-
-                    const auto regVal = dset.evalRegularizer(weightVector);
-                    std::cout<<"i = "<<iter<<"\n";
-           
-                    const auto rString = dset.regularizer().prettyRegularizerString();
-                    std::cout<<"    "<<rString<<" = "<<regVal<<"\n";
-
-                    if(showLoss){
-                        const auto lossVal = dset.totalLoss(inferenceFactory);
-                        const auto cLossVal = dset.regularizer().c()*lossVal;
-                        const auto lString = dset.regularizer().prettyLossSumString();
-                        std::cout<<"    "<<lString<<" = "<<dset.regularizer().c()*cLossVal<<"\n";
-
-                        const auto prettyObjectiveString = dset.regularizer().prettyObjectiveString();
-                        std::cout<<"    "<<prettyObjectiveString<<" = "<< regVal + cLossVal<<"\n";
 
-                    }
-                    std::cout<<"\n";
+                if(showReg)
+                    record.regularizer = dset.evalRegularizer(weightVector);
+                if(showLoss){
+                    watch.tic();
+                    record.loss = dset.totalLoss(inferenceFactory);
+                    watch.toc();
+                    record.lossEvaluationTime = watch.elapsedTime();
                 }
-                
+                iterationWatch.toc();
+                record.totalTime = iterationWatch.elapsedTime();
+
+                if(!visitor->visit(record, weightVector))
+                    break;
 
                 if(eps<options_.eps_){
                     break;
                 }
 
-            }            
+            }
+            visitor->end(weightVector);
         }
     private:
 
+        void fixBoundedWeights(WeightVector & currentWeights)const{
+            const auto & wConstraints = dataset_.weightConstraints();
+            for(const auto & kv : wConstraints.weightBounds()){
+                const auto wi = kv.first;
+                const auto lowerBound = kv.second.first;
+                const auto upperBound = kv.second.second;
+                if(currentWeights[wi] < lowerBound){
+                   currentWeights[wi] = lowerBound; 
+                }
+                if(currentWeights[wi] > upperBound){
+                   currentWeights[wi] = upperBound; 
+                }
+            }
+        }
 
+        // squared change of the weights, oldWeights 
+        // are set to the currentWeights
+        double weightChange(const WeightVector & currentWeights, WeightVector & oldWeights)const{
+            double dSum = 0;
+            const size_t nWeights = currentWeights.size();
+            for(size_t wi=0; wi<nWeights; ++wi){
+                const auto d = currentWeights[wi] - oldWeights[wi];
+                dSum += d*d;
+                oldWeights[wi]  = currentWeights[wi];
+            }
+            return dSum;
+        }
 
+        // gradient step with momentum (if not the first step),
+        // returns the squared change of the weights
         double takeGradientStep(
-            InferenceFactoryBase * inferenceFactory,
             WeightVector & currentWeights,
             WeightVector & oldWeights,
             WeightVector & gradient,
             WeightVector & oldGradient,
-            const uint64_t iter
+            const double stepSize,
+            const bool useMomentum
         ){
-            const auto diter = (double(iter+1));
-            const double stepSize = options_.n_/diter;
-            //const double stepSize = currentN_;
-
-
-
-            WeightVector wBuffer = currentWeights;
-
-            if(iter>0){
+            if(useMomentum){
                 oldGradient *= options_.m_;
                 gradient *= stepSize;
                 gradient += oldGradient;
@@ -285,39 +422,16 @@ namespace learners{
             currentWeights -= gradient;
 
             // fix bounded weights
-            const auto & wConstraints = dataset_.weightConstraints();
-            for(const auto kv : wConstraints.weightBounds()){
-                const auto wi = kv.first;
-                const auto lowerBound = kv.second.first;
-                const auto upperBound = kv.second.second;
-                if(currentWeights[wi] < lowerBound){
-                   currentWeights[wi] = lowerBound; 
-                }
-                if(currentWeights[wi] > upperBound){
-                   currentWeights[wi] = upperBound; 
-                }
-            }
-
-            dataset_.updateWeights(currentWeights);
-
+            this->fixBoundedWeights(currentWeights);
 
             // compute convergence
-            double dSum = 0;
-            for(size_t wi=0; wi<currentWeights.size(); ++wi){
-                const auto d = currentWeights[wi] - oldWeights[wi];
-                dSum += d*d;
-                oldWeights[wi]  = currentWeights[wi];
-            }
-
-            //currentN_*=facs[bestIndex];
-                
-            
-            return dSum;
+            return this->weightChange(currentWeights, oldWeights);
         }
 
         Dataset & dataset_;
         Options options_;
         double currentN_;
+        LossAugmentedArgmin<Dataset> lossAugmentedArgmin_;
     };
 
 } // end namespace inferno::learning::learners
@@ -0,0 +1,177 @@
+/** \file warm_start_inference.hxx
+    \brief  Implementation of inferno::learning::learners::WarmStartInference,
+    a cache of solvers and argmin labelings which is used
+    by the learners to warm start inference across iterations.
+*/
+#ifndef INFERNO_LEARNING_LEARNERS_WARM_START_INFERENCE_HXX
+#define INFERNO_LEARNING_LEARNERS_WARM_START_INFERENCE_HXX
+
+#include <vector>
+#include <memory>
+
+#include "inferno/inferno.hxx"
+#include "inferno/learning/weights.hxx"
+#include "inferno/inference/discrete_inference_base.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+
+namespace inferno{
+namespace learning{
+namespace learners{
+
+
+    /** \brief Cache of solvers and argmin labelings
+        for warm started inference.
+
+        The weights change only slightly between two iterations
+        of a learner, therefore the argmin of the last iteration
+        is a good starting point for the current one.
+        Each slot (usually a training instance) stores
+        the last argmin, which is passed to the solver via
+        inference::DiscreteInferenceBase::setConf
+        before inference.
+
+        If the caller guarantees that the model of a slot
+        is a persistent object (keepSolver), the solver itself is
+        kept alive and only informed about the new weights via
+        inference::DiscreteInferenceBase::updateWeights
+        instead of being reconstructed.
+        Solvers which do not support energy changes
+        are detected once and then created for each call.
+
+        Different slots can be used concurrently.
+
+        The learners only warm start if Options::warmStart_ is set,
+        which is off by default: with an exact solver the
+        learned weights are the same, with a local search solver
+        the argmin (and therefore the weights) may differ.
+    */
+    template<class MODEL>
+    class WarmStartInference{
+    public:
+        typedef MODEL Model;
+        typedef inference::DiscreteInferenceBase<Model> InferenceBase;
+        typedef inference::BaseDiscreteInferenceFactory<Model> InferenceFactoryBase;
+        typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
+
+        WarmStartInference(const size_t nSlots = 0)
+        :   slots_(nSlots){
+        }
+
+        /// \brief resize the number of slots, existing slots are kept
+        void resize(const size_t nSlots){
+            slots_.resize(nSlots);
+        }
+        size_t size()const{
+            return slots_.size();
+        }
+        /// \brief forget all solvers and labelings
+        void clear(){
+            const auto nSlots = slots_.size();
+            slots_.clear();
+            slots_.resize(nSlots);
+        }
+
+        /** \brief warm started argmin of model
+
+            \param slot slot of the cache
+            \param model model, the number of variables
+                must not change for a given slot
+            \param inferenceFactory factory for new solvers
+            \param weights current weights of model
+            \param[out] conf argmin
+            \param keepSolver keep the solver alive for the next call,
+                only valid if model is the same object in the next call
+        */
+        void argmin(
+            const size_t slot,
+            const Model & model,
+            InferenceFactoryBase * inferenceFactory,
+            const WeightVector & weights,
+            ConfMap & conf,
+            const bool keepSolver = false
+        ){
+            INFERNO_CHECK_OP(slot, <, slots_.size(), "slot out of range");
+            auto & s = slots_[slot];
+
+            if(s.solver && (s.model != &model || s.inferenceFactory != inferenceFactory))
+                s.solver.reset();
+            if(s.solver){
+                try{
+                    s.solver->updateWeights(weights);
+                }
+                catch(const NotImplementedException & e){
+                    s.solver.reset();
+                    s.canKeepSolver = false;
+                }
+            }
+            if(!s.solver){
+                s.solver = inferenceFactory->create(model);
+                s.model = &model;
+                s.inferenceFactory = inferenceFactory;
+            }
+
+            if(s.hasConf)
+                s.solver->setConf(s.conf);
+            s.solver->infer();
+            s.solver->conf(conf);
+            s.conf = conf;
+            s.hasConf = true;
+
+            if(!keepSolver || !s.canKeepSolver)
+                s.solver.reset();
+        }
+
+        /** \brief argmin of model started from the last
+            labeling of a slot, the slot is not changed
+
+            Unlike argmin, the same slot can be used concurrently,
+            the labeling of the slot is set with setConf.
+        */
+        void argminFrom(
+            const size_t slot,
+            const Model & model,
+            InferenceFactoryBase * inferenceFactory,
+            ConfMap & conf
+        )const{
+            INFERNO_CHECK_OP(slot, <, slots_.size(), "slot out of range");
+            const auto & s = slots_[slot];
+            auto solver = inferenceFactory->create(model);
+            if(s.hasConf)
+                solver->setConf(s.conf);
+            solver->infer();
+            solver->conf(conf);
+        }
+
+        /// \brief set the labeling a slot is started from
+        void setConf(const size_t slot, const ConfMap & conf){
+            INFERNO_CHECK_OP(slot, <, slots_.size(), "slot out of range");
+            auto & s = slots_[slot];
+            s.conf = conf;
+            s.hasConf = true;
+        }
+
+    private:
+        struct Slot{
+            Slot()
+            :   solver(),
+                model(nullptr),
+                inferenceFactory(nullptr),
+                conf(),
+                hasConf(false),
+                canKeepSolver(true){
+            }
+            std::shared_ptr<InferenceBase> solver;
+            const Model * model;
+            InferenceFactoryBase * inferenceFactory;
+            ConfMap conf;
+            bool hasConf;
+            bool canKeepSolver;
+        };
+        std::vector<Slot> slots_;
+    };
+
+} // end namespace inferno::learning::learners
+} // end namespace inferno::learning
+} // end namespace inferno
+
+#endif /* INFERNO_LEARNING_LEARNERS_WARM_START_INFERENCE_HXX */
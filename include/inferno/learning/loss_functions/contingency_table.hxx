@@ -0,0 +1,797 @@
+/** \file contingency_table.hxx
+    \brief  Linear time kernels to compare two partitions:
+    inferno::learning::loss_functions::ContingencyTable
+    (variation of information, rand index) and
+    inferno::learning::loss_functions::EdgeConfusion
+    (partition hamming, partition f-score)
+    and their incremental counterparts
+    inferno::learning::loss_functions::IncrementalContingencyTable and
+    inferno::learning::loss_functions::IncrementalEdgeConfusion
+    which are used for loss augmented local search.
+*/
+#ifndef INFERNO_LEARNING_LOSS_FUNCTIONS_CONTINGENCY_TABLE_HXX
+#define INFERNO_LEARNING_LOSS_FUNCTIONS_CONTINGENCY_TABLE_HXX
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <functional>
+#include <unordered_map>
+
+#include "inferno/inferno.hxx"
+
+namespace inferno{
+namespace learning{
+namespace loss_functions{
+
+    /// \cond
+    namespace detail_contingency_table{
+
+        // open addressing (linear probing) map
+        // from 64 bit keys to dense ids 0,1,2,..
+        // which grows with the number of keys
+        class DenseIdMap{
+        public:
+            DenseIdMap()
+            :   keys_(),
+                ids_(),
+                mask_(0),
+                size_(0){
+            }
+
+            // forget all keys, the capacity
+            // of the last use is kept
+            void clear(){
+                if(ids_.empty()){
+                    keys_.resize(MinCapacity);
+                    ids_.assign(MinCapacity, empty());
+                    mask_ = MinCapacity - 1;
+                }
+                else{
+                    std::fill(ids_.begin(), ids_.end(), empty());
+                }
+                size_ = 0;
+            }
+
+            uint32_t operator()(const uint64_t key){
+                uint64_t pos = hash(key) & mask_;
+                while(ids_[pos] != empty()){
+                    if(keys_[pos] == key)
+                        return ids_[pos];
+                    pos = (pos + 1) & mask_;
+                }
+                // keep the load factor <= 1/2
+                if(2*(uint64_t(size_) + 1) > ids_.size()){
+                    this->grow();
+                    pos = this->findEmpty(key);
+                }
+                keys_[pos] = key;
+                ids_[pos] = size_;
+                return size_++;
+            }
+
+            uint32_t size()const{
+                return size_;
+            }
+        private:
+            static const uint64_t MinCapacity = 16;
+
+            static uint32_t empty(){
+                return std::numeric_limits<uint32_t>::max();
+            }
+
+            uint64_t findEmpty(const uint64_t key)const{
+                uint64_t pos = hash(key) & mask_;
+                while(ids_[pos] != empty())
+                    pos = (pos + 1) & mask_;
+                return pos;
+            }
+
+            void grow(){
+                std::vector<uint64_t> oldKeys(2*keys_.size());
+                std::vector<uint32_t> oldIds(2*ids_.size(), empty());
+                // the new (doubled) arrays become the members
+                oldKeys.swap(keys_);
+                oldIds.swap(ids_);
+                mask_ = ids_.size() - 1;
+                for(size_t i=0; i<oldIds.size(); ++i){
+                    if(oldIds[i] != empty()){
+                        const auto pos = this->findEmpty(oldKeys[i]);
+                        keys_[pos] = oldKeys[i];
+                        ids_[pos] = oldIds[i];
+                    }
+                }
+            }
+
+            static uint64_t hash(uint64_t key){
+                // finalizer of MurmurHash3
+                key ^= key >> 33;
+                key *= 0xff51afd7ed558ccdULL;
+                key ^= key >> 33;
+                key *= 0xc4ceb9fe1a85ec53ULL;
+                key ^= key >> 33;
+                return key;
+            }
+
+            std::vector<uint64_t> keys_;
+            std::vector<uint32_t> ids_;
+            uint64_t mask_;
+            uint32_t size_;
+        };
+
+        inline double xLogX(const double x){
+            return x > 0.0 ? x * std::log(x) : 0.0;
+        }
+
+        // size of a cluster / intersection and the number
+        // of variables in it (to detect empty clusters exactly)
+        struct ClusterSize{
+            ClusterSize()
+            :   size(0.0),
+                count(0){
+            }
+            double size;
+            uint64_t count;
+        };
+
+        struct JointKeyHash{
+            std::size_t operator()(const std::pair<uint64_t, DiscreteLabel> & key)const{
+                return std::hash<uint64_t>()(key.first * 0x9e3779b97f4a7c15ULL ^
+                                             static_cast<uint64_t>(key.second));
+            }
+        };
+
+    } // end namespace inferno::learning::loss_functions::detail_contingency_table
+    /// \endcond
+
+
+    /** \brief Contingency table of two partitions of the variables
+        of a model (ground truth and proposed labeling).
+
+        Both partitions are relabeled to dense cluster ids and the
+        (weighted) cluster sizes and the sizes of all non-empty
+        intersections are accumulated in flat arrays,
+        therefore filling the table is linear in the number
+        of variables.
+        All measures are computed from the same table.
+
+        The buffers (and the hash maps, which are sized by the
+        number of distinct labels) are reused if a table is
+        filled multiple times, a table must not be shared
+        between threads (see threadLocalContingencyTable).
+    */
+    class ContingencyTable{
+    public:
+        ContingencyTable()
+        :   gtIds_(),
+            confIds_(),
+            jointIds_(),
+            gtSizes_(),
+            confSizes_(),
+            jointSizes_(),
+            jointGt_(),
+            jointConf_(),
+            total_(0){
+        }
+
+        /** \brief fill the table
+
+            \param model the model
+            \param confGt ground truth labeling
+            \param conf proposed labeling
+            \param sizeMap weight ("size") of each variable
+            \param useIgnoreLabel ignore variables where
+                any of the labelings is ignoreLabel
+            \param ignoreLabel label to ignore
+        */
+        template<class MODEL, class CONF_GT, class CONF, class SIZE_MAP>
+        void fill(
+            const MODEL & model,
+            const CONF_GT & confGt,
+            const CONF & conf,
+            const SIZE_MAP & sizeMap,
+            const bool useIgnoreLabel = false,
+            const DiscreteLabel ignoreLabel = DiscreteLabel(-1)
+        ){
+            gtIds_.clear();
+            confIds_.clear();
+            jointIds_.clear();
+            gtSizes_.clear();
+            confSizes_.clear();
+            jointSizes_.clear();
+            jointGt_.clear();
+            jointConf_.clear();
+            total_ = 0.0;
+
+            for(const auto var : model.variableDescriptors()){
+                const auto lGt = confGt[var];
+                const auto l   = conf[var];
+                if(useIgnoreLabel && (lGt == ignoreLabel || l == ignoreLabel))
+                    continue;
+
+                const double size = sizeMap[var];
+                const auto gtId   = gtIds_(static_cast<uint64_t>(lGt));
+                const auto confId = confIds_(static_cast<uint64_t>(l));
+                if(gtId == gtSizes_.size())
+                    gtSizes_.push_back(0.0);
+                if(confId == confSizes_.size())
+                    confSizes_.push_back(0.0);
+
+                // dense ids are 32 bit, therefore the pair is unique
+                const auto jointId = jointIds_((uint64_t(gtId) << 32) | confId);
+                if(jointId == jointSizes_.size()){
+                    jointSizes_.push_back(0.0);
+                    jointGt_.push_back(gtId);
+                    jointConf_.push_back(confId);
+                }
+                gtSizes_[gtId] += size;
+                confSizes_[confId] += size;
+                jointSizes_[jointId] += size;
+                total_ += size;
+            }
+        }
+
+        /// \brief sum of the sizes of all non ignored variables
+        double total()const{
+            return total_;
+        }
+        /// \brief number of clusters in the ground truth
+        uint64_t nGtClusters()const{
+            return gtSizes_.size();
+        }
+        /// \brief number of clusters in the proposed labeling
+        uint64_t nClusters()const{
+            return confSizes_.size();
+        }
+        /// \brief number of non-empty intersections
+        uint64_t nIntersections()const{
+            return jointSizes_.size();
+        }
+
+        /** \brief variation of information
+            \f$ H(gt) + H(conf) - 2 I(gt, conf) \f$
+        */
+        double variationOfInformation()const{
+            auto entropy = [&](const std::vector<double> & sizes){
+                double h = 0.0;
+                for(const auto s : sizes){
+                    const auto p = s / total_;
+                    h -= p * std::log(p);
+                }
+                return h;
+            };
+            double I = 0.0;
+            for(size_t j=0; j<jointSizes_.size(); ++j){
+                const auto p   = jointSizes_[j] / total_;
+                const auto pGt = gtSizes_[jointGt_[j]] / total_;
+                const auto pC  = confSizes_[jointConf_[j]] / total_;
+                I += p * std::log(p / (pGt * pC));
+            }
+            return entropy(gtSizes_) + entropy(confSizes_) - 2.0 * I;
+        }
+
+        /// \brief rand index (1 means identical partitions)
+        double randIndex()const{
+            double a = 0.0;
+            double b = total_ * total_;
+            for(const auto val : jointSizes_){
+                a += val * (val - 1.0);
+                b += val * val;
+            }
+            for(const auto val : confSizes_)
+                b -= val * val;
+            for(const auto val : gtSizes_)
+                b -= val * val;
+            const auto matchingPairs = ((a + b) / 2.0);
+            return matchingPairs*2.0/(total_*(total_-1.0));
+        }
+
+    private:
+        detail_contingency_table::DenseIdMap gtIds_;
+        detail_contingency_table::DenseIdMap confIds_;
+        detail_contingency_table::DenseIdMap jointIds_;
+        std::vector<double> gtSizes_;
+        std::vector<double> confSizes_;
+        std::vector<double> jointSizes_;
+        std::vector<uint32_t> jointGt_;
+        std::vector<uint32_t> jointConf_;
+        double total_;
+    };
+
+    /** \brief a ContingencyTable for the calling thread,
+        the loss functions reuse its buffers for all evaluations
+    */
+    inline ContingencyTable & threadLocalContingencyTable(){
+        static thread_local ContingencyTable table;
+        return table;
+    }
+
+
+    /** \brief Contingency table of a fixed ground truth and a
+        labeling which changes by moving single variables.
+
+        The table stores the sums of \f$ n \log n \f$ and \f$ n^2 \f$
+        over the cluster sizes of the ground truth, the labeling and
+        their intersections.
+        Moving a variable from cluster \f$ a \f$ to cluster \f$ b \f$
+        changes only four entries of the table, therefore
+        the variation of information and the rand index
+        after a move can be computed in O(1) (expected,
+        the labeling clusters are stored in hash maps).
+
+        Labels of the labeling can be arbitrary, e.g. a move
+        to an unused label opens a new cluster.
+    */
+    template<class MODEL>
+    class IncrementalContingencyTable{
+    public:
+        typedef MODEL Model;
+        typedef typename Model::VariableDescriptor VariableDescriptor;
+        typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
+
+        IncrementalContingencyTable()
+        :   gtIds_(),
+            denseGtIds_(),
+            sizes_(),
+            conf_(),
+            gtSizes_(),
+            confSizes_(),
+            jointSizes_(),
+            useIgnoreLabel_(false),
+            ignoreLabel_(-1),
+            sums_(){
+        }
+
+        /** \brief set ground truth and initial labeling
+
+            \param model the model
+            \param confGt ground truth labeling
+            \param conf initial labeling
+            \param sizeMap weight ("size") of each variable
+            \param useIgnoreLabel ignore variables where
+                any of the labelings is ignoreLabel
+            \param ignoreLabel label to ignore
+
+            Complexity: O(|V|)
+        */
+        template<class CONF_GT, class CONF, class SIZE_MAP>
+        void reset(
+            const Model & model,
+            const CONF_GT & confGt,
+            const CONF & conf,
+            const SIZE_MAP & sizeMap,
+            const bool useIgnoreLabel = false,
+            const DiscreteLabel ignoreLabel = DiscreteLabel(-1)
+        ){
+            useIgnoreLabel_ = useIgnoreLabel;
+            ignoreLabel_ = ignoreLabel;
+            gtIds_.assign(model);
+            sizes_.assign(model);
+            conf_.assign(model);
+            gtSizes_.clear();
+            confSizes_.clear();
+            jointSizes_.clear();
+            sums_ = Sums();
+
+            // dense ground truth cluster ids, ignored variables get -1
+            denseGtIds_.clear();
+            for(const auto var : model.variableDescriptors()){
+                const auto lGt = confGt[var];
+                const auto l = conf[var];
+                const double s = sizeMap[var];
+                sizes_[var] = s;
+                conf_[var] = l;
+                if(useIgnoreLabel_ && lGt == ignoreLabel_){
+                    gtIds_[var] = -1;
+                    continue;
+                }
+                const auto gtId = denseGtIds_(static_cast<uint64_t>(lGt));
+                if(gtId == gtSizes_.size())
+                    gtSizes_.push_back(0.0);
+                gtIds_[var] = gtId;
+                if(this->isIgnoredLabel(l))
+                    continue;
+                gtSizes_[gtId] += s;
+                auto & confSize = confSizes_[l];
+                confSize.size += s;
+                ++confSize.count;
+                auto & jointSize = jointSizes_[JointKey(gtId, l)];
+                jointSize.size += s;
+                ++jointSize.count;
+                sums_.total += s;
+            }
+
+            auto accumulate = [](double & xLogX, double & square, const double val){
+                xLogX  += detail_contingency_table::xLogX(val);
+                square += val*val;
+            };
+            for(const auto val : gtSizes_)
+                accumulate(sums_.gtXLogX, sums_.gtSquare, val);
+            for(const auto & kv : confSizes_)
+                accumulate(sums_.confXLogX, sums_.confSquare, kv.second.size);
+            for(const auto & kv : jointSizes_)
+                accumulate(sums_.jointXLogX, sums_.jointSquare, kv.second.size);
+        }
+
+        /// \brief current label of a variable
+        DiscreteLabel label(const VariableDescriptor var)const{
+            return conf_[var];
+        }
+
+        /// \brief move var to the cluster with label
+        void move(const VariableDescriptor var, const DiscreteLabel label){
+            const auto oldLabel = conf_[var];
+            if(oldLabel == label)
+                return;
+            sums_ = this->sumsAfterMove(var, label);
+            conf_[var] = label;
+
+            const auto gtIdSigned = gtIds_[var];
+            if(gtIdSigned < 0)
+                return;
+            const auto gtId = static_cast<uint64_t>(gtIdSigned);
+            const auto s = sizes_[var];
+            if(!this->isIgnoredLabel(oldLabel)){
+                gtSizes_[gtId] -= s;
+                removeFrom(confSizes_, oldLabel, s);
+                removeFrom(jointSizes_, JointKey(gtId, oldLabel), s);
+            }
+            if(!this->isIgnoredLabel(label)){
+                gtSizes_[gtId] += s;
+                auto & confSize = confSizes_[label];
+                confSize.size += s;
+                ++confSize.count;
+                auto & jointSize = jointSizes_[JointKey(gtId, label)];
+                jointSize.size += s;
+                ++jointSize.count;
+            }
+        }
+
+        /// \brief variation of information of the current labeling
+        double variationOfInformation()const{
+            return variationOfInformation(sums_);
+        }
+        /// \brief variation of information if var would be moved to label
+        double variationOfInformationAfterMove(
+            const VariableDescriptor var, 
+            const DiscreteLabel label
+        )const{
+            return variationOfInformation(this->sumsAfterMove(var, label));
+        }
+
+        /// \brief rand index of the current labeling
+        double randIndex()const{
+            return randIndex(sums_);
+        }
+        /// \brief rand index if var would be moved to label
+        double randIndexAfterMove(
+            const VariableDescriptor var, 
+            const DiscreteLabel label
+        )const{
+            return randIndex(this->sumsAfterMove(var, label));
+        }
+
+    private:
+        typedef detail_contingency_table::ClusterSize ClusterSize;
+        typedef std::pair<uint64_t, DiscreteLabel> JointKey;
+        typedef std::unordered_map<DiscreteLabel, ClusterSize> ConfSizes;
+        typedef std::unordered_map<
+            JointKey, ClusterSize, detail_contingency_table::JointKeyHash
+        > JointSizes;
+
+        struct Sums{
+            Sums()
+            :   total(0.0),
+                gtXLogX(0.0),
+                gtSquare(0.0),
+                confXLogX(0.0),
+                confSquare(0.0),
+                jointXLogX(0.0),
+                jointSquare(0.0){
+            }
+            double total;
+            double gtXLogX;
+            double gtSquare;
+            double confXLogX;
+            double confSquare;
+            double jointXLogX;
+            double jointSquare;
+        };
+
+        static double variationOfInformation(const Sums & s){
+            // H(gt) + H(conf) - 2 I(gt, conf) expressed 
+            // with unnormalized cluster sizes
+            return (s.gtXLogX + s.confXLogX - 2.0*s.jointXLogX) / s.total;
+        }
+        static double randIndex(const Sums & s){
+            const auto a = s.jointSquare - s.total;
+            const auto b = s.total*s.total + s.jointSquare - s.confSquare - s.gtSquare;
+            return (a + b)/(s.total*(s.total-1.0));
+        }
+
+        static void change(double & xLogX, double & square, const double oldVal, const double newVal){
+            xLogX  += detail_contingency_table::xLogX(newVal) - detail_contingency_table::xLogX(oldVal);
+            square += newVal*newVal - oldVal*oldVal;
+        }
+
+        template<class MAP>
+        static double sizeOf(const MAP & map, const typename MAP::key_type & key){
+            const auto iter = map.find(key);
+            return iter == map.end() ? 0.0 : iter->second.size;
+        }
+
+        // size of a cluster after removing a variable of size s,
+        // clusters which become empty are exactly zero
+        template<class MAP>
+        static double sizeAfterRemove(const MAP & map, const typename MAP::key_type & key, const double s){
+            const auto & clusterSize = map.find(key)->second;
+            return clusterSize.count == 1 ? 0.0 : clusterSize.size - s;
+        }
+
+        template<class MAP>
+        static void removeFrom(MAP & map, const typename MAP::key_type & key, const double s){
+            const auto iter = map.find(key);
+            auto & clusterSize = iter->second;
+            if(--clusterSize.count == 0)
+                map.erase(iter);
+            else
+                clusterSize.size -= s;
+        }
+
+        bool isIgnoredLabel(const DiscreteLabel label)const{
+            return useIgnoreLabel_ && label == ignoreLabel_;
+        }
+
+        Sums sumsAfterMove(const VariableDescriptor var, const DiscreteLabel label)const{
+            Sums sums = sums_;
+            const auto oldLabel = conf_[var];
+            const auto gtIdSigned = gtIds_[var];
+            if(oldLabel == label || gtIdSigned < 0)
+                return sums;
+            const auto gtId = static_cast<uint64_t>(gtIdSigned);
+            const auto s = sizes_[var];
+            auto gtSize = gtSizes_[gtId];
+
+            // remove var from its clusters
+            if(!this->isIgnoredLabel(oldLabel)){
+                const JointKey jointKey(gtId, oldLabel);
+                sums.total -= s;
+                change(sums.gtXLogX, sums.gtSquare, gtSize, gtSize - s);
+                gtSize -= s;
+                change(sums.confXLogX, sums.confSquare, sizeOf(confSizes_, oldLabel),
+                       sizeAfterRemove(confSizes_, oldLabel, s));
+                change(sums.jointXLogX, sums.jointSquare, sizeOf(jointSizes_, jointKey),
+                       sizeAfterRemove(jointSizes_, jointKey, s));
+            }
+            // add var to the clusters of label,
+            // these are distinct from the clusters of oldLabel
+            if(!this->isIgnoredLabel(label)){
+                const JointKey jointKey(gtId, label);
+                const auto confSize = sizeOf(confSizes_, label);
+                const auto jointSize = sizeOf(jointSizes_, jointKey);
+                sums.total += s;
+                change(sums.gtXLogX, sums.gtSquare, gtSize, gtSize + s);
+                change(sums.confXLogX, sums.confSquare, confSize, confSize + s);
+                change(sums.jointXLogX, sums.jointSquare, jointSize, jointSize + s);
+            }
+            return sums;
+        }
+
+        typename Model:: template VariableMap<int64_t> gtIds_;
+        detail_contingency_table::DenseIdMap denseGtIds_;
+        typename Model:: template VariableMap<double> sizes_;
+        ConfMap conf_;
+        std::vector<double> gtSizes_;
+        ConfSizes confSizes_;
+        JointSizes jointSizes_;
+        bool useIgnoreLabel_;
+        DiscreteLabel ignoreLabel_;
+        Sums sums_;
+    };
+
+
+    /** \brief Weighted confusion of the second order factors (edges)
+        of a model w.r.t. two partitions.
+
+        An edge is positive if its variables are in different
+        clusters (a cut edge).
+        - truePositive : cut in both
+        - trueNegative : not cut in both
+        - falsePositive : cut in conf but not in the ground truth (oversegmentation)
+        - falseNegative : cut in the ground truth but not in conf (undersegmentation)
+    */
+    struct EdgeConfusion{
+        EdgeConfusion()
+        :   truePositive(0),
+            trueNegative(0),
+            falsePositive(0),
+            falseNegative(0){
+        }
+
+        /** \brief accumulate over all factors with arity 2
+
+            \param model the model
+            \param confGt ground truth labeling
+            \param conf proposed labeling
+            \param factorWeightMap weight of each factor
+            \param useIgnoreLabel ignore factors where
+                a variable has ignoreLabel in the ground truth
+            \param ignoreLabel label to ignore
+        */
+        template<class MODEL, class CONF_GT, class CONF, class FACTOR_WEIGHT_MAP>
+        void fill(
+            const MODEL & model,
+            const CONF_GT & confGt,
+            const CONF & conf,
+            const FACTOR_WEIGHT_MAP & factorWeightMap,
+            const bool useIgnoreLabel = false,
+            const DiscreteLabel ignoreLabel = DiscreteLabel(-1)
+        ){
+            truePositive = trueNegative = falsePositive = falseNegative = 0.0;
+            for(const auto fac : model.factorDescriptors()){
+                const auto factor = model.factor(fac);
+                if(factor->arity() != 2)
+                    continue;
+                const auto u = factor->variable(0);
+                const auto v = factor->variable(1);
+                const auto gtU = confGt[u];
+                const auto gtV = confGt[v];
+                if(useIgnoreLabel && (gtU == ignoreLabel || gtV == ignoreLabel))
+                    continue;
+                const double w = factorWeightMap[fac];
+                const bool cut = conf[u] != conf[v];
+                if(gtU == gtV){
+                    if(cut)
+                        falsePositive += w;
+                    else
+                        trueNegative += w;
+                }
+                else{
+                    if(cut)
+                        truePositive += w;
+                    else
+                        falseNegative += w;
+                }
+            }
+        }
+
+        double truePositive;
+        double trueNegative;
+        double falsePositive;
+        double falseNegative;
+    };
+
+
+    /** \brief EdgeConfusion of a fixed ground truth and a
+        labeling which changes by moving single variables.
+
+        The second order factors are stored as adjacency
+        of the variables, the confusion after moving a 
+        variable is computed in O(degree of the variable).
+    */
+    template<class MODEL>
+    class IncrementalEdgeConfusion{
+    public:
+        typedef MODEL Model;
+        typedef typename Model::VariableDescriptor VariableDescriptor;
+        typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
+
+        IncrementalEdgeConfusion()
+        :   adjacency_(),
+            conf_(),
+            confusion_(){
+        }
+
+        /** \brief set ground truth and initial labeling
+
+            \param model the model
+            \param confGt ground truth labeling
+            \param conf initial labeling
+            \param factorWeightMap weight of each factor
+            \param useIgnoreLabel ignore factors where
+                a variable has ignoreLabel in the ground truth
+            \param ignoreLabel label to ignore
+
+            Complexity: O(|V| + |F|)
+        */
+        template<class CONF_GT, class CONF, class FACTOR_WEIGHT_MAP>
+        void reset(
+            const Model & model,
+            const CONF_GT & confGt,
+            const CONF & conf,
+            const FACTOR_WEIGHT_MAP & factorWeightMap,
+            const bool useIgnoreLabel = false,
+            const DiscreteLabel ignoreLabel = DiscreteLabel(-1)
+        ){
+            adjacency_.assign(model);
+            conf_.assign(model);
+            for(const auto var : model.variableDescriptors())
+                conf_[var] = conf[var];
+            confusion_.fill(model, confGt, conf, factorWeightMap, useIgnoreLabel, ignoreLabel);
+
+            for(const auto fac : model.factorDescriptors()){
+                const auto factor = model.factor(fac);
+                if(factor->arity() != 2)
+                    continue;
+                const auto u = factor->variable(0);
+                const auto v = factor->variable(1);
+                const auto gtU = confGt[u];
+                const auto gtV = confGt[v];
+                if(useIgnoreLabel && (gtU == ignoreLabel || gtV == ignoreLabel))
+                    continue;
+                const double w = factorWeightMap[fac];
+                adjacency_[u].push_back(Edge(v, w, gtU != gtV));
+                adjacency_[v].push_back(Edge(u, w, gtU != gtV));
+            }
+        }
+
+        /// \brief current label of a variable
+        DiscreteLabel label(const VariableDescriptor var)const{
+            return conf_[var];
+        }
+
+        /// \brief confusion of the current labeling
+        const EdgeConfusion & confusion()const{
+            return confusion_;
+        }
+
+        /// \brief confusion if var would be moved to label
+        EdgeConfusion confusionAfterMove(
+            const VariableDescriptor var, 
+            const DiscreteLabel label
+        )const{
+            EdgeConfusion c = confusion_;
+            const auto oldLabel = conf_[var];
+            if(oldLabel == label)
+                return c;
+            for(const auto & edge : adjacency_[var]){
+                const auto otherLabel = conf_[edge.other];
+                const bool wasCut = oldLabel != otherLabel;
+                const bool isCut  = label != otherLabel;
+                if(wasCut == isCut)
+                    continue;
+                if(edge.gtCut){
+                    // true positive <-> false negative
+                    const double d = isCut ? edge.weight : -edge.weight;
+                    c.truePositive  += d;
+                    c.falseNegative -= d;
+                }
+                else{
+                    // false positive <-> true negative
+                    const double d = isCut ? edge.weight : -edge.weight;
+                    c.falsePositive += d;
+                    c.trueNegative  -= d;
+                }
+            }
+            return c;
+        }
+
+        /// \brief move var to the cluster with label
+        void move(const VariableDescriptor var, const DiscreteLabel label){
+            confusion_ = this->confusionAfterMove(var, label);
+            conf_[var] = label;
+        }
+
+    private:
+        struct Edge{
+            Edge(const VariableDescriptor o, const double w, const bool c)
+            :   other(o),
+                weight(w),
+                gtCut(c){
+            }
+            VariableDescriptor other;
+            double weight;
+            bool gtCut;
+        };
+        typename Model:: template VariableMap<std::vector<Edge> > adjacency_;
+        ConfMap conf_;
+        EdgeConfusion confusion_;
+    };
+
+} // end namespace inferno::learning::loss_functions
+} // end namespace inferno::learning
+} // end namespace inferno
+
+#endif /*INFERNO_LEARNING_LOSS_FUNCTIONS_CONTINGENCY_TABLE_HXX*/
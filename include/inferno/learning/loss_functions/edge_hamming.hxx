@@ -13,6 +13,7 @@
 #include "inferno/inferno.hxx"
 #include "inferno/utilities/arithmetic_map.hxx"
 #include "inferno/model/loss_augmented/edge_hamming_augmented_model.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
 
 namespace inferno{
 namespace learning{
@@ -96,29 +97,9 @@ namespace loss_functions{
 
         template<class CONF_GT, class CONF>
         LossType eval(const MODEL & model, CONF_GT & confGt, CONF & conf)const{
-            LossType totalLoss = 0;
-            for(const auto fac : model.factorDescriptors()){
-
-                const auto factor = model.factor(fac);
-                const auto weight = edgeLossWeightMap_[fac];
-                const auto u = factor->variable(0);
-                const auto v = factor->variable(1);
-
-                const auto luGt = confGt[u];
-                const auto lvGt = confGt[v];
-                const auto lu   = conf[u];
-                const auto lv   = conf[v];
-
-                if(!useIgnoreLabel_ || (luGt!=ignoreLabel_ && lvGt!=ignoreLabel_)){
-                    if( (luGt==lvGt) && (lu!=lv) ){
-                        totalLoss += weight*overseg_;
-                    }
-                    else if( (luGt!=lvGt) && (lu==lv) ){
-                        totalLoss += weight*underseg_;
-                    }
-                }
-            }
-            return totalLoss*rescale_;
+            EdgeConfusion c;
+            c.fill(model, confGt, conf, edgeLossWeightMap_, useIgnoreLabel_, ignoreLabel_);
+            return (c.falsePositive*overseg_ + c.falseNegative*underseg_)*rescale_;
         }
         void makeLossAugmentedModel(
             Model & model,
@@ -131,6 +112,13 @@ namespace loss_functions{
                                       useIgnoreLabel_, 
                                       ignoreLabel_);
         }
+        void updateLossAugmentedModel(
+            Model & model,
+            const ConfMap & gt,
+            LossAugmentedModel & lossAugmentedModel
+        )const{
+            lossAugmentedModel.refresh();
+        }
 
     private:
         FactorWeightMap edgeLossWeightMap_;
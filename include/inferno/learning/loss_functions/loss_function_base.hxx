@@ -1,12 +1,16 @@
 #ifndef INFERNO_LEARNING_LOSS_FUNCTIONS_BASE_HXX
 #define INFERNO_LEARNING_LOSS_FUNCTIONS_BASE_HXX
 
+// std
+#include <memory>
+
 // boost
 #include <boost/concept_check.hpp>
 
 // inferno
 #include "inferno/inferno.hxx"
 #include "inferno/learning/loss_functions/loss_functions.hxx"
+#include "inferno/model/loss_augmented/non_decomposable_loss_augmented_model.hxx"
 
 
 namespace inferno{
@@ -49,7 +53,113 @@ namespace loss_functions{
 
 
 
-    /// \base class for non decomposable loss functions
+    /** \brief loss of a fixed ground truth and a labeling
+        which changes by moving single variables
+
+        Used by loss augmented local search 
+        (see inference::LossAugmentedLocalSearch).
+    */
+    template<class MODEL>
+    class IncrementalLossBase{
+    public:
+        typedef MODEL Model;
+        typedef typename Model::VariableDescriptor VariableDescriptor;
+        typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
+
+        virtual ~IncrementalLossBase(){
+        }
+
+        /// \brief set the current labeling
+        virtual void reset(const ConfMap & conf) = 0;
+
+        /// \brief loss of the current labeling
+        virtual LossType loss()const = 0;
+
+        /// \brief loss if var would be moved to label
+        virtual LossType lossAfterMove(
+            const VariableDescriptor var, 
+            const DiscreteLabel label
+        ) = 0;
+
+        /// \brief move var to label
+        virtual void move(
+            const VariableDescriptor var, 
+            const DiscreteLabel label
+        ) = 0;
+    };
+
+    /// \cond
+    namespace detail_loss_function_base{
+
+        // evaluates the full loss for each move,
+        // used for losses without an incremental implementation
+        template<class LOSS_FUNCTION>
+        class EvalIncrementalLoss : 
+            public IncrementalLossBase<typename LOSS_FUNCTION::Model>
+        {
+        public:
+            typedef typename LOSS_FUNCTION::Model Model;
+            typedef IncrementalLossBase<Model> Base;
+            typedef typename Base::VariableDescriptor VariableDescriptor;
+            typedef typename Base::ConfMap ConfMap;
+
+            EvalIncrementalLoss(
+                const LOSS_FUNCTION & lossFunction,
+                const Model & model,
+                const ConfMap & gt
+            )
+            :   lossFunction_(lossFunction),
+                model_(model),
+                gt_(gt),
+                conf_(model),
+                loss_(0){
+            }
+
+            virtual void reset(const ConfMap & conf) override {
+                for(const auto var : model_.variableDescriptors())
+                    conf_[var] = conf[var];
+                loss_ = lossFunction_.eval(model_, gt_, conf_);
+            }
+            virtual LossType loss()const override {
+                return loss_;
+            }
+            virtual LossType lossAfterMove(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                const auto oldLabel = conf_[var];
+                conf_[var] = label;
+                const auto loss = lossFunction_.eval(model_, gt_, conf_);
+                conf_[var] = oldLabel;
+                return loss;
+            }
+            virtual void move(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                loss_ = this->lossAfterMove(var, label);
+                conf_[var] = label;
+            }
+        private:
+            const LOSS_FUNCTION & lossFunction_;
+            const Model & model_;
+            const ConfMap & gt_;
+            ConfMap conf_;
+            LossType loss_;
+        };
+
+    } // end namespace inferno::learning::loss_functions::detail_loss_function_base
+    /// \endcond
+
+
+    /** \brief base class for non decomposable loss functions
+
+        The loss augmented model is a view on the 
+        lossless model (see models::NonDecomposableLossAugmentedModel),
+        loss augmented inference is done by local search
+        (see inference::LossAugmentedLocalSearch)
+        on top of NonDecomposableLossFunctionBase::incrementalLoss.
+    */
     template<class MODEL>
     class NonDecomposableLossFunctionBase : 
         public LossFunctionBase<MODEL>
@@ -58,10 +168,50 @@ namespace loss_functions{
     public:
         typedef MODEL Model;
         typedef typename Model:: template VariableMap<DiscreteLabel> ConfMap;
-        typedef NoLossAugmentedModel LossAugmentedModel;
+        typedef models::NonDecomposableLossAugmentedModel<Model> LossAugmentedModel;
+        typedef IncrementalLossBase<Model> IncrementalLoss;
 
         virtual ~NonDecomposableLossFunctionBase(){
         }
+
+        // make the loss augmented model
+        virtual void makeLossAugmentedModel(
+            const Model & model, 
+            const ConfMap & gt, 
+            LossAugmentedModel & lossAugmentedModel
+        ) const {
+            lossAugmentedModel.assign(model, gt, *this);
+        }
+
+        /** \brief update a loss augmented model after the
+            weights of model have changed
+
+            The loss augmented model is a view, 
+            there is nothing to update.
+        */
+        virtual void updateLossAugmentedModel(
+            const Model & , 
+            const ConfMap & , 
+            LossAugmentedModel & 
+        ) const {
+        }
+
+        /** \brief incremental evaluation of the loss w.r.t. gt
+
+            The default implementation evaluates the
+            full loss for each move, derived classes should
+            provide an O(1) (or O(degree)) implementation.
+            model and gt must outlive the returned object.
+        */
+        virtual std::unique_ptr<IncrementalLoss> incrementalLoss(
+            const Model & model, 
+            const ConfMap & gt
+        ) const {
+            typedef detail_loss_function_base::EvalIncrementalLoss<
+                NonDecomposableLossFunctionBase<Model> 
+            > EvalIncrementalLoss;
+            return std::unique_ptr<IncrementalLoss>(new EvalIncrementalLoss(*this, model, gt));
+        }
     private:
         
     };
@@ -87,6 +237,21 @@ namespace loss_functions{
             const ConfMap & gt, 
             LossAugmentedModel & lossAugmentedModel
         ) const = 0;
+
+        /** \brief update a loss augmented model after the
+            weights of model have changed
+
+            lossAugmentedModel has been made by makeLossAugmentedModel
+            with the same model and ground truth.
+            The default implementation remakes the loss augmented model.
+        */
+        virtual void updateLossAugmentedModel(
+            const Model & model, 
+            const ConfMap & gt, 
+            LossAugmentedModel & lossAugmentedModel
+        ) const {
+            this->makeLossAugmentedModel(model, gt, lossAugmentedModel);
+        }
     private:
         
     };
@@ -12,6 +12,7 @@
 // inferno
 #include "inferno/inferno.hxx"
 #include "inferno/utilities/arithmetic_map.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
 
 
 namespace inferno{
@@ -186,80 +187,9 @@ namespace loss_functions{
             const ConfMap & confGt, 
             const ConfMap & conf
         )const{
-
-            typedef std::pair<DiscreteLabel, DiscreteLabel>       LabelPair;
-            typedef ArithmeticOrderedMap<LabelPair, double>     LMatrix;
-            typedef ArithmeticOrderedMap<DiscreteLabel, double> LVector;
-
-            LVector vConfGt;
-            LVector vConf;
-            LMatrix mat;
-            double accSize = 0;
-            for(auto var : model.variableDescriptors()){
-
-                // get labels
-                const auto lConfGt = confGt[var];
-                const auto lConf   = conf[var];
-
-                // if not ignore label
-                if(!ignoreLabel_ || (lConfGt!=ignoreLabel_ && lConf!=ignoreLabel_)){
-
-                    // "size" of node
-                    const auto  size = variableSizeMap_[var];
-                    vConfGt[lConfGt] += size;
-                    vConf[lConf]     += size;
-                    mat[LabelPair(lConfGt,lConf)] += size;
-                    accSize += size;
-                }
-            }
-        
-            if(false){
-                // normalize
-                vConfGt/=accSize;
-                vConf/=accSize;
-                mat/=accSize;
-
-                // entropy
-                auto computeEntropy = [&](const LVector & lvec){
-                    double h = 0.0;
-                    for(const auto & kv: lvec)
-                        h -= kv.second * std::log(kv.second);
-                    return h;
-                };
-                double hConfGt = computeEntropy(vConfGt);
-                double hConf   = computeEntropy(vConf);
-
-                double I = 0.0;
-                for(const auto & kv : mat){
-                    const auto lConfGt = kv.first.first;
-                    const auto lConf   = kv.first.second;
-                    const auto valVConfGt = vConfGt[lConfGt];
-                    const auto valVConf   = vConf[lConf];
-                    const auto valMat     = kv.second;
-                    I += valMat * std::log(valMat / (valVConfGt * valVConf));
-                }
-                return hConfGt + hConf - 2.0 * I;
-            }
-            else{
-                double a = 0.0;
-                double b = accSize * accSize;
-                for(const auto kv : mat){
-                    const auto val = kv.second;
-                    a += val * (val - 1.0);
-                    b += val * val;
-                }
-                for(const auto kv : vConf){
-                    const auto val = kv.second;
-                    b -= val * val;
-                }
-                for(const auto kv : vConfGt){
-                    const auto val = kv.second;
-                    b -= val * val;
-                }
-                const auto matchingPairs = ((a + b) / 2.0);
-                const auto ri = matchingPairs*2.0/(accSize*(accSize-1.0));
-                return 1.0 - ri;
-            }
+            auto & table = threadLocalContingencyTable();
+            table.fill(model, confGt, conf, variableSizeMap_, useIgnoreLabel_, ignoreLabel_);
+            return 1.0 - table.randIndex();
         }
 
         LossType fScore(
@@ -267,49 +197,11 @@ namespace loss_functions{
             const ConfMap & confGt, 
             const ConfMap & conf
         )const{
-
+            EdgeConfusion c;
+            c.fill(model, confGt, conf, factorWeightMap_, useIgnoreLabel_, ignoreLabel_);
             const auto sB = beta_*beta_;
-            double truePositive = 0;
-            double trueNegative = 0;
-            double falsePositive = 0;
-            double falseNegative = 0;
-            for(const auto fac : model.factorDescriptors()){
-                const auto factor = model.factor(fac);
-
-
-
-                if(factor->arity() == 2){
-                    const auto u = factor->variable(0);
-                    const auto v = factor->variable(1);
-                    const auto fWeight = factorWeightMap_[fac];
-                    const auto gtU = confGt[u];
-                    const auto gtV = confGt[v];
-                    const auto cU = conf[u];
-                    const auto cV = conf[v];
-                    //std::cout<<"f weight "<<fWeight<<"\n";
-                    if(!useIgnoreLabel_ || (gtU != ignoreLabel_ && gtV != ignoreLabel_)){
-                        if(gtU == gtV){
-                            if(cU == cV)
-                                trueNegative += fWeight;
-                            else
-                                falsePositive += fWeight;
-                        }
-                        else{
-                            if(cU == cV)
-                                falseNegative += fWeight;
-                            else
-                                truePositive += fWeight;
-                        }
-                    }
-                }
-            }
-            //std::cout<<"tp "<<truePositive<<"\n";
-            //std::cout<<"tn "<<trueNegative<<"\n";
-            //std::cout<<"fp "<<falsePositive<<"\n";
-            //std::cout<<"fn "<<falseNegative<<"\n";
-
-            auto score =  (1.0 + sB) * truePositive  /
-            ( (1.0+sB)*truePositive + sB*falseNegative + falsePositive);
+            auto score =  (1.0 + sB) * c.truePositive  /
+            ( (1.0+sB)*c.truePositive + sB*c.falseNegative + c.falsePositive);
             return 1.0 - score;
         }
 
@@ -13,6 +13,7 @@
 #include "inferno/inferno.hxx"
 #include "inferno/learning/loss_functions/loss_functions.hxx"
 #include "inferno/learning/loss_functions/loss_function_base.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
 
 namespace inferno{
 namespace learning{
@@ -26,6 +27,7 @@ namespace loss_functions{
         typedef typename Base::Model Model;
         typedef typename Base::ConfMap ConfMap;
         typedef typename Base::LossAugmentedModel LossAugmentedModel;
+        typedef typename Base::IncrementalLoss IncrementalLoss;
 
         // specific typedef for fscore
         typedef typename Model:: template FactorMap<double> FactorWeightMap;
@@ -70,55 +72,72 @@ namespace loss_functions{
             const ConfMap & confGt, 
             const ConfMap & conf
         ) const override {
-            const auto sB = beta_*beta_;
-            double truePositive = 0;
-            double trueNegative = 0;
-            double falsePositive = 0;
-            double falseNegative = 0;
-            for(const auto fac : model.factorDescriptors()){
-                const auto factor = model.factor(fac);
-
-                if(factor->arity() == 2){
-                    const auto u = factor->variable(0);
-                    const auto v = factor->variable(1);
-                    //std::cout<<"get weight\n";
-                    const auto fWeight = factorWeightMap_[fac];
-                    //std::cout<<"next step\n";
-                    const auto gtU = confGt[u];
-                    const auto gtV = confGt[v];
-                    const auto cU = conf[u];
-                    const auto cV = conf[v];
-                    //std::cout<<"f weight "<<fWeight<<"\n";
-                    if(!useIgnoreLabel_ || (gtU != ignoreLabel_ && gtV != ignoreLabel_)){
-                        if(gtU == gtV){
-                            if(cU == cV)
-                                trueNegative += fWeight;
-                            else
-                                falsePositive += fWeight;
-                        }
-                        else{
-                            if(cU == cV)
-                                falseNegative += fWeight;
-                            else
-                                truePositive += fWeight;
-                        }
-                    }
-                }
-            }
-            if(falseNegative <= 0.00000000001 && falsePositive <= 0.00000000001 ){
-                return 1.0;
-            }
-            else{
-                auto score =  (1.0 + sB) * truePositive  /
-                ( (1.0+sB)*truePositive + sB*falseNegative + falsePositive);
-                return 1.0 - score;
-            }
+            EdgeConfusion c;
+            c.fill(model, confGt, conf, factorWeightMap_, useIgnoreLabel_, ignoreLabel_);
+            return this->lossFromConfusion(c);
         }
 
         virtual LossType maximumLoss()const override{
             return 1.0;
         }
+
+        virtual std::unique_ptr<IncrementalLoss> incrementalLoss(
+            const Model & model, 
+            const ConfMap & gt
+        ) const override {
+            return std::unique_ptr<IncrementalLoss>(new Incremental(*this, model, gt));
+        }
+
     private:
+        LossType lossFromConfusion(const EdgeConfusion & c)const{
+            if(c.falseNegative <= 0.00000000001 && c.falsePositive <= 0.00000000001 ){
+                // perfect score
+                return 0.0;
+            }
+            else{
+                const auto sB = beta_*beta_;
+                auto score =  (1.0 + sB) * c.truePositive  /
+                ( (1.0+sB)*c.truePositive + sB*c.falseNegative + c.falsePositive);
+                return 1.0 - score;
+            }
+        }
+
+        // O(degree) loss after moving a single variable
+        class Incremental : public IncrementalLoss{
+        public:
+            typedef typename IncrementalLoss::VariableDescriptor VariableDescriptor;
+            Incremental(const PartitionFScore & lossFunction, const Model & model, const ConfMap & gt)
+            :   lossFunction_(lossFunction),
+                model_(model),
+                gt_(gt),
+                confusion_(){
+            }
+            virtual void reset(const ConfMap & conf) override {
+                confusion_.reset(model_, gt_, conf, lossFunction_.factorWeightMap_,
+                             lossFunction_.useIgnoreLabel_, lossFunction_.ignoreLabel_);
+            }
+            virtual LossType loss()const override {
+                return lossFunction_.lossFromConfusion(confusion_.confusion());
+            }
+            virtual LossType lossAfterMove(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                return lossFunction_.lossFromConfusion(confusion_.confusionAfterMove(var, label));
+            }
+            virtual void move(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                confusion_.move(var, label);
+            }
+        private:
+            const PartitionFScore & lossFunction_;
+            const Model & model_;
+            const ConfMap & gt_;
+            IncrementalEdgeConfusion<Model> confusion_;
+        };
+
         FactorWeightMap factorWeightMap_;
         double beta_;
         bool useIgnoreLabel_;
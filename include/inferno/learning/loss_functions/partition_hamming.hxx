@@ -14,6 +14,7 @@
 #include "inferno/utilities/arithmetic_map.hxx"
 #include "inferno/model/loss_augmented/edge_hamming_augmented_model.hxx"
 #include "inferno/learning/loss_functions/loss_function_base.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
 
 namespace inferno{
 namespace learning{
@@ -115,29 +116,9 @@ namespace loss_functions{
             return "PartitionHamming";
         }
         virtual LossType eval(const Model & model, const ConfMap & confGt, const ConfMap & conf)const override{
-            LossType totalLoss = 0;
-            for(const auto fac : model.factorDescriptors()){
-
-                const auto factor = model.factor(fac);
-                const auto weight = factorWeightMap_[fac];
-                const auto u = factor->variable(0);
-                const auto v = factor->variable(1);
-
-                const auto luGt = confGt[u];
-                const auto lvGt = confGt[v];
-                const auto lu   = conf[u];
-                const auto lv   = conf[v];
-
-                if(!useIgnoreLabel_ || (luGt!=ignoreLabel_ && lvGt!=ignoreLabel_)){
-                    if( (luGt==lvGt) && (lu!=lv) ){
-                        totalLoss += weight*overseg_;
-                    }
-                    else if( (luGt!=lvGt) && (lu==lv) ){
-                        totalLoss += weight*underseg_;
-                    }
-                }
-            }
-            return totalLoss*rescale_;
+            EdgeConfusion c;
+            c.fill(model, confGt, conf, factorWeightMap_, useIgnoreLabel_, ignoreLabel_);
+            return (c.falsePositive*overseg_ + c.falseNegative*underseg_)*rescale_;
         }
 
         virtual void makeLossAugmentedModel(
@@ -152,6 +133,14 @@ namespace loss_functions{
                                       ignoreLabel_);
         }
 
+        virtual void updateLossAugmentedModel(
+            const Model & ,
+            const ConfMap & ,
+            LossAugmentedModel & lossAugmentedModel
+        )const override{
+            lossAugmentedModel.refresh();
+        }
+
     private:
         FactorWeightMap factorWeightMap_;
         double rescale_;
@@ -12,6 +12,7 @@
 #include "inferno/inferno.hxx"
 #include "inferno/learning/loss_functions/loss_functions.hxx"
 #include "inferno/learning/loss_functions/loss_function_base.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
 
 namespace inferno{
 namespace learning{
@@ -25,6 +26,7 @@ namespace loss_functions{
         typedef typename Base::Model Model;
         typedef typename Base::ConfMap ConfMap;
         typedef typename Base::LossAugmentedModel LossAugmentedModel;
+        typedef typename Base::IncrementalLoss IncrementalLoss;
 
         // specific typedef for randindex
         typedef typename Model:: template VariableMap<double> VariableSizeMap; 
@@ -67,55 +69,55 @@ namespace loss_functions{
             const ConfMap & confGt, 
             const ConfMap & conf
         ) const override {
-            typedef std::pair<DiscreteLabel, DiscreteLabel>       LabelPair;
-            typedef ArithmeticOrderedMap<LabelPair, double>     LMatrix;
-            typedef ArithmeticOrderedMap<DiscreteLabel, double> LVector;
-
-            LVector vConfGt;
-            LVector vConf;
-            LMatrix mat;
-            double accSize = 0;
-            for(auto var : model.variableDescriptors()){
-
-                // get labels
-                const auto lConfGt = confGt[var];
-                const auto lConf   = conf[var];
-
-                // if not ignore label
-                if(!ignoreLabel_ || (lConfGt!=ignoreLabel_ && lConf!=ignoreLabel_)){
-
-                    // "size" of node
-                    const auto  size = variableSizeMap_[var];
-                    vConfGt[lConfGt] += size;
-                    vConf[lConf]     += size;
-                    mat[LabelPair(lConfGt,lConf)] += size;
-                    accSize += size;
-                }
-            }
-        
+            auto & table = threadLocalContingencyTable();
+            table.fill(model, confGt, conf, variableSizeMap_, useIgnoreLabel_, ignoreLabel_);
+            return 1.0 - table.randIndex();
+        }
+
+        virtual std::unique_ptr<IncrementalLoss> incrementalLoss(
+            const Model & model, 
+            const ConfMap & gt
+        ) const override {
+            return std::unique_ptr<IncrementalLoss>(new Incremental(*this, model, gt));
+        }
 
-            double a = 0.0;
-            double b = accSize * accSize;
-            for(const auto kv : mat){
-                const auto val = kv.second;
-                a += val * (val - 1.0);
-                b += val * val;
+    private:
+        // O(1) loss after moving a single variable
+        class Incremental : public IncrementalLoss{
+        public:
+            typedef typename IncrementalLoss::VariableDescriptor VariableDescriptor;
+            Incremental(const RandIndex & lossFunction, const Model & model, const ConfMap & gt)
+            :   lossFunction_(lossFunction),
+                model_(model),
+                gt_(gt),
+                table_(){
             }
-            for(const auto kv : vConf){
-                const auto val = kv.second;
-                b -= val * val;
+            virtual void reset(const ConfMap & conf) override {
+                table_.reset(model_, gt_, conf, lossFunction_.variableSizeMap_,
+                             lossFunction_.useIgnoreLabel_, lossFunction_.ignoreLabel_);
             }
-            for(const auto kv : vConfGt){
-                const auto val = kv.second;
-                b -= val * val;
+            virtual LossType loss()const override {
+                return 1.0 - table_.randIndex();
             }
-            const auto matchingPairs = ((a + b) / 2.0);
-            const auto ri = matchingPairs*2.0/(accSize*(accSize-1.0));
-            return 1.0 - ri;
-
-        }
+            virtual LossType lossAfterMove(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                return 1.0 - table_.randIndexAfterMove(var, label);
+            }
+            virtual void move(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                table_.move(var, label);
+            }
+        private:
+            const RandIndex & lossFunction_;
+            const Model & model_;
+            const ConfMap & gt_;
+            IncrementalContingencyTable<Model> table_;
+        };
 
-    private:
         VariableSizeMap variableSizeMap_;
         bool useIgnoreLabel_;
         DiscreteLabel ignoreLabel_;
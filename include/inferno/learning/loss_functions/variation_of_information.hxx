@@ -12,6 +12,7 @@
 #include "inferno/inferno.hxx"
 #include "inferno/learning/loss_functions/loss_functions.hxx"
 #include "inferno/learning/loss_functions/loss_function_base.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
 
 namespace inferno{
 namespace learning{
@@ -25,6 +26,7 @@ namespace loss_functions{
         typedef typename Base::Model Model;
         typedef typename Base::ConfMap ConfMap;
         typedef typename Base::LossAugmentedModel LossAugmentedModel;
+        typedef typename Base::IncrementalLoss IncrementalLoss;
 
         // specific typedef for variation of information
         typedef typename Model:: template VariableMap<double> VariableSizeMap; 
@@ -67,62 +69,55 @@ namespace loss_functions{
             const ConfMap & confGt, 
             const ConfMap & conf
         ) const override {
-            typedef std::pair<DiscreteLabel, DiscreteLabel>       LabelPair;
-            typedef ArithmeticOrderedMap<LabelPair, double>     LMatrix;
-            typedef ArithmeticOrderedMap<DiscreteLabel, double> LVector;
-
-            LVector vConfGt;
-            LVector vConf;
-            LMatrix mat;
-            double accSize = 0;
-            for(auto var : model.variableDescriptors()){
-
-                // get labels
-                const auto lConfGt = confGt[var];
-                const auto lConf   = conf[var];
-
-                // if not ignore label
-                if(!ignoreLabel_ || (lConfGt!=ignoreLabel_ && lConf!=ignoreLabel_)){
-
-                    // "size" of node
-                    const auto  size = variableSizeMap_[var];
-                    vConfGt[lConfGt] += size;
-                    vConf[lConf]     += size;
-                    mat[LabelPair(lConfGt,lConf)] += size;
-                    accSize += size;
-                }
-            }
-        
-
-            // normalize
-            vConfGt/=accSize;
-            vConf/=accSize;
-            mat/=accSize;
-
-            // entropy
-            auto computeEntropy = [&](const LVector & lvec){
-                double h = 0.0;
-                for(const auto & kv: lvec)
-                    h -= kv.second * std::log(kv.second);
-                return h;
-            };
-            double hConfGt = computeEntropy(vConfGt);
-            double hConf   = computeEntropy(vConf);
-
-            double I = 0.0;
-            for(const auto & kv : mat){
-                const auto lConfGt = kv.first.first;
-                const auto lConf   = kv.first.second;
-                const auto valVConfGt = vConfGt[lConfGt];
-                const auto valVConf   = vConf[lConf];
-                const auto valMat     = kv.second;
-                I += valMat * std::log(valMat / (valVConfGt * valVConf));
-            }
-            return hConfGt + hConf - 2.0 * I;
+            auto & table = threadLocalContingencyTable();
+            table.fill(model, confGt, conf, variableSizeMap_, useIgnoreLabel_, ignoreLabel_);
+            return table.variationOfInformation();
+        }
 
+        virtual std::unique_ptr<IncrementalLoss> incrementalLoss(
+            const Model & model, 
+            const ConfMap & gt
+        ) const override {
+            return std::unique_ptr<IncrementalLoss>(new Incremental(*this, model, gt));
         }
 
     private:
+        // O(1) loss after moving a single variable
+        class Incremental : public IncrementalLoss{
+        public:
+            typedef typename IncrementalLoss::VariableDescriptor VariableDescriptor;
+            Incremental(const VariationOfInformation2 & lossFunction, const Model & model, const ConfMap & gt)
+            :   lossFunction_(lossFunction),
+                model_(model),
+                gt_(gt),
+                table_(){
+            }
+            virtual void reset(const ConfMap & conf) override {
+                table_.reset(model_, gt_, conf, lossFunction_.variableSizeMap_,
+                             lossFunction_.useIgnoreLabel_, lossFunction_.ignoreLabel_);
+            }
+            virtual LossType loss()const override {
+                return table_.variationOfInformation();
+            }
+            virtual LossType lossAfterMove(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                return table_.variationOfInformationAfterMove(var, label);
+            }
+            virtual void move(
+                const VariableDescriptor var, 
+                const DiscreteLabel label
+            ) override {
+                table_.move(var, label);
+            }
+        private:
+            const VariationOfInformation2 & lossFunction_;
+            const Model & model_;
+            const ConfMap & gt_;
+            IncrementalContingencyTable<Model> table_;
+        };
+
         VariableSizeMap variableSizeMap_;
         bool useIgnoreLabel_;
         DiscreteLabel ignoreLabel_;
@@ -121,6 +121,7 @@ namespace learning{
                 INFERNO_CHECK_OP(w.size(),== ,n.size(),"");
                 for(size_t wi=0; wi<w.size(); ++wi){
                     n[wi] = functor();
+                    w[wi] = source[wi] + n[wi];
                 }
 
                 // fix bounded weights
@@ -0,0 +1,194 @@
+/** \file perturbation_matrix.hxx
+    \brief  Implementation of inferno::learning::weights::PerturbationMatrix,
+    the perturbed weight vectors of the loss evaluating learners
+    stored in contiguous memory.
+*/
+#ifndef INFERNO_LEARNING_WEIGHTS_PERTURBATION_MATRIX_HXX
+#define INFERNO_LEARNING_WEIGHTS_PERTURBATION_MATRIX_HXX
+
+// std
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+// inferno
+#include "inferno/inferno.hxx"
+#include "inferno/learning/weights.hxx"
+#include "inferno/utilities/counter_based_random.hxx"
+
+namespace inferno{
+namespace learning{
+namespace weights{
+
+
+    /** \brief Perturbed weight vectors and their noise
+        as two contiguous row major matrices
+        (one row per perturbation).
+
+        The noise is drawn with a utilities::CounterBasedRandom,
+        row p of a perturbation only depends on the seed,
+        the key of the perturbation (e.g. the iteration) and p.
+        Therefore the perturbations are reproducible and
+        rows can be generated by any thread (see PerturbationMatrix::perturbRow).
+
+        The bounds of the weight constraints are converted
+        to dense vectors once (PerturbationMatrix::setBounds)
+        and applied to whole rows.
+        The noise of a clamped weight is the difference between
+        the clamped and the unperturbed weight.
+    */
+    class PerturbationMatrix{
+    public:
+        PerturbationMatrix(
+            const size_t nPerturbations = 0,
+            const size_t nWeights = 0,
+            const uint64_t seed = 0
+        )
+        :   nPerturbations_(nPerturbations),
+            nWeights_(nWeights),
+            weights_(nPerturbations*nWeights, 0.0),
+            noise_(nPerturbations*nWeights, 0.0),
+            lowerBounds_(nWeights, -1.0*std::numeric_limits<WeightType>::infinity()),
+            upperBounds_(nWeights,  std::numeric_limits<WeightType>::infinity()),
+            hasBounds_(false),
+            random_(seed){
+        }
+
+        template<class WEIGHT_CONSTRAINTS>
+        void setBounds(const WEIGHT_CONSTRAINTS & weightConstraints){
+            std::fill(lowerBounds_.begin(), lowerBounds_.end(), -1.0*std::numeric_limits<WeightType>::infinity());
+            std::fill(upperBounds_.begin(), upperBounds_.end(), std::numeric_limits<WeightType>::infinity());
+            hasBounds_ = false;
+            for(const auto & kv : weightConstraints.weightBounds()){
+                INFERNO_CHECK_OP(kv.first, <, nWeights_, "weight bound of a non existing weight");
+                lowerBounds_[kv.first] = kv.second.first;
+                upperBounds_[kv.first] = kv.second.second;
+                hasBounds_ = true;
+            }
+        }
+
+        size_t nPerturbations()const{
+            return nPerturbations_;
+        }
+        size_t nWeights()const{
+            return nWeights_;
+        }
+        size_t size()const{
+            return nPerturbations_;
+        }
+
+        /** \brief perturb the weights of all rows
+
+            weights(p) = clamp(source + sigma * N(0,1))
+        */
+        void perturb(const WeightVector & source, const double sigma, const uint64_t key){
+            for(size_t p=0; p<nPerturbations_; ++p)
+                this->perturbRow(source, sigma, key, p);
+        }
+
+        /// \brief perturb the weights of row p (independent of all other rows)
+        void perturbRow(const WeightVector & source, const double sigma, const uint64_t key, const size_t p){
+            INFERNO_CHECK_OP(size_t(source.size()), ==, nWeights_, "");
+            auto w = this->weights(p);
+            auto n = this->noise(p);
+            random_.normal(random_.stream(key, p), nWeights_, n, 0.0, sigma);
+            for(size_t wi=0; wi<nWeights_; ++wi)
+                w[wi] = source[wi] + n[wi];
+            if(hasBounds_){
+                for(size_t wi=0; wi<nWeights_; ++wi){
+                    w[wi] = std::min(upperBounds_[wi], std::max(lowerBounds_[wi], w[wi]));
+                    n[wi] = w[wi] - source[wi];
+                }
+            }
+        }
+
+        /** \brief gaussian weights with a mean and standard deviation per weight
+
+            weights(p) = clamp(means + sigmas * N(0,1)), the
+            noise is the difference to the means
+        */
+        template<class MEANS, class SIGMAS>
+        void gaussianWeights(const MEANS & means, const SIGMAS & sigmas, const uint64_t key){
+            INFERNO_CHECK_OP(means.size(), ==, nWeights_, "");
+            INFERNO_CHECK_OP(sigmas.size(), ==, nWeights_, "");
+            for(size_t p=0; p<nPerturbations_; ++p){
+                auto w = this->weights(p);
+                auto n = this->noise(p);
+                random_.normal(random_.stream(key, p), nWeights_, n);
+                for(size_t wi=0; wi<nWeights_; ++wi){
+                    n[wi] *= sigmas[wi];
+                    w[wi] = std::min(upperBounds_[wi], std::max(lowerBounds_[wi], means[wi] + n[wi]));
+                    n[wi] = w[wi] - means[wi];
+                }
+            }
+        }
+
+        /// \brief \f$ sum \mathrel{+}= \sum_p coefficients_p \, noise(p) \f$
+        template<class COEFFICIENTS>
+        void weightedNoiseSum(const COEFFICIENTS & coefficients, WeightVector & sum)const{
+            weightedRowSum(noise_, coefficients, sum);
+        }
+
+        /// \brief \f$ sum \mathrel{+}= \sum_p coefficients_p \, weights(p) \f$
+        template<class COEFFICIENTS>
+        void weightedSum(const COEFFICIENTS & coefficients, WeightVector & sum)const{
+            weightedRowSum(weights_, coefficients, sum);
+        }
+
+        /// \brief copy the weights of row p into a weight vector
+        void getWeights(const size_t p, WeightVector & weightVector)const{
+            if(size_t(weightVector.size()) != nWeights_)
+                weightVector = WeightVector(nWeights_);
+            const auto w = this->weights(p);
+            std::copy(w, w + nWeights_, weightVector.begin());
+        }
+
+        WeightType * weights(const size_t p){
+            return weights_.data() + p*nWeights_;
+        }
+        const WeightType * weights(const size_t p)const{
+            return weights_.data() + p*nWeights_;
+        }
+        WeightType * noise(const size_t p){
+            return noise_.data() + p*nWeights_;
+        }
+        const WeightType * noise(const size_t p)const{
+            return noise_.data() + p*nWeights_;
+        }
+
+    private:
+        template<class COEFFICIENTS>
+        void weightedRowSum(
+            const std::vector<WeightType> & matrix,
+            const COEFFICIENTS & coefficients,
+            WeightVector & sum
+        )const{
+            INFERNO_CHECK_OP(coefficients.size(), ==, nPerturbations_, "wrong sizes");
+            INFERNO_CHECK_OP(size_t(sum.size()), ==, nWeights_, "wrong sizes");
+            WeightType * s = &sum[0];
+            for(size_t p=0; p<nPerturbations_; ++p){
+                const WeightType c = coefficients[p];
+                if(c == 0.0)
+                    continue;
+                const WeightType * row = matrix.data() + p*nWeights_;
+                for(size_t wi=0; wi<nWeights_; ++wi)
+                    s[wi] += c*row[wi];
+            }
+        }
+
+        size_t nPerturbations_;
+        size_t nWeights_;
+        std::vector<WeightType> weights_;
+        std::vector<WeightType> noise_;
+        std::vector<WeightType> lowerBounds_;
+        std::vector<WeightType> upperBounds_;
+        bool hasBounds_;
+        utilities::CounterBasedRandom random_;
+    };
+
+
+} // end namespace inferno::learning::weights
+} // end namespace inferno::learning
+} // end namespace inferno
+
+#endif /* INFERNO_LEARNING_WEIGHTS_PERTURBATION_MATRIX_HXX */
@@ -1,89 +1,467 @@
+/** \file connected_components.hxx
+    \brief  Connected components of labelings:
+    inferno::models::ConnectedComponents for models
+    (components of equally labeled variables connected by factors) and
+    inferno::models::GridConnectedComponents for labelings of
+    implicit n-dimensional grids.
+
+    Both can run in parallel: a parallel pass over
+    all edges merges equally labeled neighbours with a
+    utilities::ConcurrentUfd, afterwards the components are
+    relabeled to dense consecutive ids in parallel.
+*/
 #ifndef INFERNO_MODEL_ALGORITHMS_CONNECTED_COMPONENTS_HXX
 #define INFERNO_MODEL_ALGORITHMS_CONNECTED_COMPONENTS_HXX
 
+#include <vector>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <algorithm>
+
+#include <boost/iterator/counting_iterator.hpp>
+
 #include "inferno/inferno.hxx"
 #include "inferno/model/discrete_model_base.hxx"
 #include "inferno/utilities/ufd.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
 
 
 namespace inferno{
 namespace models{
 
 
+    /// \cond
+    namespace detail_connected_components{
+
+        // call f(block) for all blocks, in parallel if there is a pool
+        template<class F>
+        void forEachBlock(utilities::ThreadPool * pool, const uint64_t nBlocks, F && f){
+            if(pool == nullptr){
+                for(uint64_t b=0; b<nBlocks; ++b)
+                    f(b);
+            }
+            else{
+                utilities::parallel_foreach(*pool, nBlocks,
+                    boost::counting_iterator<uint64_t>(0),
+                    boost::counting_iterator<uint64_t>(nBlocks),
+                    [&](const int, const uint64_t b){
+                        f(b);
+                    }
+                );
+            }
+        }
+
+        /*  dense component ids from a (finished) concurrent ufd
+
+            out[i] is set to the id of the component of element i,
+            sizes and anchors (smallest element) are indexed by the
+            component id.
+            With deterministic ids the components are numbered in
+            the order of their smallest element, otherwise in the
+            order in which the blocks are processed.
+            returns the number of components.
+        */
+        template<class UFD, class OUT, class T>
+        uint64_t denseComponentIds(
+            utilities::ThreadPool * pool,
+            UFD & ufd,
+            const bool deterministic,
+            OUT & out,
+            std::vector<T> & sizes,
+            std::vector<T> & anchors
+        ){
+            const uint64_t n = ufd.numberOfElements();
+            if(n == 0){
+                sizes.clear();
+                anchors.clear();
+                return 0;
+            }
+            const uint64_t nBlocks = pool == nullptr ? 1 : std::min<uint64_t>(n, 8*pool->nThreads());
+            const uint64_t blockSize = nBlocks == 0 ? 0 : (n + nBlocks - 1)/nBlocks;
+            const uint64_t nComponents = ufd.numberOfSets();
+
+            std::vector<uint64_t> blockOffset(nBlocks + 1, 0);
+            std::atomic<uint64_t> nextId(0);
+
+            // the representative of a set is its smallest element,
+            // out[i] becomes the representative of i for non representatives
+            // and the component id for representatives
+            forEachBlock(pool, nBlocks, [&](const uint64_t b){
+                const uint64_t begin = b*blockSize;
+                const uint64_t end = std::min(n, begin + blockSize);
+                uint64_t nRoots = 0;
+                for(uint64_t i=begin; i<end; ++i){
+                    const auto root = ufd.find(i);
+                    out[i] = root;
+                    nRoots += (uint64_t(root) == i);
+                }
+                if(deterministic){
+                    blockOffset[b + 1] = nRoots;
+                }
+                else{
+                    uint64_t id = nextId.fetch_add(nRoots);
+                    for(uint64_t i=begin; i<end; ++i)
+                        if(uint64_t(out[i]) == i)
+                            out[i] = id++;
+                }
+            });
+            if(deterministic){
+                for(uint64_t b=0; b<nBlocks; ++b)
+                    blockOffset[b + 1] += blockOffset[b];
+                forEachBlock(pool, nBlocks, [&](const uint64_t b){
+                    const uint64_t begin = b*blockSize;
+                    const uint64_t end = std::min(n, begin + blockSize);
+                    uint64_t id = blockOffset[b];
+                    for(uint64_t i=begin; i<end; ++i)
+                        if(uint64_t(out[i]) == i)
+                            out[i] = id++;
+                });
+            }
+
+            // ids of all other elements, sizes and anchors
+            std::unique_ptr<std::atomic<uint64_t>[]> atomicSizes(new std::atomic<uint64_t>[nComponents]);
+            for(uint64_t c=0; c<nComponents; ++c)
+                atomicSizes[c].store(0, std::memory_order_relaxed);
+            anchors.resize(nComponents);
+            forEachBlock(pool, nBlocks, [&](const uint64_t b){
+                const uint64_t begin = b*blockSize;
+                const uint64_t end = std::min(n, begin + blockSize);
+                // runs of equal ids are counted locally
+                uint64_t runId = 0;
+                uint64_t runLength = 0;
+                for(uint64_t i=begin; i<end; ++i){
+                    uint64_t id;
+                    if(uint64_t(ufd.find(i)) == i){
+                        id = out[i];
+                        anchors[id] = i;
+                    }
+                    else{
+                        // representatives are not written in this pass
+                        id = out[uint64_t(out[i])];
+                    }
+                    if(runLength != 0 && id != runId){
+                        atomicSizes[runId].fetch_add(runLength, std::memory_order_relaxed);
+                        runLength = 0;
+                    }
+                    runId = id;
+                    ++runLength;
+                }
+                if(runLength != 0)
+                    atomicSizes[runId].fetch_add(runLength, std::memory_order_relaxed);
+            });
+            // out of non representatives can only be set
+            // after all representatives have been read
+            forEachBlock(pool, nBlocks, [&](const uint64_t b){
+                const uint64_t begin = b*blockSize;
+                const uint64_t end = std::min(n, begin + blockSize);
+                for(uint64_t i=begin; i<end; ++i)
+                    if(uint64_t(ufd.find(i)) != i)
+                        out[i] = out[uint64_t(ufd.find(i))];
+            });
+            sizes.resize(nComponents);
+            for(uint64_t c=0; c<nComponents; ++c)
+                sizes[c] = atomicSizes[c].load(std::memory_order_relaxed);
+            return nComponents;
+        }
+
+        inline uint64_t nThreads(const uint64_t nThreads){
+            return nThreads == 0 ? std::thread::hardware_concurrency() : nThreads;
+        }
+
+    } // end namespace inferno::models::detail_connected_components
+    /// \endcond
+
+
+    /** \brief Connected components of a labeling of a model
+
+        Two variables are connected if they are equally
+        labeled and share a factor.
+        With Options::makeDense_ the labeling is replaced
+        by dense component ids, which are numbered in the
+        order of the smallest (dense) variable id of each component
+        (the sequential and the parallel algorithm give the same ids),
+        otherwise by the dense id of the first variable of each component.
+
+        With Options::nThreads_ != 1 the factors are
+        processed in parallel with a utilities::ConcurrentUfd.
+        Options::deterministic_ = false allows to number the
+        components in any order, which saves a pass over all variables.
+    */
     template<class MODEL>
     class ConnectedComponents{
     public:
         typedef MODEL Model;
         struct Options{
-            Options(const bool makeDense = true)
-            :   makeDense_(makeDense){
+            Options(
+                const bool makeDense = true,
+                const uint64_t nThreads = 1,
+                const bool deterministic = true
+            )
+            :   makeDense_(makeDense),
+                nThreads_(nThreads),
+                deterministic_(deterministic){
             }
             bool makeDense_;
+            uint64_t nThreads_;
+            bool deterministic_;
         };
 
         ConnectedComponents(const Model & model, const Options & options = Options())
         :   model_(model),
             options_(options),
             denseIds_(model),
-            ufd_(model_.nVariables()),
+            ufd_(),
+            concurrentUfd_(),
+            pool_(),
             relabeling_(),
-            anchors_(model_.nVariables())
+            componentIds_(),
+            anchors_(),
+            sizes_()
         {
-            relabeling_.reserve(model_.nVariables());
-        } 
+            const auto nThreads = detail_connected_components::nThreads(options_.nThreads_);
+            if(nThreads > 1){
+                pool_.reset(new utilities::ThreadPool(nThreads));
+                concurrentUfd_.reset(model_.nVariables());
+            }
+            else{
+                ufd_.reset(model_.nVariables());
+                relabeling_.reserve(model_.nVariables());
+            }
+            anchors_.reserve(model_.nVariables());
+        }
 
+        /** \brief replace the labeling by component ids
+
+            \returns the largest label
+        */
         template<class CONF>
         Vi run(CONF & conf){
+            if(pool_)
+                return this->runParallel(conf);
+
+            ufd_.reset(model_.nVariables());
             for(const auto factor : model_.factors()){
                 const auto arity = factor->arity();
-                for(auto v0=0; v0<arity -1; ++v0){
+                for(uint32_t v0=0; v0+1<arity; ++v0){
                     const auto vi0 = factor->variable(v0);
                     const auto l0 = conf[vi0];
-                    for(auto v1=v0+1; v1<arity; ++v1){
+                    for(uint32_t v1=v0+1; v1<arity; ++v1){
                         const auto vi1 = factor->variable(v1);
                         const auto l1 = conf[vi1];
                         if(l0 == l1){
-                            ufd_.merge(denseIds_.toDense(vi0),denseIds_.toDense(vi1));
+                            ufd_.merge(denseIds_.toDenseId(vi0),denseIds_.toDenseId(vi1));
                         }
                     }
                 }
             }
             anchors_.resize(0);
+            sizes_.resize(0);
             const auto makeDense = options_.makeDense_;
-            if(makeDense)
-                ufd_.representativeLabeling(relabeling_);
+            const DiscreteLabel nVar = model_.nVariables();
+            // components are numbered in the order of their first variable
+            // and labeled with the dense id of this variable if not makeDense
+            relabeling_.assign(nVar, -1);
+            componentIds_.resize(0);
             DiscreteLabel maxLabel = 0;
-            for(const auto varDesc : model_.variableDescriptors()){
-                const auto vi = model_.variableId(varDesc);
-                const auto denseVi = denseIds_.toDense(vi);
+            for(DiscreteLabel denseVi=0; denseVi<nVar; ++denseVi){
+                const auto varDesc = denseIds_.toDescriptor(denseVi);
                 const DiscreteLabel reprLabel = ufd_.find(denseVi);
-                if(reprLabel == denseVi){
-                    anchors_.push_back(vi);
+                if(relabeling_[reprLabel] < 0){
+                    relabeling_[reprLabel] = anchors_.size();
+                    anchors_.push_back(model_.variableId(varDesc));
+                    componentIds_.push_back(denseVi);
+                    sizes_.push_back(0);
                 }
-                conf[vi] = makeDense ? relabeling_[reprLabel] : reprLabel;
-                maxLabel = std::max(maxLabel, conf[vi]);
+                const auto componentId = relabeling_[reprLabel];
+                ++sizes_[componentId];
+                conf[varDesc] = makeDense ? componentId : componentIds_[componentId];
+                maxLabel = std::max(maxLabel, DiscreteLabel(conf[varDesc]));
             }
             if(makeDense){
-                INFERNO_CHECK_OP(maxLabel+1,==,relabeling_.size(),"");
                 INFERNO_CHECK_OP(maxLabel+1,==,ufd_.numberOfSets(),"");
             }
             return maxLabel;
         }
 
+        /// \brief number of components of the last run
+        uint64_t nComponents() const{
+            return anchors_.size();
+        }
+        /// \brief a variable of each component (the one with the smallest dense id)
         const std::vector<Vi> & anchors() const{
             return anchors_;
         }
+        /// \brief number of variables of each component
+        const std::vector<Vi> & sizes() const{
+            return sizes_;
+        }
     private:
         typedef inferno::models::DenseVariableIds<Model> DenseVarIds;
 
+        template<class CONF>
+        Vi runParallel(CONF & conf){
+            const Vi nVar = model_.nVariables();
+            concurrentUfd_.reset(nVar);
+            utilities::parallel_foreach(*pool_, model_.nFactors(),
+                model_.factorDescriptorsBegin(), model_.factorDescriptorsEnd(),
+                [&](const int, const typename Model::FactorDescriptor fDesc){
+                    const auto factor = model_.factor(fDesc);
+                    const auto arity = factor->arity();
+                    for(uint32_t v0=0; v0+1<arity; ++v0){
+                        const auto vi0 = factor->variable(v0);
+                        const auto l0 = conf[vi0];
+                        for(uint32_t v1=v0+1; v1<arity; ++v1){
+                            const auto vi1 = factor->variable(v1);
+                            if(l0 == conf[vi1])
+                                concurrentUfd_.merge(denseIds_.toDenseId(vi0), denseIds_.toDenseId(vi1));
+                        }
+                    }
+                }
+            );
+
+            componentIds_.resize(nVar);
+            const auto nComponents = detail_connected_components::denseComponentIds(
+                pool_.get(), concurrentUfd_, options_.deterministic_,
+                componentIds_, sizes_, anchors_);
+
+            // write the labeling and map the anchors to variable ids
+            const bool makeDense = options_.makeDense_;
+            detail_connected_components::forEachBlock(pool_.get(), pool_->nThreads(), [&](const uint64_t b){
+                const Vi blockSize = (nVar + pool_->nThreads() - 1)/pool_->nThreads();
+                const Vi end = std::min(nVar, Vi(b + 1)*blockSize);
+                for(Vi denseVi = Vi(b)*blockSize; denseVi<end; ++denseVi){
+                    const auto id = componentIds_[denseVi];
+                    conf[denseIds_.toDescriptor(denseVi)] = makeDense ? id : anchors_[id];
+                }
+            });
+            // without makeDense the labels are the dense ids of the anchors
+            const Vi maxLabel = makeDense ? Vi(nComponents) - 1 :
+                (nComponents == 0 ? 0 : *std::max_element(anchors_.begin(), anchors_.end()));
+            for(auto & anchor : anchors_)
+                anchor = model_.variableId(denseIds_.toDescriptor(anchor));
+            return maxLabel;
+        }
 
         const Model & model_;
         Options options_;
         DenseVarIds denseIds_;
         inferno::utilities::Ufd<DiscreteLabel> ufd_;
-        std::unordered_map<DiscreteLabel, DiscreteLabel> relabeling_;
+        inferno::utilities::ConcurrentUfd<Vi> concurrentUfd_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+        std::vector<DiscreteLabel> relabeling_;
+        std::vector<Vi> componentIds_;
         std::vector<Vi> anchors_;
+        std::vector<Vi> sizes_;
+    };
+
+
+    /** \brief Connected components of a labeling of an
+        implicit DIM dimensional grid (direct neighbourhood).
+
+        The labeling is stored in scan order (first axis fastest).
+        No model or edge list is built, the grid lines are
+        processed in parallel (Options::nThreads_ != 1)
+        with a utilities::ConcurrentUfd.
+        With Options::deterministic_ the components are numbered
+        in scan order of their first pixel.
+    */
+    template<size_t DIM>
+    class GridConnectedComponents{
+    public:
+        typedef std::array<uint64_t, DIM> Shape;
+
+        struct Options{
+            Options(
+                const uint64_t nThreads = 1,
+                const bool deterministic = true
+            )
+            :   nThreads_(nThreads),
+                deterministic_(deterministic){
+            }
+            uint64_t nThreads_;
+            bool deterministic_;
+        };
 
+        GridConnectedComponents(const Shape & shape, const Options & options = Options())
+        :   shape_(shape),
+            strides_(),
+            size_(1),
+            options_(options),
+            ufd_(),
+            pool_(),
+            sizes_(),
+            anchors_()
+        {
+            for(size_t d=0; d<DIM; ++d){
+                strides_[d] = size_;
+                size_ *= shape_[d];
+            }
+            const auto nThreads = detail_connected_components::nThreads(options_.nThreads_);
+            if(nThreads > 1)
+                pool_.reset(new utilities::ThreadPool(nThreads));
+            ufd_.reset(size_);
+        }
+
+        /** \brief component ids of a labeling
+
+            \param labels labeling of all grid points in scan order
+            \param components component id of all grid points in scan order
+            \returns the number of components
+        */
+        template<class LABEL, class COMPONENT>
+        uint64_t run(const LABEL * labels, COMPONENT * components){
+            ufd_.reset(size_);
+            const uint64_t lineLength = shape_[0];
+            const uint64_t nLines = lineLength == 0 ? 0 : size_/lineLength;
+            const uint64_t nBlocks = pool_ ? std::min<uint64_t>(nLines, 8*pool_->nThreads()) : 1;
+            const uint64_t linesPerBlock = nBlocks == 0 ? 0 : (nLines + nBlocks - 1)/nBlocks;
+
+            detail_connected_components::forEachBlock(pool_.get(), nBlocks, [&](const uint64_t b){
+                const uint64_t lineEnd = std::min(nLines, (b + 1)*linesPerBlock);
+                for(uint64_t line=b*linesPerBlock; line<lineEnd; ++line){
+                    // coordinates of the line (without the first axis)
+                    std::array<uint64_t, DIM> coord;
+                    uint64_t rest = line;
+                    for(size_t d=1; d<DIM; ++d){
+                        coord[d] = rest % shape_[d];
+                        rest /= shape_[d];
+                    }
+                    const uint64_t begin = line*lineLength;
+                    for(uint64_t x=0; x<lineLength; ++x){
+                        const uint64_t i = begin + x;
+                        const auto l = labels[i];
+                        if(x + 1 < lineLength && labels[i + 1] == l)
+                            ufd_.merge(i, i + 1);
+                        for(size_t d=1; d<DIM; ++d)
+                            if(coord[d] + 1 < shape_[d] && labels[i + strides_[d]] == l)
+                                ufd_.merge(i, i + strides_[d]);
+                    }
+                }
+            });
+            return detail_connected_components::denseComponentIds(
+                pool_.get(), ufd_, options_.deterministic_, components, sizes_, anchors_);
+        }
+
+        /// \brief number of grid points of each component of the last run
+        const std::vector<uint64_t> & sizes() const{
+            return sizes_;
+        }
+        /// \brief first grid point (scan order index) of each component of the last run
+        const std::vector<uint64_t> & anchors() const{
+            return anchors_;
+        }
+
+    private:
+        Shape shape_;
+        std::array<uint64_t, DIM> strides_;
+        uint64_t size_;
+        Options options_;
+        utilities::ConcurrentUfd<uint64_t> ufd_;
+        std::unique_ptr<utilities::ThreadPool> pool_;
+        std::vector<uint64_t> sizes_;
+        std::vector<uint64_t> anchors_;
     };
 
 
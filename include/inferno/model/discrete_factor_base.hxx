@@ -1,11 +1,14 @@
 #ifndef INFERNO_MODEL_BASE_FACTOR_HXX
 #define INFERNO_MODEL_BASE_FACTOR_HXX
 
+#include <memory>
+
 #include <boost/iterator/iterator_facade.hpp>
 
 #include "inferno/inferno.hxx"
 #include "inferno/utilities/utilities.hxx"
 #include "inferno/value_tables/discrete_value_table_base.hxx"
+#include "inferno/value_tables/min_marginals.hxx"
 #include "inferno/utilities/shape_walker.hxx"
 
 namespace inferno{
@@ -190,6 +193,18 @@ public:
         return factor()->valueTable()->isGeneralizedPotts();
     }
 
+    /** \brief per axis min-marginals and min / max of the value table.
+
+        This default implementation computes them on each call,
+        factor classes of models which own their value tables
+        (e.g. GeneralDiscreteGraphicalModelFactor) return a
+        cached object which is shared between all factors
+        with the same value table.
+    */
+    std::shared_ptr<const value_tables::MinMarginals> minMarginals()const{
+        return std::make_shared<const value_tables::MinMarginals>(factor()->valueTable());
+    }
+
     void bufferShape(DiscreteLabel * buffer)const{
         factor()->valueTable()->bufferShape(buffer);
     }
@@ -894,7 +894,7 @@ public:
     };
 
     VariableDescriptor toDescriptor(const Vi denseVi)const{
-        return model_.variableDescritor(denseVi);
+        return model_.variableDescriptor(denseVi);
     }
 
     Vi toDenseId(const VariableDescriptor var)const{
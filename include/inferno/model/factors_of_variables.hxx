@@ -6,6 +6,7 @@
 #define INFERNO_MODEL_FACTORS_OF_VARIABLES_HXX
 
 #include <initializer_list>
+#include <utility>
 
 #include <boost/iterator/counting_iterator.hpp>
 #include <boost/iterator/transform_iterator.hpp>
@@ -42,18 +43,31 @@ public:
 
     VariablesNeighbours(const Model & model)
     : storage_(model){
+        // upper bound of the number of neighbours
+        typename Model:: template VariableMap<uint64_t> nNeighbours(model, 0);
         for(const auto fac : model.factorDescriptors()){
-            const auto factor = model[fac];
+            const auto factor = model.factor(fac);
+            const auto arity = factor->arity();
+            for(uint32_t v=0; v<arity; ++v)
+                nNeighbours[factor->variable(v)] += arity - 1;
+        }
+        for(const auto var : model.variableDescriptors())
+            storage_[var].reserve(nNeighbours[var]);
+        // bulk build: append all and sort once
+        for(const auto fac : model.factorDescriptors()){
+            const auto factor = model.factor(fac);
             const auto arity = factor->arity();
             for(uint32_t va=0; va<arity-1; ++va){
                 const auto varA = factor->variable(va);
                 for(uint32_t vb=va+1; vb<arity; ++vb){
                     const auto varB = factor->variable(vb);
-                    storage_[varA].insert(varB);
-                    storage_[varB].insert(varA);
+                    storage_[varA].pushBackUnsorted(varB);
+                    storage_[varB].pushBackUnsorted(varA);
                 }
             }
         };
+        for(const auto var : model.variableDescriptors())
+            storage_[var].sortUnique();
     };
 
     const VariableNeighbours & operator[](const VariableDescriptor varDesc)const{
@@ -100,13 +114,25 @@ public:
 
     FactorsOfVariables(const Model & model)
     : storage_(model){
+        typename Model:: template VariableMap<uint64_t> nFactors(model, 0);
+        for(const auto facDesc : model.factorDescriptors()){
+            const auto factor = model.factor(facDesc);
+            const auto arity = factor->arity();
+            for(size_t v=0; v<arity; ++v)
+                ++nFactors[factor->variable(v)];
+        }
+        for(const auto var : model.variableDescriptors())
+            storage_[var].reserve(nFactors[var]);
+        // bulk build: append all and sort once
         for(const auto facDesc : model.factorDescriptors()){
             const auto factor = model.factor(facDesc);
             const auto arity = factor->arity();
-            for(auto v=0; v<arity; ++v){
-                storage_[factor->variable(v)].insert(facDesc);
+            for(size_t v=0; v<arity; ++v){
+                storage_[factor->variable(v)].pushBackUnsorted(facDesc);
             };
         };
+        for(const auto var : model.variableDescriptors())
+            storage_[var].sortUnique();
     };
 
     const FactorsOfVariable & operator[](const VariableDescriptor var)const{
@@ -159,6 +185,23 @@ public:
                 higherOrderFactors_.insert(facDesc);
             }
         }
+        void reserve(const uint64_t nUnaries, const uint64_t nHigherOrder){
+            unaryFactors_.reserve(nUnaries);
+            higherOrderFactors_.reserve(nHigherOrder);
+        }
+        // bulk build, sortUnique must be called afterwards
+        void pushBackUnsorted(const FactorDescriptor facDesc, const uint32_t arity){
+            if(arity == 1){
+                unaryFactors_.pushBackUnsorted(facDesc);
+            }
+            else{
+                higherOrderFactors_.pushBackUnsorted(facDesc);
+            }
+        }
+        void sortUnique(){
+            unaryFactors_.sortUnique();
+            higherOrderFactors_.sortUnique();
+        }
         const UnaryFactorsOfVariable & unaryFactors()const{
             return unaryFactors_;
         }
@@ -173,14 +216,28 @@ public:
 
     HigherOrderAndUnaryFactorsOfVariables(const Model & model)
     : storage_(model){
+        typedef std::pair<uint64_t, uint64_t> Counts;
+        typename Model:: template VariableMap<Counts> nFactors(model, Counts(0, 0));
+        for(const auto facDesc : model.factorDescriptors()){
+            const auto factor = model.factor(facDesc);
+            const auto arity = factor->arity();
+            for(size_t v=0; v<arity; ++v){
+                auto & counts = nFactors[factor->variable(v)];
+                ++(arity == 1 ? counts.first : counts.second);
+            }
+        }
+        for(const auto var : model.variableDescriptors())
+            storage_[var].reserve(nFactors[var].first, nFactors[var].second);
+        // bulk build: append all and sort once
         for(const auto facDesc : model.factorDescriptors()){
-            const auto factor = model[facDesc];
-            const auto fi = model.factorId(facDesc);
+            const auto factor = model.factor(facDesc);
             const auto arity = factor->arity();
-            for(auto v=0; v<arity; ++v){
-                storage_[factor->variable(v)].insert(facDesc, arity);
+            for(size_t v=0; v<arity; ++v){
+                storage_[factor->variable(v)].pushBackUnsorted(facDesc, arity);
             };
         };
+        for(const auto var : model.variableDescriptors())
+            storage_[var].sortUnique();
     };
 
     const Facs & operator[](const VariableDescriptor var)const{
@@ -231,7 +288,7 @@ public:
 
     void reset(){
         for(size_t i=0; i<nFactors_;++ i){
-            usedFac_[i] = 0;
+            usedFac_[facToRecomp_[i]] = 0;
         }
         nFactors_ = 0;
     };
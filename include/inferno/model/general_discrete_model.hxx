@@ -9,6 +9,7 @@
 #include <boost/iterator/counting_iterator.hpp>
 
 // std
+#include <memory>
 
 // inferno
 #include "inferno/inferno.hxx"
@@ -48,6 +49,7 @@ public:
     GeneralDiscreteGraphicalModelFactor()
     :   model_(NULL),
         vt_(NULL),
+        vti_(0),
         arity_(0),
         visOffset_(0){
 
@@ -56,10 +58,12 @@ public:
 
     GeneralDiscreteGraphicalModelFactor(const MODEL * model ,
                                         const value_tables::DiscreteValueTableBase * vt,
+                                        const uint64_t vti,
                                         const uint64_t visOffset, 
                                         const size_t arity)
     :   model_(model),
         vt_(vt),
+        vti_(vti),
         visOffset_(visOffset),
         arity_(arity){
 
@@ -67,6 +71,14 @@ public:
     const value_tables::DiscreteValueTableBase * valueTable()const{
         return vt_;
     }   
+    /// \brief index of the value table within the model
+    uint64_t valueTableIndex()const{
+        return vti_;
+    }
+    /// \brief cached min-marginals, shared with all factors of the same value table
+    std::shared_ptr<const value_tables::MinMarginals> minMarginals()const{
+        return model_->minMarginals(vti_);
+    }
     uint32_t arity()const{
         return arity_;
     }
@@ -81,6 +93,7 @@ public:
 private:
     const MODEL * model_;
     const value_tables::DiscreteValueTableBase * vt_;
+    uint64_t vti_;
     uint64_t visOffset_;
     size_t arity_;
 
@@ -336,9 +349,50 @@ public:
     }
     uint64_t addValueTable( value_tables::DiscreteValueTableBase * vt){
         valueTables_.push_back(vt);
+        minMarginals_.emplace_back();
         return valueTables_.size()-1;
     }   
 
+    /** \brief per axis min-marginals and min / max of a value table
+
+        The min-marginals are computed on first use and 
+        shared between all factors which use the value table.
+        This function is thread safe, if two threads
+        request the same value table at the same time,
+        both might compute it but only one result is kept.
+        
+        \param vti index of the value table (see addValueTable)
+    */
+    std::shared_ptr<const value_tables::MinMarginals> minMarginals(const uint64_t vti)const{
+        typedef std::shared_ptr<const value_tables::MinMarginals> Ptr;
+        INFERNO_ASSERT_OP(vti,<,minMarginals_.size());
+        Ptr cached = std::atomic_load(&minMarginals_[vti]);
+        if(!cached){
+            Ptr computed = std::make_shared<const value_tables::MinMarginals>(valueTables_[vti]);
+            if(std::atomic_compare_exchange_strong(&minMarginals_[vti], &cached, computed))
+                cached = computed;
+        }
+        return cached;
+    }
+
+    /** \brief drop all cached min-marginals
+
+        Must be called after a value table has been
+        changed in place, updateWeights does this on its own.
+    */
+    void invalidateMinMarginals()const{
+        for(auto & minMarginals : minMarginals_)
+            std::atomic_store(&minMarginals, std::shared_ptr<const value_tables::MinMarginals>());
+    }
+
+    /** \brief update the weights of all value tables
+        and drop the cached min-marginals
+    */
+    void updateWeights(const learning::WeightVector & weights)const{
+        SimpleDiscreteGraphicalModelBase<Self>::updateWeights(weights);
+        this->invalidateMinMarginals();
+    }
+
     template<class VI_ITER>
     uint64_t addFactor(const uint64_t vti , VI_ITER viBegin, VI_ITER viEnd){
         size_t arity=0;
@@ -352,7 +406,7 @@ public:
         }
         INFERNO_CHECK_OP(arity,==,valueTables_[vti]->arity(),
             "dist(viBegin,viEnd) does not match vt's arity");
-        factors_.push_back(GeneralDiscreteGraphicalModelFactor<GeneralDiscreteModel>(this,valueTables_[vti], visOffset, arity));
+        factors_.push_back(GeneralDiscreteGraphicalModelFactor<GeneralDiscreteModel>(this,valueTables_[vti], vti, visOffset, arity));
         maxArity_  = std::max(arity, maxArity_);
         return factors_.size()-1;
     }
@@ -395,6 +449,7 @@ private:
     std::vector<LabelType>              numberOfLabels_;
 
     std::vector<value_tables::DiscreteValueTableBase * >            valueTables_;
+    mutable std::vector<std::shared_ptr<const value_tables::MinMarginals> > minMarginals_;
     std::vector<value_tables::DiscreteUnaryValueTableBase * >       unaryValueTables_;
     std::vector<constraint_tables::DiscreteConstraintTableBase * >    constraintTables_;
 
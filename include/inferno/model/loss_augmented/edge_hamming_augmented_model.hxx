@@ -232,6 +232,16 @@ namespace models{
             return losslessModel_->constraint(c);
         }
 
+        /** \brief recompute the loss augmented betas
+
+            The structure, the ground truth and the
+            loss weights are unchanged, only the betas of the
+            lossless model have changed (e.g. new weights).
+        */
+        void refresh()const{
+            this->makeBetas();
+        }
+
         LosslessModel & baseModel() {
             return *losslessModel_;
         }
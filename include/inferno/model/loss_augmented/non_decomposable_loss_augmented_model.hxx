@@ -0,0 +1,124 @@
+#ifndef INFERNO_MODEL_LOSS_AUGMENTED_NON_DECOMPOSABLE_LOSS_AUGMENTED_MODEL
+#define INFERNO_MODEL_LOSS_AUGMENTED_NON_DECOMPOSABLE_LOSS_AUGMENTED_MODEL
+
+
+// inferno
+#include "inferno/inferno.hxx"
+#include "inferno/model/structure_view_model_base.hxx"
+#include "inferno/model/maps/model_maps.hxx"
+
+
+namespace inferno{
+
+
+namespace learning{
+namespace loss_functions{
+    template<class MODEL>
+    class NonDecomposableLossFunctionBase;
+}  // end namespace inferno::learning::loss_functions
+}  // end namespace inferno::learning
+
+
+namespace models{
+
+
+    /** \brief loss augmented model of a non decomposable loss
+        function (e.g. variation of information)
+
+        A non decomposable loss can not be expressed by factors,
+        therefore this model is a view on the lossless model
+        which carries the ground truth and the loss function.
+        The factors and unaries are those of the lossless model,
+        only NonDecomposableLossAugmentedModel::eval
+        includes the loss:
+        \f[
+            E(x) - \Delta(x_{gt}, x)
+        \f]
+
+        \warning Solvers which only look at the factors minimize
+        the lossless energy, use inference::LossAugmentedLocalSearch
+        to minimize the loss augmented energy.
+    */
+    template<class LOSSLESS_MODEL>
+    class NonDecomposableLossAugmentedModel :
+    public StructureViewModelBase<
+        NonDecomposableLossAugmentedModel<LOSSLESS_MODEL>,
+        LOSSLESS_MODEL
+    >
+    {
+        typedef NonDecomposableLossAugmentedModel<LOSSLESS_MODEL> Self;
+    public:
+        typedef LOSSLESS_MODEL LosslessModel;
+        typedef typename LosslessModel:: template VariableMap<DiscreteLabel> GtMap;
+        typedef learning::loss_functions::NonDecomposableLossFunctionBase<LosslessModel> LossFunction;
+
+        typedef typename LosslessModel::FactorProxy      FactorProxy;
+        typedef typename LosslessModel::UnaryProxy       UnaryProxy;
+        typedef typename LosslessModel::ConstraintProxy  ConstraintProxy;
+
+        NonDecomposableLossAugmentedModel()
+        :   losslessModel_(nullptr),
+            gt_(nullptr),
+            lossFunction_(nullptr){
+        }
+
+        NonDecomposableLossAugmentedModel(
+            const LosslessModel & losslessModel,
+            const GtMap & gt,
+            const LossFunction & lossFunction
+        )
+        :   losslessModel_(&losslessModel),
+            gt_(&gt),
+            lossFunction_(&lossFunction){
+        }
+
+        void assign(
+            const LosslessModel & losslessModel,
+            const GtMap & gt,
+            const LossFunction & lossFunction
+        ){
+            losslessModel_ = &losslessModel;
+            gt_ = &gt;
+            lossFunction_ = &lossFunction;
+        }
+
+        FactorProxy factor(const typename Self::FactorDescriptor fac)const{
+            return losslessModel_->factor(fac);
+        }
+
+        UnaryProxy unary(const typename Self::UnaryDescriptor unary)const{
+            return losslessModel_->unary(unary);
+        }
+
+        ConstraintProxy constraint(const typename Self::ConstraintDescriptor c)const{
+            return losslessModel_->constraint(c);
+        }
+
+        /// \brief loss augmented energy \f$ E(x) - \Delta(x_{gt}, x) \f$
+        template<class CONFIG>
+        double eval(const CONFIG & conf)const{
+            GtMap losslessConf(*losslessModel_);
+            for(const auto var : losslessModel_->variableDescriptors())
+                losslessConf[var] = conf[var];
+            return losslessModel_->eval(losslessConf) -
+                lossFunction_->eval(*losslessModel_, *gt_, losslessConf);
+        }
+
+        const LosslessModel & baseModel()const{
+            return *losslessModel_;
+        }
+        const GtMap & groundTruth()const{
+            return *gt_;
+        }
+        const LossFunction & lossFunction()const{
+            return *lossFunction_;
+        }
+    private:
+        const LosslessModel * losslessModel_;
+        const GtMap * gt_;
+        const LossFunction * lossFunction_;
+    };
+} // end namespace inferno::models
+} // end namespace inferno
+
+#endif /* INFERNO_MODEL_LOSS_AUGMENTED_NON_DECOMPOSABLE_LOSS_AUGMENTED_MODEL */
@@ -1,6 +1,11 @@
 #ifndef INFERNO_MODEL_PARAMETRIZED_MULTICUT_MODEL_HXX
 #define INFERNO_MODEL_PARAMETRIZED_MULTICUT_MODEL_HXX
 
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
+
 #include <boost/iterator/counting_iterator.hpp>
 
 #include "inferno/inferno.hxx"
@@ -13,6 +18,7 @@
 #include "inferno/model/discrete_unary_base.hxx"
 #include "inferno/model/discrete_constraint_base.hxx"
 #include "inferno/model/simple_discrete_model_base.hxx"
+#include "inferno/utilities/parallel/pool.hxx"
 
 namespace inferno{
 
@@ -64,7 +70,7 @@ namespace inferno{
                 const size_t vtsWeightIndex, 
                 const DiscreteLabel * conf
             ) const override {
-                return conf[0]==conf[1] ? 0.0 : model_->features_(edge_, vtsWeightIndex);
+                return conf[0]==conf[1] ? 0.0 : model_->feature(edge_, vtsWeightIndex);
             }
 
             virtual void updateWeights(const learning::Weights & weights) const override{
@@ -87,6 +93,45 @@ namespace inferno{
 
 namespace models{
 
+    namespace detail_parametrized_multicut_model{
+
+        // thread pool which is created on first use,
+        // copies share the number of threads but not the pool
+        class LazyThreadPool{
+        public:
+            LazyThreadPool(const uint64_t nThreads = 1)
+            :   nThreads_(nThreads),
+                pool_(){
+            }
+            LazyThreadPool(const LazyThreadPool & other)
+            :   nThreads_(other.nThreads_),
+                pool_(){
+            }
+            LazyThreadPool & operator=(const LazyThreadPool & other){
+                nThreads_ = other.nThreads_;
+                pool_.reset();
+                return *this;
+            }
+            void setNumberOfThreads(const uint64_t nThreads){
+                if(nThreads != nThreads_)
+                    pool_.reset();
+                nThreads_ = nThreads;
+            }
+            uint64_t nThreads()const{
+                return nThreads_;
+            }
+            utilities::ThreadPool & pool()const{
+                if(!pool_)
+                    pool_.reset(new utilities::ThreadPool(nThreads_));
+                return *pool_;
+            }
+        private:
+            uint64_t nThreads_;
+            mutable std::unique_ptr<utilities::ThreadPool> pool_;
+        };
+
+    } // end namespace inferno::models::detail_parametrized_multicut_model
+
     template<class MODEL>
     class ParametrizedMulticutModelFactor
     : public  DiscreteFactorBase<ParametrizedMulticutModelFactor<MODEL>, MODEL> {
@@ -119,6 +164,19 @@ namespace models{
 
 
 
+    /** \brief Multicut model where the \f$\beta\f$ of each edge is
+        the dot product of the edge features and the weights.
+
+        The features are stored row-major and contiguous
+        (one row per edge) with the value type of FEATURES,
+        therefore float32 features halve the memory traffic
+        of updateWeights.
+        updateWeights recomputes all \f$\beta\f$ with a blocked
+        features-times-weights product, which runs multi-threaded
+        for large models (see setNumberOfThreads).
+        If only a few weights have changed since the last
+        update, only \f$F \cdot \Delta w\f$ is added.
+    */
     template<class EDGES, class FEATURES>
     class ParametrizedMulticutModel :
     public SimpleDiscreteGraphicalModelBase<ParametrizedMulticutModel<EDGES, FEATURES> >{
@@ -139,22 +197,33 @@ namespace models{
         typedef UnaryImpl UnaryProxy;
         typedef ConstraintImp ConstraintProxy;
 
+        typedef typename FEATURES::value_type FeatureType;
+
 
         ParametrizedMulticutModel()
         :   nVar_(0),
             edges_(),
+            nFeatures_(0),
             features_(),
             betas_(),
-            currentWeights_(nullptr){
+            currentWeights_(nullptr),
+            lastWeights_(),
+            nDeltaUpdates_(0),
+            pool_(){
         }
 
         ParametrizedMulticutModel(const uint64_t nVar, const EDGES & edges, const FEATURES &features,
                                   const learning::WeightVector & weights)
         :   nVar_(nVar),
             edges_(edges),
-            features_(features),
+            nFeatures_(0),
+            features_(),
             betas_(edges.shape(0)),
-            currentWeights_(&weights){
+            currentWeights_(&weights),
+            lastWeights_(),
+            nDeltaUpdates_(0),
+            pool_(){
+                this->packFeatures(features);
                 this->makeBetas();
         }
 
@@ -163,12 +232,26 @@ namespace models{
         {
             nVar_ = nVar;
             edges_ = edges;
-            features_ = features;
             betas_.reshape(  edges.shape());
             currentWeights_ = & weights;
+            this->packFeatures(features);
             this->makeBetas();
         }
 
+        /** \brief number of threads used by updateWeights
+            for large models (default 1)
+        */
+        void setNumberOfThreads(const uint64_t nThreads){
+            pool_.setNumberOfThreads(nThreads == 0 ? std::thread::hardware_concurrency() : nThreads);
+        }
+
+        uint64_t nFeatures()const{
+            return nFeatures_;
+        }
+        FeatureType feature(const uint64_t edge, const uint64_t f)const{
+            return features_[edge*nFeatures_ + f];
+        }
+
 
 
 
@@ -236,29 +319,134 @@ namespace models{
 
         void updateWeights(const learning::WeightVector & weights)const{
             currentWeights_ = &weights;
-            makeBetas();
+            if(!this->makeDeltaBetas())
+                this->makeBetas();
         }
 
 
 
     private:
 
+        // edges per block of the features-times-weights product
+        static const uint64_t BlockSize = 256;
+        // minimum size of the product for multi-threading
+        static const uint64_t MinParallelWork = 1 << 16;
+        // the delta update accumulates rounding errors,
+        // therefore a full update is forced after
+        static const uint64_t MaxDeltaUpdates = 64;
+
+        void packFeatures(const FEATURES & features){
+            const uint64_t nEdges = features.shape(0);
+            nFeatures_ = features.shape(1);
+            features_.resize(nEdges*nFeatures_);
+            for(uint64_t e=0; e<nEdges; ++e)
+            for(uint64_t f=0; f<nFeatures_; ++f)
+                features_[e*nFeatures_ + f] = features(e, f);
+        }
+
+        // the features of weights beyond the weight vector are ignored
+        uint64_t nUsedFeatures()const{
+            return std::min<uint64_t>(nFeatures_, currentWeights_->size());
+        }
+
         void makeBetas()const{
-            //std::cout<<"make betas\n";
-            for(size_t e=0; e<betas_.shape(0); ++e){
-                ValueType val = 0;
-                for(size_t f=0; f<features_.shape(1); ++f){
-                    val += features_(e,f)*(*currentWeights_)[f];
+            const uint64_t nW = this->nUsedFeatures();
+            lastWeights_.resize(nW);
+            for(uint64_t f=0; f<nW; ++f)
+                lastWeights_[f] = (*currentWeights_)[f];
+            nDeltaUpdates_ = 0;
+
+            const uint64_t nEdges = betas_.size();
+            const uint64_t nBlocks = (nEdges + BlockSize - 1)/BlockSize;
+            const ValueType * w = lastWeights_.data();
+
+            auto block = [&](const int, const uint64_t b){
+                const uint64_t eEnd = std::min(nEdges, (b+1)*BlockSize);
+                for(uint64_t e=b*BlockSize; e<eEnd; ++e){
+                    const FeatureType * row = features_.data() + e*nFeatures_;
+                    // independent accumulators for instruction level parallelism
+                    ValueType v0 = 0, v1 = 0, v2 = 0, v3 = 0;
+                    uint64_t f=0;
+                    for(; f+4<=nW; f+=4){
+                        v0 += row[f  ]*w[f  ];
+                        v1 += row[f+1]*w[f+1];
+                        v2 += row[f+2]*w[f+2];
+                        v3 += row[f+3]*w[f+3];
+                    }
+                    for(; f<nW; ++f)
+                        v0 += row[f]*w[f];
+                    betas_[e] = (v0 + v1) + (v2 + v3);
                 }
-                //std::cout<<"e "<<e<<" beta "<<val<<"\n";
-                betas_[e] = val;
+            };
+
+            if(pool_.nThreads() > 1 && nBlocks > 1 && nEdges*nW >= MinParallelWork){
+                utilities::parallel_foreach(pool_.pool(), nBlocks,
+                    boost::counting_iterator<uint64_t>(0),
+                    boost::counting_iterator<uint64_t>(nBlocks), block);
+            }
+            else{
+                for(uint64_t b=0; b<nBlocks; ++b)
+                    block(0, b);
             }
         }
+
+        // add F * (w - lastWeights) if only a few weights changed,
+        // returns false if a full update is needed.
+        // Each weight is read only once, betas_ and lastWeights_
+        // stay consistent even if the weights change meanwhile.
+        bool makeDeltaBetas()const{
+            const uint64_t nW = this->nUsedFeatures();
+            if(lastWeights_.size() != nW || nDeltaUpdates_ >= MaxDeltaUpdates)
+                return false;
+
+            newWeights_.resize(nW);
+            for(uint64_t f=0; f<nW; ++f)
+                newWeights_[f] = (*currentWeights_)[f];
+
+            changedWeights_.clear();
+            for(uint64_t f=0; f<nW; ++f){
+                if(newWeights_[f] != lastWeights_[f]){
+                    changedWeights_.push_back(f);
+                    // more than 1/4 changed => full update is cheaper
+                    if(changedWeights_.size()*4 > nW)
+                        return false;
+                }
+            }
+            if(changedWeights_.empty())
+                return true;
+
+            deltaWeights_.resize(changedWeights_.size());
+            for(size_t i=0; i<changedWeights_.size(); ++i){
+                const auto f = changedWeights_[i];
+                deltaWeights_[i] = newWeights_[f] - lastWeights_[f];
+                lastWeights_[f] = newWeights_[f];
+            }
+            const uint64_t nEdges = betas_.size();
+            for(uint64_t e=0; e<nEdges; ++e){
+                const FeatureType * row = features_.data() + e*nFeatures_;
+                ValueType d = 0;
+                for(size_t i=0; i<changedWeights_.size(); ++i)
+                    d += row[changedWeights_[i]]*deltaWeights_[i];
+                betas_[e] += d;
+            }
+            ++nDeltaUpdates_;
+            return true;
+        }
+
         uint64_t nVar_;
         EDGES edges_;
-        FEATURES features_;
+        uint64_t nFeatures_;
+        std::vector<FeatureType> features_;
         mutable vigra::MultiArray<1, ValueType> betas_;
         mutable const learning::WeightVector * currentWeights_;
+
+        // state of the incremental update
+        mutable std::vector<ValueType> lastWeights_;
+        mutable std::vector<ValueType> newWeights_;
+        mutable std::vector<uint64_t> changedWeights_;
+        mutable std::vector<ValueType> deltaWeights_;
+        mutable uint64_t nDeltaUpdates_;
+        detail_parametrized_multicut_model::LazyThreadPool pool_;
     };
 
 } // end namespace models
@@ -7,9 +7,9 @@
 
 #include <vector>
 #include <unordered_map>
-#include <unordered_set>
 
 #include "inferno/inferno.hxx"
+#include "inferno/utilities/flat_hash.hxx"
 #include "inferno/value_tables/discrete_value_table_base.hxx"
 #include "inferno/model/general_discrete_model.hxx"
 #include "inferno/model/discrete_model_base.hxx"
@@ -369,8 +369,8 @@ private:
     FactorStorage                                                       factors_;
     
 
-    std::unordered_map<Vi, std::unordered_set<Fi> > factorsOfVariables_;
-    std::unordered_map<Vti, std::unordered_set<Fi> > factorsOfValueTables_; 
+    std::unordered_map<Vi, FlatHashSet<Fi> > factorsOfVariables_;
+    std::unordered_map<Vti, FlatHashSet<Fi> > factorsOfValueTables_; 
 
 };
 
@@ -14,7 +14,10 @@
 #include "inferno/inferno.hxx"
 #include "inferno/value_tables/discrete_value_table_base.hxx"
 #include "inferno/model/discrete_factor_base.hxx"
+#include "inferno/model/discrete_unary_base.hxx"
+#include "inferno/model/discrete_constraint_base.hxx"
 #include "inferno/model/discrete_model_base.hxx"
+#include "inferno/model/simple_discrete_model_base.hxx"
 
 
 namespace inferno{
@@ -41,11 +44,12 @@ namespace detail_view_submodel{
         and partially included factors in inferno::models::detail_view_submodel::PartiallyIncludedFactor
     */ 
     template<class VIEW_SUBMODEL>
-    class FactorBase : public inferno::models::DiscreteFactorBase< FactorBase<VIEW_SUBMODEL> >{
+    class FactorBase : public inferno::models::DiscreteFactorBase< FactorBase<VIEW_SUBMODEL>, VIEW_SUBMODEL >{
     public:
         typedef typename VIEW_SUBMODEL::VariableDescriptor VariableDescriptor;
         virtual ~FactorBase(){}
         virtual VariableDescriptor variable(const size_t d) const = 0;
+        virtual DiscreteLabel shape(const size_t d) const = 0;
         virtual const inferno::value_tables::DiscreteValueTableBase * valueTable()const=0;
     };
     /** \brief factor class of  inferno::models::ViewSubmodel implementing a fully included factor
@@ -70,6 +74,9 @@ namespace detail_view_submodel{
         virtual VariableDescriptor variable(const size_t d) const {
             return viewSubmodel_->fromBaseModelVariableDescriptor(baseModelFactor_->variable(d));
         }
+        virtual DiscreteLabel shape(const size_t d) const {
+            return baseModelFactor_->shape(d);
+        }
         virtual const inferno::value_tables::DiscreteValueTableBase * valueTable()const{
             return baseModelFactor_->valueTable();
         }
@@ -130,35 +137,35 @@ namespace detail_view_submodel{
             const Fi baseFi,
             const size_t newArity,
             const uint64_t indexMappingOffset,
-            const uint64_t fixedVarPosOffset,
-            const uint64_t confBufferOffset
+            const uint64_t fixedVarPosOffset
         )
         :   viewSubmodel_(&viewSubmodel),
             baseModelFactor_(viewSubmodel.baseModel().factor(baseFi)),
             newArity_(newArity),
             indexMappingOffset_(indexMappingOffset),
             fixedVarPosOffset_(fixedVarPosOffset),
-            confBufferOffset_(confBufferOffset),
             newVt_(this){
         }
         uint32_t arity()const{
             return newArity_;
         }
         ValueType eval(const DiscreteLabel * conf)const{
-            DiscreteLabel * buffer = viewSubmodel_->confBuffer_.data()+ confBufferOffset_;
+            // the buffer is local to the call, therefore eval can
+            // be called from several threads at once
+            const auto baseArity = baseModelFactor_->arity();
+            SmallVector<DiscreteLabel> buffer(baseArity);
             // copy non fixed
             for(size_t d=0; d<newArity_; ++d){
                 const size_t baseFacD = viewSubmodel_->indexMapping_[indexMappingOffset_ + d];
                 buffer[baseFacD] = conf[d];
             }
             // copy fixed
-            const auto baseArity = baseModelFactor_->arity();
             const auto nFixed = baseArity  - newArity_;
             for(size_t i=0; i<nFixed; ++i){
                 const auto p = viewSubmodel_->fixedVarPos_[fixedVarPosOffset_+i];
                 buffer[p] = viewSubmodel_->baseModelLabels_[baseModelFactor_->variable(p)];
             }
-            return baseModelFactor_->eval(buffer);
+            return baseModelFactor_->eval(buffer.data());
         }
         virtual DiscreteLabel shape(const size_t d) const {
             const size_t baseFacD = viewSubmodel_->indexMapping_[indexMappingOffset_ + d];
@@ -181,12 +188,44 @@ namespace detail_view_submodel{
         const size_t  newArity_;
         const uint64_t indexMappingOffset_;
         const uint64_t fixedVarPosOffset_;
-        const uint64_t confBufferOffset_;
 
         PartialView<PartiallyIncludedFactor<VIEW_SUBMODEL> > newVt_;
     };
 
 
+    /** \brief unary class of  inferno::models::ViewSubmodel
+
+        This unary directly uses the value table of the base-model unary
+        this unary is viewing to.
+    */
+    template<class VIEW_SUBMODEL>
+    class Unary : public inferno::models::DiscreteUnaryBase< Unary<VIEW_SUBMODEL>, VIEW_SUBMODEL >{
+    private:
+        typedef typename VIEW_SUBMODEL::VariableDescriptor VariableDescriptor;
+        typedef typename VIEW_SUBMODEL::BaseModelUnaryProxy BaseModelUnaryProxy;
+    public:
+        Unary(const VIEW_SUBMODEL & viewSubmodel, const BaseModelUnaryProxy baseModelUnary)
+        :   viewSubmodel_(&viewSubmodel),
+            baseModelUnary_(baseModelUnary){
+        }
+        const inferno::value_tables::DiscreteUnaryValueTableBase * valueTable()const{
+            return baseModelUnary_->valueTable();
+        }
+        uint32_t arity()const{
+            return 1;
+        }
+        LabelType shape()const{
+            return baseModelUnary_->shape();
+        }
+        VariableDescriptor variable()const{
+            return viewSubmodel_->fromBaseModelVariableDescriptor(baseModelUnary_->variable());
+        }
+    private:
+        const VIEW_SUBMODEL * viewSubmodel_;
+        BaseModelUnaryProxy baseModelUnary_;
+    };
+
+
     /// \cond
     template<class BASE_MODEL>
     class VariableMapping{
@@ -208,7 +247,8 @@ namespace detail_view_submodel{
         VariableMapping(const BaseModel & baseModel)
         :   notInSubmodelId_(baseModel.maxVarId()+1),
             fromBaseVarDesc_(baseModel,notInSubmodelId_),
-            toBaseVarDesc_(){
+            toBaseVarDesc_(),
+            nVar_(0){
 
         }
 
@@ -217,6 +257,9 @@ namespace detail_view_submodel{
             BASE_VI_ITER baseViIter,
             BASE_VI_ITER baseViEnd
         ){
+            // forget the variables of the last call
+            for(const auto baseVi : toBaseVarDesc_)
+                fromBaseVarDesc_[baseVi] = notInSubmodelId_;
             toBaseVarDesc_.resize(0);
             // forward and backward mapping 
             // between vi and baseVi
@@ -331,7 +374,7 @@ namespace detail_view_submodel{
 */
 template<class BASE_MODEL, class BASE_MODEL_FACTORS_OF_VARIABLES>
 class ViewSubmodel :
-    public DiscreteGraphicalModelBase< ViewSubmodel<BASE_MODEL, BASE_MODEL_FACTORS_OF_VARIABLES> > {
+    public SimpleDiscreteGraphicalModelBase< ViewSubmodel<BASE_MODEL, BASE_MODEL_FACTORS_OF_VARIABLES> > {
 private: 
     typedef ViewSubmodel<BASE_MODEL, BASE_MODEL_FACTORS_OF_VARIABLES> Self;
     enum FactorIncluding{
@@ -344,69 +387,30 @@ private:
     typedef detail_view_submodel::FactorBase<Self> FactorBase;
     typedef detail_view_submodel::FullyIncludedFactor<Self> FullyIncludedFactor;
     typedef detail_view_submodel::PartiallyIncludedFactor<Self> PartiallyIncludedFactor;
+    typedef detail_view_submodel::Unary<Self> UnaryType;
 
     friend class detail_view_submodel::PartiallyIncludedFactor<Self>;
     friend class detail_view_submodel::PartialView<Self>;
 public:
 
-    /** \brief container which can store an instance
-        of T for any variable id.
-
-        \warning changing the number of the variables in
-        this model will invalidate any instance VariableMap.
-    */
-    template<class T>
-    class VariableMap : public std::vector<T>{
-    public:
-        VariableMap(const ViewSubmodel & m, const T & val)
-        : std::vector<T>(m.nVariables(),val){
-        }//
-        VariableMap(const ViewSubmodel & m)
-        : std::vector<T>(m.nVariables()){
-        }
-    };
-    /** \brief container which can store an instance
-        of T for any factor id.
-
-        \warning Adding additional factors or changing the number of the factors in
-        this model will invalidate any instance FactorMap.
-    */
-    template<class T>
-    class FactorMap : public std::vector<T>{
-    public:
-        FactorMap(const ViewSubmodel & m, const T & val)
-        : std::vector<T>(m.nFactors(),val){
-        }
-        FactorMap(const ViewSubmodel & m)
-        : std::vector<T>(m.nFactors()){
-        }
-    };
-
-
     typedef typename BASE_MODEL::FactorProxy BaseModelFactorProxy;
+    typedef typename BASE_MODEL::UnaryProxy BaseModelUnaryProxy;
+    typedef typename BASE_MODEL::UnaryDescriptor BaseModelUnaryDescriptor;
 
     typedef const FactorBase * FactorProxy;
+    typedef FactorProxy FactorProxyRef;
+    typedef const UnaryType * UnaryProxy;
+    typedef UnaryProxy UnaryProxyRef;
+    typedef DeadCodeConstraint<Self> ConstraintProxy;
+    typedef ConstraintProxy ConstraintProxyRef;
     const static bool SortedVariableIds = true;
     const static bool SortedFactorIds = true;
 
-
-    typedef typename VariableMapping::VariableDescriptorIter VariableDescriptorIter;
-    typedef boost::counting_iterator<Fi> FactorDescriptorIter;
-
+    typedef typename  VariableMapping::BaseModelVariableDescriptor BaseModelVariableDescriptor;
 
     /// \deprecated
     typedef typename VariableMapping::VariableIdIter VariableIdIter;
 
-    /// \ deprecated
-    typedef boost::counting_iterator<Fi> FactorIdIter;
-
-    typedef Fi FactorDescriptor;
-
-    typedef typename  VariableMapping::BaseModelVariableDescriptor BaseModelVariableDescriptor;
-    typedef typename  VariableMapping::VariableDescriptor VariableDescriptor;
-
-
-
     // typedefs of adapter API
 
     /** \var typedef BaseModel 
@@ -422,14 +426,19 @@ public:
     ViewSubmodel(const BASE_MODEL & baseModel, const BASE_MODEL_FACTORS_OF_VARIABLES & baseModelFactorsOfVariables)
     :   baseModel_(baseModel),
         baseModelFacOfVars_(baseModelFactorsOfVariables),
+        baseModelUnariesOfVars_(baseModel),
         baseModelLabels_(baseModel),
         variableMapping_(baseModel),
         baseFiIncluding_(baseModel, NotIncluded),
         includedFactors_(baseModel.nFactors(),0),
         includedFactorsStorageIndex_(baseModel.nFactors(),0),
         nFac_(0),
-        maxArity_(baseModel.maxArity()){
+        maxArity_(baseModel.maxArity()),
+        constTerm_(0),
+        constTermDirty_(true){
 
+        for(const auto unaryDesc : baseModel_.unaryDescriptors())
+            baseModelUnariesOfVars_[baseModel_.unary(unaryDesc)->variable()].push_back(unaryDesc);
     }
 
 
@@ -447,6 +456,10 @@ public:
     /** \brief set which variables from the base model 
         are in the submodel.
 
+        Can be called multiple times, the cost of a call
+        only depends on the size of the current and
+        the last submodel.
+
         \todo check that baseViIter is sorted
     */
     template<class BASE_VI_ITER>
@@ -454,6 +467,17 @@ public:
         BASE_VI_ITER baseViIter,
         BASE_VI_ITER baseViEnd
     ){
+        // forget the factors of the last call
+        for(Fi fi=0; fi<nFac_; ++fi)
+            baseFiIncluding_[includedFactors_[fi]] = NotIncluded;
+        nFac_ = 0;
+        fullyIncFactors_.clear();
+        partiallyIncFactors_.clear();
+        unaries_.clear();
+        indexMapping_.clear();
+        fixedVarPos_.clear();
+        constTermDirty_ = true;
+
         // forward and backward mapping 
         // between vi and baseVi
 
@@ -471,6 +495,9 @@ public:
         for(Vi vi=0; vi< this->nVariables(); ++vi){
             const Vi baseVi = viToBaseVi(vi);
 
+            for(const auto unaryDesc : baseModelUnariesOfVars_[baseVi])
+                unaries_.push_back(UnaryType(*this, baseModel_.unary(unaryDesc)));
+
             // iterate over all factors for baseVi
             for(const auto  baseFi : baseModelFacOfVars_[baseVi]){
                 if(baseFiIncluding_[baseFi]==NotIncluded){
@@ -513,7 +540,6 @@ public:
                         // A BIT OF COMPLICATED SETUP
                         const auto indexMappingOffset = indexMapping_.size();
                         const auto fixedVarPosOffset = fixedVarPos_.size();
-                        const auto confBufferOffset = confBuffer_.size();
                         
                         for(auto d=0; d<nNotFixed; ++d){
                             indexMapping_.push_back(notFixedPos[d]);
@@ -523,14 +549,9 @@ public:
                             fixedVarPos_.push_back(fixedPos[i]);
                         }
 
-                        // make possible new allocs
-                        for(auto a=0; a<arity; ++a){
-                            confBuffer_.push_back(DiscreteLabel());
-                        }
-
                         includedFactorsStorageIndex_[nFac_] = partiallyIncFactors_.size();
                         partiallyIncFactors_.push_back(PartiallyIncludedFactor(*this, baseFi, nNotFixed,
-                                                    indexMappingOffset, fixedVarPosOffset, confBufferOffset)
+                                                    indexMappingOffset, fixedVarPosOffset)
                         );
 
                     }
@@ -544,27 +565,11 @@ public:
             pFac.finish();
     }
 
-
-    VariableIdIter variableDescriptorsBegin()const{
-        return variableMapping_.variableDescriptorsBegin();
-    }
-
-    VariableIdIter variableDescriptorsEnd()const{
-        return variableMapping_.variableDescriptorsEnd();
-    }
-
-
-
-    /** \brief begin iterator to the variable indices
-        of the model
-    */
+    /// \deprecated
     VariableIdIter variableIdsBegin()const{
         return variableMapping_.variableIdsBegin();
     }
-
-    /** \brief begin iterator to the variable indices
-        of the model
-    */
+    /// \deprecated
     VariableIdIter variableIdsEnd()const{
         return variableMapping_.variableIdsEnd();
     }
@@ -577,54 +582,19 @@ public:
     uint64_t nVariables()const{
         return variableMapping_.nVariables();
     }
-    /** \brief get the minimal variable id in the model 
-        
-        <b>Complexity:</b> O(1)
-
-        \warning 
-        - if the graphical model has no variables,
-            calling this function will have undefined behavior.
-
-    */
-    Vi minVarId()const{
-        return variableMapping_.minVarId();
+    /// \brief number of factors in the model
+    uint64_t nFactors()const{
+        return nFac_;
     }
-    /** \brief get the maximal variable id in the model
-
-        <b>Complexity:</b> O(1)
-
-        \warning 
-        - if the graphical model has no variables,
-            calling this function will have undefined behavior.
-    */
-    Vi maxVarId()const{
-        return variableMapping_.maxVarId();
+    /// \brief number of unaries in the model
+    uint64_t nUnaries()const{
+        return unaries_.size();
     }
-
-
-    FactorDescriptorIter factorDescriptorsBegin()const{
-        return FactorDescriptorIter(0);
+    /// \brief number of constraints in the model (always 0)
+    uint64_t nConstraints()const{
+        return 0;
     }
-    /** \brief end iterator of the factor indices
-        of the model
-    */
-    FactorDescriptorIter factorDescriptorsEnd()const{
-        return FactorDescriptorIter(nFac_);
-    }
-
 
-    /** \brief begin iterator to the factor indices
-        of the model
-    */
-    FactorIdIter factorIdsBegin()const{
-        return FactorIdIter(0);
-    }
-    /** \brief end iterator of the factor indices
-        of the model
-    */
-    FactorIdIter factorIdsEnd()const{
-        return FactorIdIter(nFac_);
-    }
     /** \brief get the number of labels for a certain
         variable of the model
         
@@ -652,27 +622,35 @@ public:
             return & partiallyIncFactors_[includedFactorsStorageIndex_[fi]];
         }
     }
+    /** \brief get the unary for a certain unary index.
 
+        \param ui : unary index
+    */
+    UnaryProxy unary(const Vi ui) const {
+        return & unaries_[ui];
+    }
 
+    /** \brief constraints of the base-model are not
+        viewed, there are no constraints.
+    */
+    ConstraintProxy constraint(const int64_t ) const {
+        return ConstraintProxy();
+    }
 
-
-
-
-
-    VariableDescriptor fromBaseModelVariableDescriptor(
+    BaseModelVariableDescriptor fromBaseModelVariableDescriptor(
         const BaseModelVariableDescriptor baseModelVariableDescriptor
     )const{
         return variableMapping_.fromBaseModelVariableDescriptor(baseModelVariableDescriptor);
     }
 
     BaseModelVariableDescriptor toBaseModelVariableDescriptor(
-        const VariableDescriptor variableDescriptor
+        const Vi variableDescriptor
     )const{
         return variableMapping_.toBaseModelVariableDescriptor(variableDescriptor);
     }
 
     bool inSubmodel(const BaseModelVariableDescriptor baseModelVariableDescriptor)const{
-        return variableMapping_.inSubmodel();
+        return variableMapping_.inSubmodel(baseModelVariableDescriptor);
     }
 
 
@@ -717,7 +695,7 @@ public:
         \param baseFi : factor index w.r.t. the base-model
     */
     FactorIncluding baseFiIncluding(const Fi baseFi)const{
-        return includedFactors_[baseFi];
+        return baseFiIncluding_[baseFi];
     }
 
 
@@ -729,72 +707,74 @@ public:
 
 
     /** \brief get the baseModel label map
+
+        The labels of the base-model variables which
+        are not in the submodel are fixed to these labels.
     */
-    BaseModelLabelMap & baseModelLabelMap(){
+    const BaseModelLabelMap & baseModelLabelMap()const{
         return  baseModelLabels_;
     }
 
+    /** \brief set the label of a base-model variable
+
+        Invalidates the cached const term.
+    */
+    void setBaseModelLabel(
+        const BaseModelVariableDescriptor baseModelVariableDescriptor,
+        const DiscreteLabel label
+    ){
+        baseModelLabels_[baseModelVariableDescriptor] = label;
+        constTermDirty_ = true;
+    }
+
     /** \brief compute const term. 
 
         The constant term is the energy of 
-        all factors which are not included
+        all factors and unaries which are not included
         in the sub-model (not even partially included).
-        If the base-model labels change (baseModelLabelMap)
+        If the base-model labels change (setBaseModelLabel)
         the constant term will change.
-        \warning The const term is recomputed on every call.
-
+        The const term is cached, it is recomputed after 
+        setSubmodelVariables and setBaseModelLabel have been called.
     */
     ValueType constTerm()const{
-        ValueType constT = 0.0;
-        SmallVector<DiscreteLabel> conf(maxArity_);
-        for(const auto baseFi : baseModel_.factorDescriptors()){
-            if(baseFiIncluding_[baseFi] == NotIncluded){
-                const auto baseFactor = baseModel_.factor(baseFi);
-                baseFactor->getFactorConf(baseModelLabels_, conf.begin());
-                constT += baseFactor->eval(conf.data());
+        if(constTermDirty_){
+            ValueType constT = baseModel_.constTerm();
+            SmallVector<DiscreteLabel> conf(maxArity_);
+            for(const auto baseFi : baseModel_.factorDescriptors()){
+                if(baseFiIncluding_[baseFi] == NotIncluded){
+                    const auto baseFactor = baseModel_.factor(baseFi);
+                    baseFactor->getFactorConf(baseModelLabels_, conf.begin());
+                    constT += baseFactor->eval(conf.data());
+                }
+            }
+            for(const auto baseUnary : baseModel_.unaries()){
+                const auto baseVi = baseUnary->variable();
+                if(!this->isInSubmodel(baseVi))
+                    constT += baseUnary->eval(baseModelLabels_[baseVi]);
             }
+            constTerm_ = constT;
+            constTermDirty_ = false;
         }
-        return constT;
+        return constTerm_;
     }
 
+    /** \brief overwrite the const term until
+        the next call of setSubmodelVariables / setBaseModelLabel.
 
-    /// \brief convert factor descriptor into factor id
-    ///
-    /// For this type of graphical model, factor ids and descriptors
-    /// are equivalent
-    Fi factorId(const FactorDescriptor factorDescriptor)const{
-        return factorDescriptor;
-    }
-
-    /// \brief convert variable descriptor into variable id
-    ///
-    /// For this type of graphical model, variable ids and descriptors
-    /// are equivalent
-    Vi variableId(const VariableDescriptor variableDescriptor)const{
-        return variableDescriptor;
-    }
-
-    /// \brief convert factor id into factor descriptor
-    ///
-    /// For this type of graphical model, factor ids and descriptors
-    /// are equivalent
-    FactorDescriptor factorDescriptor(const Fi fi)const{
-        return fi;
-    }
-
-    /// \brief convert factor id into factor descriptor
-    ///
-    /// For this type of graphical model, factor ids and descriptors
-    /// are equivalent
-    VariableDescriptor variableDescriptor(const Vi vi)const{
-        return vi;
+        Useful if the energy of the rest of the base-model 
+        is not of any interest, since computing the const term
+        is linear in the size of the base-model.
+    */
+    void setConstTerm(const ValueType constTerm){
+        constTerm_ = constTerm;
+        constTermDirty_ = false;
     }
 
-
-
 private:
     const BASE_MODEL & baseModel_;
     const BASE_MODEL_FACTORS_OF_VARIABLES & baseModelFacOfVars_;
+    typename BaseModel:: template VariableMap<std::vector<BaseModelUnaryDescriptor> > baseModelUnariesOfVars_;
     BaseModelLabelMap baseModelLabels_;
     VariableMapping variableMapping_;
     
@@ -806,14 +786,16 @@ private:
 
     std::vector<size_t>        indexMapping_;
     std::vector<size_t>        fixedVarPos_;
-    mutable std::vector<DiscreteLabel> confBuffer_;
 
     Fi nFac_;
     size_t maxArity_;
+    mutable ValueType constTerm_;
+    mutable bool constTermDirty_;
     
 
     std::vector<FullyIncludedFactor> fullyIncFactors_;
     std::vector<PartiallyIncludedFactor> partiallyIncFactors_;
+    std::vector<UnaryType> unaries_;
 };
 
 
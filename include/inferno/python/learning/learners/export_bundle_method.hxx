@@ -0,0 +1,168 @@
+#ifndef INFERNO_PYTHON_LEARNING_LEARNERS_EXPORT_BUNDLE_METHOD_HXX
+#define INFERNO_PYTHON_LEARNING_LEARNERS_EXPORT_BUNDLE_METHOD_HXX
+
+
+// boost python related
+#include <boost/python/detail/wrap_python.hpp>
+#include <boost/python.hpp>
+#include <boost/python/module.hpp>
+#include <boost/python/def.hpp>
+#include <boost/python/exception_translator.hpp>
+#include <boost/python/def_visitor.hpp>
+
+
+// vigra numpy array converters
+#include <vigra/numpy_array.hxx>
+#include <vigra/numpy_array_converters.hxx>
+#include <boost/python/exception_translator.hpp>
+
+// standart c++ headers (whatever you need (string and vector are just examples))
+#include <string>
+#include <vector>
+
+// inferno relatex
+#include "inferno/inferno.hxx"
+#include "inferno/inferno_python.hxx"
+
+#include "inferno/learning/learners/bundle_method.hxx"
+
+
+namespace inferno{
+namespace learning{
+namespace learners{
+
+    namespace bp = boost::python;
+
+    template<class LEARNER>
+    LEARNER * bundleMethodFactory(
+        typename LEARNER::Dataset & dataset,
+        const uint64_t              maxIterations,
+        const double                eps,
+        const int                   nThreads,
+        const bool                  warmStart,
+        const uint64_t              maxInactive,
+        const double                qpEps,
+        const uint64_t              qpMaxIterations,
+        const int                   showLossEvery
+    ){
+        LEARNER * learner;
+        {
+            ScopedGILRelease allowThreads;
+            const auto options = typename LEARNER::Options(
+                maxIterations,
+                eps,
+                nThreads,
+                warmStart,
+                maxInactive,
+                qpEps,
+                qpMaxIterations,
+                showLossEvery
+            );
+            learner = new LEARNER(dataset, options);
+        }
+        return learner;
+    }
+
+    template<class LEARNER>
+    void bundleMethodLearn(
+        LEARNER & learner,
+        typename LEARNER::LossAugmentedInferenceFactoryBase * lossInfFactory,
+        WeightVector & weightVector
+    ){
+        {
+            ScopedGILRelease allowThreads;
+            learner.learn(lossInfFactory, weightVector);
+        }
+    }
+
+    template<class LEARNER>
+    void bundleMethodLearn2(
+        LEARNER & learner,
+        typename LEARNER::LossAugmentedInferenceFactoryBase * lossInfFactory,
+        WeightVector & weightVector,
+        typename LEARNER::InferenceFactoryBase * inferenceFactory
+    ){
+        {
+            ScopedGILRelease allowThreads;
+            learner.learn(lossInfFactory, weightVector, inferenceFactory);
+        }
+    }
+
+    template<class LEARNER>
+    void bundleMethodLearn3(
+        LEARNER & learner,
+        typename LEARNER::LossAugmentedInferenceFactoryBase * lossInfFactory,
+        WeightVector & weightVector,
+        typename LEARNER::InferenceFactoryBase * inferenceFactory,
+        LearningVisitorBase * visitor
+    ){
+        {
+            ScopedGILRelease allowThreads;
+            learner.learn(lossInfFactory, weightVector, inferenceFactory, visitor);
+        }
+    }
+
+    template<class DATASET>
+    struct ExportBundleMethod{
+        typedef DATASET Dataset;
+
+        // the class to export
+        typedef learning::learners::BundleMethod<Dataset> Learner;
+        typedef typename Learner::Options Options;
+
+
+        static void exportLearner(const std::string & className){
+            // the class
+            bp::class_<Learner,boost::noncopyable>(className.c_str(),bp::no_init)
+                .def("learn",
+                    &bundleMethodLearn<Learner>,
+                    (
+                        bp::arg("lossAugmentedInferenceFactory"),
+                        bp::arg("weightVector")
+                    )
+                )
+                .def("learn",
+                    &bundleMethodLearn2<Learner>,
+                    (
+                        bp::arg("lossAugmentedInferenceFactory"),
+                        bp::arg("weightVector"),
+                        bp::arg("inferenceFactory")
+                    )
+                )
+                .def("learn",
+                    &bundleMethodLearn3<Learner>,
+                    (
+                        bp::arg("lossAugmentedInferenceFactory"),
+                        bp::arg("weightVector"),
+                        bp::arg("inferenceFactory"),
+                        bp::arg("visitor")
+                    )
+                )
+            ;
+
+            const Options defaultOptions;
+            // the factory function
+            bp::def("bundleMethod",
+                &bundleMethodFactory<Learner>,
+                (
+                    bp::arg("dataset"),
+                    bp::arg("maxIterations") = uint64_t(defaultOptions.maxIterations_) ,
+                    bp::arg("eps") = double(defaultOptions.eps_) ,
+                    bp::arg("nThreads") = int(defaultOptions.nThreads_),
+                    bp::arg("warmStart") = bool(defaultOptions.warmStart_),
+                    bp::arg("maxInactive") = uint64_t(defaultOptions.maxInactive_),
+                    bp::arg("qpEps") = double(defaultOptions.qpEps_),
+                    bp::arg("qpMaxIterations") = uint64_t(defaultOptions.qpMaxIterations_),
+                    bp::arg("showLossEvery") = int(defaultOptions.showLossEvery_)
+                ),
+                RetValPol< CustWardPost<0,1,NewObj> >()
+            );
+        }
+
+    };
+}
+}
+}
+
+
+#endif /* INFERNO_PYTHON_LEARNING_LEARNERS_EXPORT_BUNDLE_METHOD_HXX*/
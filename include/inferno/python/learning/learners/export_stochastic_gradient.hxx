@@ -41,7 +41,9 @@ namespace learners{
         const double                sigma,
         const int                   verbose,
         const int                   seed,
-        const double                n
+        const double                n,
+        const uint64_t              nThreads,
+        const bool                  warmStart
     ){
         LEARNER * learner;
         {
@@ -52,7 +54,9 @@ namespace learners{
                 sigma,
                 verbose,
                 seed,
-                n
+                n,
+                nThreads,
+                warmStart
             );
             learner = new LEARNER(dataset, options);
         }
@@ -108,7 +112,9 @@ namespace learners{
                     bp::arg("sigma") = double(defaultOptions.sigma_) ,
                     bp::arg("verbose")= int(defaultOptions.verbose_) ,
                     bp::arg("seed")= int(defaultOptions.seed_),
-                    bp::arg("n")= int(defaultOptions.n_)
+                    bp::arg("n")= int(defaultOptions.n_),
+                    bp::arg("nThreads")= uint64_t(defaultOptions.nThreads_),
+                    bp::arg("warmStart")= bool(defaultOptions.warmStart_)
                 ),
                 RetValPol< CustWardPost<0,1,NewObj> >()
             );
@@ -44,7 +44,10 @@ namespace learners{
         const int                   nThreads,
         const int                   averagingOrder,
         const int                   showLossEvery,
-        const int                   showRegularizerEvery
+        const int                   showRegularizerEvery,
+        const uint64_t              batchSize,
+        const bool                  hogwild,
+        const bool                  warmStart
     ){
         LEARNER * learner;
         {
@@ -58,7 +61,10 @@ namespace learners{
                 nThreads,
                 averagingOrder,
                 showLossEvery,
-                showRegularizerEvery
+                showRegularizerEvery,
+                batchSize,
+                hogwild,
+                warmStart
             );
             learner = new LEARNER(dataset, options);
         }
@@ -92,6 +98,30 @@ namespace learners{
         }
     }
 
+    template<class LEARNER>
+    void subGradientLearn3(
+        LEARNER & learner,
+        typename LEARNER::LossAugmentedInferenceFactoryBase * lossInfFactory,
+        WeightVector & weightVector,
+        typename LEARNER::InferenceFactoryBase * inferenceFactory,
+        LearningVisitorBase * visitor
+    ){
+        
+        {
+            ScopedGILRelease allowThreads;
+            learner.learn(lossInfFactory, weightVector, inferenceFactory, visitor);
+        }
+    }
+
+    template<class DATASET>
+    void setValidationDataset(
+        LearningRecorder & recorder,
+        DATASET & dataset,
+        typename DATASET::InferenceFactoryBase * inferenceFactory
+    ){
+        recorder.setValidationDataset(dataset, inferenceFactory);
+    }
+
     template<class DATASET>
     struct ExportSubgradient{
         typedef DATASET Dataset;
@@ -122,8 +152,28 @@ namespace learners{
                         bp::arg("inferenceFactory")
                     )
                 )
+                .def("learn",
+                    &subGradientLearn3<Learner>,
+                    (
+                        bp::arg("lossAugmentedInferenceFactory"),
+                        bp::arg("weightVector"),
+                        bp::arg("inferenceFactory"),
+                        bp::arg("visitor")
+                    )
+                )
             ;
 
+            // the dataset and the factory must outlive the recorder
+            bp::def("setValidationDataset",
+                &setValidationDataset<Dataset>,
+                (
+                    bp::arg("recorder"),
+                    bp::arg("dataset"),
+                    bp::arg("inferenceFactory")
+                ),
+                CustWardPost<1,2, CustWardPostEnd<1,3> >()
+            );
+
             const Options defaultOptions;
             // the factory function
             bp::def("subGradient",
@@ -138,7 +188,10 @@ namespace learners{
                     bp::arg("nThreads") =int(defaultOptions.nThreads_),
                     bp::arg("averagingOrder") =int(defaultOptions.averagingOrder_),
                     bp::arg("showLossEvery") =int(defaultOptions.showLossEvery_),
-                    bp::arg("showRegularizerEvery") =int(defaultOptions.showRegularizerEvery_)
+                    bp::arg("showRegularizerEvery") =int(defaultOptions.showRegularizerEvery_),
+                    bp::arg("batchSize") =uint64_t(defaultOptions.batchSize_),
+                    bp::arg("hogwild") =bool(defaultOptions.hogwild_),
+                    bp::arg("warmStart") =bool(defaultOptions.warmStart_)
                 ),
                 RetValPol< CustWardPost<0,1,NewObj> >()
             );
@@ -0,0 +1,86 @@
+/** \file counter_based_random.hxx
+    \brief  Implementation of inferno::utilities::CounterBasedRandom,
+    a stateless random number generator.
+*/
+#ifndef INFERNO_UTILITIES_COUNTER_BASED_RANDOM_HXX
+#define INFERNO_UTILITIES_COUNTER_BASED_RANDOM_HXX
+
+// std
+#include <cstdint>
+#include <cmath>
+
+namespace inferno{
+namespace utilities{
+
+
+    /** \brief Counter based (stateless) random number generator
+
+        Each random number is a hash (the SplitMix64 finalizer)
+        of the seed, a stream and a counter.
+        Since there is no state, the numbers of a stream
+        can be generated in any order and from any thread,
+        the result depends only on (seed, stream, counter).
+        Streams are usually made from several keys
+        (e.g. an iteration and a perturbation index) via
+        CounterBasedRandom::stream.
+    */
+    class CounterBasedRandom{
+    public:
+        CounterBasedRandom(const uint64_t seed = 0)
+        :   seed_(mix(seed + 0x9e3779b97f4a7c15ULL)){
+        }
+
+        /// \brief stream from two keys
+        uint64_t stream(const uint64_t keyA, const uint64_t keyB = 0)const{
+            return mix(mix(seed_ ^ keyA) + keyB);
+        }
+
+        /// \brief random 64 bit integer
+        uint64_t operator()(const uint64_t stream, const uint64_t counter)const{
+            return mix(stream + counter*0x9e3779b97f4a7c15ULL);
+        }
+
+        /// \brief uniform random number in (0,1]
+        double uniform(const uint64_t stream, const uint64_t counter)const{
+            return double(((*this)(stream, counter) >> 11) + 1) * (1.0/9007199254740992.0);
+        }
+
+        /** \brief fill [out, out+n) with normal distributed numbers
+
+            out[i] is the number with counter i of the stream
+            (Box-Muller transform of the uniform numbers
+            with counter 2*(i/2) and 2*(i/2)+1).
+        */
+        template<class T>
+        void normal(const uint64_t stream, const size_t n, T * out,
+                    const double mean = 0.0, const double sigma = 1.0)const{
+            const double twoPi = 6.283185307179586476925286766559;
+            const size_t nPairs = n/2;
+            for(size_t i=0; i<nPairs; ++i){
+                const auto r = sigma*std::sqrt(-2.0*std::log(this->uniform(stream, 2*i)));
+                const auto phi = twoPi*this->uniform(stream, 2*i + 1);
+                out[2*i]     = mean + r*std::cos(phi);
+                out[2*i + 1] = mean + r*std::sin(phi);
+            }
+            if(n % 2 == 1){
+                const auto i = nPairs;
+                const auto r = sigma*std::sqrt(-2.0*std::log(this->uniform(stream, 2*i)));
+                out[2*i] = mean + r*std::cos(twoPi*this->uniform(stream, 2*i + 1));
+            }
+        }
+
+    private:
+        static uint64_t mix(uint64_t z){
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        uint64_t seed_;
+    };
+
+
+} // end namespace inferno::utilities
+} // end namespace inferno
+
+#endif /* INFERNO_UTILITIES_COUNTER_BASED_RANDOM_HXX */
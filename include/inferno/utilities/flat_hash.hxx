@@ -0,0 +1,349 @@
+/** \file flat_hash.hxx
+    \brief  inferno::FlatHashSet and inferno::FlatHashMap,
+    open addressing hash containers which store all
+    values in a single array.
+*/
+#pragma once
+#ifndef INFERNO_UTILITIES_FLAT_HASH_HXX
+#define INFERNO_UTILITIES_FLAT_HASH_HXX
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+
+#include "inferno/inferno.hxx"
+
+namespace inferno {
+
+
+/// \cond HIDDEN_SYMBOLS
+namespace detail_flat_hash{
+
+    // std::hash of integers is the identity,
+    // therefore the hash is mixed before masking
+    inline uint64_t mix(uint64_t h){
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    struct SetKeyOf{
+        template<class T>
+        const T & operator()(const T & value)const{
+            return value;
+        }
+    };
+    struct MapKeyOf{
+        template<class PAIR>
+        const typename PAIR::first_type & operator()(const PAIR & value)const{
+            return value.first;
+        }
+    };
+
+    template<class TABLE, class VALUE>
+    class FlatHashIterator{
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename std::remove_const<VALUE>::type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef VALUE * pointer;
+        typedef VALUE & reference;
+
+        FlatHashIterator(TABLE * table = nullptr, const size_t index = 0)
+        :   table_(table),
+            index_(index){
+            this->skip();
+        }
+        // iterator to const iterator
+        template<class OTHER_TABLE, class OTHER_VALUE>
+        FlatHashIterator(const FlatHashIterator<OTHER_TABLE, OTHER_VALUE> & other)
+        :   table_(other.table()),
+            index_(other.index()){
+        }
+        reference operator*()const{
+            return table_->slots_[index_];
+        }
+        pointer operator->()const{
+            return &table_->slots_[index_];
+        }
+        FlatHashIterator & operator++(){
+            ++index_;
+            this->skip();
+            return *this;
+        }
+        FlatHashIterator operator++(int){
+            FlatHashIterator tmp(*this);
+            ++(*this);
+            return tmp;
+        }
+        template<class OTHER_TABLE, class OTHER_VALUE>
+        bool operator==(const FlatHashIterator<OTHER_TABLE, OTHER_VALUE> & other)const{
+            return index_ == other.index();
+        }
+        template<class OTHER_TABLE, class OTHER_VALUE>
+        bool operator!=(const FlatHashIterator<OTHER_TABLE, OTHER_VALUE> & other)const{
+            return index_ != other.index();
+        }
+        TABLE * table()const{
+            return table_;
+        }
+        size_t index()const{
+            return index_;
+        }
+    private:
+        void skip(){
+            if(table_ != nullptr)
+                while(index_ < table_->used_.size() && !table_->used_[index_])
+                    ++index_;
+        }
+        TABLE * table_;
+        size_t index_;
+    };
+
+
+    /*  linear probing hash table with backward shift deletion,
+        the capacity is a power of two and the load factor is at most 3/4
+    */
+    template<class KEY, class VALUE, class KEY_OF, class HASH, class EQUAL>
+    class FlatHashTable{
+    public:
+        typedef KEY key_type;
+        typedef VALUE value_type;
+        typedef size_t size_type;
+        typedef FlatHashIterator<FlatHashTable, VALUE> iterator;
+        typedef FlatHashIterator<const FlatHashTable, const VALUE> const_iterator;
+
+        FlatHashTable(const size_t expectedSize = 0, const HASH & hash = HASH(), const EQUAL & equal = EQUAL())
+        :   slots_(),
+            used_(),
+            size_(0),
+            mask_(0),
+            hash_(hash),
+            equal_(equal){
+            this->reserve(expectedSize);
+        }
+
+        size_t size()const{
+            return size_;
+        }
+        bool empty()const{
+            return size_ == 0;
+        }
+        /// number of slots
+        size_t capacity()const{
+            return slots_.size();
+        }
+
+        iterator begin(){
+            return iterator(this, 0);
+        }
+        iterator end(){
+            return iterator(this, slots_.size());
+        }
+        const_iterator begin()const{
+            return const_iterator(this, 0);
+        }
+        const_iterator end()const{
+            return const_iterator(this, slots_.size());
+        }
+
+        void clear(){
+            for(size_t i=0; i<slots_.size(); ++i){
+                if(used_[i]){
+                    slots_[i] = VALUE();
+                    used_[i] = 0;
+                }
+            }
+            size_ = 0;
+        }
+
+        /// make sure that size elements can be stored without rehashing
+        void reserve(const size_t size){
+            size_t capacity = slots_.empty() ? 8 : slots_.size();
+            while(4*size > 3*capacity)
+                capacity *= 2;
+            if(capacity != slots_.size() && size > 0)
+                this->rehash(capacity);
+        }
+
+        iterator find(const KEY & key){
+            return iterator(this, this->findIndex(key));
+        }
+        const_iterator find(const KEY & key)const{
+            return const_iterator(this, this->findIndex(key));
+        }
+        size_t count(const KEY & key)const{
+            return this->findIndex(key) == slots_.size() ? 0 : 1;
+        }
+
+        std::pair<iterator, bool> insert(const VALUE & value){
+            this->reserve(size_ + 1);
+            size_t i = this->home(keyOf_(value));
+            while(used_[i]){
+                if(equal_(keyOf_(slots_[i]), keyOf_(value)))
+                    return std::make_pair(iterator(this, i), false);
+                i = (i + 1) & mask_;
+            }
+            slots_[i] = value;
+            used_[i] = 1;
+            ++size_;
+            return std::make_pair(iterator(this, i), true);
+        }
+
+        template<class ITER>
+        void insert(ITER begin, ITER end){
+            for(; begin != end; ++begin)
+                this->insert(*begin);
+        }
+
+        /// erase key, returns the number of erased elements (0 or 1)
+        size_t erase(const KEY & key){
+            size_t i = this->findIndex(key);
+            if(i == slots_.size())
+                return 0;
+            // shift the following elements of the probe sequence back
+            size_t j = i;
+            for(;;){
+                j = (j + 1) & mask_;
+                if(!used_[j])
+                    break;
+                const size_t k = this->home(keyOf_(slots_[j]));
+                // move j to i if its home is not cyclically in (i, j]
+                const bool homeInRange = i <= j ? (i < k && k <= j) : (i < k || k <= j);
+                if(!homeInRange){
+                    slots_[i] = std::move(slots_[j]);
+                    i = j;
+                }
+            }
+            slots_[i] = VALUE();
+            used_[i] = 0;
+            --size_;
+            return 1;
+        }
+
+        void swap(FlatHashTable & other){
+            std::swap(slots_, other.slots_);
+            std::swap(used_, other.used_);
+            std::swap(size_, other.size_);
+            std::swap(mask_, other.mask_);
+            std::swap(hash_, other.hash_);
+            std::swap(equal_, other.equal_);
+        }
+
+    protected:
+        size_t home(const KEY & key)const{
+            return size_t(mix(uint64_t(hash_(key)))) & mask_;
+        }
+
+        size_t findIndex(const KEY & key)const{
+            if(size_ == 0)
+                return slots_.size();
+            size_t i = this->home(key);
+            while(used_[i]){
+                if(equal_(keyOf_(slots_[i]), key))
+                    return i;
+                i = (i + 1) & mask_;
+            }
+            return slots_.size();
+        }
+
+        void rehash(const size_t capacity){
+            std::vector<VALUE> oldSlots(capacity);
+            std::vector<unsigned char> oldUsed(capacity, 0);
+            oldSlots.swap(slots_);
+            oldUsed.swap(used_);
+            mask_ = capacity - 1;
+            for(size_t s=0; s<oldSlots.size(); ++s){
+                if(oldUsed[s]){
+                    size_t i = this->home(keyOf_(oldSlots[s]));
+                    while(used_[i])
+                        i = (i + 1) & mask_;
+                    slots_[i] = std::move(oldSlots[s]);
+                    used_[i] = 1;
+                }
+            }
+        }
+
+        template<class TABLE, class V>
+        friend class FlatHashIterator;
+
+        std::vector<VALUE> slots_;
+        std::vector<unsigned char> used_;
+        size_t size_;
+        size_t mask_;
+        HASH hash_;
+        EQUAL equal_;
+        KEY_OF keyOf_;
+    };
+
+}
+/// \endcond
+
+
+/** \brief Hash set with open addressing (linear probing)
+
+    All keys are stored in a single array,
+    therefore inserting does not allocate
+    (apart from rehashing) in contrast to std::unordered_set.
+    Keys must be default constructible,
+    insert and erase invalidate iterators.
+
+    \ingroup utilities
+    \ingroup datastructures
+*/
+template<class Key, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class FlatHashSet
+: public detail_flat_hash::FlatHashTable<Key, Key, detail_flat_hash::SetKeyOf, Hash, Equal>{
+private:
+    typedef detail_flat_hash::FlatHashTable<Key, Key, detail_flat_hash::SetKeyOf, Hash, Equal> BaseType;
+public:
+    FlatHashSet(const size_t expectedSize = 0, const Hash & hash = Hash(), const Equal & equal = Equal())
+    :   BaseType(expectedSize, hash, equal){
+    }
+    template<class ITER>
+    FlatHashSet(ITER begin, ITER end)
+    :   BaseType(){
+        this->insert(begin, end);
+    }
+};
+
+
+/** \brief Hash map with open addressing (linear probing)
+
+    All (key, value) pairs are stored in a single array,
+    therefore inserting does not allocate
+    (apart from rehashing) in contrast to std::unordered_map.
+    Keys and values must be default constructible,
+    insert, erase and operator[] invalidate iterators and references.
+
+    \ingroup utilities
+    \ingroup datastructures
+*/
+template<class Key, class T, class Hash = std::hash<Key>, class Equal = std::equal_to<Key> >
+class FlatHashMap
+: public detail_flat_hash::FlatHashTable<Key, std::pair<Key, T>, detail_flat_hash::MapKeyOf, Hash, Equal>{
+private:
+    typedef detail_flat_hash::FlatHashTable<Key, std::pair<Key, T>, detail_flat_hash::MapKeyOf, Hash, Equal> BaseType;
+public:
+    typedef T mapped_type;
+
+    FlatHashMap(const size_t expectedSize = 0, const Hash & hash = Hash(), const Equal & equal = Equal())
+    :   BaseType(expectedSize, hash, equal){
+    }
+
+    T & operator[](const Key & key){
+        auto it = this->find(key);
+        if(it == this->end())
+            it = this->insert(std::make_pair(key, T())).first;
+        return it->second;
+    }
+};
+
+
+} // namespace inferno
+
+#endif /* INFERNO_UTILITIES_FLAT_HASH_HXX */
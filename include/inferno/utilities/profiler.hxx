@@ -0,0 +1,288 @@
+/** \file profiler.hxx
+    \brief  Implementation of inferno::utilities::Profiler,
+    a hierarchical scoped section profiler with
+    Chrome trace-event output.
+
+    Sections are opened with the INFERNO_PROFILE_SCOPE macro
+    and closed at the end of the enclosing scope:
+
+    \code
+        {
+            INFERNO_PROFILE_SCOPE("Icm::sweep");
+            ...
+        }
+        inferno::utilities::Profiler::instance().writeChromeTrace("trace.json");
+    \endcode
+
+    Unless inferno is compiled with WITH_PROFILER
+    (cmake option WITH_PROFILER), INFERNO_PROFILE_SCOPE
+    expands to nothing and has no overhead at all.
+*/
+#ifndef INFERNO_UTILITIES_PROFILER_HXX
+#define INFERNO_UTILITIES_PROFILER_HXX
+
+// std
+#include <vector>
+#include <map>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+// inferno
+#include "inferno/inferno.hxx"
+
+namespace inferno{
+namespace utilities{
+
+
+    /// \brief a finished (or still open) section of a single thread
+    struct ProfilerEvent{
+        /// \brief name of the section (must outlive the profiler)
+        const char * name_;
+        /// \brief begin in nanoseconds since the construction of the profiler
+        uint64_t begin_;
+        /// \brief end in nanoseconds since the construction of the profiler
+        uint64_t end_;
+        /// \brief index of the enclosing section of the same thread or -1
+        int64_t parent_;
+    };
+
+    /// \brief accumulated statistics of a section path (e.g. "Cgc::infer/Cgc::cutPhase")
+    struct ProfilerSectionStatistics{
+        ProfilerSectionStatistics()
+        :   count_(0),
+            totalTime_(0),
+            selfTime_(0){
+        }
+        uint64_t count_;
+        /// \brief wall-clock seconds including all nested sections
+        double totalTime_;
+        /// \brief wall-clock seconds excluding all nested sections
+        double selfTime_;
+    };
+
+
+    /** \brief Hierarchical scoped section profiler
+
+        Each thread records its sections into its own buffer,
+        therefore recording does not need any synchronization
+        (only the first section of a thread registers the buffer).
+        The buffers are owned by the profiler and outlive their threads.
+
+        The recorded sections can be written as
+        Chrome trace-event JSON (chrome://tracing, perfetto)
+        or summarized per section path.
+        Reading (writeChromeTrace, statistics) and clear
+        must not be called while sections are open.
+    */
+    class Profiler{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        static Profiler & instance(){
+            static Profiler profiler;
+            return profiler;
+        }
+
+        void enable(const bool enabled = true){
+            enabled_.store(enabled, std::memory_order_relaxed);
+        }
+        void disable(){
+            this->enable(false);
+        }
+        bool enabled()const{
+            return enabled_.load(std::memory_order_relaxed);
+        }
+
+        /// \brief remove all recorded sections
+        void clear(){
+            std::lock_guard<std::mutex> lock(mutex_);
+            for(auto & buffer : buffers_){
+                buffer->events_.clear();
+                buffer->current_ = -1;
+            }
+        }
+
+        /// \brief nanoseconds since the construction of the profiler
+        uint64_t now()const{
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - origin_).count());
+        }
+
+        /// \cond
+        // the buffer of the calling thread
+        struct ThreadBuffer{
+            ThreadBuffer(const uint64_t tid)
+            :   tid_(tid),
+                events_(),
+                current_(-1){
+            }
+            uint64_t tid_;
+            std::vector<ProfilerEvent> events_;
+            int64_t current_;
+        };
+        ThreadBuffer & threadBuffer(){
+            static thread_local ThreadBuffer * buffer = nullptr;
+            if(buffer == nullptr){
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffers_.emplace_back(new ThreadBuffer(buffers_.size()));
+                buffer = buffers_.back().get();
+            }
+            return *buffer;
+        }
+        /// \endcond
+
+        /// \brief write all sections as Chrome trace-event JSON
+        void writeChromeTrace(std::ostream & out)const{
+            std::lock_guard<std::mutex> lock(mutex_);
+            out<<"{\"traceEvents\": [\n";
+            bool first = true;
+            for(const auto & buffer : buffers_){
+                for(const auto & e : buffer->events_){
+                    if(!first)
+                        out<<",\n";
+                    first = false;
+                    out<<"  {\"name\": \"";
+                    writeEscaped(out, e.name_);
+                    out<<"\", \"cat\": \"inferno\", \"ph\": \"X\", \"pid\": 0"
+                       <<", \"tid\": "<<buffer->tid_
+                       <<", \"ts\": "<<double(e.begin_)/1000.0
+                       <<", \"dur\": "<<double(e.end_ - e.begin_)/1000.0<<"}";
+                }
+            }
+            out<<"\n], \"displayTimeUnit\": \"ms\"}\n";
+        }
+        void writeChromeTrace(const std::string & filename)const{
+            std::ofstream out(filename.c_str());
+            INFERNO_CHECK(out.good(), "cannot open "+filename);
+            this->writeChromeTrace(out);
+        }
+
+        /** \brief statistics of all section paths (over all threads)
+
+            The path of a section is the '/' separated list
+            of the names of all enclosing sections of the same thread.
+        */
+        std::map<std::string, ProfilerSectionStatistics> statistics()const{
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::map<std::string, ProfilerSectionStatistics> result;
+            std::vector<std::string> paths;
+            std::vector<uint64_t> childTime;
+            for(const auto & buffer : buffers_){
+                const auto & events = buffer->events_;
+                // parents are recorded before their children
+                paths.resize(events.size());
+                childTime.assign(events.size(), 0);
+                for(size_t i=0; i<events.size(); ++i){
+                    const auto & e = events[i];
+                    paths[i] = e.parent_ < 0 ? std::string(e.name_) :
+                        paths[e.parent_] + "/" + e.name_;
+                    if(e.parent_ >= 0)
+                        childTime[e.parent_] += e.end_ - e.begin_;
+                }
+                for(size_t i=0; i<events.size(); ++i){
+                    const auto & e = events[i];
+                    auto & s = result[paths[i]];
+                    ++s.count_;
+                    s.totalTime_ += double(e.end_ - e.begin_)*1.0e-9;
+                    s.selfTime_ += double(e.end_ - e.begin_ - std::min(childTime[i], e.end_ - e.begin_))*1.0e-9;
+                }
+            }
+            return result;
+        }
+
+        /// \brief print the statistics as indented tree
+        void writeSummary(std::ostream & out = std::cout)const{
+            for(const auto & kv : this->statistics()){
+                const auto & path = kv.first;
+                const auto depth = std::count(path.begin(), path.end(), '/');
+                const auto pos = path.rfind('/');
+                out<<std::string(2*depth, ' ')
+                   <<(pos == std::string::npos ? path : path.substr(pos + 1))
+                   <<"  count = "<<kv.second.count_
+                   <<"  total = "<<kv.second.totalTime_<<" s"
+                   <<"  self = "<<kv.second.selfTime_<<" s\n";
+            }
+        }
+
+    private:
+        Profiler()
+        :   enabled_(true),
+            origin_(Clock::now()),
+            mutex_(),
+            buffers_(){
+        }
+        Profiler(const Profiler &) = delete;
+        Profiler & operator=(const Profiler &) = delete;
+
+        static void writeEscaped(std::ostream & out, const char * str){
+            for(; *str != '\0'; ++str){
+                if(*str == '"' || *str == '\\')
+                    out<<'\\';
+                out<<*str;
+            }
+        }
+
+        std::atomic<bool> enabled_;
+        Clock::time_point origin_;
+        mutable std::mutex mutex_;
+        std::vector<std::unique_ptr<ThreadBuffer> > buffers_;
+    };
+
+
+    /// \brief record a section from construction to destruction
+    class ProfilerScope{
+    public:
+        ProfilerScope(const char * name)
+        :   buffer_(nullptr),
+            index_(0){
+            auto & profiler = Profiler::instance();
+            if(profiler.enabled()){
+                buffer_ = &profiler.threadBuffer();
+                index_ = buffer_->events_.size();
+                ProfilerEvent e;
+                e.name_ = name;
+                e.parent_ = buffer_->current_;
+                e.begin_ = profiler.now();
+                e.end_ = e.begin_;
+                buffer_->events_.push_back(e);
+                buffer_->current_ = int64_t(index_);
+            }
+        }
+        ~ProfilerScope(){
+            if(buffer_ != nullptr && index_ < buffer_->events_.size()){
+                auto & e = buffer_->events_[index_];
+                e.end_ = Profiler::instance().now();
+                buffer_->current_ = e.parent_;
+            }
+        }
+    private:
+        ProfilerScope(const ProfilerScope &) = delete;
+        ProfilerScope & operator=(const ProfilerScope &) = delete;
+
+        Profiler::ThreadBuffer * buffer_;
+        size_t index_;
+    };
+
+
+} // end namespace inferno::utilities
+} // end namespace inferno
+
+
+#define INFERNO_PROFILER_CONCAT_IMPL(A, B) A##B
+#define INFERNO_PROFILER_CONCAT(A, B) INFERNO_PROFILER_CONCAT_IMPL(A, B)
+
+#ifdef WITH_PROFILER
+    /// \brief profile the enclosing scope as section NAME (a string literal)
+    #define INFERNO_PROFILE_SCOPE(NAME) \
+        ::inferno::utilities::ProfilerScope INFERNO_PROFILER_CONCAT(infernoProfilerScope, __LINE__)(NAME)
+#else
+    #define INFERNO_PROFILE_SCOPE(NAME) do{}while(false)
+#endif
+
+#endif /* INFERNO_UTILITIES_PROFILER_HXX */
@@ -4,6 +4,16 @@
 
 #include <queue>
 #include <vector>
+#include <array>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "inferno/inferno.hxx"
 
 namespace inferno{
 
@@ -238,6 +248,667 @@ private:
 
 };
 
+/// \cond
+namespace detail_queues{
+
+    // uninitialized storage of trivially copyable
+    // elements with an aligned first element
+    template<class T, size_t ALIGNMENT = 64>
+    class AlignedBuffer{
+        static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer needs trivially copyable elements");
+    public:
+        AlignedBuffer(const size_t size = 0)
+        :   size_(0),
+            raw_(),
+            data_(nullptr){
+            this->resize(size);
+        }
+        AlignedBuffer(const AlignedBuffer & other)
+        :   AlignedBuffer(other.size_){
+            std::copy(other.data_, other.data_ + size_, data_);
+        }
+        AlignedBuffer & operator=(const AlignedBuffer & other){
+            if(this != &other){
+                this->resize(other.size_);
+                std::copy(other.data_, other.data_ + size_, data_);
+            }
+            return *this;
+        }
+        void resize(const size_t size){
+            size_ = size;
+            raw_.reset(new char[size*sizeof(T) + ALIGNMENT]);
+            const auto address = reinterpret_cast<uintptr_t>(raw_.get());
+            data_ = reinterpret_cast<T*>((address + ALIGNMENT - 1) & ~uintptr_t(ALIGNMENT - 1));
+        }
+        T & operator[](const size_t i){
+            return data_[i];
+        }
+        const T & operator[](const size_t i)const{
+            return data_[i];
+        }
+    private:
+        size_t size_;
+        std::unique_ptr<char[]> raw_;
+        T * data_;
+    };
+
+    // order preserving map of keys to unsigned integers
+    inline uint64_t radixBits(const uint64_t key){
+        return key;
+    }
+    inline uint64_t radixBits(const uint32_t key){
+        return key;
+    }
+    inline uint64_t radixBits(const int64_t key){
+        return uint64_t(key) ^ (uint64_t(1) << 63);
+    }
+    inline uint64_t radixBits(const int32_t key){
+        return radixBits(int64_t(key));
+    }
+    // non-negative floating point numbers
+    // are ordered as their bit patterns
+    inline uint64_t radixBits(const double key){
+        INFERNO_ASSERT_OP(key, >=, 0.0);
+        const double positive = key + 0.0; // no negative zero
+        uint64_t bits;
+        std::memcpy(&bits, &positive, sizeof(bits));
+        return bits;
+    }
+    inline uint64_t radixBits(const float key){
+        INFERNO_ASSERT_OP(key, >=, 0.0f);
+        const float positive = key + 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &positive, sizeof(bits));
+        return bits;
+    }
+
+    // index of the highest bit in which a and b differ plus one (0 if a == b)
+    inline size_t radixBucket(const uint64_t a, const uint64_t b){
+        return a == b ? 0 : 64 - __builtin_clzll(a ^ b);
+    }
+
+    template<class ID_ITER>
+    size_t batchSize(ID_ITER begin, ID_ITER end, std::random_access_iterator_tag){
+        return std::distance(begin, end);
+    }
+    template<class ID_ITER, class TAG>
+    size_t batchSize(ID_ITER, ID_ITER, TAG){
+        return 0;
+    }
+
+} // end namespace inferno::detail_queues
+/// \endcond
+
+
+
+/** \brief Indexed D-ary heap with changeable priorities
+    and a maximum number of elements.
+
+    Same interface as ChangeablePriorityQueue, but with
+    64 bit ids, priorities stored next to the ids in the heap
+    and D = 4 children per node by default:
+    The heap is shallower than a binary heap and the
+    children of a node are stored in a single (64 byte aligned)
+    cache line if D*(sizeof(T) + 8) is 64 (e.g. D = 4 and double priorities).
+
+    With std::less the element with the smallest priority is on top.
+*/
+template<class T, size_t D = 4, class COMPARE = std::less<T> >
+class DaryHeap{
+    static_assert(D >= 2, "DaryHeap needs at least 2 children per node");
+public:
+    typedef T priority_type;
+    typedef uint64_t ValueType;
+    typedef ValueType value_type;
+    typedef ValueType const_reference;
+
+    /// Create an empty DaryHeap which can contain the ids 0,...,maxSize-1
+    DaryHeap(const size_t maxSize, const COMPARE & comp = COMPARE())
+    :   maxSize_(maxSize),
+        currentSize_(0),
+        nodes_(maxSize + D),
+        indices_(maxSize, -1),
+        comp_(comp){
+    }
+
+    /// check if the heap is empty
+    bool empty() const {
+        return currentSize_ == 0;
+    }
+
+    /// return the number of elements in the heap
+    size_t size()const{
+        return currentSize_;
+    }
+
+    /// check if i is an id in the heap
+    bool contains(const value_type i) const{
+        INFERNO_ASSERT_OP(i, <, maxSize_);
+        return indices_[i] >= 0;
+    }
+
+    /// remove all elements
+    void reset(){
+        for(size_t k=0; k<currentSize_; ++k)
+            indices_[node(k).id_] = -1;
+        currentSize_ = 0;
+    }
+
+    /** \brief Insert an id with a given priority.
+
+        If the heap contains i before this
+        call the priority of i will be changed
+    */
+    void push(const value_type i, const priority_type p){
+        if(!contains(i)){
+            const size_t k = currentSize_++;
+            node(k).priority_ = p;
+            node(k).id_ = i;
+            indices_[i] = k;
+            bubbleUp(k);
+        }
+        else{
+            changePriority(i, p);
+        }
+    }
+
+    /** \brief Insert or change the priorities of many ids at once
+
+        If the batch is large compared to the heap, all priorities
+        are written first and the heap is rebuilt in linear time
+        instead of restoring the heap property for each id.
+    */
+    template<class ID_ITER, class PRIORITY_ITER>
+    void push(ID_ITER idsBegin, ID_ITER idsEnd, PRIORITY_ITER prioritiesBegin){
+        const size_t batchSize = detail_queues::batchSize(idsBegin, idsEnd,
+            typename std::iterator_traits<ID_ITER>::iterator_category());
+        if(batchSize * depth(currentSize_ + batchSize) <= currentSize_ + batchSize){
+            for(; idsBegin != idsEnd; ++idsBegin, ++prioritiesBegin)
+                this->push(*idsBegin, *prioritiesBegin);
+        }
+        else{
+            for(; idsBegin != idsEnd; ++idsBegin, ++prioritiesBegin){
+                const value_type i = *idsBegin;
+                if(!contains(i)){
+                    const size_t k = currentSize_++;
+                    node(k).id_ = i;
+                    indices_[i] = k;
+                }
+                node(indices_[i]).priority_ = *prioritiesBegin;
+            }
+            if(currentSize_ > 1)
+                for(size_t k=(currentSize_ - 2)/D + 1; k-- > 0; )
+                    bubbleDown(k);
+        }
+    }
+
+    /// get id with top priority
+    const_reference top() const {
+        INFERNO_ASSERT(!empty());
+        return node(0).id_;
+    }
+
+    /// get top priority
+    priority_type topPriority() const {
+        INFERNO_ASSERT(!empty());
+        return node(0).priority_;
+    }
+
+    /// remove the current top element
+    void pop(){
+        INFERNO_ASSERT(!empty());
+        this->deleteItem(node(0).id_);
+    }
+
+    /// returns the priority of id i (which must be in the heap)
+    priority_type priority(const value_type i) const{
+        INFERNO_ASSERT(contains(i));
+        return node(indices_[i]).priority_;
+    }
+
+    /// delete id i (which must be in the heap)
+    void deleteItem(const value_type i){
+        INFERNO_ASSERT(contains(i));
+        const size_t k = indices_[i];
+        const size_t last = --currentSize_;
+        indices_[i] = -1;
+        if(k != last){
+            const priority_type removed = node(k).priority_;
+            node(k) = node(last);
+            indices_[node(k).id_] = k;
+            if(comp_(node(k).priority_, removed))
+                bubbleUp(k);
+            else
+                bubbleDown(k);
+        }
+    }
+
+    /** \brief change priority of a given id.
+        The id must be in the heap!
+        Call push to auto insert / change .
+    */
+    void changePriority(const value_type i, const priority_type p){
+        INFERNO_ASSERT(contains(i));
+        const size_t k = indices_[i];
+        const priority_type old = node(k).priority_;
+        node(k).priority_ = p;
+        if(comp_(p, old))
+            bubbleUp(k);
+        else if(comp_(old, p))
+            bubbleDown(k);
+    }
+
+private:
+    struct Node{
+        priority_type priority_;
+        uint64_t id_;
+    };
+
+    // the children of node k are D*k+1,...,D*k+D,
+    // node k is stored at k + D - 1 such that all
+    // children of a node start at a multiple of D
+    Node & node(const size_t k){
+        return nodes_[k + D - 1];
+    }
+    const Node & node(const size_t k)const{
+        return nodes_[k + D - 1];
+    }
+
+    void bubbleUp(size_t k){
+        const Node moving = node(k);
+        while(k > 0){
+            const size_t parent = (k - 1)/D;
+            if(!comp_(moving.priority_, node(parent).priority_))
+                break;
+            node(k) = node(parent);
+            indices_[node(k).id_] = k;
+            k = parent;
+        }
+        node(k) = moving;
+        indices_[moving.id_] = k;
+    }
+
+    void bubbleDown(size_t k){
+        const Node moving = node(k);
+        for(;;){
+            const size_t first = D*k + 1;
+            if(first >= currentSize_)
+                break;
+            const size_t last = std::min(first + D, currentSize_);
+            size_t best = first;
+            for(size_t c=first+1; c<last; ++c)
+                if(comp_(node(c).priority_, node(best).priority_))
+                    best = c;
+            if(!comp_(node(best).priority_, moving.priority_))
+                break;
+            node(k) = node(best);
+            indices_[node(k).id_] = k;
+            k = best;
+        }
+        node(k) = moving;
+        indices_[moving.id_] = k;
+    }
+
+    static size_t depth(size_t n){
+        size_t d = 1;
+        for(; n > D; n /= D)
+            ++d;
+        return d;
+    }
+
+    size_t maxSize_;
+    size_t currentSize_;
+    detail_queues::AlignedBuffer<Node> nodes_;
+    std::vector<int64_t> indices_;
+    COMPARE comp_;
+};
+
+
+
+/** \brief Indexed monotone radix heap
+
+    A min priority queue for ids 0,...,maxSize-1
+    for the case that pushed priorities are never smaller than
+    the last top priority (e.g. Dijkstra with non-negative weights).
+    Priorities can be unsigned or signed integers or non-negative
+    floating point numbers.
+
+    Elements are kept in 65 buckets w.r.t. the highest bit
+    in which their priority differs from the last top priority.
+    push, changePriority and deleteItem are O(1),
+    top and pop are amortized O(log of the priority range).
+*/
+template<class T>
+class RadixHeap{
+public:
+    typedef T priority_type;
+    typedef uint64_t ValueType;
+    typedef ValueType value_type;
+    typedef ValueType const_reference;
+
+    /// Create an empty RadixHeap which can contain the ids 0,...,maxSize-1
+    RadixHeap(const size_t maxSize)
+    :   maxSize_(maxSize),
+        currentSize_(0),
+        last_(0),
+        priorities_(maxSize),
+        bits_(maxSize),
+        bucket_(maxSize, -1),
+        position_(maxSize),
+        buckets_(){
+    }
+
+    /// check if the heap is empty
+    bool empty() const {
+        return currentSize_ == 0;
+    }
+
+    /// return the number of elements in the heap
+    size_t size()const{
+        return currentSize_;
+    }
+
+    /// check if i is an id in the heap
+    bool contains(const value_type i) const{
+        INFERNO_ASSERT_OP(i, <, maxSize_);
+        return bucket_[i] >= 0;
+    }
+
+    /// remove all elements, afterwards any priority can be pushed
+    void reset(){
+        for(auto & bucket : buckets_){
+            for(const auto i : bucket)
+                bucket_[i] = -1;
+            bucket.clear();
+        }
+        currentSize_ = 0;
+        last_ = 0;
+    }
+
+    /** \brief Insert an id with a given priority.
+
+        If the heap contains i before this
+        call the priority of i will be changed.
+        The priority must not be smaller than the last top priority.
+    */
+    void push(const value_type i, const priority_type p){
+        const uint64_t bits = detail_queues::radixBits(p);
+        INFERNO_ASSERT_OP(bits, >=, last_);
+        if(contains(i))
+            this->remove(i);
+        else
+            ++currentSize_;
+        priorities_[i] = p;
+        bits_[i] = bits;
+        this->insert(i, detail_queues::radixBucket(bits, last_));
+    }
+
+    /// insert or change the priorities of many ids at once
+    template<class ID_ITER, class PRIORITY_ITER>
+    void push(ID_ITER idsBegin, ID_ITER idsEnd, PRIORITY_ITER prioritiesBegin){
+        for(; idsBegin != idsEnd; ++idsBegin, ++prioritiesBegin)
+            this->push(*idsBegin, *prioritiesBegin);
+    }
+
+    /// get id with the smallest priority
+    const_reference top() const {
+        INFERNO_ASSERT(!empty());
+        this->pull();
+        return buckets_[0].back();
+    }
+
+    /// get the smallest priority
+    priority_type topPriority() const {
+        return priorities_[this->top()];
+    }
+
+    /// remove the current top element
+    void pop(){
+        const auto i = this->top();
+        buckets_[0].pop_back();
+        bucket_[i] = -1;
+        --currentSize_;
+    }
+
+    /// returns the priority of id i (which must be in the heap)
+    priority_type priority(const value_type i) const{
+        INFERNO_ASSERT(contains(i));
+        return priorities_[i];
+    }
+
+    /// delete id i (which must be in the heap)
+    void deleteItem(const value_type i){
+        INFERNO_ASSERT(contains(i));
+        this->remove(i);
+        --currentSize_;
+    }
+
+    /** \brief change priority of a given id.
+        The id must be in the heap!
+        Call push to auto insert / change .
+    */
+    void changePriority(const value_type i, const priority_type p){
+        INFERNO_ASSERT(contains(i));
+        this->push(i, p);
+    }
+
+private:
+
+    void insert(const value_type i, const size_t b)const{
+        bucket_[i] = b;
+        position_[i] = buckets_[b].size();
+        buckets_[b].push_back(i);
+    }
+
+    void remove(const value_type i){
+        auto & bucket = buckets_[bucket_[i]];
+        const auto pos = position_[i];
+        bucket[pos] = bucket.back();
+        position_[bucket[pos]] = pos;
+        bucket.pop_back();
+        bucket_[i] = -1;
+    }
+
+    // move the smallest elements into the first bucket
+    // by redistributing the first non empty bucket
+    void pull()const{
+        if(!buckets_[0].empty())
+            return;
+        size_t b = 1;
+        while(buckets_[b].empty())
+            ++b;
+        auto & bucket = buckets_[b];
+        uint64_t minBits = bits_[bucket.front()];
+        for(const auto i : bucket)
+            minBits = std::min(minBits, bits_[i]);
+        last_ = minBits;
+        // all elements of the bucket move to lower buckets
+        std::vector<uint64_t> elements;
+        elements.swap(bucket);
+        for(const auto i : elements)
+            this->insert(i, detail_queues::radixBucket(bits_[i], last_));
+        // keep the capacity of the bucket
+        elements.clear();
+        elements.swap(bucket);
+    }
+
+    size_t maxSize_;
+    size_t currentSize_;
+    mutable uint64_t last_;
+    std::vector<priority_type> priorities_;
+    std::vector<uint64_t> bits_;
+    mutable std::vector<int8_t> bucket_;
+    mutable std::vector<uint64_t> position_;
+    mutable std::array<std::vector<uint64_t>, 65> buckets_;
+};
+
+
+
+/** \brief Indexed bucket queue for small integer priorities
+
+    A min priority queue for ids 0,...,maxSize-1 and
+    priorities 0,...,nBuckets-1. Real valued priorities
+    can be mapped to buckets with BucketQueue::quantize.
+    push, changePriority and deleteItem are O(1),
+    pop is O(1) plus the number of empty buckets skipped.
+    In contrast to RadixHeap, priorities do not need to be monotone.
+*/
+class BucketQueue{
+public:
+    typedef uint64_t priority_type;
+    typedef uint64_t ValueType;
+    typedef ValueType value_type;
+    typedef ValueType const_reference;
+
+    /// Create an empty BucketQueue for the ids 0,...,maxSize-1 and nBuckets priorities
+    BucketQueue(const size_t maxSize, const size_t nBuckets)
+    :   maxSize_(maxSize),
+        currentSize_(0),
+        current_(nBuckets),
+        bucket_(maxSize, nBuckets),
+        position_(maxSize),
+        buckets_(nBuckets){
+    }
+
+    /// bucket of a real valued priority in [minValue, maxValue] (clipped)
+    static priority_type quantize(const double value, const double minValue,
+                                  const double maxValue, const size_t nBuckets){
+        INFERNO_ASSERT_OP(minValue, <, maxValue);
+        const double relative = (value - minValue)/(maxValue - minValue);
+        if(!(relative > 0.0))
+            return 0;
+        return std::min(priority_type(relative*nBuckets), priority_type(nBuckets - 1));
+    }
+
+    /// check if the queue is empty
+    bool empty() const {
+        return currentSize_ == 0;
+    }
+
+    /// return the number of elements in the queue
+    size_t size()const{
+        return currentSize_;
+    }
+
+    /// number of priorities
+    size_t nBuckets()const{
+        return buckets_.size();
+    }
+
+    /// check if i is an id in the queue
+    bool contains(const value_type i) const{
+        INFERNO_ASSERT_OP(i, <, maxSize_);
+        return bucket_[i] < buckets_.size();
+    }
+
+    /// remove all elements
+    void reset(){
+        for(; current_ < buckets_.size(); ++current_){
+            for(const auto i : buckets_[current_])
+                bucket_[i] = buckets_.size();
+            buckets_[current_].clear();
+        }
+        currentSize_ = 0;
+    }
+
+    /** \brief Insert an id with a given priority.
+
+        If the queue contains i before this
+        call the priority of i will be changed
+    */
+    void push(const value_type i, const priority_type p){
+        this->set(i, p);
+        this->advance();
+    }
+
+    /// insert or change the priorities of many ids at once
+    template<class ID_ITER, class PRIORITY_ITER>
+    void push(ID_ITER idsBegin, ID_ITER idsEnd, PRIORITY_ITER prioritiesBegin){
+        for(; idsBegin != idsEnd; ++idsBegin, ++prioritiesBegin)
+            this->set(*idsBegin, *prioritiesBegin);
+        this->advance();
+    }
+
+    /// get an id with the smallest priority
+    const_reference top() const {
+        INFERNO_ASSERT(!empty());
+        return buckets_[current_].back();
+    }
+
+    /// get the smallest priority
+    priority_type topPriority() const {
+        INFERNO_ASSERT(!empty());
+        return current_;
+    }
+
+    /// remove the current top element
+    void pop(){
+        this->deleteItem(this->top());
+    }
+
+    /// returns the priority of id i (which must be in the queue)
+    priority_type priority(const value_type i) const{
+        INFERNO_ASSERT(contains(i));
+        return bucket_[i];
+    }
+
+    /// delete id i (which must be in the queue)
+    void deleteItem(const value_type i){
+        INFERNO_ASSERT(contains(i));
+        this->remove(i);
+        --currentSize_;
+        this->advance();
+    }
+
+    /** \brief change priority of a given id.
+        The id must be in the queue!
+        Call push to auto insert / change .
+    */
+    void changePriority(const value_type i, const priority_type p){
+        INFERNO_ASSERT(contains(i));
+        this->push(i, p);
+    }
+
+private:
+    void set(const value_type i, const priority_type p){
+        INFERNO_ASSERT_OP(p, <, buckets_.size());
+        if(contains(i))
+            this->remove(i);
+        else
+            ++currentSize_;
+        bucket_[i] = p;
+        position_[i] = buckets_[p].size();
+        buckets_[p].push_back(i);
+        current_ = std::min<size_t>(current_, p);
+    }
+
+    void remove(const value_type i){
+        auto & bucket = buckets_[bucket_[i]];
+        const auto pos = position_[i];
+        bucket[pos] = bucket.back();
+        position_[bucket[pos]] = pos;
+        bucket.pop_back();
+        bucket_[i] = buckets_.size();
+    }
+
+    // move the current bucket to the smallest non empty bucket
+    void advance(){
+        if(currentSize_ == 0){
+            current_ = buckets_.size();
+            return;
+        }
+        while(buckets_[current_].empty())
+            ++current_;
+    }
+
+    size_t maxSize_;
+    size_t currentSize_;
+    size_t current_;
+    std::vector<uint64_t> bucket_;
+    std::vector<uint64_t> position_;
+    std::vector<std::vector<uint64_t> > buckets_;
+};
+
 }
 
 #endif
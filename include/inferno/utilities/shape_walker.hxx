@@ -2,6 +2,10 @@
 #define INFERNO_UTILITIES_SHAPE_WALKER_HXX
 
 
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
 # include <boost/iterator/iterator_facade.hpp>
 
 #include "inferno/utilities/small_vector.hxx"
@@ -21,12 +25,11 @@ namespace inferno{
     \warning Using this class to iterate over
     all configurations is way more expensive
     then nested for loops.
-    But since these nested for loops cannot 
-    be written down for any arity, we
-    need this call as fall-back.
-    In inferno, this class is mostly used
-    for factors and value tables 
-    with an arity larger then 5.
+    If the configurations are only needed
+    within a loop body, use inferno::forEachConfiguration
+    which is as fast as nested for loops
+    for arities up to 5 and carries only
+    once per row for larger arities.
 
 */
 template<class SHAPE_FUNCTOR, class OUT_ITER>
@@ -90,12 +93,11 @@ private:
     \warning Using this class to iterate over
     all configurations is way more expensive
     then nested for loops.
-    But since these nested for loops cannot 
-    be written down for any arity, we
-    need this call as fall-back.
-    In inferno, this class is mostly used
-    for factors and value tables 
-    with an arity larger then 5.
+    If the configurations are only needed
+    within a loop body, use inferno::forEachConfiguration
+    which is as fast as nested for loops
+    for arities up to 5 and carries only
+    once per row for larger arities.
 
 */
 template<class SHAPE_FUNCTOR>
@@ -166,6 +168,207 @@ class ConfIterator
 
 
 
+/// \cond
+namespace detail_shape_walker{
+
+    // compile time nested loops, the last axis is the outermost loop
+    template<size_t AXIS>
+    struct NestedLoops{
+        template<class F>
+        static void run(const DiscreteLabel * shape, DiscreteLabel * conf, uint64_t & index, F & f){
+            for(conf[AXIS-1]=0; conf[AXIS-1]<shape[AXIS-1]; ++conf[AXIS-1])
+                NestedLoops<AXIS-1>::run(shape, conf, index, f);
+        }
+    };
+    template<>
+    struct NestedLoops<0>{
+        template<class F>
+        static void run(const DiscreteLabel * , DiscreteLabel * conf, uint64_t & index, F & f){
+            f(static_cast<const DiscreteLabel *>(conf), index);
+            ++index;
+        }
+    };
+
+    // any arity: a tight loop over the first axis,
+    // the remaining axes are incremented once per row
+    template<class F>
+    void forEachConfigurationGeneric(const DiscreteLabel * shape, const size_t arity, F & f){
+        uint64_t size = 1;
+        for(size_t d=0; d<arity; ++d)
+            size *= shape[d];
+        if(size == 0)
+            return;
+        SmallVector<DiscreteLabel> conf(arity, DiscreteLabel(0));
+        const DiscreteLabel s0 = shape[0];
+        uint64_t index = 0;
+        while(index < size){
+            for(conf[0]=0; conf[0]<s0; ++conf[0], ++index)
+                f(static_cast<const DiscreteLabel *>(conf.data()), index);
+            conf[0] = 0;
+            for(size_t d=1; d<arity; ++d){
+                if(++conf[d] < shape[d])
+                    break;
+                conf[d] = 0;
+            }
+        }
+    }
+
+    // neutral element of the minimum, integer types have no infinity
+    template<class T>
+    inline T minIdentity(){
+        return std::numeric_limits<T>::has_infinity ?
+            std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+    }
+
+    // a shape seen as (outer, shape[axis], inner) where inner is the stride of axis
+    inline void axisBlocks(const DiscreteLabel * shape, const size_t arity, const size_t axis,
+                           uint64_t & inner, uint64_t & outer){
+        INFERNO_ASSERT_OP(axis,<,arity);
+        inner = 1;
+        outer = 1;
+        for(size_t d=0; d<axis; ++d)
+            inner *= shape[d];
+        for(size_t d=axis+1; d<arity; ++d)
+            outer *= shape[d];
+    }
+}
+/// \endcond
+
+
+/** \brief strides of an array where the first axis runs fastest
+
+    This is the memory layout of DiscreteValueTableBase::bufferValueTable,
+    the configuration \c conf has the linear index
+    \f$\sum_d conf_d \cdot strides_d\f$.
+
+    \returns the number of configurations
+*/
+inline uint64_t shapeStrides(const DiscreteLabel * shape, const size_t arity, uint64_t * strides){
+    uint64_t size = 1;
+    for(size_t d=0; d<arity; ++d){
+        strides[d] = size;
+        size *= shape[d];
+    }
+    return size;
+}
+
+/** \brief call f(conf, linearIndex) for all configurations of a shape
+    with an arity known at compile time.
+
+    The configurations are enumerated such that the first
+    axis runs fastest, therefore linearIndex is the index
+    within a buffered value table.
+    The nested loops are generated at compile time.
+*/
+template<size_t ARITY, class F>
+inline void forEachConfiguration(const DiscreteLabel * shape, F && f){
+    DiscreteLabel conf[ARITY == 0 ? 1 : ARITY] = {};
+    uint64_t index = 0;
+    detail_shape_walker::NestedLoops<ARITY>::run(shape, conf, index, f);
+}
+
+/** \brief call f(conf, linearIndex) for all configurations of a shape.
+
+    Arities up to 5 are dispatched to compile time nested loops,
+    for larger arities the first axis is iterated in a tight loop
+    and the remaining axes are incremented once per row.
+    In contrast to ConfIterator, no shape functor is called
+    while iterating.
+*/
+template<class F>
+inline void forEachConfiguration(const DiscreteLabel * shape, const size_t arity, F && f){
+    switch(arity){
+        case 0 : {forEachConfiguration<0>(shape, f); break;}
+        case 1 : {forEachConfiguration<1>(shape, f); break;}
+        case 2 : {forEachConfiguration<2>(shape, f); break;}
+        case 3 : {forEachConfiguration<3>(shape, f); break;}
+        case 4 : {forEachConfiguration<4>(shape, f); break;}
+        case 5 : {forEachConfiguration<5>(shape, f); break;}
+        default : {detail_shape_walker::forEachConfigurationGeneric(shape, arity, f); break;}
+    }
+}
+
+/** \brief minimize an array over all axes but one
+
+    out[l] is the minimum of all values where
+    the configuration has label l at the given axis.
+    The array is stored with the first axis running fastest.
+    No configurations are enumerated, 
+    the array is traversed block wise with the stride of the axis.
+    
+    \param values array with \f$\prod_d shape_d\f$ entries
+    \param shape shape of the array
+    \param arity number of axes
+    \param axis the axis which is kept
+    \param[out] out minima, must hold shape[axis] values
+*/
+template<class T>
+inline void minMarginalize(const T * values, const DiscreteLabel * shape, const size_t arity,
+                           const size_t axis, T * out){
+    uint64_t inner, outer;
+    detail_shape_walker::axisBlocks(shape, arity, axis, inner, outer);
+    const DiscreteLabel n = shape[axis];
+    std::fill(out, out+n, detail_shape_walker::minIdentity<T>());
+    for(uint64_t o=0; o<outer; ++o)
+    for(DiscreteLabel l=0; l<n; ++l){
+        const T * block = values + (o*n + l)*inner;
+        T m = out[l];
+        for(uint64_t i=0; i<inner; ++i)
+            m = std::min(m, block[i]);
+        out[l] = m;
+    }
+}
+
+/** \brief minimize an array over all axes but one
+    and store the linear index of each minimum.
+
+    \param[out] argOut linear index of the first minimum
+        for each label of the axis, must hold shape[axis] values
+
+    \see minMarginalize
+*/
+template<class T>
+inline void minMarginalize(const T * values, const DiscreteLabel * shape, const size_t arity,
+                           const size_t axis, T * out, uint64_t * argOut){
+    uint64_t inner, outer;
+    detail_shape_walker::axisBlocks(shape, arity, axis, inner, outer);
+    const DiscreteLabel n = shape[axis];
+    std::fill(out, out+n, detail_shape_walker::minIdentity<T>());
+    std::fill(argOut, argOut+n, uint64_t(0));
+    for(uint64_t o=0; o<outer; ++o)
+    for(DiscreteLabel l=0; l<n; ++l){
+        const uint64_t offset = (o*n + l)*inner;
+        for(uint64_t i=0; i<inner; ++i){
+            if(values[offset+i] < out[l]){
+                out[l] = values[offset+i];
+                argOut[l] = offset+i;
+            }
+        }
+    }
+}
+
+/** \brief add a vector along one axis of an array
+
+    values[conf] += vec[conf[axis]] for all configurations.
+    This is the counterpart to minMarginalize
+    and is used to add messages to a buffered value table.
+*/
+template<class T>
+inline void addAlongAxis(T * values, const DiscreteLabel * shape, const size_t arity,
+                         const size_t axis, const T * vec){
+    uint64_t inner, outer;
+    detail_shape_walker::axisBlocks(shape, arity, axis, inner, outer);
+    const DiscreteLabel n = shape[axis];
+    for(uint64_t o=0; o<outer; ++o)
+    for(DiscreteLabel l=0; l<n; ++l){
+        T * block = values + (o*n + l)*inner;
+        const T v = vec[l];
+        for(uint64_t i=0; i<inner; ++i)
+            block[i] += v;
+    }
+}
+
+
 } // end namespace inferno
 
 #endif /* INFERNO_UTILITIES_SHAPE_WALKER_HXX */
@@ -4,6 +4,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <cstring>
+#include <utility>
+#include <type_traits>
 
 #include "inferno/inferno.hxx"
 
@@ -12,6 +15,36 @@ namespace inferno {
 
 /// \cond HIDDEN_SYMBOLS
 namespace detail_small_vector{
+
+    // trivially copyable values are moved and
+    // copied with memcpy, all others element wise
+    template<class T>
+    inline void copyElements(const T * source, const size_t n, T * dest, std::true_type){
+        if(n != 0)
+            std::memcpy(static_cast<void*>(dest), static_cast<const void*>(source), n*sizeof(T));
+    }
+    template<class T>
+    inline void copyElements(const T * source, const size_t n, T * dest, std::false_type){
+        std::copy(source, source + n, dest);
+    }
+    template<class T>
+    inline void copyElements(const T * source, const size_t n, T * dest){
+        copyElements(source, n, dest, typename std::is_trivially_copyable<T>::type());
+    }
+
+    template<class T>
+    inline void moveElements(T * source, const size_t n, T * dest, std::true_type){
+        copyElements(source, n, dest, std::true_type());
+    }
+    template<class T>
+    inline void moveElements(T * source, const size_t n, T * dest, std::false_type){
+        std::move(source, source + n, dest);
+    }
+    template<class T>
+    inline void moveElements(T * source, const size_t n, T * dest){
+        moveElements(source, n, dest, typename std::is_trivially_copyable<T>::type());
+    }
+
     template<class TAG>
     struct AssignmentHelper{
 
@@ -51,8 +84,10 @@ namespace detail_small_vector{
 /// \tparam T value type
 /// \tparam MAX_STACK maximum number of elements kept on the stack
 ///
-/// The member functions resize and clear reduce the size but not the
-/// capacity of the vector.
+/// The member function resize reduces the size but not the
+/// capacity of the vector, clear releases the heap memory.
+/// Trivially copyable values are copied and relocated with memcpy,
+/// moving a vector which uses heap memory does not copy at all.
 ///
 /// \ingroup utilities
 template<class T, size_t MAX_STACK=inferno::USUAL_MAX_FACTOR_ORDER>
@@ -71,11 +106,13 @@ public:
     SmallVector(const size_t );
     SmallVector(const size_t , const T & );
     SmallVector(const SmallVector<T, MAX_STACK> &);
+    SmallVector(SmallVector<T, MAX_STACK> &&);
     template<class ITER>
     SmallVector(ITER begin, ITER end);
 
     ~SmallVector( );
     SmallVector<T, MAX_STACK>& operator=(const SmallVector<T, MAX_STACK> &);
+    SmallVector<T, MAX_STACK>& operator=(SmallVector<T, MAX_STACK> &&);
     template<class ITERATOR> void assign(ITERATOR , ITERATOR);
 
     size_t size() const ;
@@ -97,22 +134,12 @@ public:
 
     iterator erase(iterator pos){
         const difference_type index = std::distance(begin(), pos);
-        if(index == size_ - 1){
-            --size_;
-            // now pointing to end
-            return pointerToSequence_ + index;
-        }
-        else{ //(index != size_ - 1){
-            for(size_t i=index+1 ; i<size_; ++i){
-                pointerToSequence_[index-1] = pointerToSequence_[index];
-            }
-            --size_;
-            // now pointing to the address
-            // the erased element has been
-            return pointerToSequence_ + index;
-        }
-        
-        
+        std::move(pointerToSequence_ + index + 1, pointerToSequence_ + size_,
+                  pointerToSequence_ + index);
+        --size_;
+        // now pointing to the address
+        // the erased element has been
+        return pointerToSequence_ + index;
     }
 
     iterator erase (iterator first, iterator last){
@@ -150,6 +177,12 @@ public:
 
 private:
 
+   bool onHeap()const{
+      return pointerToSequence_ != stackSequence_;
+   }
+   // change the capacity (which must not be smaller than size_)
+   void reallocate(const size_t);
+
    size_t size_;
    size_t capacity_;
    T stackSequence_[MAX_STACK];
@@ -214,8 +247,9 @@ SmallVector<T, MAX_STACK>::SmallVector
     ITER begin,
     ITER end
 )
-:   size_(),
-    capacity_() 
+:   size_(0),
+    capacity_(MAX_STACK),
+    pointerToSequence_(stackSequence_)
 {
     typedef std::iterator_traits<ITER> IterTraits;
     typedef typename IterTraits::iterator_category  IteratorTag;
@@ -237,18 +271,43 @@ SmallVector<T, MAX_STACK>::SmallVector
    INFERNO_ASSERT(size_<=capacity_);
    INFERNO_ASSERT(capacity_>=MAX_STACK);
    if(size_>MAX_STACK) {
+      capacity_ = size_;
       pointerToSequence_ = new T[size_];
    }
+   else{
+      capacity_ = MAX_STACK;
+      pointerToSequence_=stackSequence_;
+   }
+   detail_small_vector::copyElements(other.pointerToSequence_, size_, pointerToSequence_);
+}
+
+/// move constructor
+/// \param other container to move, empty afterwards
+template<class T, size_t MAX_STACK>
+SmallVector<T, MAX_STACK>::SmallVector
+(
+   SmallVector<T, MAX_STACK> && other
+)
+:  size_(other.size_),
+   capacity_(other.capacity_)
+{
+   if(other.onHeap()) {
+      // steal the heap memory
+      pointerToSequence_ = other.pointerToSequence_;
+      other.pointerToSequence_ = other.stackSequence_;
+      other.capacity_ = MAX_STACK;
+   }
    else{
       pointerToSequence_=stackSequence_;
+      detail_small_vector::moveElements(other.pointerToSequence_, size_, pointerToSequence_);
    }
-   std::copy(other.pointerToSequence_, other.pointerToSequence_+size_, pointerToSequence_);
+   other.size_ = 0;
 }
 
 /// destructor
 template<class T, size_t MAX_STACK>
 SmallVector<T, MAX_STACK>::~SmallVector( ) {
-   if(size_>MAX_STACK) {
+   if(onHeap()) {
       INFERNO_ASSERT(pointerToSequence_!=NULL);
       delete[] pointerToSequence_;
    }
@@ -263,28 +322,45 @@ SmallVector<T, MAX_STACK> & SmallVector<T, MAX_STACK>::operator=
 )
 {
    if(&other != this) {
-      // size_=other.size_;
-      // capacity_=other.capacity_;
-      // INFERNO_ASSERT(size_<=capacity_);
-      // INFERNO_ASSERT(capacity_>=MAX_STACK);
-      if(other.size_>MAX_STACK) {
-         // delete old sequence
-         if(size_>MAX_STACK) {
+      // the current memory is reused if it is large enough
+      if(other.size_>capacity_) {
+         if(onHeap()) {
             delete [] pointerToSequence_;
-            pointerToSequence_ = new T[other.size_];
          }
-         // nothing to delete
-         else{
-            pointerToSequence_ = new T[other.size_];
+         pointerToSequence_ = new T[other.size_];
+         capacity_=other.size_;
+      }
+      size_=other.size_;
+      detail_small_vector::copyElements(other.pointerToSequence_, size_, pointerToSequence_);
+   }
+   return *this;
+}
+
+/// move assignment operator
+/// \param other container to move, empty afterwards
+template<class T, size_t MAX_STACK>
+SmallVector<T, MAX_STACK> & SmallVector<T, MAX_STACK>::operator=
+(
+   SmallVector<T, MAX_STACK> && other
+)
+{
+   if(&other != this) {
+      if(other.onHeap()) {
+         // steal the heap memory
+         if(onHeap()) {
+            delete [] pointerToSequence_;
          }
-         size_=other.size_;
-         capacity_=size_;
+         pointerToSequence_ = other.pointerToSequence_;
+         capacity_ = other.capacity_;
+         other.pointerToSequence_ = other.stackSequence_;
+         other.capacity_ = MAX_STACK;
       }
       else{
-         pointerToSequence_=stackSequence_;
-         size_=other.size_;
+         // other is on the stack, therefore it fits into this
+         detail_small_vector::moveElements(other.pointerToSequence_, other.size_, pointerToSequence_);
       }
-      std::copy(other.pointerToSequence_, other.pointerToSequence_+size_, pointerToSequence_);
+      size_ = other.size_;
+      other.size_ = 0;
    }
    return *this;
 }
@@ -363,13 +439,7 @@ SmallVector<T, MAX_STACK>::push_back
    INFERNO_ASSERT(capacity_ >= MAX_STACK);
    INFERNO_ASSERT(size_ <= capacity_);
    if(capacity_ == size_) {
-      T * tmp=new T[capacity_ * 2];
-      std::copy(pointerToSequence_, pointerToSequence_ + size_, tmp);
-      if(capacity_ > MAX_STACK) {
-         delete[] pointerToSequence_;
-      }
-      capacity_ *= 2;
-      pointerToSequence_ = tmp;
+      reallocate(std::max<size_t>(capacity_ * 2, 1));
    }
    pointerToSequence_[size_]=value;
    ++size_;
@@ -388,13 +458,7 @@ SmallVector<T, MAX_STACK>::resize
    INFERNO_ASSERT(capacity_>=MAX_STACK);
    INFERNO_ASSERT(size_<=capacity_);
    if(size>capacity_) {
-      T * tmp=new T[size];
-      std::copy(pointerToSequence_, pointerToSequence_+size_, tmp);
-      if(capacity_>MAX_STACK) {
-         delete[] pointerToSequence_;
-      }
-      capacity_=size;
-      pointerToSequence_=tmp;
+      reallocate(std::max(size, capacity_ * 2));
    }
    size_=size;
    INFERNO_ASSERT(size_<=capacity_);
@@ -412,26 +476,37 @@ SmallVector<T, MAX_STACK>::reserve
    INFERNO_ASSERT(capacity_>=MAX_STACK);
    INFERNO_ASSERT(size_<=capacity_);
    if(size>capacity_) {
-      T * tmp=new T[size];
-      std::copy(pointerToSequence_, pointerToSequence_+size_, tmp);
-      if(capacity_>MAX_STACK) {
-         delete[] pointerToSequence_;
-      }
-      capacity_=size;
-      pointerToSequence_=tmp;
+      reallocate(size);
    }
-   // size_ = size;
    INFERNO_ASSERT(size_<=capacity_);
    INFERNO_ASSERT(capacity_>=MAX_STACK);
 }
 
+/// move the sequence to new heap memory
+/// \param capacity new capacity of the container
+template<class T, size_t MAX_STACK>
+inline void
+SmallVector<T, MAX_STACK>::reallocate
+(
+   const size_t capacity
+) {
+   INFERNO_ASSERT(capacity>=size_);
+   T * tmp=new T[capacity];
+   detail_small_vector::moveElements(pointerToSequence_, size_, tmp);
+   if(onHeap()) {
+      delete[] pointerToSequence_;
+   }
+   capacity_=capacity;
+   pointerToSequence_=tmp;
+}
+
 /// clear the sequence
 template<class T, size_t MAX_STACK>
 inline void
 SmallVector<T, MAX_STACK>::clear() {
    INFERNO_ASSERT(capacity_>=MAX_STACK);
    INFERNO_ASSERT(size_<=capacity_);
-   if(capacity_>MAX_STACK) {
+   if(onHeap()) {
       delete[] pointerToSequence_;
    }
    pointerToSequence_=stackSequence_;
@@ -468,19 +543,14 @@ SmallVector<T, MAX_STACK>::insert
     iterator position, 
     const value_type& val
 ){
-    if(position==end()){
-        resize(size_+1);
-        back() = val; 
-        return pointerToSequence_ + (size_ -1);
-    }
-    else{
-        resize(size_+1);
-        const difference_type index = std::distance(begin(),position);
-        for(difference_type i=size_ -2; i>index; --i){
-            pointerToSequence_[i+1] = pointerToSequence_[i]; 
-        }
-        pointerToSequence_ + index;
-    }
+    // resize invalidates position
+    const difference_type index = std::distance(begin(),position);
+    const value_type copy = val;
+    resize(size_+1);
+    std::move_backward(pointerToSequence_ + index, pointerToSequence_ + size_ - 1,
+                       pointerToSequence_ + size_);
+    pointerToSequence_[index] = copy;
+    return pointerToSequence_ + index;
 }
 
 template<class T, size_t MAX_STACK>
@@ -491,24 +561,13 @@ SmallVector<T, MAX_STACK>::insert
     size_type n, 
     const value_type& val
 ){
-    if(position==end()){
-        const difference_type index = std::distance(begin(),position);
-        resize(size_+n);
-        for(difference_type i=index; i<size_; ++i)
-            pointerToSequence_[i] = val;
-    }
-    else{
-        const size_t oldSize = size_;
-        const difference_type index = std::distance(begin(),position);
-        resize(size_+n);
-        for(difference_type i=size_ - 1; i>index; --i){
-            pointerToSequence_[i] = pointerToSequence_[i-n]; 
-        }
-        for(difference_type i=0; i<n; ++i){
-            pointerToSequence_[index + i]  = val;
-        }
-        pointerToSequence_ + index;
-    }
+    // resize invalidates position
+    const difference_type index = std::distance(begin(),position);
+    const value_type copy = val;
+    resize(size_+n);
+    std::move_backward(pointerToSequence_ + index, pointerToSequence_ + size_ - n,
+                       pointerToSequence_ + size_);
+    std::fill(pointerToSequence_ + index, pointerToSequence_ + index + n, copy);
 }
 
 template<class T, size_t MAX_STACK>
@@ -3,6 +3,11 @@
 #define INFERNO_UTILITIES_TIMER
 
 #include <stdexcept>
+#include <vector>
+#include <string>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
 
 # if  (defined(_INFERNO_TIMER_MACH__) || defined(__APPLE__))
 #   define INFERNO_TIMER_MAC
@@ -15,6 +20,7 @@
 
 # if defined(INFERNO_TIMER_MAC)
 #    include <mach/mach_time.h>
+#    include <time.h>
 # elif defined(INFERNO_TIMER_WINDOWS)
 #    include <windows.h>
 #    undef min
@@ -25,38 +31,42 @@
 
 namespace inferno {
 
-/// Platform-independent runtime measurements
+/** \brief Platform-independent runtime measurements
+
+    By default the timer measures the elapsed wall-clock time
+    (monotonic clock). Alternatively the CPU time of the
+    whole process (summed over all threads) or the CPU time
+    of the calling thread can be measured.
+    Note that the process CPU time of a multi-threaded
+    computation is (much) larger than its wall-clock time.
+    Where the platform provides no CPU clock the wall-clock is used.
+*/
 class Timer {
 public:
+   enum Clock{
+      WallClock,
+      ProcessCpuClock,
+      ThreadCpuClock
+   };
+
    // construction
-   Timer();
+   Timer(const Clock clock = WallClock);
 
    // query
    double elapsedTime() const;
+   Clock clock() const;
 
    // manipulation
    void tic();
    void toc();
    void reset();
 
-private:
-   #if defined(INFERNO_TIMER_MAC)
-      typedef uint64_t TimerT;
-      typedef double TimerC;
-   #elif defined(INFERNO_TIMER_WINDOWS)
-      typedef LONGLONG TimerT;
-      typedef LARGE_INTEGER TimerC;
-   #else
-      typedef double TimerT;
-      typedef timespec TimerC;
-   #endif
+   /// \brief current time of a clock in seconds (arbitrary origin)
+   static double now(const Clock clock = WallClock);
 
-   TimerT start_;
-#if !defined(INFERNO_TIMER_MAC)
-   TimerC ts_;
-#endif
-   double duration_;
-   double conversionFactor_;
+private:
+   Clock clock_;
+   double start_;
    double elapsedTime_;
 };
 
@@ -79,56 +89,65 @@ private:
     double stdev_;
 };
 
-inline Timer::Timer()
-: start_(0), duration_(0), elapsedTime_(0)
+inline Timer::Timer(const Clock clock)
+: clock_(clock), start_(0), elapsedTime_(0)
 {
+   reset();
+}
+
+inline double Timer::now(const Clock clock) {
    #if defined(INFERNO_TIMER_MAC)
-      mach_timebase_info_data_t info;
-      mach_timebase_info(&info);
-      conversionFactor_ = (static_cast<double>(info.numer))/
-                     (static_cast<double>(info.denom));
-      conversionFactor_ = conversionFactor_*1.0e-9;
+      #if defined(CLOCK_THREAD_CPUTIME_ID)
+         if(clock != WallClock){
+            timespec ts;
+            clock_gettime(clock == ThreadCpuClock ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID, &ts);
+            return static_cast<double>(ts.tv_sec) + 1.0e-9 * static_cast<double>(ts.tv_nsec);
+         }
+      #endif
+      static const double conversionFactor = [](){
+         mach_timebase_info_data_t info;
+         mach_timebase_info(&info);
+         return 1.0e-9*(static_cast<double>(info.numer))/(static_cast<double>(info.denom));
+      }();
+      return static_cast<double>(mach_absolute_time())*conversionFactor;
    #elif defined(INFERNO_TIMER_WINDOWS)
-      TimerC freq;
+      if(clock != WallClock){
+         FILETIME creationTime, exitTime, kernelTime, userTime;
+         const BOOL ok = clock == ThreadCpuClock ?
+            GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime) :
+            GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+         if(ok){
+            // FILETIME is in units of 100 ns
+            ULARGE_INTEGER k, u;
+            k.LowPart = kernelTime.dwLowDateTime;
+            k.HighPart = kernelTime.dwHighDateTime;
+            u.LowPart = userTime.dwLowDateTime;
+            u.HighPart = userTime.dwHighDateTime;
+            return 1.0e-7*static_cast<double>(k.QuadPart + u.QuadPart);
+         }
+      }
+      LARGE_INTEGER freq, counter;
       QueryPerformanceFrequency(&freq);
-      conversionFactor_ = 1.0/(static_cast<double>(freq.QuadPart));
+      QueryPerformanceCounter(&counter);
+      return static_cast<double>(counter.QuadPart)/static_cast<double>(freq.QuadPart);
    #else
-      conversionFactor_ = 1.0;
+      timespec ts;
+      clock_gettime(clock == WallClock ? CLOCK_MONOTONIC :
+                   (clock == ThreadCpuClock ? CLOCK_THREAD_CPUTIME_ID : CLOCK_PROCESS_CPUTIME_ID), &ts);
+      return static_cast<double>(ts.tv_sec) + 1.0e-9 * static_cast<double>(ts.tv_nsec);
    #endif
-   reset();
 }
 
 inline void Timer::tic() {
-   #if defined(INFERNO_TIMER_MAC)
-      start_ = mach_absolute_time();
-   #elif defined(INFERNO_TIMER_WINDOWS)
-      QueryPerformanceCounter(&ts_);
-      start_ = ts_.QuadPart;
-   #else
-      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts_);
-      start_ = static_cast<double>(ts_.tv_sec) + 1.0e-9 *
-               static_cast<double>(ts_.tv_nsec);
-   #endif
+   start_ = now(clock_);
 }
 
 inline void Timer::toc() {
-   #if defined(INFERNO_TIMER_MAC)
-      duration_ =  static_cast<double>(mach_absolute_time() - start_);
-   #elif defined(INFERNO_TIMER_WINDOWS)
-      LARGE_INTEGER qpc_t; // ???
-      QueryPerformanceCounter(&qpc_t);
-      duration_ = static_cast<double>(qpc_t.QuadPart - start_);
-   #else
-      clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts_);
-      duration_ = (static_cast<double>(ts_.tv_sec) + 1.0e-9 *
-                  static_cast<double>(ts_.tv_nsec)) - start_;
-   #endif
-   elapsedTime_ = duration_*conversionFactor_;
+   elapsedTime_ = now(clock_) - start_;
 }
 
 inline void Timer::reset() {
    start_ = 0;
-   duration_ = 0;
    elapsedTime_ = 0;
 }
 
@@ -136,6 +155,10 @@ inline double Timer::elapsedTime() const {
    return elapsedTime_;
 }
 
+inline Timer::Clock Timer::clock() const {
+   return clock_;
+}
+
 template<class FUNCTOR>
 inline Timing<FUNCTOR>::Timing(
    FUNCTOR functor,
@@ -3,11 +3,18 @@
 
 #include <vector>
 #include <map>
+#include <atomic>
+#include <memory>
+#include <algorithm>
 
 namespace inferno {
 namespace utilities{
 
-/// Disjoint set data structure with path compression.
+/// Disjoint set data structure with path halving and union by size.
+///
+/// The parent and the set size of an element are stored
+/// next to each other, such that a find touches a single
+/// cache line per visited element.
 /// \ingroup datastructures
 template<class T = size_t>
 class Ufd {
@@ -19,7 +26,8 @@ public:
 
     // query
     value_type find(const value_type&) const; // without path compression
-    value_type find(value_type); // with path compression
+    value_type find(value_type); // with path halving
+    value_type size(const value_type&) const; // size of the set of an element
     value_type numberOfElements() const;
     value_type numberOfSets() const;
     template<class Iterator> void elementLabeling(Iterator) const;
@@ -33,8 +41,11 @@ public:
     void insert(const value_type&);
 
 private:
-    std::vector<value_type> parents_;
-    std::vector<value_type> ranks_;
+    struct Node{
+        value_type parent_;
+        value_type size_; // only valid for representatives
+    };
+    std::vector<Node> nodes_;
     value_type numberOfElements_;
     value_type numberOfSets_;
 };
@@ -42,8 +53,7 @@ private:
 /// Construct a Ufd.
 template<class T>
 Ufd<T>::Ufd()
-:   parents_(),
-    ranks_(),
+:   nodes_(),
     numberOfElements_(0),
     numberOfSets_(0)
 {}
@@ -58,13 +68,13 @@ Ufd<T>::Ufd
 (
     const value_type& size
 )
-:   parents_(static_cast<size_t>(size)),
-    ranks_(static_cast<size_t>(size)),
+:   nodes_(static_cast<size_t>(size)),
     numberOfElements_(size),
     numberOfSets_(size)
 {
     for(T j=0; j<size; ++j) {
-        parents_[static_cast<size_t>(j)] = j;
+        nodes_[static_cast<size_t>(j)].parent_ = j;
+        nodes_[static_cast<size_t>(j)].size_ = 1;
     }
 }
 
@@ -81,11 +91,10 @@ Ufd<T>::reset
 {
     numberOfElements_ = size;
     numberOfSets_ = size;
-    ranks_.resize(static_cast<size_t>(size));
-    parents_.resize(static_cast<size_t>(size));
+    nodes_.resize(static_cast<size_t>(size));
     for(T j=0; j<size; ++j) {
-        ranks_[static_cast<size_t>(j)] = 0;
-        parents_[static_cast<size_t>(j)] = j;
+        nodes_[static_cast<size_t>(j)].parent_ = j;
+        nodes_[static_cast<size_t>(j)].size_ = 1;
     }
 }
 
@@ -104,15 +113,16 @@ Ufd<T>::find
 {
     // find the root
     value_type root = element;
-    while(parents_[static_cast<size_t>(root)] != root) {
-        root = parents_[static_cast<size_t>(root)];
+    while(nodes_[static_cast<size_t>(root)].parent_ != root) {
+        root = nodes_[static_cast<size_t>(root)].parent_;
     }
     return root;
 }
 
 /// Find the representative element of the set that contains the given element.
 ///
-/// This mutable function compresses the search path.
+/// This mutable function compresses the search path
+/// by path halving (each visited element is linked to its grandparent).
 ///
 /// \param element Element.
 ///
@@ -123,18 +133,29 @@ Ufd<T>::find
     value_type element // copy to work with
 )
 {
-    // find the root
-    value_type root = element;
-    while(parents_[static_cast<size_t>(root)] != root) {
-        root = parents_[static_cast<size_t>(root)];
-    }
-    // path compression
-    while(element != root) {
-        value_type tmp = parents_[static_cast<size_t>(element)];
-        parents_[static_cast<size_t>(element)] = root;
-        element = tmp;
+    for(;;) {
+        Node & node = nodes_[static_cast<size_t>(element)];
+        if(node.parent_ == element) {
+            return element;
+        }
+        const value_type grandParent = nodes_[static_cast<size_t>(node.parent_)].parent_;
+        node.parent_ = grandParent;
+        element = grandParent;
     }
-    return root;
+}
+
+/// Size of the set that contains the given element.
+///
+/// \param element Element.
+///
+template<class T>
+inline typename Ufd<T>::value_type
+Ufd<T>::size
+(
+    const value_type& element
+) const
+{
+    return nodes_[static_cast<size_t>(find(element))].size_;
 }
 
 /// Merge two sets.
@@ -150,22 +171,23 @@ Ufd<T>::merge
     value_type element2
 )
 {
-    // merge by rank
+    // merge by size
     element1 = find(element1);
     element2 = find(element2);
-    if(ranks_[static_cast<size_t>(element1)] < ranks_[static_cast<size_t>(element2)]) {
-        parents_[static_cast<size_t>(element1)] = element2;
-        --numberOfSets_;
+    if(element1 == element2) {
+        return;
     }
-    else if(ranks_[static_cast<size_t>(element1)] > ranks_[static_cast<size_t>(element2)]) {
-        parents_[static_cast<size_t>(element2)] = element1;
-        --numberOfSets_;
+    Node & node1 = nodes_[static_cast<size_t>(element1)];
+    Node & node2 = nodes_[static_cast<size_t>(element2)];
+    if(node1.size_ < node2.size_) {
+        node1.parent_ = element2;
+        node2.size_ += node1.size_;
     }
-    else if(element1 != element2) {
-        parents_[static_cast<size_t>(element2)] = element1;
-        ++ranks_[static_cast<size_t>(element1)];
-        --numberOfSets_;
+    else {
+        node2.parent_ = element1;
+        node1.size_ += node2.size_;
     }
+    --numberOfSets_;
 }
 
 /// Insert new sets.
@@ -179,10 +201,10 @@ Ufd<T>::insert
     const value_type& number
 )
 {
-    ranks_.insert(ranks_.end(), static_cast<size_t>(number), T(0));
-    parents_.insert(parents_.end(), static_cast<size_t>(number), T(0));
+    nodes_.resize(static_cast<size_t>(numberOfElements_ + number));
     for(value_type j=numberOfElements_; j<numberOfElements_+number; ++j) {
-        parents_[static_cast<size_t>(j)] = j;
+        nodes_[static_cast<size_t>(j)].parent_ = j;
+        nodes_[static_cast<size_t>(j)].size_ = 1;
     }
     numberOfElements_ += number;
     numberOfSets_ += number;
@@ -201,7 +223,7 @@ Ufd<T>::representatives
 ) const
 {
     for(value_type j=0; j<numberOfElements(); ++j) {
-        if(parents_[static_cast<size_t>(j)] == j) {
+        if(nodes_[static_cast<size_t>(j)].parent_ == j) {
             *it = j;
             ++it;
         }
@@ -240,10 +262,17 @@ Ufd<T>::elementLabeling
 Iterator out
 ) const
 {
-    std::map<value_type, value_type> rl;
-    representativeLabeling(rl);
+    // representatives are labeled in increasing order
+    std::vector<value_type> rl(static_cast<size_t>(numberOfElements()));
+    value_type label = 0;
+    for(value_type j=0; j<numberOfElements(); ++j) {
+        if(nodes_[static_cast<size_t>(j)].parent_ == j) {
+            rl[static_cast<size_t>(j)] = label;
+            ++label;
+        }
+    }
     for(value_type j=0; j<numberOfElements(); ++j) {
-        *out = rl[find(j)];
+        *out = rl[static_cast<size_t>(find(j))];
         ++out;
     }
 }
@@ -262,6 +291,226 @@ Ufd<T>::numberOfSets() const
     return numberOfSets_;
 }
 
+/// Lock-free disjoint set data structure for concurrent merges.
+///
+/// find, merge and sameSet can be called from any number of threads
+/// at the same time. Roots are linked by index (the larger root
+/// below the smaller one) with a compare-and-swap, find uses
+/// path halving, also via compare-and-swap (a failed swap is harmless).
+/// Since links always point to smaller elements, the representative
+/// of a set is its smallest element, independent of the
+/// order in which the merges have been done.
+///
+/// The labeling functions must not be called while merges are running.
+/// \ingroup datastructures
+template<class T = size_t>
+class ConcurrentUfd {
+public:
+    typedef T value_type;
+
+    ConcurrentUfd(const value_type& = 0);
+
+    // query
+    value_type find(value_type);
+    bool sameSet(value_type, value_type);
+    value_type numberOfElements() const;
+    value_type numberOfSets() const;
+    template<class Iterator> void elementLabeling(Iterator);
+    template<class Iterator> void representatives(Iterator) const;
+
+    // manipulation
+    void reset(const value_type&);
+    bool merge(value_type, value_type);
+
+private:
+    std::unique_ptr<std::atomic<value_type>[]> parents_;
+    value_type numberOfElements_;
+    std::atomic<value_type> numberOfSets_;
+};
+
+/// Construct a ConcurrentUfd.
+///
+/// \param size Number of distinct sets.
+///
+template<class T>
+inline
+ConcurrentUfd<T>::ConcurrentUfd
+(
+    const value_type& size
+)
+:   parents_(),
+    numberOfElements_(0),
+    numberOfSets_(0)
+{
+    reset(size);
+}
+
+/// Reset such that each set contains precisely one element
+/// (not thread safe).
+///
+/// \param size Number of distinct sets.
+///
+template<class T>
+inline void
+ConcurrentUfd<T>::reset
+(
+    const value_type& size
+)
+{
+    if(size != numberOfElements_) {
+        parents_.reset(new std::atomic<value_type>[static_cast<size_t>(size)]);
+    }
+    for(value_type j=0; j<size; ++j) {
+        parents_[static_cast<size_t>(j)].store(j, std::memory_order_relaxed);
+    }
+    numberOfElements_ = size;
+    numberOfSets_.store(size);
+}
+
+/// Find the representative (the smallest element) of the set
+/// that contains the given element.
+///
+/// \param element Element.
+///
+template<class T>
+inline typename ConcurrentUfd<T>::value_type
+ConcurrentUfd<T>::find
+(
+    value_type element
+)
+{
+    for(;;) {
+        value_type parent = parents_[static_cast<size_t>(element)].load(std::memory_order_acquire);
+        if(parent == element) {
+            return element;
+        }
+        const value_type grandParent = parents_[static_cast<size_t>(parent)].load(std::memory_order_acquire);
+        if(grandParent != parent) {
+            // path halving
+            parents_[static_cast<size_t>(element)].compare_exchange_weak(
+                parent, grandParent, std::memory_order_release, std::memory_order_relaxed);
+        }
+        element = grandParent;
+    }
+}
+
+/// Merge two sets.
+///
+/// \param element1 Element in the first set.
+/// \param element2 Element in the second set.
+/// \return true if the elements have been in different sets
+///
+template<class T>
+inline bool
+ConcurrentUfd<T>::merge
+(
+    value_type element1,
+    value_type element2
+)
+{
+    for(;;) {
+        element1 = find(element1);
+        element2 = find(element2);
+        if(element1 == element2) {
+            return false;
+        }
+        if(element1 < element2) {
+            std::swap(element1, element2);
+        }
+        // link the larger root below the smaller one,
+        // fails if element1 is no root any more
+        value_type expected = element1;
+        if(parents_[static_cast<size_t>(element1)].compare_exchange_strong(
+            expected, element2, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            numberOfSets_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+/// Check if two elements are in the same set.
+///
+template<class T>
+inline bool
+ConcurrentUfd<T>::sameSet
+(
+    value_type element1,
+    value_type element2
+)
+{
+    for(;;) {
+        element1 = find(element1);
+        element2 = find(element2);
+        if(element1 == element2) {
+            return true;
+        }
+        // element1 is still a root, the sets were different
+        // at the time of the check
+        if(parents_[static_cast<size_t>(element1)].load(std::memory_order_acquire) == element1) {
+            return false;
+        }
+    }
+}
+
+/// Output all elements which are set representatives.
+///
+/// \param it (Output) Iterator into a container.
+///
+template<class T>
+template<class Iterator>
+inline void
+ConcurrentUfd<T>::representatives
+(
+    Iterator it
+) const
+{
+    for(value_type j=0; j<numberOfElements_; ++j) {
+        if(parents_[static_cast<size_t>(j)].load(std::memory_order_relaxed) == j) {
+            *it = j;
+            ++it;
+        }
+    }
+}
+
+/// Output a continuous labeling of all elements, the
+/// sets are labeled in the order of their smallest elements.
+///
+/// \param out (Output) Iterator into a container in which the j-th entry is the label of the element j.
+///
+template<class T>
+template<class Iterator>
+inline void
+ConcurrentUfd<T>::elementLabeling
+(
+    Iterator out
+)
+{
+    // the representative of j is <= j, therefore
+    // it has been labeled before j
+    std::vector<value_type> labels(static_cast<size_t>(numberOfElements_));
+    value_type label = 0;
+    for(value_type j=0; j<numberOfElements_; ++j) {
+        const value_type root = find(j);
+        labels[static_cast<size_t>(j)] = root == j ? label++ : labels[static_cast<size_t>(root)];
+        *out = labels[static_cast<size_t>(j)];
+        ++out;
+    }
+}
+
+template<class T>
+inline typename ConcurrentUfd<T>::value_type
+ConcurrentUfd<T>::numberOfElements() const
+{
+    return numberOfElements_;
+}
+
+template<class T>
+inline typename ConcurrentUfd<T>::value_type
+ConcurrentUfd<T>::numberOfSets() const
+{
+    return numberOfSets_.load();
+}
+
 } // end namespace utilities
 } // namespace inferno
 
@@ -119,7 +119,15 @@ public:
       vector_.assign(set.begin(),set.end());
    }
 
+   // bulk build
+   template<class InputIterator>
+      void assignUnsorted(InputIterator, InputIterator);
+   void pushBackUnsorted(const value_type&);
+   void sortUnique();
+
 private:
+   void removeDuplicates();
+
    std::vector<Key> vector_;
    Compare compare_;
 };
@@ -185,10 +193,7 @@ VectorSet<Key,Compare,Alloc>::VectorSet
 :  vector_(alloc),
    compare_(compare)
 {
-   while(beginInput!=endInput) {
-      this->insert(*beginInput);
-      ++beginInput;
-   }
+   this->assignUnsorted(beginInput, endInput);
 }
 
 /// copy constructor
@@ -352,10 +357,71 @@ VectorSet<Key,Compare,Alloc>::insert
    InputIterator last
 )
 {
-   while(first!=last) {
-      this->insert(*first);
-      ++first;
-   }
+   // append, sort the new elements and merge them
+   const size_type oldSize = vector_.size();
+   vector_.insert(vector_.end(), first, last);
+   std::sort(vector_.begin() + oldSize, vector_.end(), compare_);
+   std::inplace_merge(vector_.begin(), vector_.begin() + oldSize, vector_.end(), compare_);
+   this->removeDuplicates();
+}
+
+/// replace the content of the set by a sequence of elements
+/// in any order (possibly with duplicates)
+///
+/// The sequence is sorted once instead of inserting
+/// each element at its position.
+/// \param first iterator to the first element
+/// \param last iterator to the last element
+template<class Key, class Compare, class Alloc>
+template <class InputIterator>
+inline void
+VectorSet<Key,Compare,Alloc>::assignUnsorted
+(
+   InputIterator first,
+   InputIterator last
+)
+{
+   vector_.assign(first, last);
+   this->sortUnique();
+}
+
+/// append an element without keeping the set sorted
+///
+/// \warning until sortUnique is called the set
+/// is in an invalid state, only pushBackUnsorted, size,
+/// reserve and sortUnique may be called.
+/// \param value element to append
+template<class Key, class Compare, class Alloc>
+inline void
+VectorSet<Key,Compare,Alloc>::pushBackUnsorted
+(
+   const typename VectorSet<Key,Compare,Alloc>::value_type& value
+)
+{
+   vector_.push_back(value);
+}
+
+/// restore the set property after pushBackUnsorted
+template<class Key, class Compare, class Alloc>
+inline void
+VectorSet<Key,Compare,Alloc>::sortUnique()
+{
+   if(!std::is_sorted(vector_.begin(), vector_.end(), compare_))
+      std::sort(vector_.begin(), vector_.end(), compare_);
+   this->removeDuplicates();
+}
+
+/// remove equal neighbours (the set must be sorted)
+template<class Key, class Compare, class Alloc>
+inline void
+VectorSet<Key,Compare,Alloc>::removeDuplicates()
+{
+   const Compare & compare = compare_;
+   vector_.erase(std::unique(vector_.begin(), vector_.end(),
+      [&compare](const Key & a, const Key & b){
+         return !compare(a, b) && !compare(b, a);
+      }
+   ), vector_.end());
 }
 
 /// insert a sequence of elements with a hint for the position
@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <vector>
 #include <limits>
+#include <algorithm>
 
 #include <boost/iterator/iterator_facade.hpp>
 
@@ -563,25 +564,26 @@ public:
             return true;
         }
         else{
-            ConfIterator<ShapeFunctor> confIter(ShapeFunctor(this), arity, this->size());
-            ConfIterator<ShapeFunctor> confEnd = confIter.getEnd();
-
-            const ValueType vAA=this->eval(confIter->data());
-            ++confIter;
-            const ValueType vAB=this->eval(confIter->data());
-            ++confIter;
-            for( ; confIter != confEnd; ++confIter){
-                const auto val = this->eval(confIter->data());
-                if(allValuesEq(*confIter)){
-                   if(!fEq(val,vAA))
-                        return false;
-                }
-                else if(!fEq(val,vAB)){
-                        return false;
-                }
-            }
+            SmallVector<DiscreteLabel> s(arity);
+            this->bufferShape(s.data());
+            ValueType vAA = 0;
+            ValueType vAB = 0;
+            bool potts = true;
+            forEachConfiguration(s.data(), arity, [&](const DiscreteLabel * conf, const uint64_t index){
+                if(!potts)
+                    return;
+                const auto val = this->eval(conf);
+                if(index == 0)
+                    vAA = val;
+                else if(index == 1)
+                    vAB = val;
+                else if(std::all_of(conf, conf+arity, [&](const DiscreteLabel l){return l == conf[0];}))
+                    potts = fEq(val,vAA);
+                else 
+                    potts = fEq(val,vAB);
+            });
             beta = vAB - vAA;
-            return true;
+            return potts;
         }
     }
 
@@ -672,17 +674,15 @@ public:
             }
         }
         else { // (arity >= 6)
-            const int64_t nConf = this->size();
-            ConfIterator<ShapeFunctor> confIter(ShapeFunctor(this), arity, nConf);
-            ConfIterator<ShapeFunctor> confEnd = confIter.getEnd();
-            for( ; confIter != confEnd; ++confIter){
-                const ValueType v = this->eval(confIter->data());
+            SmallVector<DiscreteLabel> s(arity);
+            this->bufferShape(s.data());
+            forEachConfiguration(s.data(), arity, [&](const DiscreteLabel * c, const uint64_t){
+                const ValueType v = this->eval(c);
                 if(v<minVal){
-                    for(auto a=0; a<arity; ++a)
-                        conf[a] = confIter->data()[a];
+                    std::copy(c, c+arity, conf);
                     minVal = v;
                 }
-            }
+            });
         }
         return minVal;
     }
@@ -806,16 +806,11 @@ public:
             }
         }
         else { // (arity >= 6)
-
-            
-            const int64_t nConf = this->size();
-            ConfIterator<ShapeFunctor> confIter(ShapeFunctor(this), arity, nConf);
-            ConfIterator<ShapeFunctor> confEnd = confIter.getEnd();
-            int64_t c=0;
-            for( ; confIter != confEnd; ++confIter){
-                buffer[c] = this->eval(confIter->data());
-                ++c;
-            }
+            SmallVector<DiscreteLabel> s(arity);
+            this->bufferShape(s.data());
+            forEachConfiguration(s.data(), arity, [&](const DiscreteLabel * conf, const uint64_t c){
+                buffer[c] = this->eval(conf);
+            });
         }
     }
 
@@ -891,14 +886,11 @@ public:
             }
         }
         else { // (arity >= 6)
-            const int64_t nConf = this->size();
-            ConfIterator<ShapeFunctor> confIter(ShapeFunctor(this), arity, nConf);
-            ConfIterator<ShapeFunctor> confEnd = confIter.getEnd();
-            int64_t c=0;
-            for( ; confIter != confEnd; ++confIter){
-                buffer[c] += this->eval(confIter->data());
-                ++c;
-            }
+            SmallVector<DiscreteLabel> s(arity);
+            this->bufferShape(s.data());
+            forEachConfiguration(s.data(), arity, [&](const DiscreteLabel * conf, const uint64_t c){
+                buffer[c] += this->eval(conf);
+            });
         }
     }
 
@@ -975,14 +967,11 @@ public:
             }
         }
         else { // (arity >= 6)
-            const int64_t nConf = this->size();
-            ConfIterator<ShapeFunctor> confIter(ShapeFunctor(this), arity, nConf);
-            ConfIterator<ShapeFunctor> confEnd = confIter.getEnd();
-            int64_t c=0;
-            for( ; confIter != confEnd; ++confIter){
-                buffer[c] += w * this->eval(confIter->data());
-                ++c;
-            }
+            SmallVector<DiscreteLabel> s(arity);
+            this->bufferShape(s.data());
+            forEachConfiguration(s.data(), arity, [&](const DiscreteLabel * conf, const uint64_t c){
+                buffer[c] += w * this->eval(conf);
+            });
         }
     }
 
@@ -0,0 +1,127 @@
+/** \file min_marginals.hxx
+    \brief inferno::value_tables::MinMarginals
+    is implemented in this header.
+*/
+#ifndef INFERNO_VALUE_TABLES_MIN_MARGINALS_HXX
+#define INFERNO_VALUE_TABLES_MIN_MARGINALS_HXX
+
+#include <cstdint>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "inferno/inferno.hxx"
+#include "inferno/utilities/small_vector.hxx"
+#include "inferno/utilities/shape_walker.hxx"
+#include "inferno/value_tables/discrete_value_table_base.hxx"
+
+namespace inferno{
+namespace value_tables{
+
+/** \brief per axis minima / argminima and the
+    overall minimum and maximum of a value table.
+
+    For each axis \f$ a \f$ and label \f$ l \f$
+    the min-marginal is
+    \f[
+        \min_{x : x_a = l} \theta(x)
+    \f]
+    All quantities are computed in the constructor
+    from a single DiscreteValueTableBase::bufferValueTable
+    call, afterwards the object is immutable.
+    Since the whole value table is buffered once,
+    this is meant for value tables of moderate size
+    which are evaluated over and over again
+    (see models::GeneralDiscreteModel::minMarginals).
+
+    \ingroup value_tables
+*/
+class MinMarginals{
+public:
+    MinMarginals(const DiscreteValueTableBase * vt)
+    :   shape_(vt->arity()),
+        offsets_(vt->arity()+1, 0),
+        mins_(),
+        argmins_(),
+        min_(std::numeric_limits<ValueType>::infinity()),
+        max_(-1.0*std::numeric_limits<ValueType>::infinity()),
+        argminIndex_(0){
+
+        const size_t arity = shape_.size();
+        vt->bufferShape(shape_.data());
+        for(size_t a=0; a<arity; ++a)
+            offsets_[a+1] = offsets_[a] + shape_[a];
+        mins_.resize(offsets_.back());
+        argmins_.resize(offsets_.back());
+
+        std::vector<ValueType> values(vt->size());
+        if(values.empty())
+            return;
+        vt->bufferValueTable(values.data());
+        for(size_t a=0; a<arity; ++a)
+            minMarginalize(values.data(), shape_.data(), arity, a,
+                           mins_.data() + offsets_[a], argmins_.data() + offsets_[a]);
+
+        const auto minMax = std::minmax_element(values.begin(), values.end());
+        min_ = *minMax.first;
+        max_ = *minMax.second;
+        argminIndex_ = std::distance(values.begin(), minMax.first);
+    }
+
+    uint32_t arity()const{
+        return shape_.size();
+    }
+    DiscreteLabel shape(const size_t a)const{
+        return shape_[a];
+    }
+
+    /// \brief minimum of the value table
+    ValueType minValue()const{
+        return min_;
+    }
+    /// \brief maximum of the value table
+    ValueType maxValue()const{
+        return max_;
+    }
+    /// \brief configuration of the (first) minimum
+    void argmin(DiscreteLabel * conf)const{
+        this->configuration(argminIndex_, conf);
+    }
+
+    /// \brief min-marginal of axis a, holds shape(a) values
+    const ValueType * minMarginal(const size_t a)const{
+        return mins_.data() + offsets_[a];
+    }
+    /// \brief min-marginal of axis a for label l
+    ValueType minMarginal(const size_t a, const DiscreteLabel l)const{
+        INFERNO_ASSERT_OP(l,<,shape_[a]);
+        return mins_[offsets_[a] + l];
+    }
+    /// \brief configuration of the (first) minimum with label l at axis a
+    void argminMarginal(const size_t a, const DiscreteLabel l, DiscreteLabel * conf)const{
+        INFERNO_ASSERT_OP(l,<,shape_[a]);
+        this->configuration(argmins_[offsets_[a] + l], conf);
+    }
+
+private:
+    // linear index (first axis runs fastest) to configuration
+    void configuration(uint64_t index, DiscreteLabel * conf)const{
+        for(size_t a=0; a<shape_.size(); ++a){
+            conf[a] = index % shape_[a];
+            index /= shape_[a];
+        }
+    }
+
+    SmallVector<DiscreteLabel> shape_;
+    SmallVector<uint64_t> offsets_;
+    std::vector<ValueType> mins_;
+    std::vector<uint64_t> argmins_;
+    ValueType min_;
+    ValueType max_;
+    uint64_t argminIndex_;
+};
+
+} // end namespace inferno::value_tables
+} // end namespace inferno
+
+#endif /* INFERNO_VALUE_TABLES_MIN_MARGINALS_HXX */
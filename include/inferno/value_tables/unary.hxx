@@ -68,7 +68,7 @@ public:
     }
 
     virtual ValueType eval(const LabelType l1)const {
-        return 0.0; //data_[l1];
+        return data_[l1];
     }
     DiscreteLabel shape() const{
         return nLabels_;
@@ -11,6 +11,8 @@
 #include <algorithm>
 
 #include "inferno/inferno.hxx"
+#include "inferno/utilities/small_vector.hxx"
+#include "inferno/utilities/shape_walker.hxx"
 
 namespace inferno{
 namespace value_tables{
@@ -41,19 +43,6 @@ namespace value_tables{
             }
             return res;
         }
-        template<class VT>
-        struct ShapeFunctor{
-            ShapeFunctor()
-            : f_(NULL){}
-            ShapeFunctor(const VT * f)
-            : f_(f){
-            }
-            DiscreteLabel operator()(const size_t d)const{
-                return f_->shape(d);
-            }
-            const VT * f_;
-        };
-
     }
 
 
@@ -92,6 +81,63 @@ namespace value_tables{
 
 
 
+    /** \brief factor to variable messages of a buffered value table
+        with an arity known at compile time.
+
+        \param values buffered value table (first axis runs fastest)
+        \param shape shape of the value table
+    */
+    template<size_t ARITY>
+    inline void facToVarMsgKernel(
+        const ValueType * values,
+        const DiscreteLabel * shape,
+        const ValueType ** inMsgs,
+        ValueType ** outMsgs
+    ){
+        // initialize 
+        for(size_t a=0; a<ARITY; ++a)
+            std::fill(outMsgs[a], outMsgs[a]+shape[a], std::numeric_limits<ValueType>::infinity());
+
+        // minimize
+        forEachConfiguration<ARITY>(shape, [&](const DiscreteLabel * conf, const uint64_t index){
+            const ValueType facVal = values[index];
+            for(size_t a=0; a<ARITY; ++a){
+                ValueType s = facVal;
+                for(size_t b=0; b<ARITY; ++b)
+                    if(b != a)
+                        s += inMsgs[b][conf[b]];
+                outMsgs[a][conf[a]] = std::min(outMsgs[a][conf[a]], s);
+            }
+        });
+    }
+
+    /** \brief factor to variable messages of a buffered value table
+        of any arity.
+
+        All incoming messages are added to the buffer
+        which is min-marginalized for each axis afterwards.
+        Therefore no configurations are enumerated.
+
+        \param[in,out] values buffered value table (first axis runs fastest),
+            the incoming messages are added inplace
+        \param shape shape of the value table
+    */
+    inline void facToVarMsgKernel(
+        ValueType * values,
+        const DiscreteLabel * shape,
+        const size_t arity,
+        const ValueType ** inMsgs,
+        ValueType ** outMsgs
+    ){
+        for(size_t a=0; a<arity; ++a)
+            addAlongAxis(values, shape, arity, a, inMsgs[a]);
+        for(size_t a=0; a<arity; ++a){
+            minMarginalize(values, shape, arity, a, outMsgs[a]);
+            for(DiscreteLabel l=0; l<shape[a]; ++l)
+                outMsgs[a][l] -= inMsgs[a][l];
+        }
+    }
+
     template<class VT>
     inline void fallBackFacToVarMsg(
         const VT * vt,
@@ -102,104 +148,19 @@ namespace value_tables{
         if(arity == 1){
             throw RuntimeError("facToVarMsg must not be called on value tables with arity<2");
         }
-        else if(arity == 2){
-            // get shape
-            DiscreteLabel s[2];
-            vt->bufferShape(s);
-            
-            // initialize 
-            for(auto a=0; a<2; ++a)
-                std::fill(outMsgs[a], outMsgs[a]+s[a], std::numeric_limits<ValueType>::infinity());
-
-            // minimize
-            for(DiscreteLabel l1=0; l1 < s[1]; ++l1)
-            for(DiscreteLabel l0=0; l0 < s[0]; ++l0){
-                const ValueType facVal = vt->eval(l0, l1);
-                outMsgs[0][l0] = std::min(outMsgs[0][l0], facVal + inMsgs[1][l1]);
-                outMsgs[1][l1] = std::min(outMsgs[1][l1], facVal + inMsgs[0][l0]);
-            }
-        }
-        else if(arity == 3){
-            // get shape
-            DiscreteLabel s[3];
-            vt->bufferShape(s);
-            
-            // initialize 
-            for(auto a=0; a<3; ++a)
-                std::fill(outMsgs[a], outMsgs[a]+s[a], std::numeric_limits<ValueType>::infinity());
-
-            // minimize
-            for(DiscreteLabel l2=0; l2 < s[2]; ++l2)
-            for(DiscreteLabel l1=0; l1 < s[1]; ++l1)
-            for(DiscreteLabel l0=0; l0 < s[0]; ++l0){
-                const ValueType facVal = vt->eval(l0, l1, l2);
-                outMsgs[0][l0] = std::min(outMsgs[0][l0], facVal + inMsgs[1][l1] + inMsgs[2][l2]);
-                outMsgs[1][l1] = std::min(outMsgs[1][l1], facVal + inMsgs[0][l0] + inMsgs[2][l2]);
-                outMsgs[2][l2] = std::min(outMsgs[2][l2], facVal + inMsgs[0][l0] + inMsgs[1][l1]);
-            }
-        }
-        else if(arity == 4){
-            // get shape
-            DiscreteLabel s[4];
-            vt->bufferShape(s);
-            
-            // initialize 
-            for(auto a=0; a<4; ++a)
-                std::fill(outMsgs[a], outMsgs[a]+s[a], std::numeric_limits<ValueType>::infinity());
-
-            // minimize
-            for(DiscreteLabel l3=0; l3 < s[3]; ++l3)
-            for(DiscreteLabel l2=0; l2 < s[2]; ++l2)
-            for(DiscreteLabel l1=0; l1 < s[1]; ++l1)
-            for(DiscreteLabel l0=0; l0 < s[0]; ++l0){
-                const ValueType facVal = vt->eval(l0, l1, l2, l3);
-                outMsgs[0][l0] = std::min(outMsgs[0][l0], facVal + inMsgs[1][l1] + inMsgs[2][l2] + inMsgs[3][l3]);
-                outMsgs[1][l1] = std::min(outMsgs[1][l1], facVal + inMsgs[0][l0] + inMsgs[2][l2] + inMsgs[3][l3]);
-                outMsgs[2][l2] = std::min(outMsgs[2][l2], facVal + inMsgs[0][l0] + inMsgs[1][l1] + inMsgs[3][l3]);
-                outMsgs[3][l3] = std::min(outMsgs[3][l3], facVal + inMsgs[0][l0] + inMsgs[1][l1] + inMsgs[2][l2]);
-            }
-        }
-        else if(arity == 5){
-            // get shape
-            DiscreteLabel s[5];
-            vt->bufferShape(s);
-            
-            // initialize 
-            for(auto a=0; a<5; ++a)
-                std::fill(outMsgs[a], outMsgs[a]+s[a], std::numeric_limits<ValueType>::infinity());
-
-            // minimize
-            for(DiscreteLabel l4=0; l4 < s[4]; ++l4)
-            for(DiscreteLabel l3=0; l3 < s[3]; ++l3)
-            for(DiscreteLabel l2=0; l2 < s[2]; ++l2)
-            for(DiscreteLabel l1=0; l1 < s[1]; ++l1)
-            for(DiscreteLabel l0=0; l0 < s[0]; ++l0){
-                const ValueType facVal = vt->eval(l0, l1, l2, l3);
-                outMsgs[0][l0] = std::min(outMsgs[0][l0], facVal + inMsgs[1][l1] + inMsgs[2][l2] + inMsgs[3][l3] + inMsgs[4][l4]);
-                outMsgs[1][l1] = std::min(outMsgs[1][l1], facVal + inMsgs[0][l0] + inMsgs[2][l2] + inMsgs[3][l3] + inMsgs[4][l4]);
-                outMsgs[2][l2] = std::min(outMsgs[2][l2], facVal + inMsgs[0][l0] + inMsgs[1][l1] + inMsgs[3][l3] + inMsgs[4][l4]);
-                outMsgs[3][l3] = std::min(outMsgs[3][l3], facVal + inMsgs[0][l0] + inMsgs[1][l1] + inMsgs[2][l2] + inMsgs[4][l4]);
-                outMsgs[4][l4] = std::min(outMsgs[4][l4], facVal + inMsgs[0][l0] + inMsgs[1][l1] + inMsgs[2][l2] + inMsgs[3][l3]);
-            }
-        }
-        else { // (arity >= 6)
-            const int64_t nConf = vt->size();
-            typedef detail_value_tablle_utitlities::ShapeFunctor<VT> ShapeF;
-            ConfIterator<ShapeF > confIter(ShapeF(vt), arity, nConf);
-            ConfIterator<ShapeF > confEnd = confIter.getEnd();
-            for( ; confIter != confEnd; ++confIter){
-                const auto conf = confIter->data();
-                // sum up incoming messages
-                ValueType s = vt->eval(conf);
-                for(uint32_t a=0; a<arity; ++a)
-                    s += inMsgs[a][conf[a]];
-                // fill outgoing messages
-                for(uint32_t a=0; a<arity; ++a){
-                    const auto confA = conf[a];
-                    const auto currentVal = outMsgs[a][confA];
-                    outMsgs[a][confA] = std::min(currentVal, s - inMsgs[a][confA]); 
-                }
-            }
+        
+        // get shape and values with two virtual calls
+        SmallVector<DiscreteLabel> shape(arity);
+        vt->bufferShape(shape.data());
+        SmallVector<ValueType, 256> values(vt->size());
+        vt->bufferValueTable(values.data());
+
+        switch(arity){
+            case 2 : {facToVarMsgKernel<2>(values.data(), shape.data(), inMsgs, outMsgs); break;}
+            case 3 : {facToVarMsgKernel<3>(values.data(), shape.data(), inMsgs, outMsgs); break;}
+            case 4 : {facToVarMsgKernel<4>(values.data(), shape.data(), inMsgs, outMsgs); break;}
+            case 5 : {facToVarMsgKernel<5>(values.data(), shape.data(), inMsgs, outMsgs); break;}
+            default : {facToVarMsgKernel(values.data(), shape.data(), arity, inMsgs, outMsgs); break;}
         }
     }
 
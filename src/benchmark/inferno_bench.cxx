@@ -0,0 +1,482 @@
+/** \file inferno_bench.cxx
+    \brief  Self contained benchmark suite, runs all solvers which
+    build without optional externals on reproducible reference models
+    and writes setup time, wall time, energy, bound, peak RSS and
+    iterations per second as JSON.
+
+    The setup time is the time spent in the constructor of
+    the solver, the wall time is the time spent in infer.
+
+    usage: inferno_bench [--quick] [--no-fork] [output.json]
+
+    - --quick : only the small model sizes
+    - --no-fork : run the solvers in this process, the peak RSS
+      is the peak of the whole process instead of the peak of the run
+*/
+// std
+#include <string>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <functional>
+
+// posix
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+// inferno
+#include "inferno/inferno.hxx"
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/inference/icm.hxx"
+#include "inferno/inference/alpha_expansion.hxx"
+#include "inferno/inference/cgc.hxx"
+#include "inferno/inference/hmmwc.hxx"
+#include "inferno/inference/component_decomposition.hxx"
+#include "inferno/inference/persistency.hxx"
+#include "inferno/inference/portfolio.hxx"
+
+// reproducible model builders, all random
+// numbers are drawn from utilities::ReprRandom
+#include "rep_rand.hxx"
+#include "reference_models.hxx"
+
+
+namespace inferno{
+namespace bench{
+
+    typedef models::GeneralDiscreteModel Model;
+    typedef inference::DiscreteInferenceBase<Model> BaseInf;
+
+    struct RunResult{
+        RunResult()
+        :   setupTime(0),
+            wallTime(0),
+            energy(std::numeric_limits<double>::quiet_NaN()),
+            lowerBound(std::numeric_limits<double>::quiet_NaN()),
+            iterations(0),
+            peakRssKb(0),
+            error(){
+        }
+        double setupTime;
+        double wallTime;
+        double energy;
+        double lowerBound;
+        uint64_t iterations;
+        long peakRssKb;
+        std::string error;
+    };
+
+    struct ModelInfo{
+        std::string family;
+        std::string size;
+        uint64_t nVariables;
+        uint64_t nFactors;
+        uint64_t nLabels;
+        uint64_t maxArity;
+    };
+
+    // counts the visits of a solver
+    class IterationCounter{
+    public:
+        typedef BaseInf::Visitor Visitor;
+        IterationCounter()
+        :   visitor_(),
+            count_(0){
+            visitor_.visitCallBack = Visitor::VisitCallBack:: template from_method<IterationCounter, &IterationCounter::visit>(this);
+        }
+        void visit(BaseInf * ){
+            ++count_;
+        }
+        Visitor & visitor(){
+            return visitor_;
+        }
+        uint64_t count()const{
+            return count_;
+        }
+    private:
+        Visitor visitor_;
+        uint64_t count_;
+    };
+
+    template<class SOLVER>
+    RunResult runSolver(const Model & model, const typename SOLVER::Options & options){
+        RunResult result;
+        IterationCounter counter;
+        const auto setupStart = std::chrono::steady_clock::now();
+        SOLVER solver(model, options);
+        const auto start = std::chrono::steady_clock::now();
+        solver.infer(&counter.visitor());
+        const auto end = std::chrono::steady_clock::now();
+        result.setupTime = std::chrono::duration<double>(start - setupStart).count();
+        result.wallTime = std::chrono::duration<double>(end - start).count();
+        result.energy = solver.energy();
+        result.lowerBound = solver.lowerBound();
+        result.iterations = counter.count();
+        return result;
+    }
+
+    struct Solver{
+        std::string name;
+        std::function<bool(const Model &)> applicable;
+        std::function<RunResult(const Model &)> run;
+    };
+
+    // the meta solvers get icm as sub-solver for higher order
+    // models and alpha expansion otherwise
+    template<class SUB_MODEL>
+    std::shared_ptr<inference::BaseDiscreteInferenceFactory<SUB_MODEL> >
+    subSolverFactory(const Model & model){
+        typedef inference::Icm<SUB_MODEL> Icm;
+        typedef inference::AlphaExpansion<SUB_MODEL> Expansion;
+        if(model.maxArity() <= 2)
+            return std::make_shared<inference::DiscreteInferenceFactory<Expansion> >(
+                typename Expansion::Options(Expansion::Options::Expansion));
+        return std::make_shared<inference::DiscreteInferenceFactory<Icm> >();
+    }
+
+    inline bool isSecondOrderPotts(const Model & model){
+        if(model.maxArity() > 2)
+            return false;
+        for(const auto factor : model.factors()){
+            ValueType beta;
+            if(factor->arity() == 2 && !factor->isPotts(beta))
+                return false;
+        }
+        return true;
+    }
+
+    /* Every solver which builds without optional externals is part of
+       the suite, except
+       - Mp (message passing): does not compile with GeneralDiscreteModel
+       - Ehc, HigherOrderQpbo, Qpbo, Multicut, LpInference, OpengmInference:
+         need QPBO, CPLEX or OpenGM
+    */
+    inline std::vector<Solver> solvers(){
+        std::vector<Solver> s;
+        auto any = [](const Model & ){ return true; };
+        auto secondOrder = [](const Model & model){ return model.maxArity() <= 2; };
+        auto multicut = [](const Model & model){ return model.isSecondOrderMulticutModel(); };
+        // multicut models have as many labels as variables, too many
+        // for a move per label pair and for the dominance test of persistency
+        auto fewLabelsSecondOrder = [](const Model & model){
+            return model.maxArity() <= 2 && !model.isSecondOrderMulticutModel();
+        };
+        auto fewLabels = [](const Model & model){ return !model.isSecondOrderMulticutModel(); };
+
+        s.push_back({"Icm", any, [](const Model & model){
+            return runSolver<inference::Icm<Model> >(model, inference::Icm<Model>::Options());
+        }});
+        s.push_back({"AlphaExpansion", secondOrder, [](const Model & model){
+            typedef inference::AlphaExpansion<Model> Inf;
+            return runSolver<Inf>(model, typename Inf::Options(Inf::Options::Expansion));
+        }});
+        s.push_back({"AlphaBetaSwap", fewLabelsSecondOrder, [](const Model & model){
+            typedef inference::AlphaExpansion<Model> Inf;
+            return runSolver<Inf>(model, typename Inf::Options(Inf::Options::Swap));
+        }});
+        s.push_back({"Cgc", multicut, [](const Model & model){
+            return runSolver<inference::Cgc<Model> >(model, inference::Cgc<Model>::Options());
+        }});
+        s.push_back({"Hmmwc", isSecondOrderPotts, [](const Model & model){
+            return runSolver<inference::Hmmwc<Model> >(model, inference::Hmmwc<Model>::Options());
+        }});
+        s.push_back({"ComponentDecomposition", any, [](const Model & model){
+            typedef inference::ComponentDecomposition<Model> Inf;
+            return runSolver<Inf>(model, typename Inf::Options(subSolverFactory<typename Inf::SubModel>(model)));
+        }});
+        s.push_back({"PersistencyReduction", fewLabels, [](const Model & model){
+            typedef inference::PersistencyReduction<Model> Inf;
+            return runSolver<Inf>(model, typename Inf::Options(subSolverFactory<typename Inf::SubModel>(model)));
+        }});
+        s.push_back({"Portfolio", secondOrder, [](const Model & model){
+            typedef inference::Portfolio<Model> Inf;
+            typedef inference::AlphaExpansion<Model> Expansion;
+            std::vector<std::shared_ptr<typename Inf::InferenceFactory> > factories;
+            factories.push_back(std::make_shared<inference::DiscreteInferenceFactory<inference::Icm<Model> > >());
+            factories.push_back(std::make_shared<inference::DiscreteInferenceFactory<Expansion> >(
+                typename Expansion::Options(Expansion::Options::Expansion)));
+            if(model.isSecondOrderMulticutModel())
+                factories.push_back(std::make_shared<inference::DiscreteInferenceFactory<inference::Cgc<Model> > >());
+            else
+                factories.push_back(std::make_shared<inference::DiscreteInferenceFactory<Expansion> >(
+                    typename Expansion::Options(Expansion::Options::Swap)));
+            return runSolver<Inf>(model, typename Inf::Options(factories));
+        }});
+        return s;
+    }
+
+    inline RunResult runGuarded(const Solver & solver, const Model & model){
+        RunResult result;
+        try{
+            result = solver.run(model);
+        }
+        catch(const std::exception & e){
+            result.error = e.what();
+        }
+        return result;
+    }
+
+    // run in a child process to measure the peak RSS of a single run
+    inline RunResult runIsolated(const Solver & solver, const Model & model){
+        RunResult result;
+        int fd[2];
+        if(pipe(fd) != 0){
+            result.error = "pipe failed";
+            return result;
+        }
+        std::cout.flush();
+        const pid_t pid = fork();
+        if(pid < 0){
+            close(fd[0]);
+            close(fd[1]);
+            result.error = "fork failed";
+            return result;
+        }
+        if(pid == 0){
+            close(fd[0]);
+            const auto r = runGuarded(solver, model);
+            std::stringstream ss;
+            ss<<std::setprecision(17)<<r.setupTime<<" "<<r.wallTime<<" "<<r.energy<<" "<<r.lowerBound<<" "
+              <<r.iterations<<" "<<r.error;
+            const auto str = ss.str();
+            ssize_t written = write(fd[1], str.data(), str.size());
+            (void)written;
+            close(fd[1]);
+            _exit(0);
+        }
+        close(fd[1]);
+        std::string str;
+        char buffer[4096];
+        ssize_t n;
+        while((n = read(fd[0], buffer, sizeof(buffer))) > 0)
+            str.append(buffer, n);
+        close(fd[0]);
+
+        int status = 0;
+        struct rusage usage;
+        std::memset(&usage, 0, sizeof(usage));
+        wait4(pid, &status, 0, &usage);
+        result.peakRssKb = usage.ru_maxrss;
+        if(WIFSIGNALED(status) || str.empty()){
+            result.error = "solver crashed";
+            return result;
+        }
+        // nan and inf are not parsed by streams
+        std::stringstream ss(str);
+        std::string setupTime, wallTime, energy, lowerBound;
+        ss>>setupTime>>wallTime>>energy>>lowerBound>>result.iterations;
+        result.setupTime = std::strtod(setupTime.c_str(), nullptr);
+        result.wallTime = std::strtod(wallTime.c_str(), nullptr);
+        result.energy = std::strtod(energy.c_str(), nullptr);
+        result.lowerBound = std::strtod(lowerBound.c_str(), nullptr);
+        std::getline(ss, result.error);
+        if(!result.error.empty() && result.error[0] == ' ')
+            result.error.erase(0, 1);
+        return result;
+    }
+
+    inline void writeNumber(std::ostream & out, const double value){
+        if(std::isfinite(value))
+            out<<value;
+        else
+            out<<"null";
+    }
+
+    inline std::string escape(const std::string & str){
+        std::string escaped;
+        for(const char c : str){
+            if(c == '"' || c == '\\')
+                escaped.push_back('\\');
+            if(c == '\n')
+                escaped += "\\n";
+            else
+                escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    class Suite{
+    public:
+        Suite(std::ostream & out, const bool isolate)
+        :   out_(out),
+            isolate_(isolate),
+            solvers_(solvers()),
+            nRecords_(0),
+            info_(){
+            out_<<"{\n  \"benchmark\": \"inferno_bench\",\n  \"results\": [";
+        }
+        ~Suite(){
+            out_<<"\n  ]\n}\n";
+        }
+
+        void setModel(const std::string & family, const std::string & size){
+            info_.family = family;
+            info_.size = size;
+        }
+
+        // called by the model builders
+        void operator()(const Model & model){
+            info_.nVariables = model.nVariables();
+            info_.nFactors = model.nFactors();
+            DiscreteLabel minLabels, maxLabels;
+            model.minMaxNLabels(minLabels, maxLabels);
+            info_.nLabels = maxLabels;
+            info_.maxArity = model.maxArity();
+            for(const auto & solver : solvers_){
+                if(!solver.applicable(model))
+                    continue;
+                std::cerr<<info_.family<<" "<<info_.size<<" "<<solver.name<<"\n";
+                RunResult result;
+                if(isolate_){
+                    result = runIsolated(solver, model);
+                }
+                else{
+                    result = runGuarded(solver, model);
+                    struct rusage usage;
+                    getrusage(RUSAGE_SELF, &usage);
+                    result.peakRssKb = usage.ru_maxrss;
+                }
+                this->write(solver.name, result);
+            }
+        }
+
+    private:
+        void write(const std::string & solverName, const RunResult & r){
+            out_<<(nRecords_ == 0 ? "\n" : ",\n");
+            ++nRecords_;
+            out_<<std::setprecision(10)
+                <<"    {\"model\": \""<<info_.family<<"\""
+                <<", \"size\": \""<<info_.size<<"\""
+                <<", \"nVariables\": "<<info_.nVariables
+                <<", \"nFactors\": "<<info_.nFactors
+                <<", \"nLabels\": "<<info_.nLabels
+                <<", \"maxArity\": "<<info_.maxArity
+                <<", \"solver\": \""<<solverName<<"\""
+                <<", \"setupTime\": ";
+            writeNumber(out_, r.setupTime);
+            out_<<", \"wallTime\": ";
+            writeNumber(out_, r.wallTime);
+            out_<<", \"energy\": ";
+            writeNumber(out_, r.energy);
+            out_<<", \"lowerBound\": ";
+            writeNumber(out_, r.lowerBound);
+            out_<<", \"iterations\": "<<r.iterations
+                <<", \"iterationsPerSecond\": ";
+            writeNumber(out_, r.wallTime > 0.0 ? r.iterations/r.wallTime : 0.0);
+            out_<<", \"peakRssKb\": "<<r.peakRssKb;
+            if(!r.error.empty())
+                out_<<", \"error\": \""<<escape(r.error)<<"\"";
+            out_<<"}";
+            out_.flush();
+        }
+
+        std::ostream & out_;
+        bool isolate_;
+        std::vector<Solver> solvers_;
+        uint64_t nRecords_;
+        ModelInfo info_;
+    };
+
+    inline std::string sizeString(const size_t a, const size_t b, const DiscreteLabel nl){
+        std::stringstream ss;
+        ss<<a<<"x"<<b<<"_l"<<nl;
+        return ss.str();
+    }
+
+} // end namespace inferno::bench
+} // end namespace inferno
+
+
+
+int main(int argc, const char* argv[]){
+
+    using namespace inferno;
+    namespace mo = inferno::models;
+
+    bool quick = false;
+    bool isolate = true;
+    std::string outFile;
+    for(int i=1; i<argc; ++i){
+        const std::string arg(argv[i]);
+        if(arg == "--quick")
+            quick = true;
+        else if(arg == "--no-fork")
+            isolate = false;
+        else if(arg == "--help" || arg == "-h"){
+            std::cout<<"usage: "<<argv[0]<<" [--quick] [--no-fork] [output.json]\n";
+            return 0;
+        }
+        else
+            outFile = arg;
+    }
+
+    std::ofstream file;
+    if(!outFile.empty()){
+        file.open(outFile.c_str());
+        if(!file.good()){
+            std::cerr<<"cannot open "<<outFile<<"\n";
+            return 1;
+        }
+    }
+    std::ostream & out = outFile.empty() ? std::cout : file;
+
+    const size_t seed = 0;
+    bench::Suite suite(out, isolate);
+
+    {   // 2d potts grids
+        typedef mo::PottsGrid2d<mo::GeneralDiscreteModel> Builder;
+        const std::vector<size_t> sizes = quick ? std::vector<size_t>{16, 32} : std::vector<size_t>{16, 64, 256};
+        for(const DiscreteLabel nl : {DiscreteLabel(2), DiscreteLabel(5)})
+        for(const auto size : sizes){
+            suite.setModel("PottsGrid2d", bench::sizeString(size, size, nl));
+            mo::PottsGridParam mp{nl, size, size, 1.0, true};
+            Builder::buildModelCallFunctor(mp, Builder::BuilderParam(), seed, suite);
+        }
+    }
+    {   // superpixel region adjacency graphs
+        typedef mo::PottsRag<mo::GeneralDiscreteModel> Builder;
+        const std::vector<size_t> nSuperpixels = quick ? std::vector<size_t>{100} : std::vector<size_t>{100, 1000, 4000};
+        for(const auto n : nSuperpixels){
+            suite.setModel("PottsRag", bench::sizeString(256, n, 5));
+            mo::PottsRagParam mp{DiscreteLabel(5), 256, 256, n, 1.0, true};
+            Builder::buildModelCallFunctor(mp, Builder::BuilderParam(), seed, suite);
+        }
+    }
+    {   // dense models
+        typedef mo::DensePotts<mo::GeneralDiscreteModel> Builder;
+        const std::vector<size_t> sizes = quick ? std::vector<size_t>{30} : std::vector<size_t>{30, 100, 300};
+        for(const auto size : sizes){
+            suite.setModel("DensePotts", bench::sizeString(size, size, 3));
+            mo::DensePottsParam mp{DiscreteLabel(3), size, 1.0, true};
+            Builder::buildModelCallFunctor(mp, Builder::BuilderParam(), seed, suite);
+        }
+    }
+    {   // higher order grids
+        typedef mo::HigherOrderGrid2d<mo::GeneralDiscreteModel> Builder;
+        const std::vector<size_t> sizes = quick ? std::vector<size_t>{16} : std::vector<size_t>{16, 64, 128};
+        for(const auto size : sizes){
+            suite.setModel("HigherOrderGrid2d", bench::sizeString(size, size, 3));
+            mo::HigherOrderGridParam mp{DiscreteLabel(3), size, size, 1.0};
+            Builder::buildModelCallFunctor(mp, Builder::BuilderParam(), seed, suite);
+        }
+    }
+    {   // multicut grids
+        typedef mo::MulticutGrid2d<mo::GeneralDiscreteModel> Builder;
+        const std::vector<size_t> sizes = quick ? std::vector<size_t>{16} : std::vector<size_t>{16, 32};
+        for(const auto size : sizes){
+            suite.setModel("MulticutGrid2d", bench::sizeString(size, size, size*size));
+            mo::MulticutGridParam mp{size, size, 1.0};
+            Builder::buildModelCallFunctor(mp, Builder::BuilderParam(), seed, suite);
+        }
+    }
+    return 0;
+}
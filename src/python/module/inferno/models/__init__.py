@@ -153,10 +153,13 @@ def _extendModelClass(modelCls, classStr):
         def lossAugmentedModelClass2(cls, lossName):
             ownName = cls.__name__
             lossClsName = None
-            allowedLossNames = ['partitionHamming']
+            allowedLossNames = ['partitionHamming', 'partitionFScore',
+                                'variationOfInformation2', 'randIndex']
 
             if lossName == allowedLossNames[0]:
                 lossClsName = 'EdgeHamming'
+            elif lossName in allowedLossNames[1:]:
+                lossClsName = 'NonDecomposable'
             else:
                 raise RuntimeError('lossName must be in %s'%str(allowedLossNames))
             
@@ -0,0 +1,51 @@
+#ifndef INFERNO_PYTHON_LOSS_AUGMENTED_LOCAL_SEARCH_FACTORY
+#define INFERNO_PYTHON_LOSS_AUGMENTED_LOCAL_SEARCH_FACTORY
+
+#include "../exportInference.hxx"
+
+#include "inferno/inference/loss_augmented_local_search.hxx"
+
+namespace inferno{
+namespace inference{
+
+    template<class INF>
+    struct ExportInferenceFactory;
+
+    template< class MODEL>
+    struct ExportInferenceFactory<LossAugmentedLocalSearch<MODEL> >{
+
+        typedef LossAugmentedLocalSearch<MODEL> Inference;
+        typedef typename Inference::Options Options;
+        typedef typename Inference::Model Model;
+        typedef BaseDiscreteInferenceFactory<Model> BaseInfFactory;
+        typedef DiscreteInferenceFactory<Inference> InfFactory;
+
+        static void op(const std::string  & modelName, const std::string & infName){
+
+            namespace bp = boost::python;
+            const std::string clsName =  infName + std::string("Factory") + modelName;
+
+            bp::class_<InfFactory, bp::bases<BaseInfFactory> >(clsName.c_str(),bp::no_init);
+            const Options defaultOptions;
+            bp::def(lowerFirst(clsName).c_str(), &pyFactoryFactory,
+                (
+                    bp::arg("maxSweeps") = defaultOptions.maxSweeps_,
+                    bp::arg("maxEnumeratedLabels") = defaultOptions.maxEnumeratedLabels_,
+                    bp::arg("eps") = defaultOptions.eps_
+                )
+            );
+        }
+
+        static std::shared_ptr<BaseInfFactory>  pyFactoryFactory(
+            const uint64_t maxSweeps,
+            const DiscreteLabel maxEnumeratedLabels,
+            const double eps
+        ){      
+            const Options opt(maxSweeps, maxEnumeratedLabels, eps);
+            return  std::make_shared<InfFactory>(opt);
+        }
+    };
+} 
+}
+
+#endif // INFERNO_PYTHON_LOSS_AUGMENTED_LOCAL_SEARCH_FACTORY
@@ -36,6 +36,7 @@ namespace inference{
     void exportGeneralDiscreteModelInference();
     void exportParametrizedMulticutModelInference();
     void exportEdgeHammingLossAugmentedModelInference();
+    void exportNonDecomposableLossAugmentedModelInference();
 
 
     void exportInference(){
@@ -45,6 +46,7 @@ namespace inference{
         exportGeneralDiscreteModelInference();
         exportParametrizedMulticutModelInference();
         exportEdgeHammingLossAugmentedModelInference();
+        exportNonDecomposableLossAugmentedModelInference();
     }
 
 
@@ -0,0 +1,50 @@
+#define PY_ARRAY_UNIQUE_SYMBOL inferno_inference_PyArray_API
+#define NO_IMPORT_ARRAY
+
+
+// inferno relatex
+#include "inferno/inferno_python.hxx"
+
+// vigra numpy array converters
+#include <vigra/numpy_array.hxx>
+#include <vigra/numpy_array_converters.hxx>
+
+// functions and macros to export inference
+#include "exportInference.hxx"
+
+// model type
+#include "inferno/learning/loss_functions/loss_function_base.hxx"
+#include "inferno/python/model/parametrized_multicut_model.hxx"
+
+// solvers
+#include "factories/loss_augmented_local_search.hxx"
+
+namespace inferno{
+namespace inference{
+
+    template<class BASE_MODEL>
+    void exportNonDecomposableLossAugmentedModelInferenceT(const std::string baseModelName){
+
+        typedef BASE_MODEL BaseModel;
+        typedef learning::loss_functions::NonDecomposableLossFunctionBase<BaseModel> LossFunctionBase;
+        typedef typename LossFunctionBase::LossAugmentedModel Model;
+
+        const std::string modelName = "NonDecomposableLossAugmented" + baseModelName;
+
+        // export the base class for discrete inference
+        exportDiscreteInferenceBase<Model>(modelName);
+
+        // export concrete solvers (via macro)
+        typedef LossAugmentedLocalSearch<Model> LocalSearch;
+        INFERNO_EXPORT_INFERENCE(Model, modelName, LocalSearch, "LossAugmentedLocalSearch");
+    }
+    
+
+    void exportNonDecomposableLossAugmentedModelInference(){
+        exportNonDecomposableLossAugmentedModelInferenceT<models::PyParametrizedMulticutModel>("ParametrizedMulticutModel");
+    }
+
+} // end namespace inferno::inference
+} // end namespace inferno
+
+
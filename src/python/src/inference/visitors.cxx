@@ -11,6 +11,9 @@
 
 // standart c++ headers 
 #include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
 
 // inferno related
 #include "inferno/inferno.hxx"
@@ -40,9 +43,74 @@ namespace inference{
         return  new VerboseVisitor<MODEL>(printNth, singleLine);
     }
 
+    template<class MODEL>
+    StoppingVisitor<MODEL> * stoppingVisitorFactory(
+         const MODEL & model,
+         const double timeLimit,
+         const uint64_t maxIterations,
+         const uint64_t improvementWindow,
+         const ValueType minRelativeImprovement,
+         const ValueType absoluteGap,
+         const ValueType relativeGap,
+         const bool recordTrace
+    ){
+        typedef typename StoppingVisitor<MODEL>::Options Options;
+        return new StoppingVisitor<MODEL>(Options(timeLimit, maxIterations, improvementWindow,
+            minRelativeImprovement, absoluteGap, relativeGap, recordTrace));
+    }
+
+    template<class T>
+    vigra::NumpyAnyArray vectorToArray(const std::vector<T> & values){
+        typedef vigra::NumpyArray<1, T> Array;
+        Array out(typename Array::difference_type(values.size()));
+        std::copy(values.begin(), values.end(), out.begin());
+        return out;
+    }
+
+    template<class VISITOR>
+    vigra::NumpyAnyArray traceTimes(const VISITOR & visitor){
+        return vectorToArray(visitor.times());
+    }
+    template<class VISITOR>
+    vigra::NumpyAnyArray traceEnergies(const VISITOR & visitor){
+        return vectorToArray(visitor.energies());
+    }
+    template<class VISITOR>
+    vigra::NumpyAnyArray traceLowerBounds(const VISITOR & visitor){
+        return vectorToArray(visitor.lowerBounds());
+    }
+
     template<class MODEL>
     void exportVisitorsT(const std::string modelName){
 
+        {
+            const std::string visitorClsName = std::string("StoppingVisitor") + modelName;
+            typedef StoppingVisitor<MODEL> VisitorType;
+            bp::class_<VisitorType>(visitorClsName.c_str(),bp::no_init)
+                .def("visitor",&VisitorType::visitor,bp::return_internal_reference<>())
+                .def("stopReason",&VisitorType::stopReason)
+                .def("iterations",&VisitorType::iterations)
+                .def("times",&traceTimes<VisitorType>)
+                .def("energies",&traceEnergies<VisitorType>)
+                .def("lowerBounds",&traceLowerBounds<VisitorType>)
+            ;
+
+            // export visitor factory
+            bp::def("stoppingVisitor", & stoppingVisitorFactory<MODEL>,
+                    (
+                        bp::arg("model"),
+                        bp::arg("timeLimit") = std::numeric_limits<double>::infinity(),
+                        bp::arg("maxIterations") = uint64_t(0),
+                        bp::arg("improvementWindow") = uint64_t(0),
+                        bp::arg("minRelativeImprovement") = 0.0,
+                        bp::arg("absoluteGap") = 0.0,
+                        bp::arg("relativeGap") = 0.0,
+                        bp::arg("recordTrace") = true
+                    ),
+                    bp::return_value_policy<bp::manage_new_object>()
+            );
+        }
+
         {
             const std::string visitorClsName = std::string("VerboseVisitor") + modelName;
             typedef VerboseVisitor<MODEL> VisitorType;
@@ -79,6 +147,13 @@ namespace inference{
 
 
     void exportVisitors(){
+        bp::enum_<StopReason>("StopReason")
+            .value("NotStopped", NotStopped)
+            .value("TimeLimit", TimeLimit)
+            .value("IterationLimit", IterationLimit)
+            .value("NoImprovement", NoImprovement)
+            .value("GapClosed", GapClosed)
+        ;
         exportVisitorsT<inferno::models::GeneralDiscreteModel>("GeneralDiscreteModel");
         exportVisitorsT<inferno::models::PyParametrizedMulticutModel>("ParametrizedMulticutModel");
     }
@@ -37,6 +37,7 @@ namespace learners{
     namespace bp = boost::python;
 
     void exportLearnersParametrizedMulticutModel();
+    void exportLearningVisitors();
        
 }
 }
@@ -58,5 +59,6 @@ BOOST_PYTHON_MODULE_INIT(learners) {
     // No not change 4 line above
 
     namespace ll = inferno::learning::learners;
+    ll::exportLearningVisitors();
     ll::exportLearnersParametrizedMulticutModel();
 }
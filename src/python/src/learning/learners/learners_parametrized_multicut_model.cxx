@@ -9,6 +9,7 @@
 #include "inferno/python/learning/dataset/default_dataset.hxx"
 #include "inferno/python/learning/learners/export_stochastic_gradient.hxx"
 #include "inferno/python/learning/learners/export_subgradient.hxx"
+#include "inferno/python/learning/learners/export_bundle_method.hxx"
 
 namespace inferno{
 namespace learning{
@@ -30,6 +31,14 @@ namespace learners{
                 const auto solverName = std::string("StochasticGradient") + modelName + lossBaseName;
                 ExportStochasticGradient<Dataset>::exportLearner(solverName);
             }
+            {   // subgradient (with approximate loss augmented inference)
+                const auto solverName = std::string("Subgradient") + modelName + lossBaseName;
+                ExportSubgradient<Dataset>::exportLearner(solverName);
+            }
+            {   // bundle method (with approximate loss augmented inference)
+                const auto solverName = std::string("BundleMethod") + modelName + lossBaseName;
+                ExportBundleMethod<Dataset>::exportLearner(solverName);
+            }
         }
 
         {   // learners for partition hamming
@@ -41,6 +50,11 @@ namespace learners{
                 const auto solverName = std::string("Subgradient") + modelName + lossBaseName;
                 ExportSubgradient<Dataset>::exportLearner(solverName);
             }
+            {
+                // bundle method
+                const auto solverName = std::string("BundleMethod") + modelName + lossBaseName;
+                ExportBundleMethod<Dataset>::exportLearner(solverName);
+            }
         }
     }
 
@@ -0,0 +1,73 @@
+#define PY_ARRAY_UNIQUE_SYMBOL inferno_learning_learners_PyArray_API
+#define NO_IMPORT_ARRAY
+
+
+// boost python related
+#include <boost/python/detail/wrap_python.hpp>
+#include <boost/python.hpp>
+
+// standart c++ headers (whatever you need (string and vector are just examples))
+#include <string>
+#include <sstream>
+
+// inferno relatex
+#include "inferno/inferno.hxx"
+#include "inferno/inferno_python.hxx"
+#include "inferno/learning/learners/learning_visitor.hxx"
+
+
+namespace inferno{
+namespace learning{
+namespace learners{
+
+    namespace bp = boost::python;
+
+    template<class RECORDER>
+    std::string recorderToCsv(const RECORDER & recorder){
+        std::stringstream ss;
+        recorder.writeCsv(ss);
+        return ss.str();
+    }
+
+    template<class RECORDER>
+    std::string recorderToJson(const RECORDER & recorder){
+        std::stringstream ss;
+        recorder.writeJson(ss);
+        return ss.str();
+    }
+
+    template<class RECORDER>
+    uint64_t recorderSize(const RECORDER & recorder){
+        return recorder.records().size();
+    }
+
+    void exportLearningVisitors(){
+
+        bp::class_<LearningVisitorBase, boost::noncopyable>("LearningVisitorBase", bp::no_init);
+
+        typedef LearningRecorder Recorder;
+        void (Recorder::*writeCsv)(const std::string &)const = &Recorder::writeCsv;
+        void (Recorder::*writeJson)(const std::string &)const = &Recorder::writeJson;
+
+        bp::class_<Recorder, bp::bases<LearningVisitorBase>, boost::noncopyable>(
+            "LearningRecorder",
+            bp::init<const bool, const uint64_t, const bool>(
+                (
+                    bp::arg("verbose") = false,
+                    bp::arg("validationEvery") = uint64_t(1),
+                    bp::arg("asyncValidation") = true
+                )
+            )
+        )
+            .def("writeCsv", writeCsv, bp::arg("filename"))
+            .def("writeJson", writeJson, bp::arg("filename"))
+            .def("toCsv", &recorderToCsv<Recorder>)
+            .def("toJson", &recorderToJson<Recorder>)
+            .def("__len__", &recorderSize<Recorder>)
+        ;
+    }
+
+}
+}
+}
+
@@ -35,6 +35,7 @@ namespace models{
     void exportGeneralDiscreteGraphicalModel();
     void exportParametrizedMulticutModel();
     void exportEdgeHammingLossAugmentedModel();
+    void exportNonDecomposableLossAugmentedModel();
 
 
    
@@ -42,6 +43,7 @@ namespace models{
         exportGeneralDiscreteGraphicalModel();
         exportParametrizedMulticutModel();
         exportEdgeHammingLossAugmentedModel();
+        exportNonDecomposableLossAugmentedModel();
     }
 
 } // end namespace inferno::models  
@@ -74,6 +74,7 @@ namespace models{
             .def("_assign",vigra::registerConverters(&parametrizedMulticutModelAssign), 
                 RetValPol< CustWardEnd<1,5> >()
             )
+            .def("setNumberOfThreads", &Model::setNumberOfThreads, (bp::arg("nThreads")))
         ;
 
         // the factory function
@@ -1,9 +1,15 @@
+// std
+#include <map>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
 #include "inferno/inferno.hxx"
-#include "inferno/model/sparse_discrete_model.hxx"
 #include "inferno/model/general_discrete_model.hxx"
-#include "inferno/model/general_discrete_tl_model.hxx"
 #include "inferno/value_tables/potts.hxx"
 #include "inferno/value_tables/unary.hxx"
+#include "inferno/value_tables/explicit.hxx"
 
 #include "inferno/utilities/timer.hxx"
 
@@ -84,7 +90,7 @@ namespace models{
                     }
                     auto vti = model.addValueTable(new (mem) inferno::value_tables::UnaryViewValueTable(nLabels, data) );
                     mem += sU + sizeof(inferno::ValueType)*nLabels;
-                    auto fi = model.addFactor(vti ,{vi});
+                    model.addFactor(vti ,{vi});
                 }
 
 
@@ -97,15 +103,15 @@ namespace models{
                         const inferno::Vi vi1 = x + 1 + y*gridShape[0];
                         auto vti = model.addValueTable(new(mem) inferno::value_tables::PottsValueTable(nLabels, beta));
                         mem += sSO; 
-                        auto fi = model.addFactor(vti ,{vi0, vi1});
+                        model.addFactor(vti ,{vi0, vi1});
                     }
                     if(y+1 <gridShape[1]){
                         double beta = mp.submodular_ ? rgen.rDouble()*mp.betaScale_ : (rgen.rDouble()-0.5)*2.0*mp.betaScale_ ;
                         const inferno::Vi vi0 = x + y*gridShape[0];
                         const inferno::Vi vi1 = x + (1 + y)*gridShape[0];
-                        auto vti = model.addValueTable(new(mem) inferno::value_tables::PottsValueTable(nLabels, 1.0));
+                        auto vti = model.addValueTable(new(mem) inferno::value_tables::PottsValueTable(nLabels, beta));
                         mem += sSO;
-                        auto fi = model.addFactor(vti ,{vi0, vi1});
+                        model.addFactor(vti ,{vi0, vi1});
                     }
                 }
 
@@ -125,5 +131,273 @@ namespace models{
 
     };
 
+
+
+    template<class MODEL>
+    struct PottsRag;
+
+    template<class MODEL>
+    struct DensePotts;
+
+    template<class MODEL>
+    struct HigherOrderGrid2d;
+
+    template<class MODEL>
+    struct MulticutGrid2d;
+
+    /// \brief superpixel region adjacency graph on a sizeX x sizeY image
+    struct PottsRagParam{
+        DiscreteLabel nl_;
+        size_t        sizeX_;
+        size_t        sizeY_;
+        size_t        nSuperpixels_;
+        double        betaScale_;
+        bool          submodular_;
+    };
+
+    /// \brief fully connected potts model
+    struct DensePottsParam{
+        DiscreteLabel nl_;
+        size_t        nVar_;
+        double        betaScale_;
+        bool          submodular_;
+    };
+
+    /// \brief grid with a fourth order factor for each 2x2 block
+    struct HigherOrderGridParam{
+        DiscreteLabel nl_;
+        size_t        sizeX_;
+        size_t        sizeY_;
+        double        betaScale_;
+    };
+
+    /// \brief second order multicut model on a sizeX x sizeY grid
+    struct MulticutGridParam{
+        size_t        sizeX_;
+        size_t        sizeY_;
+        double        betaScale_;
+    };
+
+
+    /** \brief superpixel region adjacency graph
+
+        The superpixels are the voronoi cells of
+        nSuperpixels_ random seeds, each region adjacency
+        gets a potts factor with a weight proportional
+        to the length of the boundary.
+    */
+    template< >
+    struct PottsRag<GeneralDiscreteModel>{
+        typedef GeneralDiscreteModel Model;
+        typedef PottsRagParam ModelParam;
+        struct BuilderParam{
+        };
+
+        template<class FUNCTOR>
+        static void buildModelCallFunctor(const ModelParam & mp,
+                                          const BuilderParam &,
+                                          const size_t seed,
+                                          FUNCTOR & functor){
+
+            utilities::ReprRandom rgen(seed);
+            const size_t nSeeds = std::max(size_t(1), std::min(mp.nSuperpixels_, mp.sizeX_*mp.sizeY_));
+
+            // voronoi cells of the seeds
+            std::vector<std::pair<size_t, size_t> > seeds(nSeeds);
+            for(auto & s : seeds)
+                s = std::make_pair(rgen.rUInt32(mp.sizeX_), rgen.rUInt32(mp.sizeY_));
+            std::vector<uint64_t> labels(mp.sizeX_*mp.sizeY_);
+            for(size_t y=0; y<mp.sizeY_; ++y)
+            for(size_t x=0; x<mp.sizeX_; ++x){
+                uint64_t best = 0;
+                double bestD = std::numeric_limits<double>::infinity();
+                for(size_t s=0; s<nSeeds; ++s){
+                    const double dx = double(x) - double(seeds[s].first);
+                    const double dy = double(y) - double(seeds[s].second);
+                    if(dx*dx + dy*dy < bestD){
+                        bestD = dx*dx + dy*dy;
+                        best = s;
+                    }
+                }
+                labels[x + y*mp.sizeX_] = best;
+            }
+
+            // dense relabeling (empty cells are dropped)
+            std::map<uint64_t, Vi> dense;
+            for(const auto l : labels)
+                dense.insert(std::make_pair(l, Vi(dense.size())));
+            for(auto & l : labels)
+                l = dense[l];
+            const Vi nVar = dense.size();
+
+            // boundary length of adjacent regions
+            std::map<std::pair<Vi, Vi>, size_t> boundaries;
+            for(size_t y=0; y<mp.sizeY_; ++y)
+            for(size_t x=0; x<mp.sizeX_; ++x){
+                const Vi u = labels[x + y*mp.sizeX_];
+                if(x+1 < mp.sizeX_){
+                    const Vi v = labels[x + 1 + y*mp.sizeX_];
+                    if(u != v)
+                        ++boundaries[std::make_pair(std::min(u,v), std::max(u,v))];
+                }
+                if(y+1 < mp.sizeY_){
+                    const Vi v = labels[x + (y+1)*mp.sizeX_];
+                    if(u != v)
+                        ++boundaries[std::make_pair(std::min(u,v), std::max(u,v))];
+                }
+            }
+
+            Model model(nVar, mp.nl_);
+            for(Vi vi=0; vi<nVar; ++vi){
+                std::vector<ValueType> values(mp.nl_);
+                for(auto & v : values)
+                    v = rgen.rDouble();
+                const auto vti = model.addValueTable(new value_tables::UnaryValueTable(values.begin(), values.end()));
+                model.addFactor(vti, {vi});
+            }
+            for(const auto & kv : boundaries){
+                const double r = mp.submodular_ ? rgen.rDouble() : (rgen.rDouble()-0.5)*2.0;
+                const double beta = r*mp.betaScale_*std::sqrt(double(kv.second));
+                const auto vti = model.addValueTable(new value_tables::PottsValueTable(mp.nl_, beta));
+                model.addFactor(vti, {kv.first.first, kv.first.second});
+            }
+            functor(model);
+        }
+    };
+
+
+    /// \brief fully connected potts model with random weights
+    template< >
+    struct DensePotts<GeneralDiscreteModel>{
+        typedef GeneralDiscreteModel Model;
+        typedef DensePottsParam ModelParam;
+        struct BuilderParam{
+        };
+
+        template<class FUNCTOR>
+        static void buildModelCallFunctor(const ModelParam & mp,
+                                          const BuilderParam &,
+                                          const size_t seed,
+                                          FUNCTOR & functor){
+
+            utilities::ReprRandom rgen(seed);
+            const Vi nVar = mp.nVar_;
+            Model model(nVar, mp.nl_);
+            for(Vi vi=0; vi<nVar; ++vi){
+                std::vector<ValueType> values(mp.nl_);
+                for(auto & v : values)
+                    v = rgen.rDouble();
+                const auto vti = model.addValueTable(new value_tables::UnaryValueTable(values.begin(), values.end()));
+                model.addFactor(vti, {vi});
+            }
+            for(Vi u=0; u<nVar; ++u)
+            for(Vi v=u+1; v<nVar; ++v){
+                const double r = mp.submodular_ ? rgen.rDouble() : (rgen.rDouble()-0.5)*2.0;
+                const auto vti = model.addValueTable(new value_tables::PottsValueTable(mp.nl_, r*mp.betaScale_/nVar));
+                model.addFactor(vti, {u, v});
+            }
+            functor(model);
+        }
+    };
+
+
+    /** \brief grid with unaries and a fourth order
+        factor for each 2x2 block
+
+        The fourth order factors are explicit value tables,
+        the value of a configuration is a random weight times
+        the number of different labels in the block minus one.
+    */
+    template< >
+    struct HigherOrderGrid2d<GeneralDiscreteModel>{
+        typedef GeneralDiscreteModel Model;
+        typedef HigherOrderGridParam ModelParam;
+        struct BuilderParam{
+        };
+
+        template<class FUNCTOR>
+        static void buildModelCallFunctor(const ModelParam & mp,
+                                          const BuilderParam &,
+                                          const size_t seed,
+                                          FUNCTOR & functor){
+
+            utilities::ReprRandom rgen(seed);
+            const DiscreteLabel nl = mp.nl_;
+            const Vi nVar = mp.sizeX_*mp.sizeY_;
+            Model model(nVar, nl);
+            for(Vi vi=0; vi<nVar; ++vi){
+                std::vector<ValueType> values(nl);
+                for(auto & v : values)
+                    v = rgen.rDouble();
+                const auto vti = model.addValueTable(new value_tables::UnaryValueTable(values.begin(), values.end()));
+                model.addFactor(vti, {vi});
+            }
+
+            const size_t shape[4] = {size_t(nl), size_t(nl), size_t(nl), size_t(nl)};
+            for(size_t y=0; y+1<mp.sizeY_; ++y)
+            for(size_t x=0; x+1<mp.sizeX_; ++x){
+                const double beta = rgen.rDouble()*mp.betaScale_;
+                ValueMarray vt(shape, shape+4);
+                DiscreteLabel c[4];
+                for(c[3]=0; c[3]<nl; ++c[3])
+                for(c[2]=0; c[2]<nl; ++c[2])
+                for(c[1]=0; c[1]<nl; ++c[1])
+                for(c[0]=0; c[0]<nl; ++c[0]){
+                    std::vector<DiscreteLabel> l(c, c+4);
+                    std::sort(l.begin(), l.end());
+                    const auto nDifferent = std::unique(l.begin(), l.end()) - l.begin();
+                    vt(c[0], c[1], c[2], c[3]) = beta*double(nDifferent - 1);
+                }
+                const Vi v00 = x + y*mp.sizeX_;
+                const Vi v10 = x + 1 + y*mp.sizeX_;
+                const Vi v01 = x + (y+1)*mp.sizeX_;
+                const Vi v11 = x + 1 + (y+1)*mp.sizeX_;
+                const auto vti = model.addValueTable(new value_tables::Explicit(vt));
+                model.addFactor(vti, {v00, v10, v01, v11});
+            }
+            functor(model);
+        }
+    };
+
+
+    /** \brief second order multicut model on a grid
+
+        No unaries, as many labels as variables and
+        attractive and repulsive potts factors
+        between 4-neighbours.
+    */
+    template< >
+    struct MulticutGrid2d<GeneralDiscreteModel>{
+        typedef GeneralDiscreteModel Model;
+        typedef MulticutGridParam ModelParam;
+        struct BuilderParam{
+        };
+
+        template<class FUNCTOR>
+        static void buildModelCallFunctor(const ModelParam & mp,
+                                          const BuilderParam &,
+                                          const size_t seed,
+                                          FUNCTOR & functor){
+
+            utilities::ReprRandom rgen(seed);
+            const Vi nVar = mp.sizeX_*mp.sizeY_;
+            Model model(nVar, nVar);
+            for(size_t y=0; y<mp.sizeY_; ++y)
+            for(size_t x=0; x<mp.sizeX_; ++x){
+                const Vi u = x + y*mp.sizeX_;
+                if(x+1 < mp.sizeX_){
+                    const double beta = (rgen.rDouble()-0.5)*2.0*mp.betaScale_;
+                    const auto vti = model.addValueTable(new value_tables::PottsValueTable(nVar, beta));
+                    model.addFactor(vti, {u, Vi(u+1)});
+                }
+                if(y+1 < mp.sizeY_){
+                    const double beta = (rgen.rDouble()-0.5)*2.0*mp.betaScale_;
+                    const auto vti = model.addValueTable(new value_tables::PottsValueTable(nVar, beta));
+                    model.addFactor(vti, {u, Vi(u+mp.sizeX_)});
+                }
+            }
+            functor(model);
+        }
+    };
 }
 }
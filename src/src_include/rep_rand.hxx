@@ -1,6 +1,8 @@
 #ifndef INFERNO_SRC_INCLUDE_REPR_RAND_HXX
 #define INFERNO_SRC_INCLUDE_REPR_RAND_HXX
 
+#include <cstdint>
+
 namespace inferno{
 namespace utilities{
 
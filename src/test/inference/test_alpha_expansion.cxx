@@ -0,0 +1,89 @@
+#define BOOST_TEST_MODULE AlphaExpansionTest
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/inference/alpha_expansion.hxx"
+#include "inferno/inference/visitors.hxx"
+#include "inferno_test/random_grid.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::inference::AlphaExpansion<Model> AlphaExpansion;
+typedef inferno::inference::StoppingVisitor<Model> StoppingVisitor;
+
+// the energy is evaluated at each visit and must never increase
+void checkRun(AlphaExpansion & solver, const Model & model){
+    using namespace inferno;
+    StoppingVisitor visitor;
+    solver.infer(&visitor.visitor());
+    const auto & energies = visitor.energies();
+    BOOST_REQUIRE_GE(energies.size(), 2);
+    for(size_t i=1; i<energies.size(); ++i)
+        BOOST_CHECK_LE(energies[i], energies[i-1] + TEST_EPS);
+    Model::VariableMap<DiscreteLabel> conf(model);
+    solver.conf(conf);
+    BOOST_CHECK_CLOSE(model.eval(conf), solver.energy(), TEST_EPS);
+}
+
+BOOST_AUTO_TEST_CASE(TestAlphaExpansionBinaryOptimal)
+{
+    using namespace inferno;
+    // binary submodular models are solved exactly by a single move
+    for(int seed=0; seed<5; ++seed){
+        Model model(12, 2);
+        // random (non negative) unaries and submodular potts factors
+        test::fillPottsGrid(model, 4, 3, 2, seed, 0.0, 0.6);
+        const auto optimum = test::bruteForce(model);
+        for(const auto moveType : {AlphaExpansion::Options::Expansion, AlphaExpansion::Options::Swap}){
+            AlphaExpansion solver(model, AlphaExpansion::Options(moveType));
+            checkRun(solver, model);
+            BOOST_CHECK_CLOSE(solver.energy(), optimum, TEST_EPS);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestAlphaExpansionMultiLabel)
+{
+    using namespace inferno;
+    for(int seed=0; seed<5; ++seed){
+        Model model(9, 3);
+        test::fillPottsGrid(model, 3, 3, 3, seed, 0.0, 0.6);
+        const auto optimum = test::bruteForce(model);
+        for(const auto moveType : {AlphaExpansion::Options::Expansion, AlphaExpansion::Options::Swap}){
+            for(const uint64_t nThreads : {1, 2}){
+                AlphaExpansion solver(model, AlphaExpansion::Options(moveType, 1000,
+                    AlphaExpansion::Options::DefaultOrder, true, nThreads));
+                checkRun(solver, model);
+                BOOST_CHECK_GE(solver.energy(), optimum - TEST_EPS);
+                // the expansion bound for potts models with non negative unaries
+                if(moveType == AlphaExpansion::Options::Expansion)
+                    BOOST_CHECK_LE(solver.energy(), 2.0*optimum + TEST_EPS);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestAlphaExpansionReuseTrees)
+{
+    using namespace inferno;
+    // reusing the search trees must not change the result,
+    // repulsive factors make some moves non submodular
+    for(int seed=0; seed<5; ++seed){
+        Model model(64, 4);
+        test::fillPottsGrid(model, 8, 8, 4, seed, -0.2, 0.6);
+        for(const auto moveType : {AlphaExpansion::Options::Expansion, AlphaExpansion::Options::Swap}){
+            AlphaExpansion reuse(model, AlphaExpansion::Options(moveType, 1000,
+                AlphaExpansion::Options::DefaultOrder, true));
+            AlphaExpansion fresh(model, AlphaExpansion::Options(moveType, 1000,
+                AlphaExpansion::Options::DefaultOrder, false));
+            checkRun(reuse, model);
+            checkRun(fresh, model);
+            BOOST_CHECK_EQUAL(reuse.energy(), fresh.energy());
+            for(const auto vi : model.variableDescriptors())
+                BOOST_CHECK_EQUAL(reuse.label(vi), fresh.label(vi));
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#define BOOST_TEST_MODULE CgcTest
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/inference/cgc.hxx"
+#include "inferno/inference/visitors.hxx"
+#include "inferno_test/random_grid.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::inference::Cgc<Model> Cgc;
+typedef inferno::inference::StoppingVisitor<Model> StoppingVisitor;
+
+// second order multicut model on a grid with
+// random attractive and repulsive potts factors
+void fillMulticutGrid(Model & model, const size_t sizeX, const size_t sizeY, const int seed){
+    using namespace inferno;
+    std::uniform_real_distribution<ValueType> dist(-1.0, 1.0);
+    const LabelType nl = sizeX*sizeY;
+    test::fillGrid(model, sizeX, sizeY, seed,
+        [](std::mt19937 &, const Vi) -> value_tables::DiscreteValueTableBase * {
+            return NULL;
+        },
+        [&](std::mt19937 & gen, const Vi, const Vi, const bool){
+            return new value_tables::PottsValueTable(nl, dist(gen));
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(TestCgcBruteForce)
+{
+    using namespace inferno;
+    size_t nOptimal = 0;
+    for(int seed=0; seed<10; ++seed){
+        Model model(9, 9);
+        fillMulticutGrid(model, 3, 3, seed);
+        const auto optimum = test::bruteForcePartitions(model);
+        for(const uint64_t nThreads : {1, 2}){
+            Cgc solver(model, Cgc::Options(1000, true, nThreads));
+            StoppingVisitor visitor;
+            solver.infer(&visitor.visitor());
+
+            // the energy must never increase
+            const auto & energies = visitor.energies();
+            for(size_t i=1; i<energies.size(); ++i)
+                BOOST_CHECK_LE(energies[i], energies[i-1] + TEST_EPS);
+
+            Model::VariableMap<DiscreteLabel> conf(model);
+            solver.conf(conf);
+            BOOST_CHECK_SMALL(model.eval(conf) - solver.energy(), TEST_EPS);
+            BOOST_CHECK_GE(solver.energy(), optimum - TEST_EPS);
+            BOOST_CHECK_LE(solver.lowerBound(), optimum + TEST_EPS);
+            if(solver.energy() <= optimum + TEST_EPS)
+                ++nOptimal;
+        }
+    }
+    // cut, glue & cut is a local search, but on
+    // these tiny grids it should almost always be optimal
+    BOOST_CHECK_GE(nOptimal, 16);
+}
+
+BOOST_AUTO_TEST_CASE(TestCgcWarmStart)
+{
+    using namespace inferno;
+    Model model(12, 12);
+    fillMulticutGrid(model, 4, 3, 42);
+    const auto optimum = test::bruteForcePartitions(model);
+
+    // a warm start is never worsened
+    Model::VariableMap<DiscreteLabel> start(model);
+    for(const auto vi : model.variableDescriptors())
+        start[vi] = vi % 3;
+    const auto startEnergy = model.eval(start);
+
+    Cgc solver(model);
+    solver.setConf(start);
+    BOOST_CHECK_SMALL(solver.energy() - startEnergy, TEST_EPS);
+    solver.infer();
+    BOOST_CHECK_LE(solver.energy(), startEnergy + TEST_EPS);
+    BOOST_CHECK_GE(solver.energy(), optimum - TEST_EPS);
+}
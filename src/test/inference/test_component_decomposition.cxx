@@ -0,0 +1,181 @@
+#define BOOST_TEST_MODULE ComponentDecompositionTest
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+#include <limits>
+#include <memory>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/value_tables/unary.hxx"
+#include "inferno/inference/component_decomposition.hxx"
+#include "inferno/inference/alpha_expansion.hxx"
+#include "inferno/inference/icm.hxx"
+#include "inferno/inference/visitors.hxx"
+#include "inferno_test/random_grid.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::inference::ComponentDecomposition<Model> Decomposition;
+typedef Decomposition::SubModel SubModel;
+typedef inferno::inference::StoppingVisitor<Model> StoppingVisitor;
+
+// binary grid with random unaries and submodular potts factors,
+// the potts factors of every third column are constant (beta = 0)
+// and split the grid into several components
+void fillSplitGrid(Model & model, const size_t sizeX, const size_t sizeY, const int seed,
+                   const inferno::ValueType betaScale = 0.8){
+    using namespace inferno;
+    std::uniform_real_distribution<ValueType> dist(0.0, 1.0);
+    test::fillGrid(model, sizeX, sizeY, seed,
+        [&](std::mt19937 & gen, const Vi){
+            const ValueType vals[2] = {dist(gen), dist(gen)};
+            return new value_tables::UnaryValueTable(vals, vals+2);
+        },
+        [&](std::mt19937 & gen, const Vi vi0, const Vi, const bool horizontal){
+            // no random number is drawn for the constant factors
+            if(horizontal && (vi0 % Vi(sizeX)) % 3 == 2)
+                return new value_tables::PottsValueTable(2, 0.0);
+            return new value_tables::PottsValueTable(2, betaScale*dist(gen));
+        }
+    );
+}
+
+template<class SUB_SOLVER>
+Decomposition::Options makeOptions(const uint64_t nThreads = 1){
+    using namespace inferno::inference;
+    std::shared_ptr<Decomposition::SubInferenceFactory> factory =
+        std::make_shared<DiscreteInferenceFactory<SUB_SOLVER> >();
+    return Decomposition::Options(factory, nThreads);
+}
+
+// sub-solver which ignores the warm start and labels all variables with 0
+class ZeroSolver : public inferno::inference::DiscreteInferenceBase<SubModel>{
+public:
+    struct Options{
+    };
+    ZeroSolver(const SubModel & model, const Options & = Options())
+    :   model_(model){
+    }
+    virtual std::string name()const{
+        return "ZeroSolver";
+    }
+    virtual void infer(Visitor * = NULL){
+    }
+    virtual void conf(Conf & conf){
+        for(const auto vi : model_.variableDescriptors())
+            conf[vi] = 0;
+    }
+    virtual inferno::DiscreteLabel label(const inferno::Vi){
+        return 0;
+    }
+    virtual const SubModel & model()const{
+        return model_;
+    }
+    virtual void stopInference(){
+    }
+private:
+    const SubModel & model_;
+};
+
+BOOST_AUTO_TEST_CASE(TestComponentDecompositionFullModel)
+{
+    using namespace inferno;
+    typedef inference::AlphaExpansion<Model> FullSolver;
+    typedef inference::AlphaExpansion<SubModel> SubSolver;
+    for(int seed=0; seed<5; ++seed){
+        Model model(5*4, 2);
+        fillSplitGrid(model, 5, 4, seed);
+
+        // binary submodular models are solved exactly
+        FullSolver fullSolver(model);
+        fullSolver.infer();
+        const auto optimum = fullSolver.energy();
+
+        for(const uint64_t nThreads : {1, 2}){
+            Decomposition solver(model, makeOptions<SubSolver>(nThreads));
+            BOOST_CHECK_EQUAL(solver.nComponents(), 2);
+            StoppingVisitor visitor;
+            solver.infer(&visitor.visitor());
+            // one visit per component
+            BOOST_CHECK_EQUAL(visitor.iterations(), solver.nComponents());
+            const auto & energies = visitor.energies();
+            for(size_t i=1; i<energies.size(); ++i)
+                BOOST_CHECK_LE(energies[i], energies[i-1] + TEST_EPS);
+
+            Model::VariableMap<DiscreteLabel> conf(model);
+            solver.conf(conf);
+            BOOST_CHECK_SMALL(model.eval(conf) - solver.energy(), TEST_EPS);
+            BOOST_CHECK_SMALL(solver.energy() - optimum, TEST_EPS);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestComponentDecompositionStop)
+{
+    using namespace inferno;
+    typedef inference::AlphaExpansion<SubModel> SubSolver;
+    Model model(7*3, 2);
+    fillSplitGrid(model, 7, 3, 0);
+
+    Decomposition solver(model, makeOptions<SubSolver>());
+    BOOST_CHECK_EQUAL(solver.nComponents(), 3);
+    StoppingVisitor visitor(StoppingVisitor::Options(std::numeric_limits<double>::infinity(), 1));
+    solver.infer(&visitor.visitor());
+    BOOST_CHECK_EQUAL(visitor.iterations(), 1);
+    BOOST_CHECK(visitor.stopReason() == inference::IterationLimit);
+    // the energy matches the partially solved labeling
+    Model::VariableMap<DiscreteLabel> conf(model);
+    solver.conf(conf);
+    BOOST_CHECK_SMALL(model.eval(conf) - solver.energy(), TEST_EPS);
+}
+
+BOOST_AUTO_TEST_CASE(TestComponentDecompositionWarmStart)
+{
+    using namespace inferno;
+    typedef inference::Icm<SubModel> SubSolver;
+    // with strong potts factors any labeling which is constant
+    // on each component is a local optimum for icm
+    Model model(6*4, 2);
+    fillSplitGrid(model, 6, 4, 3, 100.0);
+
+    for(const DiscreteLabel startLabel : {0, 1}){
+        Model::VariableMap<DiscreteLabel> start(model, startLabel);
+        Decomposition solver(model, makeOptions<SubSolver>());
+        solver.setConf(start);
+        BOOST_CHECK_SMALL(solver.energy() - model.eval(start), TEST_EPS);
+        solver.infer();
+        // the sub-solvers start from the given labeling
+        Model::VariableMap<DiscreteLabel> conf(model);
+        solver.conf(conf);
+        for(const auto vi : model.variableDescriptors())
+            BOOST_CHECK_EQUAL(conf[vi], startLabel);
+        BOOST_CHECK_SMALL(solver.energy() - model.eval(start), TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestComponentDecompositionKeepBetterStart)
+{
+    using namespace inferno;
+    typedef inference::AlphaExpansion<Model> FullSolver;
+    for(int seed=0; seed<5; ++seed){
+        Model model(6*4, 2);
+        fillSplitGrid(model, 6, 4, seed);
+        FullSolver fullSolver(model);
+        fullSolver.infer();
+        Model::VariableMap<DiscreteLabel> start(model);
+        fullSolver.conf(start);
+
+        // the labels of the sub-solver are only taken if they are better
+        Decomposition solver(model, makeOptions<ZeroSolver>());
+        solver.setConf(start);
+        solver.infer();
+        Model::VariableMap<DiscreteLabel> conf(model);
+        solver.conf(conf);
+        for(const auto vi : model.variableDescriptors())
+            BOOST_CHECK_EQUAL(conf[vi], start[vi]);
+        BOOST_CHECK_SMALL(solver.energy() - fullSolver.energy(), TEST_EPS);
+    }
+}
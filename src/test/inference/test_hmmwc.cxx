@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE HmmwcTest
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/value_tables/unary.hxx"
+#include "inferno/inference/hmmwc.hxx"
+#include "inferno_test/random_grid.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::inference::Hmmwc<Model> Hmmwc;
+
+// modified multiway cut model on a grid:
+// nNoCut semantic classes with a single label followed by
+// nCut semantic classes with nVar labels each.
+// The unaries are constant within a semantic class,
+// the potts factors are attractive and repulsive.
+void fillMultiwayCutGrid(Model & model, const size_t sizeX, const size_t sizeY,
+                         const size_t nNoCut, const size_t nCut, const int seed){
+    using namespace inferno;
+    std::uniform_real_distribution<ValueType> dist(-1.0, 1.0);
+    const Vi nVar = sizeX*sizeY;
+    const LabelType nl = nNoCut + nCut*nVar;
+    std::vector<ValueType> vals(nl);
+    test::fillGrid(model, sizeX, sizeY, seed,
+        [&](std::mt19937 & gen, const Vi){
+            LabelType l = 0;
+            for(size_t c=0; c<nNoCut + nCut; ++c){
+                const ValueType v = dist(gen);
+                const LabelType n = c < nNoCut ? 1 : nVar;
+                for(LabelType i=0; i<n; ++i)
+                    vals[l++] = v;
+            }
+            return new value_tables::UnaryValueTable(vals.begin(), vals.end());
+        },
+        [&](std::mt19937 & gen, const Vi, const Vi, const bool){
+            return new value_tables::PottsValueTable(nl, dist(gen));
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(TestHmmwcBruteForce)
+{
+    using namespace inferno;
+    for(int seed=0; seed<4; ++seed){
+        // 6 variables, 2 classes without and 1 class with cuts
+        Model model(6, 8);
+        fillMultiwayCutGrid(model, 3, 2, 2, 1, seed);
+        const auto optimum = test::bruteForce(model);
+
+        std::vector<ValueType> energies;
+        for(const uint64_t nThreads : {1, 2}){
+            Hmmwc solver(model, Hmmwc::Options(nThreads));
+            solver.infer();
+
+            Model::VariableMap<DiscreteLabel> conf(model);
+            solver.conf(conf);
+            BOOST_CHECK_SMALL(model.eval(conf) - solver.energy(), TEST_EPS);
+            BOOST_CHECK_GE(solver.energy(), optimum - TEST_EPS);
+            // the lower bound must never be above the optimum
+            BOOST_CHECK_LE(solver.lowerBound(), optimum + TEST_EPS);
+            energies.push_back(solver.energy());
+        }
+        // the result does not depend on the number of threads
+        BOOST_CHECK_SMALL(energies[0] - energies[1], TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestHmmwcSemanticOnly)
+{
+    using namespace inferno;
+    // without repulsive factors there is nothing to cut,
+    // the binary splits of the semantic classes are exact
+    // for two classes.
+    for(int seed=0; seed<4; ++seed){
+        Model model(6, 2);
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<ValueType> dist(-1.0, 1.0);
+        for(Vi vi=0; vi<6; ++vi){
+            const ValueType vals[2] = {dist(gen), dist(gen)};
+            const auto vti = model.addValueTable(new value_tables::UnaryValueTable(vals, vals+2));
+            model.addFactor(vti, {vi});
+        }
+        for(Vi vi=0; vi+1<6; ++vi){
+            const auto vti = model.addValueTable(new value_tables::PottsValueTable(2, 0.5*(dist(gen)+1.0)));
+            model.addFactor(vti, {vi, Vi(vi+1)});
+        }
+        const auto optimum = test::bruteForce(model);
+        Hmmwc solver(model);
+        solver.infer();
+        BOOST_CHECK_SMALL(solver.energy() - optimum, TEST_EPS);
+        BOOST_CHECK_LE(solver.lowerBound(), optimum + TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestHmmwcRepeatedInfer)
+{
+    using namespace inferno;
+    // a second run must start from the connected components
+    // of the model and not from the previous segmentation
+    for(int seed=0; seed<4; ++seed){
+        Model model(6, 8);
+        fillMultiwayCutGrid(model, 3, 2, 2, 1, seed);
+        Hmmwc solver(model);
+        solver.infer();
+        const auto first = solver.energy();
+        solver.infer();
+        BOOST_CHECK_SMALL(solver.energy() - first, TEST_EPS);
+
+        Model::VariableMap<DiscreteLabel> conf(model);
+        solver.conf(conf);
+        BOOST_CHECK_SMALL(model.eval(conf) - solver.energy(), TEST_EPS);
+    }
+}
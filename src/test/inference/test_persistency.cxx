@@ -0,0 +1,123 @@
+#define BOOST_TEST_MODULE PersistencyTest
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+#include <memory>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/value_tables/unary.hxx"
+#include "inferno/value_tables/explicit.hxx"
+#include "inferno/inference/icm.hxx"
+#include "inferno/inference/persistency.hxx"
+#include "inferno_test/random_grid.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+
+// 3x3 grid with random unaries and random
+// (potts or explicit) second order factors
+void fillGrid(Model & model, const inferno::LabelType nl, const bool potts, const int seed){
+    using namespace inferno;
+    std::uniform_real_distribution<ValueType> dist(-1.0, 1.0);
+    std::vector<ValueType> vals(nl);
+    const size_t shape[2] = {size_t(nl), size_t(nl)};
+    test::fillGrid(model, 3, 3, seed,
+        [&](std::mt19937 & gen, const Vi){
+            for(auto & v : vals)
+                v = dist(gen);
+            return new value_tables::UnaryValueTable(vals.begin(), vals.end());
+        },
+        [&](std::mt19937 & gen, const Vi, const Vi, const bool) -> value_tables::DiscreteValueTableBase * {
+            if(potts)
+                return new value_tables::PottsValueTable(nl, 1.5*dist(gen));
+            ValueMarray vt(shape, shape+2);
+            for(auto & v : vt)
+                v = dist(gen);
+            return new value_tables::Explicit(vt);
+        }
+    );
+}
+
+// the optimum over all labelings which do not use excluded
+// labels must be equal to the global optimum
+void checkPersistency(const inferno::LabelType nl, const bool potts){
+    using namespace inferno;
+    for(int seed=0; seed<25; ++seed){
+        Model model(9, nl);
+        fillGrid(model, nl, potts, seed);
+        models::FactorsOfVariables<Model> facOfVars(model);
+        inference::Persistency<Model> persistency(model, facOfVars);
+        persistency.run();
+
+        ValueType opt = infVal();
+        ValueType optAllowed = infVal();
+        test::forEachLabeling(model, [&](const Model::VariableMap<DiscreteLabel> & conf){
+            const ValueType e = model.eval(conf);
+            opt = std::min(opt, e);
+            bool allowed = true;
+            for(const auto vi : model.variableDescriptors())
+                allowed = allowed && !persistency.isExcluded(vi, conf[vi]);
+            if(allowed)
+                optAllowed = std::min(optAllowed, e);
+        });
+        BOOST_CHECK_CLOSE(opt, optAllowed, TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestPersistencyBinary)
+{
+    checkPersistency(2, false);
+    checkPersistency(2, true);
+}
+
+BOOST_AUTO_TEST_CASE(TestPersistencyMultiLabel)
+{
+    checkPersistency(3, false);
+    checkPersistency(3, true);
+}
+
+BOOST_AUTO_TEST_CASE(TestPersistencyReduction)
+{
+    using namespace inferno;
+    Model model(9, 3);
+    fillGrid(model, 3, true, 0);
+
+    typedef inference::PersistencyReduction<Model> Solver;
+    typedef inference::Icm<Solver::SubModel> SubSolver;
+    typedef inference::DiscreteInferenceFactory<SubSolver> SubFactory;
+
+    Solver solver(model, Solver::Options(std::make_shared<SubFactory>()));
+    solver.infer();
+    Solver::Conf conf(model);
+    solver.conf(conf);
+    BOOST_CHECK_CLOSE(solver.energy(), model.eval(conf), TEST_EPS);
+    for(const auto vi : model.variableDescriptors()){
+        BOOST_CHECK(!solver.persistency().isExcluded(vi, conf[vi]));
+        BOOST_CHECK_EQUAL(solver.isPartialOptimal(vi), solver.persistency().isPartialOptimal(vi));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestPersistencyReductionRepeatedInfer)
+{
+    using namespace inferno;
+    Model model(9, 3);
+    fillGrid(model, 3, true, 1);
+
+    typedef inference::PersistencyReduction<Model> Solver;
+    typedef inference::Icm<Solver::SubModel> SubSolver;
+    typedef inference::DiscreteInferenceFactory<SubSolver> SubFactory;
+
+    Solver solver(model, Solver::Options(std::make_shared<SubFactory>()));
+    solver.infer();
+    const ValueType energy = solver.energy();
+    const ValueType lowerBound = solver.lowerBound();
+    const uint64_t nExcluded = solver.persistency().nExcludedLabels();
+
+    solver.infer();
+    BOOST_CHECK_EQUAL(solver.energy(), energy);
+    BOOST_CHECK_EQUAL(solver.lowerBound(), lowerBound);
+    BOOST_CHECK_EQUAL(solver.persistency().nExcludedLabels(), nExcluded);
+}
@@ -0,0 +1,80 @@
+#define BOOST_TEST_MODULE PortfolioTest
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <memory>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno_test/random_grid.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/inference/icm.hxx"
+#include "inferno/inference/alpha_expansion.hxx"
+#include "inferno/inference/portfolio.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::inference::Portfolio<Model> Portfolio;
+typedef inferno::inference::BaseDiscreteInferenceFactory<Model> Factory;
+
+// grid with random unaries and submodular potts factors
+void fillGrid(Model & model, const size_t size, const inferno::LabelType nl, const int seed){
+    inferno::test::fillPottsGrid(model, size, size, nl, seed, 0.0, 0.5);
+}
+
+std::vector<std::shared_ptr<Factory> > icmAndExpansion(){
+    using namespace inferno::inference;
+    std::vector<std::shared_ptr<Factory> > factories;
+    factories.push_back(std::make_shared<DiscreteInferenceFactory<Icm<Model> > >());
+    factories.push_back(std::make_shared<DiscreteInferenceFactory<AlphaExpansion<Model> > >());
+    return factories;
+}
+
+BOOST_AUTO_TEST_CASE(TestPortfolioBestSolver)
+{
+    using namespace inferno;
+    for(int seed=0; seed<5; ++seed){
+        Model model(100, 4);
+        fillGrid(model, 10, 4, seed);
+
+        inference::AlphaExpansion<Model> expansion(model);
+        expansion.infer();
+
+        Portfolio portfolio(model, Portfolio::Options(icmAndExpansion()));
+        portfolio.infer();
+
+        // the portfolio is at least as good as each of its solvers
+        BOOST_CHECK_LE(portfolio.energy(), expansion.energy() + TEST_EPS);
+        Model::VariableMap<DiscreteLabel> conf(model);
+        portfolio.conf(conf);
+        BOOST_CHECK_CLOSE(model.eval(conf), portfolio.energy(), TEST_EPS);
+        BOOST_CHECK_GE(portfolio.bestSolver(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestPortfolioStopping)
+{
+    using namespace inferno;
+    Model model(100, 4);
+    fillGrid(model, 10, 4, 42);
+    Model::VariableMap<DiscreteLabel> conf(model, 0);
+    const ValueType startEnergy = model.eval(conf);
+
+    // with a time limit of zero the solvers are stopped
+    // at their first visit, the portfolio still
+    // returns a consistent labeling
+    for(const bool restart : {false, true}){
+        Portfolio portfolio(model, Portfolio::Options(icmAndExpansion(), 0.0, 0.0, 0.0, restart));
+        portfolio.infer();
+        portfolio.conf(conf);
+        BOOST_CHECK_CLOSE(model.eval(conf), portfolio.energy(), TEST_EPS);
+        BOOST_CHECK_LE(portfolio.energy(), startEnergy + TEST_EPS);
+    }
+
+    // a large gap stops as soon as a bound and a labeling are known
+    Portfolio portfolio(model, Portfolio::Options(icmAndExpansion(),
+        std::numeric_limits<double>::infinity(), std::numeric_limits<ValueType>::infinity()));
+    portfolio.infer();
+    portfolio.conf(conf);
+    BOOST_CHECK_CLOSE(model.eval(conf), portfolio.energy(), TEST_EPS);
+}
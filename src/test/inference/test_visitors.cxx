@@ -0,0 +1,85 @@
+#define BOOST_TEST_MODULE VisitorsTest
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno_test/random_grid.hxx"
+#include "inferno/inference/icm.hxx"
+#include "inferno/inference/alpha_expansion.hxx"
+#include "inferno/inference/visitors.hxx"
+
+#define TEST_EPS 0.00001
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::inference::StoppingVisitor<Model> StoppingVisitor;
+
+// grid with random unaries and submodular potts factors
+void fillGrid(Model & model, const size_t size, const inferno::LabelType nl, const int seed){
+    inferno::test::fillPottsGrid(model, size, size, nl, seed, 0.0, 0.5);
+}
+
+BOOST_AUTO_TEST_CASE(TestStoppingVisitorIterations)
+{
+    using namespace inferno;
+    Model model(100, 4);
+    fillGrid(model, 10, 4, 0);
+
+    inference::Icm<Model> icm(model);
+    StoppingVisitor visitor(StoppingVisitor::Options(std::numeric_limits<double>::infinity(), 5));
+    icm.infer(&visitor.visitor());
+
+    BOOST_CHECK_EQUAL(visitor.iterations(), 5);
+    BOOST_CHECK(visitor.stopReason() == inference::IterationLimit);
+
+    // begin, all visits and end are recorded
+    BOOST_CHECK_EQUAL(visitor.times().size(), 7);
+    BOOST_CHECK_EQUAL(visitor.energies().size(), 7);
+    BOOST_CHECK_EQUAL(visitor.lowerBounds().size(), 7);
+    BOOST_CHECK_CLOSE(visitor.energies().back(), icm.energy(), TEST_EPS);
+    for(size_t i=1; i<visitor.times().size(); ++i){
+        BOOST_CHECK_GE(visitor.times()[i], visitor.times()[i-1]);
+        BOOST_CHECK_LE(visitor.energies()[i], visitor.energies()[i-1] + TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestStoppingVisitorCriteria)
+{
+    using namespace inferno;
+    Model model(100, 4);
+    fillGrid(model, 10, 4, 1);
+    const auto inf = std::numeric_limits<double>::infinity();
+
+    {
+        // a time limit of zero stops at the first visit
+        inference::Icm<Model> icm(model);
+        StoppingVisitor visitor(StoppingVisitor::Options(0.0));
+        icm.infer(&visitor.visitor());
+        BOOST_CHECK_EQUAL(visitor.iterations(), 1);
+        BOOST_CHECK(visitor.stopReason() == inference::TimeLimit);
+    }
+    {
+        // a huge minimal improvement stops after the first window
+        inference::Icm<Model> icm(model);
+        StoppingVisitor visitor(StoppingVisitor::Options(inf, 0, 3, 1000.0));
+        icm.infer(&visitor.visitor());
+        BOOST_CHECK_EQUAL(visitor.iterations(), 4);
+        BOOST_CHECK(visitor.stopReason() == inference::NoImprovement);
+    }
+    {
+        // infinite gap is closed at the first visit
+        inference::Icm<Model> icm(model);
+        StoppingVisitor visitor(StoppingVisitor::Options(inf, 0, 0, 0.0, inf));
+        icm.infer(&visitor.visitor());
+        BOOST_CHECK_EQUAL(visitor.iterations(), 1);
+        BOOST_CHECK(visitor.stopReason() == inference::GapClosed);
+    }
+    {
+        // without a budget the solver runs to convergence
+        inference::AlphaExpansion<Model> expansion(model);
+        StoppingVisitor visitor(StoppingVisitor::Options(), NULL);
+        expansion.infer(&visitor.visitor());
+        BOOST_CHECK(visitor.stopReason() == inference::NotStopped);
+        BOOST_CHECK_CLOSE(visitor.energies().back(), expansion.energy(), TEST_EPS);
+    }
+}
@@ -0,0 +1,152 @@
+#define BOOST_TEST_MODULE MaxFlowTest
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "inferno/inference/utilities/maxflow.hxx"
+
+#define TEST_EPS 0.00001
+
+namespace{
+
+    typedef inferno::inference::MaxFlow<double> Graph;
+
+    struct Edge{
+        int i;
+        int j;
+        double cap;
+        double revCap;
+    };
+
+    double cutValue(
+        const std::vector<double> & net,
+        const std::vector<Edge> & edges,
+        const unsigned int sinkMask
+    ){
+        double value = 0.0;
+        for(size_t i=0; i<net.size(); ++i){
+            const bool isSink = (sinkMask >> i) & 1u;
+            if(isSink && net[i] > 0)
+                value += net[i];
+            if(!isSink && net[i] < 0)
+                value -= net[i];
+        }
+        for(const auto & e : edges){
+            const bool si = (sinkMask >> e.i) & 1u;
+            const bool sj = (sinkMask >> e.j) & 1u;
+            if(!si && sj)
+                value += e.cap;
+            if(si && !sj)
+                value += e.revCap;
+        }
+        return value;
+    }
+
+    double bruteForceMinCut(const std::vector<double> & net, const std::vector<Edge> & edges){
+        double best = std::numeric_limits<double>::infinity();
+        for(unsigned int mask=0; mask < (1u<<net.size()); ++mask)
+            best = std::min(best, cutValue(net, edges, mask));
+        return best;
+    }
+
+    double graphCutValue(
+        const Graph & graph,
+        const std::vector<double> & net,
+        const std::vector<Edge> & edges
+    ){
+        unsigned int mask = 0;
+        for(size_t i=0; i<net.size(); ++i)
+            if(graph.segment(i) == Graph::Sink)
+                mask |= 1u<<i;
+        return cutValue(net, edges, mask);
+    }
+}
+
+
+
+BOOST_AUTO_TEST_CASE(TestMaxFlowBruteForce)
+{
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> netDist(-3.0, 3.0);
+    std::uniform_real_distribution<double> capDist(0.0, 3.0);
+
+    for(size_t trial=0; trial<500; ++trial){
+        const int nNodes = 2 + gen()%9;
+        std::vector<double> net(nNodes);
+        std::vector<Edge> edges;
+        for(auto & n : net)
+            n = netDist(gen);
+        for(int e=0; e<2*nNodes; ++e){
+            const int i = gen()%nNodes;
+            const int j = gen()%nNodes;
+            if(i!=j)
+                edges.push_back(Edge{i, j, capDist(gen), capDist(gen)});
+        }
+
+        Graph graph(nNodes, edges.size());
+        graph.addNodes(nNodes);
+        for(int i=0; i<nNodes; ++i)
+            graph.addTWeights(i, std::max(net[i], 0.0), std::max(-net[i], 0.0));
+        for(const auto & e : edges)
+            graph.addEdge(e.i, e.j, e.cap, e.revCap);
+
+        const double flow = graph.maxflow();
+        const double optimal = bruteForceMinCut(net, edges);
+        BOOST_CHECK_SMALL(flow - optimal, TEST_EPS);
+        BOOST_CHECK_SMALL(graphCutValue(graph, net, edges) - optimal, TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestMaxFlowReuseTrees)
+{
+    std::mt19937 gen(43);
+    std::uniform_real_distribution<double> netDist(-3.0, 3.0);
+    std::uniform_real_distribution<double> capDist(0.0, 3.0);
+
+    for(size_t trial=0; trial<200; ++trial){
+        const int nNodes = 2 + gen()%9;
+        std::vector<double> net(nNodes);
+        std::vector<Edge> edges;
+        for(auto & n : net)
+            n = netDist(gen);
+        for(int e=0; e<2*nNodes; ++e){
+            const int i = gen()%nNodes;
+            const int j = gen()%nNodes;
+            if(i!=j)
+                edges.push_back(Edge{i, j, capDist(gen), capDist(gen)});
+        }
+
+        Graph graph(nNodes, edges.size());
+        graph.addNodes(nNodes);
+        for(int i=0; i<nNodes; ++i)
+            graph.setTWeights(i, std::max(net[i], 0.0), std::max(-net[i], 0.0));
+        std::vector<Graph::ArcIndex> edgeIds;
+        for(const auto & e : edges)
+            edgeIds.push_back(graph.addEdge(e.i, e.j, e.cap, e.revCap));
+        graph.resetFlow();
+
+        for(size_t round=0; round<5; ++round){
+            graph.maxflow(round > 0);
+            BOOST_CHECK_SMALL(graphCutValue(graph, net, edges) - 
+                              bruteForceMinCut(net, edges), TEST_EPS);
+
+            // change some capacities of the solved graph
+            for(int i=0; i<nNodes; ++i){
+                if(gen()%2){
+                    net[i] = netDist(gen);
+                    graph.setTWeights(i, std::max(net[i], 0.0), std::max(-net[i], 0.0));
+                }
+            }
+            for(size_t e=0; e<edges.size(); ++e){
+                if(gen()%2){
+                    edges[e].cap = capDist(gen);
+                    edges[e].revCap = capDist(gen);
+                    graph.setEdgeCapacities(edgeIds[e], edges[e].cap, edges[e].revCap);
+                }
+            }
+        }
+    }
+}
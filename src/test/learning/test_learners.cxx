@@ -0,0 +1,443 @@
+#define BOOST_TEST_MODULE LearnersTest
+#include <boost/test/unit_test.hpp>
+#include "inferno_test/test.hxx"
+#include "inferno_test/random_grid.hxx"
+
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <limits>
+
+#include <vigra/multi_array.hxx>
+
+#include "inferno/model/parametrized_multicut_model.hxx"
+#include "inferno/inference/cgc.hxx"
+#include "inferno/inference/base_discrete_inference_factory.hxx"
+#include "inferno/learning/learners/perturbation_evaluator.hxx"
+#include "inferno/learning/loss_functions/partition_hamming.hxx"
+#include "inferno/learning/dataset/default_dataset.hxx"
+#include "inferno/learning/learners/subgradient.hxx"
+#include "inferno/learning/learners/bundle_method.hxx"
+
+typedef vigra::MultiArray<1, vigra::TinyVector<uint64_t, 2> > EdgeArray;
+typedef vigra::MultiArray<2, double> FeatureArray;
+typedef inferno::models::ParametrizedMulticutModel<EdgeArray, FeatureArray> Model;
+typedef Model::VariableMap<inferno::DiscreteLabel> Conf;
+typedef inferno::inference::Cgc<Model> Solver;
+typedef inferno::inference::DiscreteInferenceFactory<Solver> SolverFactory;
+typedef inferno::learning::loss_functions::PartitionHamming<Model> PartitionHamming;
+typedef PartitionHamming::LossAugmentedModel LossAugmentedModel;
+typedef LossAugmentedModel::VariableMap<inferno::DiscreteLabel> LossAugmentedConf;
+typedef inferno::learning::dataset::DefaultDataset<
+    std::vector<PartitionHamming *>, std::vector<Model>, std::vector<Conf>
+> Dataset;
+typedef inferno::inference::Cgc<LossAugmentedModel> LossAugmentedSolver;
+
+// exact multicut solver enumerating all partitions (see inferno::test::
+// forEachPartition), the start labeling is only replaced by a better one
+template<class MODEL>
+class BruteForceMulticut : public inferno::inference::DiscreteInferenceBase<MODEL>{
+public:
+    typedef MODEL Model;
+    typedef inferno::inference::DiscreteInferenceBase<Model> BaseInf;
+    typedef typename BaseInf::Visitor Visitor;
+    typedef typename Model:: template VariableMap<inferno::DiscreteLabel> Conf;
+    struct Options{
+    };
+
+    BruteForceMulticut(const Model & model, const Options & = Options())
+    :   BaseInf(),
+        model_(model),
+        best_(model, 0),
+        hasStart_(false){
+    }
+    virtual std::string name()const{
+        return "BruteForceMulticut";
+    }
+    virtual void infer(Visitor * = NULL){
+        using namespace inferno;
+        ValueType bestValue = hasStart_ ? model_.eval(best_) : std::numeric_limits<ValueType>::infinity();
+        test::forEachPartition(model_, [&](const Conf & conf){
+            const auto value = model_.eval(conf);
+            if(value < bestValue){
+                bestValue = value;
+                for(const auto var : model_.variableDescriptors())
+                    best_[var] = conf[var];
+            }
+        });
+    }
+    virtual void conf(Conf & conf){
+        for(const auto var : model_.variableDescriptors())
+            conf[var] = best_[var];
+    }
+    virtual inferno::DiscreteLabel label(const inferno::Vi vi){
+        return best_[vi];
+    }
+    virtual const Model & model()const{
+        return model_;
+    }
+    virtual void stopInference(){
+    }
+    virtual void setConf(const Conf & conf){
+        for(const auto var : model_.variableDescriptors())
+            best_[var] = conf[var];
+        hasStart_ = true;
+    }
+    virtual void energyChange(){
+    }
+    virtual inferno::ValueType energy(){
+        return model_.eval(best_);
+    }
+private:
+    const Model & model_;
+    Conf best_;
+    bool hasStart_;
+};
+
+// grid edges with random features, the first feature is a bias
+Model makeGridModel(const size_t sizeX, const size_t sizeY, const size_t nFeatures,
+                    const inferno::learning::WeightVector & weights, const int seed){
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<std::pair<uint64_t, uint64_t> > uv;
+    inferno::test::forEachGridEdge(sizeX, sizeY, [&](const inferno::Vi u, const inferno::Vi v, const bool){
+        uv.push_back(std::make_pair(u, v));
+    });
+    EdgeArray edges(EdgeArray::difference_type(uv.size()));
+    FeatureArray features(FeatureArray::difference_type(uv.size(), nFeatures));
+    for(size_t e=0; e<uv.size(); ++e){
+        edges[e] = vigra::TinyVector<uint64_t, 2>(uv[e].first, uv[e].second);
+        features(e, 0) = 1.0;
+        for(size_t f=1; f<nFeatures; ++f)
+            features(e, f) = dist(gen);
+    }
+    return Model(sizeX*sizeY, edges, features, weights);
+}
+
+// number of edges where the labelings disagree on being cut
+struct CutDisagreement{
+    template<class MODEL>
+    inferno::LossType eval(const MODEL & model, const Conf & gt, const Conf & conf)const{
+        inferno::LossType loss = 0;
+        for(const auto factor : model.factors()){
+            const auto u = factor->variable(0);
+            const auto v = factor->variable(1);
+            if((gt[u] == gt[v]) != (conf[u] == conf[v]))
+                loss += 1;
+        }
+        return loss;
+    }
+};
+
+
+BOOST_AUTO_TEST_CASE(TestPerturbationEvaluatorThreads)
+{
+    using namespace inferno;
+    typedef learning::learners::PerturbationEvaluator<Model> Evaluator;
+    typedef learning::weights::PerturbationMatrix PerturbationMatrix;
+
+    const size_t nFeatures = 4;
+    const size_t nPerturbations = 12;
+    const size_t nInstances = 2;
+    learning::WeightVector weights(nFeatures);
+    weights[0] = -0.2;
+    for(size_t f=1; f<nFeatures; ++f)
+        weights[f] = 0.5;
+
+    std::vector<Model> models;
+    std::vector<Conf> gts;
+    for(size_t i=0; i<nInstances; ++i){
+        models.push_back(makeGridModel(4, 3, nFeatures, weights, int(i)));
+        gts.push_back(Conf(models.back()));
+        for(const auto var : models.back().variableDescriptors())
+            gts.back()[var] = var % 4 < 2 ? 0 : 1;
+    }
+    const CutDisagreement loss;
+    SolverFactory factory;
+
+    PerturbationMatrix perturbationMatrix(nPerturbations, nFeatures, 7);
+    Evaluator sequential(1);
+    Evaluator parallel(4);
+    BOOST_CHECK_EQUAL(parallel.nThreads(), 4);
+    // warm started, independent of the number of threads
+    Evaluator warm2(2, true);
+    Evaluator warm4(4, true);
+    std::vector<LossType> losses1, losses4, warmLosses2, warmLosses4;
+
+    // several rounds, the replicas of the parallel
+    // evaluator are reused after the first round
+    for(uint64_t step=0; step<3; ++step){
+        perturbationMatrix.perturb(weights, 1.0, step);
+        for(size_t i=0; i<nInstances; ++i){
+            sequential.evaluate(models[i], loss, gts[i], &factory, perturbationMatrix, losses1, i);
+            parallel.evaluate(models[i], loss, gts[i], &factory, perturbationMatrix, losses4, i);
+            warm2.evaluate(models[i], loss, gts[i], &factory, perturbationMatrix, warmLosses2, i);
+            warm4.evaluate(models[i], loss, gts[i], &factory, perturbationMatrix, warmLosses4, i);
+            BOOST_REQUIRE_EQUAL(losses1.size(), nPerturbations);
+            BOOST_REQUIRE_EQUAL(losses4.size(), nPerturbations);
+            BOOST_REQUIRE_EQUAL(warmLosses2.size(), nPerturbations);
+            BOOST_REQUIRE_EQUAL(warmLosses4.size(), nPerturbations);
+            for(size_t p=0; p<nPerturbations; ++p){
+                BOOST_CHECK_SMALL(losses1[p] - losses4[p], TEST_EPS);
+                BOOST_CHECK_SMALL(warmLosses2[p] - warmLosses4[p], TEST_EPS);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestUpdateLossAugmentedModel)
+{
+    using namespace inferno;
+    const size_t nFeatures = 3;
+    learning::WeightVector weights(nFeatures);
+    weights[0] = -0.2;
+    weights[1] = 0.5;
+    weights[2] = 0.3;
+    Model model = makeGridModel(4, 3, nFeatures, weights, 0);
+    Conf gt(model);
+    for(const auto var : model.variableDescriptors())
+        gt[var] = var % 4 < 2 ? 0 : 1;
+    const PartitionHamming loss(model, 1.0, 1.0, 2.0, false, 0);
+
+    LossAugmentedModel cached;
+    loss.makeLossAugmentedModel(model, gt, cached);
+
+    // change the weights, refresh the cached loss augmented
+    // model and make a new one from scratch
+    learning::WeightVector newWeights(nFeatures);
+    newWeights[0] = 0.4;
+    newWeights[1] = -0.1;
+    newWeights[2] = 0.7;
+    model.updateWeights(newWeights);
+    loss.updateLossAugmentedModel(model, gt, cached);
+    LossAugmentedModel fresh;
+    loss.makeLossAugmentedModel(model, gt, fresh);
+
+    // both must give the same energies for random labelings,
+    // up to a constant the energies are model energy minus loss
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<DiscreteLabel> dist(0, model.nVariables()-1);
+    Conf conf(model);
+    LossAugmentedConf cachedConf(cached);
+    LossAugmentedConf freshConf(fresh);
+    ValueType offset = 0;
+    for(size_t i=0; i<20; ++i){
+        auto cachedVar = cached.variableDescriptorsBegin();
+        auto freshVar = fresh.variableDescriptorsBegin();
+        for(const auto var : model.variableDescriptors()){
+            conf[var] = dist(gen);
+            cachedConf[*cachedVar] = conf[var];
+            freshConf[*freshVar] = conf[var];
+            ++cachedVar;
+            ++freshVar;
+        }
+        const auto energy = cached.eval(cachedConf);
+        const auto expected = model.eval(conf) - loss.eval(model, gt, conf);
+        BOOST_CHECK_SMALL(energy - fresh.eval(freshConf), TEST_EPS);
+        if(i == 0)
+            offset = energy - expected;
+        BOOST_CHECK_SMALL(energy - expected - offset, TEST_EPS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestSubGradientBatchSizeOne)
+{
+    using namespace inferno;
+    typedef learning::learners::SubGradient<Dataset> Learner;
+
+    const size_t nFeatures = 3;
+    const size_t nInstances = 3;
+    const uint64_t nIterations = 4;
+    const double n = 1.0;
+    const double m = 0.5;
+    learning::WeightVector startWeights(nFeatures);
+    startWeights[0] = -0.2;
+    startWeights[1] = 0.5;
+    startWeights[2] = 0.3;
+
+    // two identical copies of the training set, the
+    // models keep a pointer to the weights they were updated with
+    std::vector<Model> models, referenceModels;
+    std::vector<Conf> gts;
+    for(size_t i=0; i<nInstances; ++i){
+        models.push_back(makeGridModel(3, 3, nFeatures, startWeights, int(i)));
+        referenceModels.push_back(makeGridModel(3, 3, nFeatures, startWeights, int(i)));
+        gts.push_back(Conf(models.back()));
+        for(const auto var : models.back().variableDescriptors())
+            gts.back()[var] = var % 3 < 1 ? 0 : 1;
+    }
+    std::vector<PartitionHamming> losses;
+    for(size_t i=0; i<nInstances; ++i)
+        losses.push_back(PartitionHamming(models[i], 1.0, 1.0, 1.0, false, 0));
+    std::vector<PartitionHamming *> lossPtrs;
+    for(auto & loss : losses)
+        lossPtrs.push_back(&loss);
+    const learning::WeightConstraints weightConstraints(nFeatures);
+    const learning::Regularizer regularizer;
+    Dataset dataset(models, lossPtrs, gts, weightConstraints, regularizer);
+
+    // mini-batches of a single training instance
+    learning::WeightVector weights = startWeights;
+    Learner learner(dataset, Learner::Options(nIterations, n, 0.0, m, 0, 1, -1, 0, 0, 1, false, false));
+    inference::DiscreteInferenceFactory<LossAugmentedSolver> factory;
+    learning::learners::LearningRecorder recorder;
+    std::srand(42);
+    learner.learn(&factory, weights, nullptr, &recorder);
+
+    // sequential update: a step with momentum after each
+    // training instance, in the same random order,
+    // the step size only decays per iteration
+    learning::WeightVector referenceWeights = startWeights;
+    learning::WeightVector oldGradient(nFeatures);
+    utilities::IndexVector< > indices(nInstances);
+    uint64_t step = 0;
+    std::srand(42);
+    for(uint64_t iter=0; iter<nIterations; ++iter){
+        indices.randomShuffle();
+        for(const auto i : indices){
+            auto & model = referenceModels[i];
+            LossAugmentedModel lossAugmentedModel;
+            losses[i].makeLossAugmentedModel(model, gts[i], lossAugmentedModel);
+            LossAugmentedSolver solver(lossAugmentedModel);
+            solver.infer();
+            LossAugmentedConf lossAugmentedConf(lossAugmentedModel);
+            solver.conf(lossAugmentedConf);
+            Conf conf(model);
+            auto lVar = lossAugmentedModel.variableDescriptorsBegin();
+            for(const auto var : model.variableDescriptors()){
+                conf[var] = lossAugmentedConf[*lVar];
+                ++lVar;
+            }
+            learning::WeightVector featureDiff(nFeatures);
+            model.accumulateJointFeaturesDifference(featureDiff, gts[i], conf);
+
+            const double stepSize = n/double(iter+1);
+            for(size_t wi=0; wi<nFeatures; ++wi){
+                auto g = stepSize*(referenceWeights[wi] + regularizer.c()*featureDiff[wi]);
+                if(step > 0)
+                    g += m*oldGradient[wi];
+                oldGradient[wi] = g;
+                referenceWeights[wi] -= g;
+            }
+            ++step;
+            for(auto & referenceModel : referenceModels)
+                referenceModel.updateWeights(referenceWeights);
+        }
+    }
+
+    BOOST_CHECK_EQUAL(recorder.records().size(), nIterations);
+    for(size_t wi=0; wi<nFeatures; ++wi)
+        BOOST_CHECK_SMALL(weights[wi] - referenceWeights[wi], TEST_EPS);
+}
+
+BOOST_AUTO_TEST_CASE(TestSubGradientWarmStart)
+{
+    using namespace inferno;
+    typedef learning::learners::SubGradient<Dataset> Learner;
+    typedef inference::DiscreteInferenceFactory<BruteForceMulticut<LossAugmentedModel> > ExactFactory;
+
+    const size_t nFeatures = 3;
+    const size_t nInstances = 2;
+    learning::WeightVector startWeights(nFeatures);
+    startWeights[0] = -0.2;
+    startWeights[1] = 0.5;
+    startWeights[2] = 0.3;
+
+    std::vector<learning::WeightVector> learnedWeights;
+    for(const bool warmStart : {false, true}){
+        std::vector<Model> models;
+        std::vector<Conf> gts;
+        for(size_t i=0; i<nInstances; ++i){
+            models.push_back(makeGridModel(3, 2, nFeatures, startWeights, int(i)));
+            gts.push_back(Conf(models.back()));
+            for(const auto var : models.back().variableDescriptors())
+                gts.back()[var] = var % 3 < 1 ? 0 : 1;
+        }
+        std::vector<PartitionHamming> losses;
+        for(size_t i=0; i<nInstances; ++i)
+            losses.push_back(PartitionHamming(models[i], 1.0, 1.0, 1.0, false, 0));
+        std::vector<PartitionHamming *> lossPtrs;
+        for(auto & loss : losses)
+            lossPtrs.push_back(&loss);
+        const learning::WeightConstraints weightConstraints(nFeatures);
+        Dataset dataset(models, lossPtrs, gts, weightConstraints, learning::Regularizer());
+
+        learning::WeightVector weights = startWeights;
+        Learner learner(dataset, Learner::Options(5, 1.0, 0.0, 0.5, 0, 1, -1, 0, 0, 0, false, warmStart));
+        ExactFactory factory;
+        learning::learners::LearningRecorder recorder;
+        learner.learn(&factory, weights, nullptr, &recorder);
+        BOOST_CHECK_EQUAL(recorder.records().size(), 5);
+        learnedWeights.push_back(weights);
+    }
+    // with an exact solver the warm start must not change the result
+    for(size_t wi=0; wi<nFeatures; ++wi)
+        BOOST_CHECK_SMALL(learnedWeights[0][wi] - learnedWeights[1][wi], TEST_EPS);
+}
+
+BOOST_AUTO_TEST_CASE(TestBundleMethodLearn)
+{
+    using namespace inferno;
+    typedef learning::learners::BundleMethod<Dataset> Learner;
+    typedef inference::DiscreteInferenceFactory<BruteForceMulticut<Model> > ExactFactory;
+    typedef inference::DiscreteInferenceFactory<BruteForceMulticut<LossAugmentedModel> > ExactLossAugmentedFactory;
+
+    const size_t nFeatures = 3;
+    const size_t nInstances = 4;
+    learning::WeightVector trueWeights(nFeatures);
+    trueWeights[0] = -0.2;
+    trueWeights[1] = 0.8;
+    trueWeights[2] = -0.5;
+
+    // separable training set: the ground truths
+    // are the argmins for the true weights
+    ExactFactory factory;
+    std::vector<Model> models;
+    std::vector<Conf> gts;
+    for(size_t i=0; i<nInstances; ++i){
+        models.push_back(makeGridModel(3, 2, nFeatures, trueWeights, int(i)));
+        gts.push_back(Conf(models.back()));
+        auto solver = factory.create(models.back());
+        solver->infer();
+        solver->conf(gts.back());
+    }
+    std::vector<PartitionHamming> losses;
+    for(size_t i=0; i<nInstances; ++i)
+        losses.push_back(PartitionHamming(models[i], 1.0, 1.0, 1.0, false, 0));
+    std::vector<PartitionHamming *> lossPtrs;
+    for(auto & loss : losses)
+        lossPtrs.push_back(&loss);
+    const learning::WeightConstraints weightConstraints(nFeatures);
+    const learning::Regularizer regularizer(learning::RegularizerType::L2, 100.0);
+    Dataset dataset(models, lossPtrs, gts, weightConstraints, regularizer);
+
+    // start from the wrong signs
+    learning::WeightVector weights(nFeatures);
+    for(size_t wi=0; wi<nFeatures; ++wi)
+        weights[wi] = -1.0*trueWeights[wi];
+    dataset.updateWeights(weights);
+    const auto startLoss = dataset.totalLoss(&factory);
+    BOOST_REQUIRE_GT(startLoss, 0.0);
+
+    const uint64_t maxIterations = 200;
+    Learner learner(dataset, Learner::Options(maxIterations, 1.0e-4, 1, false, 50, 1.0e-10, 100000, 1));
+    ExactLossAugmentedFactory lossAugmentedFactory;
+    learning::learners::LearningRecorder recorder;
+    learner.learn(&lossAugmentedFactory, weights, &factory, &recorder);
+
+    // converged before the last iteration: the best objective is
+    // non increasing, the gap is closed and the weights do not change
+    const auto & records = recorder.records();
+    BOOST_REQUIRE_GT(records.size(), 1);
+    BOOST_CHECK_LT(records.size(), maxIterations);
+    for(size_t r=1; r<records.size(); ++r)
+        BOOST_CHECK_LE(records[r].objective, records[r-1].objective);
+    const auto & last = records.back();
+    BOOST_CHECK_LE(last.objective - last.lowerBound, 1.0e-4*std::abs(last.objective) + TEST_EPS);
+    BOOST_CHECK_LE(last.weightChange, 1.0e-6);
+    BOOST_CHECK_LE(last.loss, records.front().loss);
+
+    // the learned weights reproduce the training set
+    dataset.updateWeights(weights);
+    BOOST_CHECK_SMALL(dataset.totalLoss(&factory), TEST_EPS);
+}
@@ -10,6 +10,9 @@
 #include "inferno/model/general_discrete_model.hxx"
 #include "inferno/value_tables/potts.hxx"
 #include "inferno/value_tables/unary.hxx"
+#include "inferno/learning/learners/bundle_method.hxx"
+#include "inferno/learning/weights/perturbation_matrix.hxx"
+#include "inferno/learning/weight_constraints.hxx"
 
 
 
@@ -25,6 +28,140 @@ BOOST_AUTO_TEST_CASE(TestLearning_1)
 }
 
 
+BOOST_AUTO_TEST_CASE(TestCuttingPlaneDualSolver)
+{
+    using namespace inferno;
+    typedef learning::learners::CuttingPlaneDualSolver Solver;
+
+    std::mt19937 gen(3);
+    std::normal_distribution<double> normalDist(0.0, 1.0);
+    const size_t nWeights = 7;
+    const size_t nPlanes = 15;
+    const double c = 2.5;
 
+    for(const bool bounded : {false, true}){
+        Solver solver(nWeights);
+        if(bounded){
+            solver.setBound(0, -0.1, 0.1);
+            solver.setBound(3,  0.2, 0.2);
+            solver.setBound(5,  0.0, 10.0);
+        }
+        std::vector<learning::WeightVector> planes;
+        std::vector<double> offsets;
+        for(size_t p=0; p<nPlanes; ++p){
+            learning::WeightVector a(nWeights);
+            for(size_t wi=0; wi<nWeights; ++wi)
+                a[wi] = normalDist(gen);
+            planes.push_back(a);
+            offsets.push_back(normalDist(gen));
+            solver.addPlane(a, offsets.back());
 
+            // at the optimum the dual value equals the primal value
+            const auto dualValue = solver.solve(c, 1.0e-12);
+            const auto & w = solver.weights();
+            double maxPlane = -1.0*std::numeric_limits<double>::infinity();
+            double regularizer = 0;
+            for(size_t pp=0; pp<planes.size(); ++pp){
+                double v = offsets[pp];
+                for(size_t wi=0; wi<nWeights; ++wi)
+                    v += planes[pp][wi]*w[wi];
+                maxPlane = std::max(maxPlane, v);
+            }
+            for(size_t wi=0; wi<nWeights; ++wi)
+                regularizer += 0.5*w[wi]*w[wi];
+            BOOST_CHECK_SMALL(regularizer + c*maxPlane - dualValue, 1.0e-8);
 
+            if(bounded){
+                BOOST_CHECK_LE(std::abs(w[0]), 0.1);
+                BOOST_CHECK_CLOSE(w[3], 0.2, TEST_EPS);
+                BOOST_CHECK_GE(w[5], 0.0);
+            }
+
+            double alphaSum = 0;
+            for(const auto a : solver.alpha()){
+                BOOST_CHECK_GE(a, 0.0);
+                alphaSum += a;
+            }
+            BOOST_CHECK_SMALL(alphaSum - 1.0, 1.0e-10);
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(TestPerturbationMatrix)
+{
+    using namespace inferno;
+    typedef learning::weights::PerturbationMatrix PerturbationMatrix;
+
+    const size_t nPerturbations = 200;
+    const size_t nWeights = 11;
+    const double sigma = 0.5;
+
+    learning::WeightVector source(nWeights);
+    for(size_t wi=0; wi<nWeights; ++wi)
+        source[wi] = double(wi) - 5.0;
+    learning::WeightConstraints weightConstraints(nWeights);
+    weightConstraints.addBound(2, -3.2, -2.8);
+    weightConstraints.addBound(7,  2.0,  2.0);
+
+    PerturbationMatrix a(nPerturbations, nWeights, 42);
+    PerturbationMatrix b(nPerturbations, nWeights, 42);
+    a.setBounds(weightConstraints);
+    b.setBounds(weightConstraints);
+
+    // the rows only depend on seed, key and row index
+    a.perturb(source, sigma, 3);
+    for(size_t p=nPerturbations; p>0; --p)
+        b.perturbRow(source, sigma, 3, p-1);
+    for(size_t p=0; p<nPerturbations; ++p){
+        for(size_t wi=0; wi<nWeights; ++wi){
+            BOOST_CHECK_EQUAL(a.weights(p)[wi], b.weights(p)[wi]);
+            BOOST_CHECK_EQUAL(a.noise(p)[wi], b.noise(p)[wi]);
+            BOOST_CHECK_SMALL(a.weights(p)[wi] - source[wi] - a.noise(p)[wi], TEST_EPS);
+        }
+        BOOST_CHECK_GE(a.weights(p)[2], -3.2);
+        BOOST_CHECK_LE(a.weights(p)[2], -2.8);
+        BOOST_CHECK_EQUAL(a.weights(p)[7], 2.0);
+    }
+    b.perturb(source, sigma, 4);
+    BOOST_CHECK(a.weights(0)[0] != b.weights(0)[0]);
+
+    // moments of the unbounded noise
+    double mean = 0, var = 0;
+    const size_t n = nPerturbations*(nWeights - 2);
+    for(size_t p=0; p<nPerturbations; ++p)
+        for(size_t wi=0; wi<nWeights; ++wi)
+            if(wi != 2 && wi != 7)
+                mean += a.noise(p)[wi];
+    mean /= n;
+    for(size_t p=0; p<nPerturbations; ++p)
+        for(size_t wi=0; wi<nWeights; ++wi)
+            if(wi != 2 && wi != 7)
+                var += (a.noise(p)[wi] - mean)*(a.noise(p)[wi] - mean);
+    var /= n;
+    BOOST_CHECK_SMALL(mean, 0.05);
+    BOOST_CHECK_CLOSE(var, sigma*sigma, 10.0);
+
+    // weighted sums
+    std::vector<double> coefficients(nPerturbations);
+    for(size_t p=0; p<nPerturbations; ++p)
+        coefficients[p] = double(p % 7) - 3.0;
+    learning::WeightVector noiseSum(nWeights, 0.0), weightSum(nWeights, 0.0);
+    a.weightedNoiseSum(coefficients, noiseSum);
+    a.weightedSum(coefficients, weightSum);
+    for(size_t wi=0; wi<nWeights; ++wi){
+        double ns = 0, ws = 0;
+        for(size_t p=0; p<nPerturbations; ++p){
+            ns += coefficients[p]*a.noise(p)[wi];
+            ws += coefficients[p]*a.weights(p)[wi];
+        }
+        BOOST_CHECK_SMALL(noiseSum[wi] - ns, 1.0e-9);
+        BOOST_CHECK_SMALL(weightSum[wi] - ws, 1.0e-9);
+    }
+
+    learning::WeightVector row;
+    a.getWeights(5, row);
+    BOOST_REQUIRE_EQUAL(row.size(), nWeights);
+    for(size_t wi=0; wi<nWeights; ++wi)
+        BOOST_CHECK_EQUAL(row[wi], a.weights(5)[wi]);
+}
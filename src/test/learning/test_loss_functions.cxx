@@ -0,0 +1,217 @@
+#define BOOST_TEST_MODULE LossFunctionsTest
+#include <boost/test/unit_test.hpp>
+#include "inferno_test/test.hxx"
+
+#include <random>
+#include <map>
+#include <cmath>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/learning/loss_functions/contingency_table.hxx"
+#include "inferno/learning/loss_functions/variation_of_information.hxx"
+#include "inferno/learning/loss_functions/rand_index.hxx"
+#include "inferno/learning/loss_functions/partition_f_score.hxx"
+#include "inferno/learning/loss_functions/partition_hamming.hxx"
+#include "inferno/inference/loss_augmented_local_search.hxx"
+
+
+
+BOOST_AUTO_TEST_CASE(TestContingencyTable)
+{
+    using namespace inferno;
+    typedef models::GeneralDiscreteModel Model;
+    typedef Model::VariableMap<DiscreteLabel> Conf;
+    typedef Model::VariableMap<double> SizeMap;
+
+    const Vi nVar = 200;
+    Model model(nVar, nVar);
+    const auto vti = model.addValueTable(new value_tables::PottsValueTable(nVar, 1.0));
+    for(Vi vi=0; vi+1<nVar; ++vi)
+        model.addFactor(vti, {vi, vi+1});
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<DiscreteLabel> labelDist(0, 9);
+    std::uniform_real_distribution<double> sizeDist(0.5, 2.0);
+
+    Conf confGt(model), conf(model);
+    SizeMap sizes(model);
+    learning::loss_functions::ContingencyTable table;
+
+    for(size_t r=0; r<10; ++r){
+        for(const auto var : model.variableDescriptors()){
+            // sparse labels
+            confGt[var] = labelDist(gen)*1000;
+            conf[var]   = r==0 ? confGt[var] : labelDist(gen) + 7;
+            sizes[var]  = sizeDist(gen);
+        }
+
+        // naive reference
+        std::map<DiscreteLabel, double> nGt, nConf;
+        std::map<std::pair<DiscreteLabel, DiscreteLabel>, double> nJoint;
+        double total = 0;
+        for(const auto var : model.variableDescriptors()){
+            nGt[confGt[var]] += sizes[var];
+            nConf[conf[var]] += sizes[var];
+            nJoint[std::make_pair(confGt[var], conf[var])] += sizes[var];
+            total += sizes[var];
+        }
+        double hGt = 0, hConf = 0, I = 0;
+        for(const auto & kv : nGt)
+            hGt -= kv.second/total*std::log(kv.second/total);
+        for(const auto & kv : nConf)
+            hConf -= kv.second/total*std::log(kv.second/total);
+        for(const auto & kv : nJoint){
+            const auto p = kv.second/total;
+            I += p*std::log(p/(nGt[kv.first.first]/total * nConf[kv.first.second]/total));
+        }
+
+        table.fill(model, confGt, conf, sizes);
+        BOOST_CHECK_EQUAL(table.nGtClusters(), nGt.size());
+        BOOST_CHECK_EQUAL(table.nClusters(), nConf.size());
+        BOOST_CHECK_EQUAL(table.nIntersections(), nJoint.size());
+        BOOST_CHECK_CLOSE(table.total(), total, TEST_EPS);
+        BOOST_CHECK_SMALL(table.variationOfInformation() - (hGt + hConf - 2.0*I), TEST_EPS);
+        if(r==0)
+            BOOST_CHECK_CLOSE(table.randIndex(), 1.0, TEST_EPS);
+
+        // loss functions
+        learning::loss_functions::VariationOfInformation2<Model> vi(model, false, -1, sizes);
+        BOOST_CHECK_SMALL(vi.eval(model, confGt, conf) - (hGt + hConf - 2.0*I), TEST_EPS);
+        learning::loss_functions::RandIndex<Model> ri(model, false, -1, sizes);
+        BOOST_CHECK_SMALL(ri.eval(model, confGt, conf) - (1.0 - table.randIndex()), TEST_EPS);
+
+        // edge confusion
+        learning::loss_functions::EdgeConfusion c;
+        c.fill(model, confGt, conf, Model::FactorMap<double>(model, 1.0));
+        double tp=0, tn=0, fp=0, fn=0;
+        for(Vi vi=0; vi+1<nVar; ++vi){
+            const bool cutGt = confGt[vi] != confGt[vi+1];
+            const bool cut   = conf[vi] != conf[vi+1];
+            tp += cutGt && cut;
+            tn += !cutGt && !cut;
+            fp += !cutGt && cut;
+            fn += cutGt && !cut;
+        }
+        BOOST_CHECK_EQUAL(c.truePositive, tp);
+        BOOST_CHECK_EQUAL(c.trueNegative, tn);
+        BOOST_CHECK_EQUAL(c.falsePositive, fp);
+        BOOST_CHECK_EQUAL(c.falseNegative, fn);
+
+        learning::loss_functions::PartitionHamming<Model> ph(model, 1.0, 2.0, 3.0, false, -1);
+        BOOST_CHECK_CLOSE(ph.eval(model, confGt, conf), 3.0*fp + 2.0*fn, TEST_EPS);
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE(TestIncrementalLoss)
+{
+    using namespace inferno;
+    typedef models::GeneralDiscreteModel Model;
+    typedef Model::VariableMap<DiscreteLabel> Conf;
+    typedef Model::VariableMap<double> SizeMap;
+    typedef learning::loss_functions::NonDecomposableLossFunctionBase<Model> LossBase;
+
+    const Vi nVar = 100;
+    Model model(nVar, nVar);
+    const auto vti = model.addValueTable(new value_tables::PottsValueTable(nVar, 1.0));
+    for(Vi vi=0; vi+1<nVar; ++vi)
+        model.addFactor(vti, {vi, vi+1});
+    for(Vi vi=0; vi+10<nVar; vi+=3)
+        model.addFactor(vti, {vi, vi+10});
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<DiscreteLabel> labelDist(0, 5);
+    std::uniform_int_distribution<Vi> varDist(0, nVar-1);
+    std::uniform_real_distribution<double> sizeDist(0.5, 2.0);
+
+    Conf confGt(model), conf(model);
+    SizeMap sizes(model);
+    Model::FactorMap<double> factorWeights(model);
+    for(const auto var : model.variableDescriptors()){
+        confGt[var] = labelDist(gen);
+        conf[var] = labelDist(gen);
+        sizes[var] = sizeDist(gen);
+    }
+    for(const auto fac : model.factorDescriptors())
+        factorWeights[fac] = sizeDist(gen);
+
+    std::vector<std::unique_ptr<LossBase> > losses;
+    for(const bool useIgnoreLabel : {false, true}){
+        losses.emplace_back(new learning::loss_functions::VariationOfInformation2<Model>(
+            model, useIgnoreLabel, 0, sizes));
+        losses.emplace_back(new learning::loss_functions::RandIndex<Model>(
+            model, useIgnoreLabel, 0, sizes));
+        losses.emplace_back(new learning::loss_functions::PartitionFScore<Model>(
+            model, 0.5, useIgnoreLabel, 0, factorWeights));
+    }
+
+    for(const auto & loss : losses){
+        Conf c(model);
+        for(const auto var : model.variableDescriptors())
+            c[var] = conf[var];
+        auto incrementalLoss = loss->incrementalLoss(model, confGt);
+        incrementalLoss->reset(c);
+        BOOST_CHECK_SMALL(incrementalLoss->loss() - loss->eval(model, confGt, c), TEST_EPS);
+
+        for(size_t i=0; i<500; ++i){
+            const auto var = varDist(gen);
+            // labels 6.. open new clusters
+            const auto label = DiscreteLabel(varDist(gen) % 9);
+            const auto oldLabel = c[var];
+            c[var] = label;
+            const auto trueLoss = loss->eval(model, confGt, c);
+            c[var] = oldLabel;
+            BOOST_CHECK_SMALL(incrementalLoss->lossAfterMove(var, label) - trueLoss, TEST_EPS);
+            if(i % 2 == 0){
+                incrementalLoss->move(var, label);
+                c[var] = label;
+                BOOST_CHECK_SMALL(incrementalLoss->loss() - trueLoss, TEST_EPS);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestLossAugmentedLocalSearch)
+{
+    using namespace inferno;
+    typedef models::GeneralDiscreteModel Model;
+    typedef Model::VariableMap<DiscreteLabel> Conf;
+    typedef learning::loss_functions::NonDecomposableLossFunctionBase<Model> LossBase;
+    typedef LossBase::LossAugmentedModel LossAugmentedModel;
+    typedef inference::LossAugmentedLocalSearch<LossAugmentedModel> Solver;
+
+    const Vi nVar = 50;
+    Model model(nVar, nVar);
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> betaDist(-0.5, 1.0);
+    for(Vi vi=0; vi+1<nVar; ++vi){
+        const auto vti = model.addValueTable(new value_tables::PottsValueTable(nVar, betaDist(gen)));
+        model.addFactor(vti, {vi, vi+1});
+    }
+
+    Conf confGt(model);
+    for(const auto var : model.variableDescriptors())
+        confGt[var] = var / 10;
+
+    learning::loss_functions::VariationOfInformation2<Model> vi(model, false, -1);
+    LossAugmentedModel lossAugmentedModel;
+    vi.makeLossAugmentedModel(model, confGt, lossAugmentedModel);
+
+    Solver solver(lossAugmentedModel);
+    solver.infer();
+    LossAugmentedModel::VariableMap<DiscreteLabel> conf(lossAugmentedModel);
+    solver.conf(conf);
+
+    // the search starts at the ground truth and only improves
+    const auto gtValue = lossAugmentedModel.eval(confGt);
+    const auto value = lossAugmentedModel.eval(conf);
+    BOOST_CHECK_CLOSE(gtValue, model.eval(confGt), TEST_EPS);
+    BOOST_CHECK_SMALL(value - solver.energy(), TEST_EPS);
+    BOOST_CHECK_LT(value, gtValue);
+
+    // a warm started search from a local optimum does not move
+    solver.setConf(conf);
+    solver.infer();
+    BOOST_CHECK_SMALL(solver.energy() - value, TEST_EPS);
+}
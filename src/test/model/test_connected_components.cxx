@@ -0,0 +1,197 @@
+#define BOOST_TEST_MODULE ConnectedComponentsTest
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include <vector>
+#include <array>
+
+#include "inferno/model/general_discrete_model.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/model/algorithms/connected_components.hxx"
+#include "inferno_test/random_grid.hxx"
+
+typedef inferno::models::GeneralDiscreteModel Model;
+typedef inferno::models::ConnectedComponents<Model> ConnectedComponents;
+
+// 4-neighbourhood grid of potts factors
+void fillGrid(Model & model, const size_t sizeX, const size_t sizeY){
+    using namespace inferno;
+    const auto vti = model.addValueTable(new value_tables::PottsValueTable(model.nLabels(0), 1.0));
+    test::forEachGridEdge(sizeX, sizeY, [&](const Vi vi0, const Vi vi1, const bool){
+        model.addFactor(vti, {vi0, vi1});
+    });
+}
+
+// reference component ids (in the order of the first pixel) by flood fill
+std::vector<uint64_t> referenceComponents(
+    const std::vector<inferno::DiscreteLabel> & labels,
+    const size_t sizeX,
+    const size_t sizeY,
+    std::vector<uint64_t> & sizes
+){
+    const uint64_t unset = labels.size();
+    std::vector<uint64_t> comp(labels.size(), unset);
+    std::vector<uint64_t> stack;
+    sizes.clear();
+    for(uint64_t start=0; start<labels.size(); ++start){
+        if(comp[start] != unset)
+            continue;
+        const uint64_t id = sizes.size();
+        sizes.push_back(0);
+        comp[start] = id;
+        stack.push_back(start);
+        while(!stack.empty()){
+            const uint64_t i = stack.back();
+            stack.pop_back();
+            ++sizes[id];
+            const uint64_t x = i % sizeX;
+            const uint64_t y = i / sizeX;
+            uint64_t neighbours[4];
+            size_t nn = 0;
+            if(x > 0) neighbours[nn++] = i - 1;
+            if(x + 1 < sizeX) neighbours[nn++] = i + 1;
+            if(y > 0) neighbours[nn++] = i - sizeX;
+            if(y + 1 < sizeY) neighbours[nn++] = i + sizeX;
+            for(size_t n=0; n<nn; ++n){
+                const auto j = neighbours[n];
+                if(comp[j] == unset && labels[j] == labels[i]){
+                    comp[j] = id;
+                    stack.push_back(j);
+                }
+            }
+        }
+    }
+    return comp;
+}
+
+std::vector<inferno::DiscreteLabel> randomLabels(const size_t n, const inferno::DiscreteLabel nl, const int seed){
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<inferno::DiscreteLabel> dist(0, nl-1);
+    std::vector<inferno::DiscreteLabel> labels(n);
+    for(auto & l : labels)
+        l = dist(gen);
+    return labels;
+}
+
+BOOST_AUTO_TEST_CASE(TestConnectedComponents)
+{
+    using namespace inferno;
+    const size_t sizeX = 23;
+    const size_t sizeY = 17;
+    Model model(sizeX*sizeY, 3);
+    fillGrid(model, sizeX, sizeY);
+
+    for(int seed=0; seed<5; ++seed){
+        const auto labels = randomLabels(sizeX*sizeY, 3, seed);
+        std::vector<uint64_t> refSizes;
+        const auto ref = referenceComponents(labels, sizeX, sizeY, refSizes);
+
+        for(const uint64_t nThreads : {1, 2, 4}){
+            ConnectedComponents cc(model, ConnectedComponents::Options(true, nThreads, true));
+            Model::VariableMap<DiscreteLabel> conf(model);
+            for(const auto vi : model.variableDescriptors())
+                conf[vi] = labels[vi];
+            const Vi maxLabel = cc.run(conf);
+
+            BOOST_CHECK_EQUAL(maxLabel + 1, refSizes.size());
+            BOOST_CHECK_EQUAL(cc.nComponents(), refSizes.size());
+            for(const auto vi : model.variableDescriptors())
+                BOOST_CHECK_EQUAL(conf[vi], ref[vi]);
+            for(size_t c=0; c<refSizes.size(); ++c){
+                BOOST_CHECK_EQUAL(cc.sizes()[c], refSizes[c]);
+                BOOST_CHECK_EQUAL(ref[cc.anchors()[c]], c);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestConnectedComponentsNotDense)
+{
+    using namespace inferno;
+    const size_t sizeX = 11;
+    const size_t sizeY = 13;
+    Model model(sizeX*sizeY, 2);
+    fillGrid(model, sizeX, sizeY);
+    const auto labels = randomLabels(sizeX*sizeY, 2, 42);
+
+    for(const uint64_t nThreads : {1, 3}){
+        for(const bool deterministic : {true, false}){
+            ConnectedComponents cc(model, ConnectedComponents::Options(false, nThreads, deterministic));
+            Model::VariableMap<DiscreteLabel> conf(model);
+            for(const auto vi : model.variableDescriptors())
+                conf[vi] = labels[vi];
+            const Vi maxLabel = cc.run(conf);
+
+            // each variable is labeled with the smallest variable of its component
+            std::vector<uint64_t> refSizes;
+            const auto ref = referenceComponents(labels, sizeX, sizeY, refSizes);
+            Vi refMax = 0;
+            for(const auto vi : model.variableDescriptors()){
+                BOOST_CHECK_EQUAL(ref[conf[vi]], ref[vi]);
+                BOOST_CHECK_LE(conf[vi], vi);
+                refMax = std::max(refMax, Vi(conf[vi]));
+            }
+            BOOST_CHECK_EQUAL(maxLabel, refMax);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestGridConnectedComponents)
+{
+    using namespace inferno;
+    const size_t sizeX = 37;
+    const size_t sizeY = 29;
+    typedef models::GridConnectedComponents<2> GridCC;
+
+    for(int seed=0; seed<5; ++seed){
+        const auto labels = randomLabels(sizeX*sizeY, 2, seed);
+        std::vector<uint64_t> refSizes;
+        const auto ref = referenceComponents(labels, sizeX, sizeY, refSizes);
+
+        for(const uint64_t nThreads : {1, 4}){
+            for(const bool deterministic : {true, false}){
+                GridCC cc({{sizeX, sizeY}}, GridCC::Options(nThreads, deterministic));
+                std::vector<uint32_t> comp(labels.size());
+                const auto nComponents = cc.run(labels.data(), comp.data());
+                BOOST_CHECK_EQUAL(nComponents, refSizes.size());
+                BOOST_REQUIRE_EQUAL(cc.sizes().size(), refSizes.size());
+
+                if(deterministic){
+                    for(size_t i=0; i<labels.size(); ++i)
+                        BOOST_CHECK_EQUAL(comp[i], ref[i]);
+                }
+                // the same partition with consistent sizes and anchors
+                std::vector<int64_t> refToComp(refSizes.size(), -1);
+                for(size_t i=0; i<labels.size(); ++i){
+                    if(refToComp[ref[i]] < 0)
+                        refToComp[ref[i]] = comp[i];
+                    BOOST_CHECK_EQUAL(refToComp[ref[i]], comp[i]);
+                }
+                for(size_t c=0; c<refSizes.size(); ++c){
+                    BOOST_CHECK_EQUAL(cc.sizes()[refToComp[c]], refSizes[c]);
+                    BOOST_CHECK_EQUAL(comp[cc.anchors()[refToComp[c]]], refToComp[c]);
+                    BOOST_CHECK_EQUAL(ref[cc.anchors()[refToComp[c]]], c);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestGridConnectedComponents3d)
+{
+    using namespace inferno;
+    typedef models::GridConnectedComponents<3> GridCC;
+    const std::vector<DiscreteLabel> labels = {
+        0, 0,   1, 0,
+        1, 1,   1, 0
+    };
+    GridCC cc({{2, 2, 2}}, GridCC::Options(1));
+    std::vector<uint64_t> comp(labels.size());
+    BOOST_CHECK_EQUAL(cc.run(labels.data(), comp.data()), 2);
+    const std::vector<uint64_t> expected = {0, 0, 1, 0, 1, 1, 1, 0};
+    for(size_t i=0; i<labels.size(); ++i)
+        BOOST_CHECK_EQUAL(comp[i], expected[i]);
+    BOOST_CHECK_EQUAL(cc.sizes()[0], 4);
+    BOOST_CHECK_EQUAL(cc.sizes()[1], 4);
+    BOOST_CHECK_EQUAL(cc.anchors()[1], 2);
+}
@@ -226,4 +226,40 @@ BOOST_AUTO_TEST_CASE(TestGeneralDiscreteModel_2)
 
 
 
-}
\ No newline at end of file
+}
+BOOST_AUTO_TEST_CASE(TestGeneralDiscreteModelMinMarginals)
+{
+    using namespace inferno;
+
+    models::GeneralDiscreteModel model(4, 3);
+    auto potts = model.addValueTable(new value_tables::PottsValueTable(3, -2.0));
+    auto other = model.addValueTable(new value_tables::PottsValueTable(3, 1.5));
+    model.addFactor(potts, {0,1});
+    model.addFactor(potts, {1,2});
+    model.addFactor(other, {2,3});
+
+    // computed once and shared between factors of the same value table
+    const auto mm0 = model.factor(0)->minMarginals();
+    BOOST_CHECK(mm0 == model.factor(1)->minMarginals());
+    BOOST_CHECK(mm0 == model.minMarginals(potts));
+    BOOST_CHECK(mm0 != model.factor(2)->minMarginals());
+
+    BOOST_CHECK_EQUAL(mm0->arity(), 2);
+    BOOST_CHECK_CLOSE(mm0->minValue(), -2.0, TEST_EPS);
+    BOOST_CHECK_CLOSE(mm0->maxValue(), 0.0, TEST_EPS);
+    DiscreteLabel conf[2];
+    mm0->argmin(conf);
+    BOOST_CHECK(conf[0] != conf[1]);
+    for(size_t a=0; a<2; ++a)
+    for(DiscreteLabel l=0; l<3; ++l){
+        BOOST_CHECK_CLOSE(mm0->minMarginal(a, l), -2.0, TEST_EPS);
+        mm0->argminMarginal(a, l, conf);
+        BOOST_CHECK_EQUAL(conf[a], l);
+        BOOST_CHECK(conf[0] != conf[1]);
+    }
+
+    const auto mm2 = model.factor(2)->minMarginals();
+    BOOST_CHECK_CLOSE(mm2->minValue(), 0.0, TEST_EPS);
+    BOOST_CHECK_CLOSE(mm2->maxValue(), 1.5, TEST_EPS);
+    BOOST_CHECK_CLOSE(mm2->minMarginal(1, 2), 0.0, TEST_EPS);
+}
@@ -132,3 +132,72 @@ BOOST_AUTO_TEST_CASE(TestMulticutLearning_1)
 
 
 
+
+// the edges are split into blocks which are updated in
+// parallel if nEdges*nFeatures is large enough
+template<class FEATURE_TYPE>
+void checkUpdateWeights(const uint64_t nEdges, const inferno::ValueType eps){
+    using namespace inferno;
+    typedef vigra::MultiArray<2, FEATURE_TYPE> Features;
+    typedef vigra::MultiArrayView<2, FEATURE_TYPE> FeaturesView;
+    typedef typename Features::difference_type FeaturesShape;
+
+    const uint64_t nFeatures = 9;
+
+    auto edges = EdgeArray(EdgeArrayShape(nEdges));
+    auto features = Features(FeaturesShape(nEdges, nFeatures));
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for(uint64_t e=0; e<nEdges; ++e){
+        edges[e] = Edge(e%10, (e+1)%10);
+        for(uint64_t f=0; f<nFeatures; ++f)
+            features(e, f) = dist(gen);
+    }
+
+    auto weights = learning::WeightVector(nFeatures);
+    for(auto & w : weights)
+        w = dist(gen);
+
+    typedef models::ParametrizedMulticutModel<EdgeArrayView, FeaturesView> Model;
+    Model model(10, edges, features, weights);
+    model.setNumberOfThreads(2);
+
+    auto checkBetas = [&](){
+        for(uint64_t e=0; e<nEdges; ++e){
+            ValueType beta = 0;
+            for(uint64_t f=0; f<nFeatures; ++f)
+                beta += ValueType(features(e, f))*weights[f];
+            ValueType modelBeta;
+            BOOST_CHECK(model.factor(e)->isPotts(modelBeta));
+            BOOST_CHECK_SMALL(modelBeta - beta, eps);
+        }
+    };
+    checkBetas();
+
+    for(size_t i=0; i<100; ++i){
+        if(i % 10 == 0){
+            // all weights change
+            for(auto & w : weights)
+                w = dist(gen);
+        }
+        else{
+            // a single weight changes
+            weights[i % nFeatures] += dist(gen);
+        }
+        model.updateWeights(weights);
+        checkBetas();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestParametrizedMulticutModelUpdateWeights)
+{
+    // sequential and parallel update
+    checkUpdateWeights<double>(1000, TEST_EPS);
+    checkUpdateWeights<double>(10000, TEST_EPS);
+}
+
+BOOST_AUTO_TEST_CASE(TestParametrizedMulticutModelUpdateWeightsFloat)
+{
+    checkUpdateWeights<float>(1000, TEST_EPS);
+    checkUpdateWeights<float>(10000, TEST_EPS);
+}
@@ -7,26 +7,22 @@
 #include "inferno/model/general_discrete_model.hxx"
 #include "inferno/model/factors_of_variables.hxx"
 #include "inferno/model/view_submodel.hxx"
-
-
-
+#include "inferno_test/random_grid.hxx"
 
 
 BOOST_AUTO_TEST_CASE(TestViewSubmodel)
 {
     using namespace inferno;
 
-    // create the base model
-    const auto shape = {3, 3};
     const auto nl = 4;
-    const auto beta = 0.1;
-    const auto submodular = false;
 
     // create the base model
     typedef models::GeneralDiscreteModel Model;
     typedef models::FactorsOfVariables<Model> FacOfVars;
     BOOST_TEST_CHECKPOINT("model constructor");
-    const Model model = models::grid2d(shape, nl, beta, submodular);
+    Model model(9, nl);
+    // 3x3 grid with random unaries (as factors) and random potts factors
+    test::fillPottsGrid(model, 3, 3, nl, 42, -1.0, 1.0, -1.0, 1.0);
     const FacOfVars facOfVars(model);
     BOOST_CHECK_EQUAL(model.maxVarId(),8);
     BOOST_CHECK_EQUAL(model.nVariables(),9);
@@ -37,23 +33,19 @@ BOOST_AUTO_TEST_CASE(TestViewSubmodel)
     BOOST_TEST_CHECKPOINT("submodel constructor");
     ViewSubmodelType submodel(model, facOfVars);
     INFERNO_CHECK_EMPTY_MODEL(submodel);
-    //BOOST_CHECK_EQUAL(submodel.nFactors(),0);
-    // 0 | 1 | 2 
+    // 0 | 1 | 2
     // -- --- --
     // 3 | 4 | 5
     // -- --  --
     // 6 | 7 | 8
 
 
-    BOOST_TEST_CHECKPOINT("get labels");
-    // set the states of the base model
-    auto & labels = submodel.baseModelLabelMap();
-
     BOOST_TEST_CHECKPOINT("fill labels");
+    // set the states of the base model
     for(const auto vi : model.variableDescriptors())
-        labels[vi] = 0;
+        submodel.setBaseModelLabel(vi, vi % nl);
 
-    // X | 1 | X  
+    // X | 1 | X
     // -- --- --
     // X | 4 | 5
     // -- --  --
@@ -64,7 +56,6 @@ BOOST_AUTO_TEST_CASE(TestViewSubmodel)
     BOOST_TEST_CHECKPOINT("check res");
     {
         const auto svi = {0, 1, 2};
-        const auto snl = {nl, nl, nl};
         INFERNO_CHECK_MODEL_VIS(ViewSubmodelType, submodel, svi);
     }
 
@@ -78,18 +69,17 @@ BOOST_AUTO_TEST_CASE(TestViewSubmodel)
         const auto factor = submodel.factor(fi);
         const auto arity = factor->arity();
         BOOST_CHECK(arity<=2);
-        if(arity==1)
-            BOOST_CHECK_EQUAL(factor->size(),nl);
-        else{
-            BOOST_CHECK_EQUAL(factor->size(),nl*nl);
+        for(size_t d=0; d<arity; ++d){
+            BOOST_CHECK_EQUAL(factor->shape(d), nl);
+            BOOST_CHECK_LT(factor->variable(d), submodel.nVariables());
         }
-        //std::cout<<inferno::io::variableIds(factor)<<"\n";
     }
 
     std::vector<DiscreteLabel> conf(model.nVariables(), 0);
+    for(const auto vi : model.variableDescriptors())
+        conf[vi] = vi % nl;
     std::vector<DiscreteLabel> subConf(submodel.nVariables(), 0);
 
-    const ValueType constTerm = submodel.constTerm();
     for(size_t x1=0; x1<nl; ++x1)
     for(size_t x4=0; x4<nl; ++x4)
     for(size_t x5=0; x5<nl; ++x5){
@@ -102,16 +92,31 @@ BOOST_AUTO_TEST_CASE(TestViewSubmodel)
         subConf[submodel.baseViToVi(4)] = x4;
         subConf[submodel.baseViToVi(5)] = x5;
 
-
         const auto modelEval = model.eval(conf);
+        // submodel.eval includes the const term
         const auto submodelEval = submodel.eval(subConf);
 
-        BOOST_CHECK_CLOSE(modelEval, submodelEval + constTerm, TEST_EPS);
-
-        //std::cout<<"model "<<modelEval<< "sub "<<submodelEval<<" d "<<modelEval-submodelEval<<"\n";
+        BOOST_CHECK_CLOSE(modelEval, submodelEval, TEST_EPS);
     }
 
+    // the submodel can be reused
+    BOOST_TEST_CHECKPOINT("setSubmodelVariables again");
+    submodel.setSubmodelVariables({6, 7});
+    BOOST_CHECK_EQUAL(submodel.nVariables(),2);
+    BOOST_CHECK(!submodel.isInSubmodel(1));
+    BOOST_CHECK(submodel.isInSubmodel(7));
+    // 2 unaries, 1 binary factor, 3 partial factors
+    BOOST_CHECK_EQUAL(submodel.nFactors(),6);
 
-
-
+    for(const auto vi : model.variableDescriptors())
+        conf[vi] = vi % nl;
+    subConf.assign(submodel.nVariables(), 0);
+    for(size_t x6=0; x6<nl; ++x6)
+    for(size_t x7=0; x7<nl; ++x7){
+        conf[6] = x6;
+        conf[7] = x7;
+        subConf[submodel.baseViToVi(6)] = x6;
+        subConf[submodel.baseViToVi(7)] = x7;
+        BOOST_CHECK_CLOSE(model.eval(conf), submodel.eval(subConf), TEST_EPS);
+    }
 }
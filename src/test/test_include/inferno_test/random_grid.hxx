@@ -0,0 +1,179 @@
+#ifndef INFERNO_TEST_RANDOM_GRID_HXX
+#define INFERNO_TEST_RANDOM_GRID_HXX
+
+#include <vector>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+#include "inferno/inferno.hxx"
+#include "inferno/value_tables/potts.hxx"
+#include "inferno/value_tables/unary.hxx"
+
+
+namespace inferno{
+namespace test{
+
+    /** \brief call f(vi0, vi1, horizontal) for each edge of
+        the 4-neighbourhood of a sizeX x sizeY grid
+
+        The variable of (x, y) is y*sizeX + x, the edges are
+        visited in scan order, the horizontal edge of a
+        variable before its vertical edge.
+    */
+    template<class F>
+    void forEachGridEdge(const size_t sizeX, const size_t sizeY, F && f){
+        const Vi nX = sizeX;
+        const Vi nY = sizeY;
+        for(Vi y=0; y<nY; ++y)
+        for(Vi x=0; x<nX; ++x){
+            const Vi vi = y*nX + x;
+            if(x+1 < nX)
+                f(vi, Vi(vi+1), true);
+            if(y+1 < nY)
+                f(vi, Vi(vi+nX), false);
+        }
+    }
+
+    /** \brief random second order model on a grid
+
+        All values are drawn from a std::mt19937 seeded with seed:
+        first unary(gen, vi) for all variables, afterwards
+        pairwise(gen, vi0, vi1, horizontal) for all edges
+        (see forEachGridEdge).
+        Both return a new value table or NULL (no factor).
+    */
+    template<class MODEL, class UNARY, class PAIRWISE>
+    void fillGrid(
+        MODEL & model,
+        const size_t sizeX,
+        const size_t sizeY,
+        const int seed,
+        UNARY && unary,
+        PAIRWISE && pairwise
+    ){
+        std::mt19937 gen(seed);
+        const Vi nVar = sizeX*sizeY;
+        for(Vi vi=0; vi<nVar; ++vi){
+            if(auto vt = unary(gen, vi))
+                model.addFactor(model.addValueTable(vt), {vi});
+        }
+        forEachGridEdge(sizeX, sizeY, [&](const Vi vi0, const Vi vi1, const bool horizontal){
+            if(auto vt = pairwise(gen, vi0, vi1, horizontal))
+                model.addFactor(model.addValueTable(vt), {vi0, vi1});
+        });
+    }
+
+    /** \brief grid with unaries uniform in [unaryLow, unaryHigh)
+        and potts factors with beta uniform in [betaLow, betaHigh)
+    */
+    template<class MODEL>
+    void fillPottsGrid(
+        MODEL & model,
+        const size_t sizeX,
+        const size_t sizeY,
+        const LabelType nl,
+        const int seed,
+        const ValueType betaLow,
+        const ValueType betaHigh,
+        const ValueType unaryLow = 0.0,
+        const ValueType unaryHigh = 1.0
+    ){
+        std::uniform_real_distribution<ValueType> unaryDist(unaryLow, unaryHigh);
+        std::uniform_real_distribution<ValueType> betaDist(betaLow, betaHigh);
+        std::vector<ValueType> vals(nl);
+        fillGrid(model, sizeX, sizeY, seed,
+            [&](std::mt19937 & gen, const Vi){
+                for(auto & v : vals)
+                    v = unaryDist(gen);
+                return new value_tables::UnaryValueTable(vals.begin(), vals.end());
+            },
+            [&](std::mt19937 & gen, const Vi, const Vi, const bool){
+                return new value_tables::PottsValueTable(nl, betaDist(gen));
+            }
+        );
+    }
+
+    /** \brief call f(conf) for all labelings of a model
+        where all variables have the same number of labels
+        (which must be small)
+    */
+    template<class MODEL, class F>
+    void forEachLabeling(const MODEL & model, F && f){
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+        const Vi nVar = model.nVariables();
+        const DiscreteLabel nl = model.nLabels(0);
+        Conf conf(model, 0);
+        while(true){
+            f(static_cast<const Conf &>(conf));
+            Vi vi = 0;
+            for(; vi<nVar; ++vi){
+                if(++conf[vi] < nl)
+                    break;
+                conf[vi] = 0;
+            }
+            if(vi == nVar)
+                break;
+        }
+    }
+
+    /// \brief optimal energy by enumerating all labelings
+    template<class MODEL>
+    ValueType bruteForce(const MODEL & model){
+        ValueType best = std::numeric_limits<ValueType>::infinity();
+        forEachLabeling(model, [&](const typename MODEL:: template VariableMap<DiscreteLabel> & conf){
+            best = std::min(best, model.eval(conf));
+        });
+        return best;
+    }
+
+    /** \brief call f(conf) for all partitions of the variables
+        of a model (as restricted growth strings in the order
+        of the variable descriptors, the number of variables
+        must be small)
+    */
+    template<class MODEL, class F>
+    void forEachPartition(const MODEL & model, F && f){
+        typedef typename MODEL:: template VariableMap<DiscreteLabel> Conf;
+        std::vector<typename MODEL::VariableDescriptor> vars;
+        for(const auto var : model.variableDescriptors())
+            vars.push_back(var);
+        const size_t nVar = vars.size();
+        Conf conf(model, 0);
+        std::vector<DiscreteLabel> maxPrefix(nVar, 0);
+        while(true){
+            f(static_cast<const Conf &>(conf));
+            size_t i = nVar - 1;
+            for(; i>0; --i){
+                if(conf[vars[i]] <= maxPrefix[i-1]){
+                    ++conf[vars[i]];
+                    break;
+                }
+            }
+            if(i == 0)
+                break;
+            for(size_t j=i; j<nVar; ++j){
+                if(j > i)
+                    conf[vars[j]] = 0;
+                maxPrefix[j] = std::max(maxPrefix[j-1], conf[vars[j]]);
+            }
+        }
+    }
+
+    /** \brief optimal energy of a multicut model by enumerating
+        all partitions (see forEachPartition)
+    */
+    template<class MODEL>
+    ValueType bruteForcePartitions(const MODEL & model){
+        ValueType best = std::numeric_limits<ValueType>::infinity();
+        forEachPartition(model, [&](const typename MODEL:: template VariableMap<DiscreteLabel> & conf){
+            best = std::min(best, model.eval(conf));
+        });
+        return best;
+    }
+
+} // end namespace inferno::test
+} // end namespace inferno
+
+
+#endif /* INFERNO_TEST_RANDOM_GRID_HXX */
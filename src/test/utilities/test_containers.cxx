@@ -0,0 +1,140 @@
+#define BOOST_TEST_MODULE ContainersTest
+#include <boost/test/unit_test.hpp>
+
+#include <set>
+#include <map>
+#include <string>
+#include <vector>
+#include <random>
+
+#include "inferno/utilities/small_vector.hxx"
+#include "inferno/utilities/vector_set.hxx"
+#include "inferno/utilities/flat_hash.hxx"
+
+BOOST_AUTO_TEST_CASE(TestSmallVector)
+{
+    typedef inferno::SmallVector<int64_t, 4> Vec;
+    Vec a;
+    std::vector<int64_t> ref;
+    for(int64_t i=0; i<10; ++i){
+        a.push_back(i);
+        ref.push_back(i);
+    }
+    BOOST_CHECK(std::equal(a.begin(), a.end(), ref.begin()));
+
+    a.insert(a.begin() + 3, 42);
+    ref.insert(ref.begin() + 3, 42);
+    a.insert(a.begin() + 1, 2, int64_t(-1));
+    ref.insert(ref.begin() + 1, 2, int64_t(-1));
+    a.erase(a.begin() + 5);
+    ref.erase(ref.begin() + 5);
+    BOOST_REQUIRE_EQUAL(a.size(), ref.size());
+    BOOST_CHECK(std::equal(a.begin(), a.end(), ref.begin()));
+
+    // copy and move of heap and stack vectors
+    Vec b(a);
+    BOOST_CHECK(std::equal(b.begin(), b.end(), ref.begin()));
+    Vec c(std::move(b));
+    BOOST_CHECK_EQUAL(b.size(), 0);
+    BOOST_REQUIRE_EQUAL(c.size(), ref.size());
+    BOOST_CHECK(std::equal(c.begin(), c.end(), ref.begin()));
+    Vec small(3, int64_t(7));
+    Vec d(std::move(small));
+    BOOST_CHECK_EQUAL(d.size(), 3);
+    BOOST_CHECK_EQUAL(d[2], 7);
+    d = std::move(c);
+    BOOST_REQUIRE_EQUAL(d.size(), ref.size());
+    BOOST_CHECK(std::equal(d.begin(), d.end(), ref.begin()));
+    d = Vec(2, int64_t(5));
+    BOOST_CHECK_EQUAL(d.size(), 2);
+    BOOST_CHECK_EQUAL(d[1], 5);
+    d = a;
+    BOOST_CHECK(std::equal(d.begin(), d.end(), ref.begin()));
+
+    // non trivial values
+    inferno::SmallVector<std::string, 2> strings;
+    for(int i=0; i<5; ++i)
+        strings.push_back(std::string(20, char('a' + i)));
+    inferno::SmallVector<std::string, 2> movedStrings(std::move(strings));
+    BOOST_CHECK_EQUAL(movedStrings.size(), 5);
+    BOOST_CHECK_EQUAL(movedStrings[4], std::string(20, 'e'));
+}
+
+BOOST_AUTO_TEST_CASE(TestVectorSetBulk)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> dist(0, 50);
+    std::vector<int> values(200);
+    for(auto & v : values)
+        v = dist(gen);
+    const std::set<int> ref(values.begin(), values.end());
+
+    inferno::VectorSet<int> a;
+    a.assignUnsorted(values.begin(), values.end());
+    BOOST_REQUIRE_EQUAL(a.size(), ref.size());
+    BOOST_CHECK(std::equal(a.begin(), a.end(), ref.begin()));
+
+    inferno::VectorSet<int> b;
+    for(const auto v : values)
+        b.pushBackUnsorted(v);
+    b.sortUnique();
+    BOOST_CHECK(std::equal(b.begin(), b.end(), ref.begin()));
+
+    inferno::VectorSet<int> c;
+    c.insert(values.begin(), values.begin() + 100);
+    c.insert(values.begin() + 100, values.end());
+    BOOST_REQUIRE_EQUAL(c.size(), ref.size());
+    BOOST_CHECK(std::equal(c.begin(), c.end(), ref.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(TestFlatHashSet)
+{
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int64_t> dist(0, 300);
+    inferno::FlatHashSet<int64_t> set;
+    std::set<int64_t> ref;
+    for(size_t i=0; i<5000; ++i){
+        const auto v = dist(gen);
+        if(i % 3 == 0){
+            BOOST_CHECK_EQUAL(set.erase(v), ref.erase(v));
+        }
+        else{
+            BOOST_CHECK_EQUAL(set.insert(v).second, ref.insert(v).second);
+        }
+        BOOST_REQUIRE_EQUAL(set.size(), ref.size());
+    }
+    for(int64_t v=0; v<=300; ++v)
+        BOOST_CHECK_EQUAL(set.count(v), ref.count(v));
+    std::set<int64_t> iterated(set.begin(), set.end());
+    BOOST_CHECK(iterated == ref);
+    set.clear();
+    BOOST_CHECK(set.empty());
+    BOOST_CHECK(set.begin() == set.end());
+}
+
+BOOST_AUTO_TEST_CASE(TestFlatHashMap)
+{
+    inferno::FlatHashMap<uint64_t, std::string> map(10);
+    std::map<uint64_t, std::string> ref;
+    for(uint64_t i=0; i<1000; i+=7){
+        map[i] = std::to_string(i);
+        ref[i] = std::to_string(i);
+    }
+    for(uint64_t i=0; i<1000; i+=21){
+        map.erase(i);
+        ref.erase(i);
+    }
+    BOOST_REQUIRE_EQUAL(map.size(), ref.size());
+    for(const auto & kv : ref){
+        const auto it = map.find(kv.first);
+        BOOST_REQUIRE(it != map.end());
+        BOOST_CHECK_EQUAL(it->second, kv.second);
+    }
+    BOOST_CHECK(map.find(21) == map.end());
+    size_t n = 0;
+    for(const auto & kv : map){
+        BOOST_CHECK_EQUAL(ref[kv.first], kv.second);
+        ++n;
+    }
+    BOOST_CHECK_EQUAL(n, ref.size());
+}
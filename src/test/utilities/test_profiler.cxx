@@ -0,0 +1,80 @@
+#define BOOST_TEST_MODULE ProfilerTest
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <chrono>
+#include <sstream>
+
+#ifndef WITH_PROFILER
+#define WITH_PROFILER
+#endif
+#include "inferno/utilities/profiler.hxx"
+#include "inferno/utilities/timer.hxx"
+
+
+BOOST_AUTO_TEST_CASE(TestTimerClocks)
+{
+    inferno::Timer wallTimer;
+    inferno::Timer cpuTimer(inferno::Timer::ThreadCpuClock);
+    BOOST_CHECK(wallTimer.clock() == inferno::Timer::WallClock);
+
+    wallTimer.tic();
+    cpuTimer.tic();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    wallTimer.toc();
+    cpuTimer.toc();
+
+    // sleeping takes wall-clock time but (almost) no cpu time
+    BOOST_CHECK_GE(wallTimer.elapsedTime(), 0.045);
+    BOOST_CHECK_LT(cpuTimer.elapsedTime(), 0.045);
+    BOOST_CHECK_GE(cpuTimer.elapsedTime(), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(TestProfilerSections)
+{
+    auto & profiler = inferno::utilities::Profiler::instance();
+    profiler.enable();
+    profiler.clear();
+
+    {
+        INFERNO_PROFILE_SCOPE("outer");
+        for(size_t i=0; i<3; ++i){
+            INFERNO_PROFILE_SCOPE("inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    std::thread t([](){
+        INFERNO_PROFILE_SCOPE("thread");
+    });
+    t.join();
+
+    // disabled profiler records nothing
+    profiler.disable();
+    {
+        INFERNO_PROFILE_SCOPE("disabled");
+    }
+    profiler.enable();
+
+    const auto stats = profiler.statistics();
+    BOOST_CHECK_EQUAL(stats.size(), 3);
+    BOOST_REQUIRE(stats.find("outer") != stats.end());
+    BOOST_REQUIRE(stats.find("outer/inner") != stats.end());
+    BOOST_REQUIRE(stats.find("thread") != stats.end());
+    BOOST_CHECK_EQUAL(stats.at("outer").count_, 1);
+    BOOST_CHECK_EQUAL(stats.at("outer/inner").count_, 3);
+    BOOST_CHECK_GE(stats.at("outer/inner").totalTime_, 0.006);
+    BOOST_CHECK_GE(stats.at("outer").totalTime_, stats.at("outer/inner").totalTime_);
+    BOOST_CHECK_CLOSE(stats.at("outer").selfTime_ + stats.at("outer/inner").totalTime_,
+                      stats.at("outer").totalTime_, 0.0001);
+
+    std::stringstream ss;
+    profiler.writeChromeTrace(ss);
+    const auto trace = ss.str();
+    BOOST_CHECK(trace.find("\"traceEvents\"") != std::string::npos);
+    BOOST_CHECK(trace.find("\"name\": \"inner\"") != std::string::npos);
+    BOOST_CHECK(trace.find("\"name\": \"thread\"") != std::string::npos);
+    BOOST_CHECK(trace.find("\"name\": \"disabled\"") == std::string::npos);
+
+    profiler.clear();
+    BOOST_CHECK_EQUAL(profiler.statistics().size(), 0);
+}
@@ -0,0 +1,163 @@
+#define BOOST_TEST_MODULE QueuesTest
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "inferno/utilities/queues.hxx"
+
+// reference: id -> priority
+typedef std::map<uint64_t, double> Reference;
+
+double referenceMin(const Reference & ref){
+    double m = std::numeric_limits<double>::infinity();
+    for(const auto & kv : ref)
+        m = std::min(m, kv.second);
+    return m;
+}
+
+template<class QUEUE>
+void checkQueue(const QUEUE & queue, const Reference & ref){
+    BOOST_REQUIRE_EQUAL(queue.size(), ref.size());
+    BOOST_REQUIRE_EQUAL(queue.empty(), ref.empty());
+    if(!ref.empty()){
+        BOOST_CHECK_EQUAL(double(queue.topPriority()), referenceMin(ref));
+        BOOST_CHECK_EQUAL(double(queue.priority(queue.top())), referenceMin(ref));
+    }
+    for(const auto & kv : ref){
+        BOOST_REQUIRE(queue.contains(kv.first));
+        BOOST_CHECK_EQUAL(double(queue.priority(kv.first)), kv.second);
+    }
+}
+
+// random pushes, priority changes, deletions and pops,
+// new priorities are generated by gen(last top priority)
+template<class QUEUE, class GEN>
+void randomOperations(QUEUE & queue, const size_t maxSize, const int seed, GEN && gen){
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint64_t> idDist(0, maxSize-1);
+    std::uniform_int_distribution<int> opDist(0, 9);
+    Reference ref;
+    double last = 0;
+    for(size_t iter=0; iter<3000; ++iter){
+        const int op = opDist(rng);
+        if(op < 4){
+            const uint64_t id = idDist(rng);
+            const auto p = gen(rng, last);
+            queue.push(id, p);
+            ref[id] = p;
+        }
+        else if(op < 5 && !ref.empty()){
+            const uint64_t id = idDist(rng);
+            if(ref.count(id)){
+                queue.deleteItem(id);
+                ref.erase(id);
+            }
+        }
+        else if(op < 6){
+            // batch
+            std::vector<uint64_t> ids;
+            std::vector<decltype(gen(rng, last))> priorities;
+            for(size_t i=0; i<20; ++i){
+                const uint64_t id = idDist(rng);
+                if(std::find(ids.begin(), ids.end(), id) != ids.end())
+                    continue;
+                ids.push_back(id);
+                priorities.push_back(gen(rng, last));
+                ref[id] = priorities.back();
+            }
+            queue.push(ids.begin(), ids.end(), priorities.begin());
+        }
+        else if(!ref.empty()){
+            const auto top = queue.top();
+            BOOST_REQUIRE(ref.count(top));
+            BOOST_REQUIRE_EQUAL(ref[top], referenceMin(ref));
+            last = ref[top];
+            queue.pop();
+            ref.erase(top);
+        }
+        checkQueue(queue, ref);
+        // checkQueue asked for the top priority
+        if(!ref.empty())
+            last = referenceMin(ref);
+    }
+    queue.reset();
+    BOOST_CHECK(queue.empty());
+    for(uint64_t id=0; id<maxSize; ++id)
+        BOOST_CHECK(!queue.contains(id));
+}
+
+BOOST_AUTO_TEST_CASE(TestDaryHeap)
+{
+    for(int seed=0; seed<5; ++seed){
+        inferno::DaryHeap<double> heap(100);
+        randomOperations(heap, 100, seed, [](std::mt19937 & rng, double){
+            return std::uniform_real_distribution<double>(-1.0, 1.0)(rng);
+        });
+        inferno::DaryHeap<int, 2> binaryHeap(50);
+        randomOperations(binaryHeap, 50, seed, [](std::mt19937 & rng, double){
+            return std::uniform_int_distribution<int>(-10, 10)(rng);
+        });
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestDaryHeapMax)
+{
+    inferno::DaryHeap<double, 4, std::greater<double> > heap(10);
+    const std::vector<double> priorities = {3, 1, 4, 1, 5, 9, 2, 6, 5, 3};
+    for(uint64_t i=0; i<priorities.size(); ++i)
+        heap.push(i, priorities[i]);
+    heap.changePriority(5, 0.5);
+    const std::vector<double> expected = {6, 5, 5, 4, 3, 3, 2, 1, 1, 0.5};
+    for(const auto e : expected){
+        BOOST_CHECK_EQUAL(heap.topPriority(), e);
+        heap.pop();
+    }
+    BOOST_CHECK(heap.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestRadixHeap)
+{
+    for(int seed=0; seed<5; ++seed){
+        inferno::RadixHeap<double> heap(100);
+        randomOperations(heap, 100, seed, [](std::mt19937 & rng, double last){
+            return last + std::uniform_real_distribution<double>(0.0, 10.0)(rng);
+        });
+        inferno::RadixHeap<uint64_t> intHeap(100);
+        randomOperations(intHeap, 100, seed, [](std::mt19937 & rng, double last){
+            return uint64_t(last) + std::uniform_int_distribution<uint64_t>(0, 1000)(rng);
+        });
+        inferno::RadixHeap<int64_t> signedHeap(100);
+        randomOperations(signedHeap, 100, seed, [](std::mt19937 & rng, double last){
+            return int64_t(last) + std::uniform_int_distribution<int64_t>(0, 100)(rng);
+        });
+    }
+    // negative priorities
+    inferno::RadixHeap<int64_t> heap(3);
+    heap.push(0, -5);
+    heap.push(1, 3);
+    heap.push(2, -100);
+    BOOST_CHECK_EQUAL(heap.top(), 2);
+    heap.pop();
+    heap.changePriority(1, -5);
+    BOOST_CHECK_EQUAL(heap.topPriority(), -5);
+    heap.pop();
+    BOOST_CHECK_EQUAL(heap.topPriority(), -5);
+    heap.pop();
+    BOOST_CHECK(heap.empty());
+}
+
+BOOST_AUTO_TEST_CASE(TestBucketQueue)
+{
+    for(int seed=0; seed<5; ++seed){
+        inferno::BucketQueue queue(100, 32);
+        randomOperations(queue, 100, seed, [](std::mt19937 & rng, double){
+            return std::uniform_int_distribution<uint64_t>(0, 31)(rng);
+        });
+    }
+    BOOST_CHECK_EQUAL(inferno::BucketQueue::quantize(-1.0, 0.0, 1.0, 10), 0);
+    BOOST_CHECK_EQUAL(inferno::BucketQueue::quantize(0.55, 0.0, 1.0, 10), 5);
+    BOOST_CHECK_EQUAL(inferno::BucketQueue::quantize(1.0, 0.0, 1.0, 10), 9);
+}
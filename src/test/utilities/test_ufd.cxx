@@ -0,0 +1,121 @@
+#define BOOST_TEST_MODULE UfdTest
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <random>
+#include <thread>
+
+#include "inferno/utilities/ufd.hxx"
+
+// reference partition by repeated relabeling
+std::vector<size_t> referenceLabeling(const size_t n, const std::vector<std::pair<size_t, size_t> > & merges){
+    std::vector<size_t> label(n);
+    for(size_t i=0; i<n; ++i)
+        label[i] = i;
+    for(const auto & m : merges){
+        const size_t a = label[m.first];
+        const size_t b = label[m.second];
+        if(a != b)
+            for(auto & l : label)
+                if(l == b)
+                    l = a;
+    }
+    // dense labels in the order of the smallest elements
+    std::vector<size_t> dense(n, n);
+    size_t nLabels = 0;
+    for(auto & l : label){
+        if(dense[l] == n)
+            dense[l] = nLabels++;
+        l = dense[l];
+    }
+    return label;
+}
+
+// relabel in the order of the first occurrence
+std::vector<size_t> canonicalLabeling(const std::vector<size_t> & labels){
+    std::vector<size_t> dense(labels.size(), labels.size());
+    std::vector<size_t> result(labels.size());
+    size_t nLabels = 0;
+    for(size_t i=0; i<labels.size(); ++i){
+        if(dense[labels[i]] == labels.size())
+            dense[labels[i]] = nLabels++;
+        result[i] = dense[labels[i]];
+    }
+    return result;
+}
+
+std::vector<std::pair<size_t, size_t> > randomMerges(const size_t n, const size_t nMerges, const int seed){
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> dist(0, n-1);
+    std::vector<std::pair<size_t, size_t> > merges(nMerges);
+    for(auto & m : merges)
+        m = std::make_pair(dist(gen), dist(gen));
+    return merges;
+}
+
+BOOST_AUTO_TEST_CASE(TestUfd)
+{
+    const size_t n = 500;
+    for(int seed=0; seed<10; ++seed){
+        const auto merges = randomMerges(n, 300, seed);
+        const auto reference = referenceLabeling(n, merges);
+
+        inferno::utilities::Ufd<size_t> ufd(n);
+        for(const auto & m : merges)
+            ufd.merge(m.first, m.second);
+
+        std::vector<size_t> labels(n);
+        ufd.elementLabeling(labels.begin());
+        BOOST_CHECK(canonicalLabeling(labels) == reference);
+
+        const size_t nSets = *std::max_element(reference.begin(), reference.end()) + 1;
+        BOOST_CHECK_EQUAL(ufd.numberOfSets(), nSets);
+
+        std::vector<size_t> sizes(nSets, 0);
+        for(const auto l : reference)
+            ++sizes[l];
+        for(size_t i=0; i<n; ++i){
+            BOOST_CHECK_EQUAL(ufd.size(i), sizes[reference[i]]);
+            BOOST_CHECK_EQUAL(static_cast<const inferno::utilities::Ufd<size_t> &>(ufd).find(i), ufd.find(i));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestConcurrentUfd)
+{
+    const size_t n = 20000;
+    const size_t nThreads = 4;
+    for(int seed=0; seed<5; ++seed){
+        const auto merges = randomMerges(n, 15000, seed);
+
+        const auto reference = referenceLabeling(n, merges);
+        inferno::utilities::Ufd<size_t> ufd(n);
+        for(const auto & m : merges)
+            ufd.merge(m.first, m.second);
+
+        inferno::utilities::ConcurrentUfd<size_t> cufd(n);
+        std::vector<std::thread> threads;
+        for(size_t t=0; t<nThreads; ++t){
+            threads.emplace_back([&, t](){
+                for(size_t i=t; i<merges.size(); i+=nThreads)
+                    cufd.merge(merges[i].first, merges[i].second);
+            });
+        }
+        for(auto & t : threads)
+            t.join();
+
+        BOOST_CHECK_EQUAL(cufd.numberOfSets(), ufd.numberOfSets());
+        std::vector<size_t> labels(n);
+        cufd.elementLabeling(labels.begin());
+        BOOST_CHECK(labels == reference);
+
+        // the representative is the smallest element of the set,
+        // therefore the labels are in the order of the smallest elements
+        for(size_t i=0; i<n; ++i){
+            BOOST_CHECK_LE(cufd.find(i), i);
+            BOOST_CHECK_EQUAL(labels[cufd.find(i)], labels[i]);
+        }
+        for(const auto & m : merges)
+            BOOST_CHECK(cufd.sameSet(m.first, m.second));
+    }
+}
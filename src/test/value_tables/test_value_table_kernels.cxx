@@ -0,0 +1,220 @@
+#define BOOST_TEST_MODULE ValueTableKernelsTest
+
+#include <boost/test/unit_test.hpp>
+#include "inferno_test/test.hxx"
+
+#include <vector>
+#include <random>
+#include <limits>
+
+#include "inferno/inferno.hxx"
+#include "inferno/utilities/shape_walker.hxx"
+#include "inferno/value_tables/explicit.hxx"
+#include "inferno/value_tables/min_marginals.hxx"
+
+
+typedef inferno::value_tables::DiscreteValueTableBase Vtb;
+typedef inferno::ValueMarray Marray;
+
+// all shapes used below, arity 1 to 7
+std::vector<std::vector<inferno::DiscreteLabel> > testShapes(){
+    return {
+        {4}, {3, 2}, {2, 3, 4}, {3, 1, 2, 3}, {2, 3, 2, 2, 3},
+        {2, 2, 3, 2, 1, 2}, {2, 3, 2, 2, 2, 1, 2}
+    };
+}
+
+// random explicit value table with the given shape
+Marray randomMarray(const std::vector<inferno::DiscreteLabel> & shape, const int seed){
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<inferno::ValueType> dist(-1.0, 1.0);
+    Marray array(shape.begin(), shape.end());
+    for(size_t i=0; i<array.size(); ++i)
+        array(i) = dist(gen);
+    return array;
+}
+
+struct ShapeFunctor{
+    ShapeFunctor(const inferno::DiscreteLabel * shape = nullptr)
+    : shape_(shape){
+    }
+    inferno::DiscreteLabel operator()(const size_t d)const{
+        return shape_[d];
+    }
+    const inferno::DiscreteLabel * shape_;
+};
+
+BOOST_AUTO_TEST_CASE(TestForEachConfiguration)
+{
+    using namespace inferno;
+    for(const auto & shape : testShapes()){
+        const auto arity = shape.size();
+        std::vector<uint64_t> strides(arity);
+        const uint64_t size = shapeStrides(shape.data(), arity, strides.data());
+
+        // same order as ConfIterator and consistent with the strides
+        ConfIterator<ShapeFunctor> confIter(ShapeFunctor(shape.data()), arity, size);
+        uint64_t count = 0;
+        forEachConfiguration(shape.data(), arity, [&](const DiscreteLabel * conf, const uint64_t index){
+            BOOST_REQUIRE_EQUAL(index, count);
+            uint64_t linear = 0;
+            for(size_t d=0; d<arity; ++d){
+                BOOST_CHECK_EQUAL(conf[d], (*confIter)[d]);
+                linear += conf[d]*strides[d];
+            }
+            BOOST_CHECK_EQUAL(linear, index);
+            ++confIter;
+            ++count;
+        });
+        BOOST_CHECK_EQUAL(count, size);
+    }
+    // constant and empty shapes
+    uint64_t count = 0;
+    forEachConfiguration<0>(nullptr, [&](const DiscreteLabel *, const uint64_t){++count;});
+    BOOST_CHECK_EQUAL(count, 1);
+    const DiscreteLabel empty[] = {2, 2, 2, 0, 2, 2, 2};
+    forEachConfiguration(empty, 7, [&](const DiscreteLabel *, const uint64_t){++count;});
+    BOOST_CHECK_EQUAL(count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(TestMinMarginalize)
+{
+    using namespace inferno;
+    for(const auto & shape : testShapes()){
+        const auto arity = shape.size();
+        const auto array = randomMarray(shape, int(arity));
+        std::vector<ValueType> values(array.size());
+        Vtb * vt = new value_tables::Explicit(array);
+        vt->bufferValueTable(values.data());
+
+        std::vector<ValueType> vec(shape[arity-1]);
+        for(size_t l=0; l<vec.size(); ++l)
+            vec[l] = ValueType(l);
+        std::vector<ValueType> added(values);
+        addAlongAxis(added.data(), shape.data(), arity, arity-1, vec.data());
+
+        for(size_t axis=0; axis<arity; ++axis){
+            std::vector<ValueType> ref(shape[axis], std::numeric_limits<ValueType>::infinity());
+            forEachConfiguration(shape.data(), arity, [&](const DiscreteLabel * conf, const uint64_t index){
+                BOOST_CHECK_EQUAL(added[index], values[index] + vec[conf[arity-1]]);
+                ref[conf[axis]] = std::min(ref[conf[axis]], vt->eval(conf));
+            });
+            std::vector<ValueType> out(shape[axis]);
+            std::vector<uint64_t> argOut(shape[axis]);
+            minMarginalize(values.data(), shape.data(), arity, axis, out.data());
+            for(DiscreteLabel l=0; l<shape[axis]; ++l)
+                BOOST_CHECK_EQUAL(out[l], ref[l]);
+            minMarginalize(values.data(), shape.data(), arity, axis, out.data(), argOut.data());
+            for(DiscreteLabel l=0; l<shape[axis]; ++l){
+                BOOST_CHECK_EQUAL(out[l], ref[l]);
+                BOOST_CHECK_EQUAL(values[argOut[l]], ref[l]);
+            }
+        }
+        delete vt;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestMinMarginalizeInteger)
+{
+    using namespace inferno;
+    // integer types have no infinity, the minima must still be correct
+    const DiscreteLabel shape[2] = {3, 2};
+    const int64_t values[6] = {5, 7, 6,   9, 4, 8};
+    int64_t out[2];
+    uint64_t argOut[2];
+    minMarginalize(values, shape, 2, 1, out);
+    BOOST_CHECK_EQUAL(out[0], 5);
+    BOOST_CHECK_EQUAL(out[1], 4);
+    minMarginalize(values, shape, 2, 1, out, argOut);
+    BOOST_CHECK_EQUAL(out[0], 5);
+    BOOST_CHECK_EQUAL(out[1], 4);
+    BOOST_CHECK_EQUAL(argOut[0], 0);
+    BOOST_CHECK_EQUAL(argOut[1], 4);
+    const uint32_t uvalues[6] = {5, 7, 6,   9, 4, 8};
+    uint32_t uout[3];
+    minMarginalize(uvalues, shape, 2, 0, uout);
+    BOOST_CHECK_EQUAL(uout[0], 5);
+    BOOST_CHECK_EQUAL(uout[1], 4);
+    BOOST_CHECK_EQUAL(uout[2], 6);
+}
+
+BOOST_AUTO_TEST_CASE(TestFacToVarMsg)
+{
+    using namespace inferno;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<ValueType> dist(-1.0, 1.0);
+    for(const auto & shape : testShapes()){
+        const auto arity = shape.size();
+        if(arity < 2)
+            continue;
+        Vtb * vt = new value_tables::Explicit(randomMarray(shape, 3));
+
+        std::vector<std::vector<ValueType> > in(arity), out(arity), ref(arity);
+        std::vector<const ValueType *> inPtr(arity);
+        std::vector<ValueType *> outPtr(arity);
+        for(size_t a=0; a<arity; ++a){
+            in[a].resize(shape[a]);
+            for(auto & v : in[a])
+                v = dist(gen);
+            out[a].resize(shape[a]);
+            ref[a].assign(shape[a], std::numeric_limits<ValueType>::infinity());
+            inPtr[a] = in[a].data();
+            outPtr[a] = out[a].data();
+        }
+
+        // brute force
+        forEachConfiguration(shape.data(), arity, [&](const DiscreteLabel * conf, const uint64_t){
+            for(size_t a=0; a<arity; ++a){
+                ValueType s = vt->eval(conf);
+                for(size_t b=0; b<arity; ++b)
+                    if(b != a)
+                        s += in[b][conf[b]];
+                ref[a][conf[a]] = std::min(ref[a][conf[a]], s);
+            }
+        });
+
+        vt->facToVarMsg(inPtr.data(), outPtr.data());
+        for(size_t a=0; a<arity; ++a)
+        for(DiscreteLabel l=0; l<shape[a]; ++l)
+            _CHECK_CLOSE(out[a][l], ref[a][l], TEST_EPS);
+        delete vt;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(TestMinMarginals)
+{
+    using namespace inferno;
+    for(const auto & shape : testShapes()){
+        const auto arity = shape.size();
+        Vtb * vt = new value_tables::Explicit(randomMarray(shape, 7));
+        const value_tables::MinMarginals mm(vt);
+        BOOST_REQUIRE_EQUAL(mm.arity(), arity);
+
+        ValueType minValue = std::numeric_limits<ValueType>::infinity();
+        ValueType maxValue = -minValue;
+        forEachConfiguration(shape.data(), arity, [&](const DiscreteLabel * conf, const uint64_t){
+            minValue = std::min(minValue, vt->eval(conf));
+            maxValue = std::max(maxValue, vt->eval(conf));
+        });
+        BOOST_CHECK_EQUAL(mm.minValue(), minValue);
+        BOOST_CHECK_EQUAL(mm.maxValue(), maxValue);
+
+        std::vector<DiscreteLabel> conf(arity);
+        mm.argmin(conf.data());
+        BOOST_CHECK_EQUAL(vt->eval(conf.data()), minValue);
+        BOOST_CHECK_EQUAL(vt->argmin(conf.data()), minValue);
+
+        for(size_t a=0; a<arity; ++a){
+            BOOST_CHECK_EQUAL(mm.shape(a), shape[a]);
+            for(DiscreteLabel l=0; l<shape[a]; ++l){
+                mm.argminMarginal(a, l, conf.data());
+                BOOST_CHECK_EQUAL(conf[a], l);
+                BOOST_CHECK_EQUAL(vt->eval(conf.data()), mm.minMarginal(a, l));
+                BOOST_CHECK_EQUAL(mm.minMarginal(a)[l], mm.minMarginal(a, l));
+                BOOST_CHECK_GE(mm.minMarginal(a, l), minValue);
+            }
+            BOOST_CHECK_EQUAL(*std::min_element(mm.minMarginal(a), mm.minMarginal(a) + shape[a]), minValue);
+        }
+        delete vt;
+    }
+}